@@ -20,6 +20,8 @@ public class EnhancedOnlineSubsystem : ModuleRules
 		{ 
 			"CoreUObject",
 			"Engine",
+			"Json",
+			"Projects",
 		});
 	}
 }
@@ -0,0 +1,71 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineDeferredCallbacks.h"
+
+FEnhancedOnlineDeferredCallbacks::FEnhancedOnlineDeferredCallbacks()
+{
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FEnhancedOnlineDeferredCallbacks::Tick));
+}
+
+FEnhancedOnlineDeferredCallbacks::~FEnhancedOnlineDeferredCallbacks()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+}
+
+void FEnhancedOnlineDeferredCallbacks::Schedule(const void* Owner, double DelaySeconds, TUniqueFunction<void()>&& Callback)
+{
+	FScheduledCallback& Scheduled = ScheduledCallbacks.AddDefaulted_GetRef();
+	Scheduled.DueTime = FPlatformTime::Seconds() + FMath::Max(DelaySeconds, 0.0);
+	Scheduled.Sequence = NextSequence++;
+	Scheduled.Owner = Owner;
+	Scheduled.Callback = MoveTemp(Callback);
+}
+
+void FEnhancedOnlineDeferredCallbacks::Cancel(const void* Owner)
+{
+	ScheduledCallbacks.RemoveAll([Owner](const FScheduledCallback& Scheduled)
+	{
+		return Scheduled.Owner == Owner;
+	});
+
+	// The owner may go away from within a callback that is being dispatched
+	for (FScheduledCallback& Dispatching : DispatchingCallbacks)
+	{
+		if (Dispatching.Owner == Owner)
+		{
+			Dispatching.Callback.Reset();
+		}
+	}
+}
+
+bool FEnhancedOnlineDeferredCallbacks::Tick(float DeltaTime)
+{
+	const double Now = FPlatformTime::Seconds();
+
+	// Callbacks may schedule further ones, those run on the next tick at the earliest
+	check(DispatchingCallbacks.Num() == 0);
+	for (int32 Index = ScheduledCallbacks.Num() - 1; Index >= 0; --Index)
+	{
+		if (ScheduledCallbacks[Index].DueTime <= Now)
+		{
+			DispatchingCallbacks.Add(MoveTemp(ScheduledCallbacks[Index]));
+			ScheduledCallbacks.RemoveAt(Index, 1, false);
+		}
+	}
+
+	DispatchingCallbacks.Sort([](const FScheduledCallback& A, const FScheduledCallback& B)
+	{
+		return A.DueTime != B.DueTime ? A.DueTime < B.DueTime : A.Sequence < B.Sequence;
+	});
+
+	for (int32 Index = 0; Index < DispatchingCallbacks.Num(); ++Index)
+	{
+		if (DispatchingCallbacks[Index].Callback)
+		{
+			DispatchingCallbacks[Index].Callback();
+		}
+	}
+
+	DispatchingCallbacks.Reset();
+	return true;
+}
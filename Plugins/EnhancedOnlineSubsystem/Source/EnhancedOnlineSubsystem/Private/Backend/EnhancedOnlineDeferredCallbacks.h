@@ -0,0 +1,47 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+
+/**
+ * Runs callbacks on the core ticker once their delay has passed, for the backends that hold answers back
+ * Callbacks are dispatched by due time and, for equal times, in the order they were scheduled.
+ */
+class FEnhancedOnlineDeferredCallbacks
+{
+public:
+	FEnhancedOnlineDeferredCallbacks();
+	~FEnhancedOnlineDeferredCallbacks();
+
+	FEnhancedOnlineDeferredCallbacks(const FEnhancedOnlineDeferredCallbacks&) = delete;
+	FEnhancedOnlineDeferredCallbacks& operator=(const FEnhancedOnlineDeferredCallbacks&) = delete;
+
+	/** Runs the callback on the first tick after the delay, callbacks scheduled while dispatching run on the next tick at the earliest */
+	void Schedule(const void* Owner, double DelaySeconds, TUniqueFunction<void()>&& Callback);
+
+	/** Drops the callbacks of an owner, safe to call from within a callback that is being dispatched */
+	void Cancel(const void* Owner);
+
+	int32 Num() const { return ScheduledCallbacks.Num(); }
+
+private:
+	struct FScheduledCallback
+	{
+		double DueTime = 0.0;
+		uint64 Sequence = 0;
+		const void* Owner = nullptr;
+		TUniqueFunction<void()> Callback;
+	};
+
+	bool Tick(float DeltaTime);
+
+	TArray<FScheduledCallback> ScheduledCallbacks;
+
+	/** Callbacks that are due in the current tick */
+	TArray<FScheduledCallback> DispatchingCallbacks;
+
+	uint64 NextSequence = 0;
+	FTSTicker::FDelegateHandle TickerHandle;
+};
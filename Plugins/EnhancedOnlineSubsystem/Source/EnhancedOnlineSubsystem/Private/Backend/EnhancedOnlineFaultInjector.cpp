@@ -0,0 +1,262 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineFaultInjector.h"
+
+#include "EnhancedOnlineSubsystem.h"
+#include "OnlineSessionSettings.h"
+
+static TAutoConsoleVariable<bool> CVarEnhancedFaultsEnabled(
+	TEXT("EnhancedOnline.Faults.Enabled"),
+	false,
+	TEXT("Wraps the session and identity interfaces of every backend with the fault injection. Read when the subsystem initializes, the other EnhancedOnline.Faults variables apply right away."));
+
+static TAutoConsoleVariable<FString> CVarEnhancedFaultsMethods(
+	TEXT("EnhancedOnline.Faults.Methods"),
+	TEXT(""),
+	TEXT("Comma separated answers to inject faults into: CreateSession, StartSession, FindSessions, JoinSession, Login, Logout. Empty targets all of them."));
+
+static TAutoConsoleVariable<float> CVarEnhancedFaultsDelayMs(
+	TEXT("EnhancedOnline.Faults.DelayMs"),
+	0.0f,
+	TEXT("Milliseconds every targeted answer of the backend is held back."));
+
+static TAutoConsoleVariable<float> CVarEnhancedFaultsJitterMs(
+	TEXT("EnhancedOnline.Faults.JitterMs"),
+	0.0f,
+	TEXT("Random milliseconds, up to this value, added to the delay of every targeted answer."));
+
+static TAutoConsoleVariable<float> CVarEnhancedFaultsDropChance(
+	TEXT("EnhancedOnline.Faults.DropChance"),
+	0.0f,
+	TEXT("Chance, 0 to 1, that a targeted answer never arrives."));
+
+static TAutoConsoleVariable<float> CVarEnhancedFaultsPartialResultsChance(
+	TEXT("EnhancedOnline.Faults.PartialResultsChance"),
+	0.0f,
+	TEXT("Chance, 0 to 1, that a search answer only keeps a random part of its results."));
+
+static TAutoConsoleVariable<float> CVarEnhancedFaultsReorderChance(
+	TEXT("EnhancedOnline.Faults.ReorderChance"),
+	0.0f,
+	TEXT("Chance, 0 to 1, that a targeted answer is held back for EnhancedOnline.Faults.ReorderMs more, so answers to later calls overtake it."));
+
+static TAutoConsoleVariable<float> CVarEnhancedFaultsReorderMs(
+	TEXT("EnhancedOnline.Faults.ReorderMs"),
+	1000.0f,
+	TEXT("Milliseconds a reordered answer is held back on top of its delay."));
+
+namespace EnhancedOnlineFaults
+{
+	static const TCHAR* GetMethodName(EEnhancedFaultMethod Method)
+	{
+		switch (Method)
+		{
+		case EEnhancedFaultMethod::CreateSession: return TEXT("CreateSession");
+		case EEnhancedFaultMethod::StartSession: return TEXT("StartSession");
+		case EEnhancedFaultMethod::FindSessions: return TEXT("FindSessions");
+		case EEnhancedFaultMethod::JoinSession: return TEXT("JoinSession");
+		case EEnhancedFaultMethod::Login: return TEXT("Login");
+		case EEnhancedFaultMethod::Logout: return TEXT("Logout");
+		default: return TEXT("Unknown");
+		}
+	}
+
+	static bool RollChance(float Chance)
+	{
+		return Chance > 0.0f && FMath::FRand() < Chance;
+	}
+}
+
+TSharedPtr<FEnhancedOnlineFaultInjector> FEnhancedOnlineFaultInjector::Create()
+{
+	if (!CVarEnhancedFaultsEnabled.GetValueOnGameThread())
+	{
+		return nullptr;
+	}
+
+	TSharedPtr<FEnhancedOnlineFaultInjector> Injector = MakeShareable(new FEnhancedOnlineFaultInjector());
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Injecting faults into the answers of the online backend."));
+	return Injector;
+}
+
+void FEnhancedOnlineFaultInjector::Relay(const void* Owner, EEnhancedFaultMethod Method, TUniqueFunction<void()>&& Answer)
+{
+	if (!IsTargeted(Method))
+	{
+		Answer();
+		return;
+	}
+
+	if (EnhancedOnlineFaults::RollChance(CVarEnhancedFaultsDropChance.GetValueOnGameThread()))
+	{
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Fault injection dropped the answer to %s."), EnhancedOnlineFaults::GetMethodName(Method));
+		return;
+	}
+
+	double DelayMs = FMath::Max(CVarEnhancedFaultsDelayMs.GetValueOnGameThread(), 0.0f);
+	DelayMs += FMath::FRand() * FMath::Max(CVarEnhancedFaultsJitterMs.GetValueOnGameThread(), 0.0f);
+
+	if (EnhancedOnlineFaults::RollChance(CVarEnhancedFaultsReorderChance.GetValueOnGameThread()))
+	{
+		DelayMs += FMath::Max(CVarEnhancedFaultsReorderMs.GetValueOnGameThread(), 0.0f);
+		UE_LOG(LogEnhancedSubsystem, Verbose, TEXT("Fault injection reorders the answer to %s."), EnhancedOnlineFaults::GetMethodName(Method));
+	}
+
+	if (DelayMs <= 0.0)
+	{
+		Answer();
+		return;
+	}
+
+	UE_LOG(LogEnhancedSubsystem, Verbose, TEXT("Fault injection holds the answer to %s back for %.0f ms."), EnhancedOnlineFaults::GetMethodName(Method), DelayMs);
+
+	HeldAnswers.Schedule(Owner, DelayMs / 1000.0, MoveTemp(Answer));
+}
+
+bool FEnhancedOnlineFaultInjector::ShouldTruncateResults() const
+{
+	return IsTargeted(EEnhancedFaultMethod::FindSessions)
+		&& EnhancedOnlineFaults::RollChance(CVarEnhancedFaultsPartialResultsChance.GetValueOnGameThread());
+}
+
+void FEnhancedOnlineFaultInjector::Cancel(const void* Owner)
+{
+	HeldAnswers.Cancel(Owner);
+}
+
+bool FEnhancedOnlineFaultInjector::IsTargeted(EEnhancedFaultMethod Method) const
+{
+	const FString Methods = CVarEnhancedFaultsMethods.GetValueOnGameThread();
+	if (Methods.IsEmpty())
+	{
+		return true;
+	}
+
+	TArray<FString> MethodNames;
+	Methods.ParseIntoArray(MethodNames, TEXT(","));
+
+	const TCHAR* MethodName = EnhancedOnlineFaults::GetMethodName(Method);
+	return MethodNames.ContainsByPredicate([MethodName](const FString& Name)
+	{
+		return Name.TrimStartAndEnd().Equals(MethodName, ESearchCase::IgnoreCase);
+	});
+}
+
+FEnhancedOnlineSessionFaultInjector::FEnhancedOnlineSessionFaultInjector(const IOnlineSessionPtr& InInner, const TSharedRef<FEnhancedOnlineFaultInjector>& InInjector)
+	: FEnhancedOnlineSessionDecorator(InInner)
+	, Injector(InInjector)
+{
+}
+
+FEnhancedOnlineSessionFaultInjector::~FEnhancedOnlineSessionFaultInjector()
+{
+	Injector->Cancel(this);
+}
+
+bool FEnhancedOnlineSessionFaultInjector::FindSessions(int32 SearchingPlayerNum, const TSharedRef<FOnlineSessionSearch>& SearchSettings)
+{
+	return TrackFindSessions([&]()
+	{
+		return Inner->FindSessions(SearchingPlayerNum, SearchSettings);
+	}, SearchSettings);
+}
+
+bool FEnhancedOnlineSessionFaultInjector::FindSessions(const FUniqueNetId& SearchingPlayerId, const TSharedRef<FOnlineSessionSearch>& SearchSettings)
+{
+	return TrackFindSessions([&]()
+	{
+		return Inner->FindSessions(SearchingPlayerId, SearchSettings);
+	}, SearchSettings);
+}
+
+void FEnhancedOnlineSessionFaultInjector::OnInnerCreateSessionComplete(FName SessionName, bool bWasSuccessful)
+{
+	Injector->Relay(this, EEnhancedFaultMethod::CreateSession, [this, SessionName, bWasSuccessful]()
+	{
+		FEnhancedOnlineSessionDecorator::OnInnerCreateSessionComplete(SessionName, bWasSuccessful);
+	});
+}
+
+void FEnhancedOnlineSessionFaultInjector::OnInnerStartSessionComplete(FName SessionName, bool bWasSuccessful)
+{
+	Injector->Relay(this, EEnhancedFaultMethod::StartSession, [this, SessionName, bWasSuccessful]()
+	{
+		FEnhancedOnlineSessionDecorator::OnInnerStartSessionComplete(SessionName, bWasSuccessful);
+	});
+}
+
+void FEnhancedOnlineSessionFaultInjector::OnInnerFindSessionsComplete(bool bWasSuccessful)
+{
+	TSharedPtr<FOnlineSessionSearch> SearchSettings;
+	if (OpenSearches.Num() > 0)
+	{
+		SearchSettings = OpenSearches[0];
+		OpenSearches.RemoveAt(0);
+	}
+
+	Injector->Relay(this, EEnhancedFaultMethod::FindSessions, [this, SearchSettings, bWasSuccessful]()
+	{
+		// The search is only cut down once it is handed on, the backend is done with it by then
+		if (SearchSettings.IsValid() && SearchSettings->SearchResults.Num() > 0 && Injector->ShouldTruncateResults())
+		{
+			const int32 NumResults = SearchSettings->SearchResults.Num();
+			const int32 NumKept = FMath::RandRange(0, NumResults - 1);
+			SearchSettings->SearchResults.SetNum(NumKept);
+
+			UE_LOG(LogEnhancedSubsystem, Log, TEXT("Fault injection kept %d of %d search results."), NumKept, NumResults);
+		}
+
+		FEnhancedOnlineSessionDecorator::OnInnerFindSessionsComplete(bWasSuccessful);
+	});
+}
+
+void FEnhancedOnlineSessionFaultInjector::OnInnerJoinSessionComplete(FName SessionName, EOnJoinSessionCompleteResult::Type Result)
+{
+	Injector->Relay(this, EEnhancedFaultMethod::JoinSession, [this, SessionName, Result]()
+	{
+		FEnhancedOnlineSessionDecorator::OnInnerJoinSessionComplete(SessionName, Result);
+	});
+}
+
+bool FEnhancedOnlineSessionFaultInjector::TrackFindSessions(TFunctionRef<bool()> Call, const TSharedRef<FOnlineSessionSearch>& SearchSettings)
+{
+	OpenSearches.Add(SearchSettings);
+
+	// A rejected search was either answered right away or never will be
+	const bool bStarted = Call();
+	if (!bStarted)
+	{
+		OpenSearches.Remove(SearchSettings);
+	}
+
+	return bStarted;
+}
+
+FEnhancedOnlineIdentityFaultInjector::FEnhancedOnlineIdentityFaultInjector(const IOnlineIdentityPtr& InInner, const TSharedRef<FEnhancedOnlineFaultInjector>& InInjector)
+	: FEnhancedOnlineIdentityDecorator(InInner)
+	, Injector(InInjector)
+{
+}
+
+FEnhancedOnlineIdentityFaultInjector::~FEnhancedOnlineIdentityFaultInjector()
+{
+	Injector->Cancel(this);
+}
+
+void FEnhancedOnlineIdentityFaultInjector::OnInnerLoginComplete(int32 LocalUserNum, bool bWasSuccessful, const FUniqueNetId& UserId, const FString& Error)
+{
+	// The backend only lends the id for the duration of its own callback
+	Injector->Relay(this, EEnhancedFaultMethod::Login, [this, LocalUserNum, bWasSuccessful, UserIdRef = UserId.AsShared(), Error]()
+	{
+		FEnhancedOnlineIdentityDecorator::OnInnerLoginComplete(LocalUserNum, bWasSuccessful, *UserIdRef, Error);
+	});
+}
+
+void FEnhancedOnlineIdentityFaultInjector::OnInnerLogoutComplete(int32 LocalUserNum, bool bWasSuccessful)
+{
+	Injector->Relay(this, EEnhancedFaultMethod::Logout, [this, LocalUserNum, bWasSuccessful]()
+	{
+		FEnhancedOnlineIdentityDecorator::OnInnerLogoutComplete(LocalUserNum, bWasSuccessful);
+	});
+}
@@ -0,0 +1,104 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnhancedOnlineDeferredCallbacks.h"
+#include "EnhancedOnlineIdentityDecorator.h"
+#include "EnhancedOnlineSessionDecorator.h"
+
+/**
+ * Backend answers faults can be injected into, see EnhancedOnline.Faults.Methods
+ */
+enum class EEnhancedFaultMethod : uint8
+{
+	CreateSession,
+	StartSession,
+	FindSessions,
+	JoinSession,
+	Login,
+	Logout,
+
+	Num
+};
+
+/**
+ * Delays, drops and reorders the answers of the backend, configured by the EnhancedOnline.Faults console variables
+ * Shared by the wrappers of every backend, so session and identity answers can overtake each other.
+ */
+class FEnhancedOnlineFaultInjector
+{
+public:
+	/** Creates the injector if EnhancedOnline.Faults.Enabled is set, returns null otherwise */
+	static TSharedPtr<FEnhancedOnlineFaultInjector> Create();
+
+	/**
+	 * Passes an answer of the backend on after the configured delay, or drops it.
+	 * Answers of methods that aren't targeted, or that aren't delayed, are passed on right away.
+	 */
+	void Relay(const void* Owner, EEnhancedFaultMethod Method, TUniqueFunction<void()>&& Answer);
+
+	/** Rolls whether a search answer only keeps part of its results */
+	bool ShouldTruncateResults() const;
+
+	/** Drops the answers an interface is holding back, called when it is destroyed */
+	void Cancel(const void* Owner);
+
+private:
+	FEnhancedOnlineFaultInjector() = default;
+
+	bool IsTargeted(EEnhancedFaultMethod Method) const;
+
+	FEnhancedOnlineDeferredCallbacks HeldAnswers;
+};
+
+/**
+ * Injects faults into the create, start, search and join answers of the session interface of a backend
+ */
+class FEnhancedOnlineSessionFaultInjector : public FEnhancedOnlineSessionDecorator
+{
+public:
+	FEnhancedOnlineSessionFaultInjector(const IOnlineSessionPtr& InInner, const TSharedRef<FEnhancedOnlineFaultInjector>& InInjector);
+	virtual ~FEnhancedOnlineSessionFaultInjector() override;
+
+	//~ Begin IOnlineSession Interface
+	virtual bool FindSessions(int32 SearchingPlayerNum, const TSharedRef<FOnlineSessionSearch>& SearchSettings) override;
+	virtual bool FindSessions(const FUniqueNetId& SearchingPlayerId, const TSharedRef<FOnlineSessionSearch>& SearchSettings) override;
+	//~ End IOnlineSession Interface
+
+protected:
+	//~ Begin FEnhancedOnlineSessionDecorator Interface
+	virtual void OnInnerCreateSessionComplete(FName SessionName, bool bWasSuccessful) override;
+	virtual void OnInnerStartSessionComplete(FName SessionName, bool bWasSuccessful) override;
+	virtual void OnInnerFindSessionsComplete(bool bWasSuccessful) override;
+	virtual void OnInnerJoinSessionComplete(FName SessionName, EOnJoinSessionCompleteResult::Type Result) override;
+	//~ End FEnhancedOnlineSessionDecorator Interface
+
+private:
+	/** Remembers a search, so its results can be truncated once the backend answers */
+	bool TrackFindSessions(TFunctionRef<bool()> Call, const TSharedRef<FOnlineSessionSearch>& SearchSettings);
+
+	TSharedRef<FEnhancedOnlineFaultInjector> Injector;
+
+	/** Searches that weren't answered yet, oldest first */
+	TArray<TSharedRef<FOnlineSessionSearch>> OpenSearches;
+};
+
+/**
+ * Injects faults into the login and logout answers of the identity interface of a backend
+ */
+class FEnhancedOnlineIdentityFaultInjector : public FEnhancedOnlineIdentityDecorator
+{
+public:
+	FEnhancedOnlineIdentityFaultInjector(const IOnlineIdentityPtr& InInner, const TSharedRef<FEnhancedOnlineFaultInjector>& InInjector);
+	virtual ~FEnhancedOnlineIdentityFaultInjector() override;
+
+protected:
+	//~ Begin FEnhancedOnlineIdentityDecorator Interface
+	virtual void OnInnerLoginComplete(int32 LocalUserNum, bool bWasSuccessful, const FUniqueNetId& UserId, const FString& Error) override;
+	virtual void OnInnerLogoutComplete(int32 LocalUserNum, bool bWasSuccessful) override;
+	//~ End FEnhancedOnlineIdentityDecorator Interface
+
+private:
+	TSharedRef<FEnhancedOnlineFaultInjector> Injector;
+};
@@ -0,0 +1,126 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineIdentityDecorator.h"
+
+FEnhancedOnlineIdentityDecorator::FEnhancedOnlineIdentityDecorator(const IOnlineIdentityPtr& InInner)
+	: Inner(InInner)
+{
+	check(Inner.IsValid());
+
+	for (int32 LocalUserNum = 0; LocalUserNum < MAX_LOCAL_PLAYERS; ++LocalUserNum)
+	{
+		LoginCompleteHandles[LocalUserNum] = Inner->AddOnLoginCompleteDelegate_Handle(LocalUserNum, FOnLoginCompleteDelegate::CreateRaw(this, &FEnhancedOnlineIdentityDecorator::OnInnerLoginComplete));
+		LogoutCompleteHandles[LocalUserNum] = Inner->AddOnLogoutCompleteDelegate_Handle(LocalUserNum, FOnLogoutCompleteDelegate::CreateRaw(this, &FEnhancedOnlineIdentityDecorator::OnInnerLogoutComplete));
+		LoginStatusChangedHandles[LocalUserNum] = Inner->AddOnLoginStatusChangedDelegate_Handle(LocalUserNum, FOnLoginStatusChangedDelegate::CreateRaw(this, &FEnhancedOnlineIdentityDecorator::OnInnerLoginStatusChanged));
+	}
+}
+
+FEnhancedOnlineIdentityDecorator::~FEnhancedOnlineIdentityDecorator()
+{
+	for (int32 LocalUserNum = 0; LocalUserNum < MAX_LOCAL_PLAYERS; ++LocalUserNum)
+	{
+		Inner->ClearOnLoginCompleteDelegate_Handle(LocalUserNum, LoginCompleteHandles[LocalUserNum]);
+		Inner->ClearOnLogoutCompleteDelegate_Handle(LocalUserNum, LogoutCompleteHandles[LocalUserNum]);
+		Inner->ClearOnLoginStatusChangedDelegate_Handle(LocalUserNum, LoginStatusChangedHandles[LocalUserNum]);
+	}
+}
+
+bool FEnhancedOnlineIdentityDecorator::Login(int32 LocalUserNum, const FOnlineAccountCredentials& AccountCredentials)
+{
+	return Inner->Login(LocalUserNum, AccountCredentials);
+}
+
+bool FEnhancedOnlineIdentityDecorator::Logout(int32 LocalUserNum)
+{
+	return Inner->Logout(LocalUserNum);
+}
+
+bool FEnhancedOnlineIdentityDecorator::AutoLogin(int32 LocalUserNum)
+{
+	return Inner->AutoLogin(LocalUserNum);
+}
+
+TSharedPtr<FUserOnlineAccount> FEnhancedOnlineIdentityDecorator::GetUserAccount(const FUniqueNetId& UserId) const
+{
+	return Inner->GetUserAccount(UserId);
+}
+
+TArray<TSharedPtr<FUserOnlineAccount>> FEnhancedOnlineIdentityDecorator::GetAllUserAccounts() const
+{
+	return Inner->GetAllUserAccounts();
+}
+
+FUniqueNetIdPtr FEnhancedOnlineIdentityDecorator::GetUniquePlayerId(int32 LocalUserNum) const
+{
+	return Inner->GetUniquePlayerId(LocalUserNum);
+}
+
+FUniqueNetIdPtr FEnhancedOnlineIdentityDecorator::CreateUniquePlayerId(uint8* Bytes, int32 Size)
+{
+	return Inner->CreateUniquePlayerId(Bytes, Size);
+}
+
+FUniqueNetIdPtr FEnhancedOnlineIdentityDecorator::CreateUniquePlayerId(const FString& Str)
+{
+	return Inner->CreateUniquePlayerId(Str);
+}
+
+ELoginStatus::Type FEnhancedOnlineIdentityDecorator::GetLoginStatus(int32 LocalUserNum) const
+{
+	return Inner->GetLoginStatus(LocalUserNum);
+}
+
+ELoginStatus::Type FEnhancedOnlineIdentityDecorator::GetLoginStatus(const FUniqueNetId& UserId) const
+{
+	return Inner->GetLoginStatus(UserId);
+}
+
+FString FEnhancedOnlineIdentityDecorator::GetPlayerNickname(int32 LocalUserNum) const
+{
+	return Inner->GetPlayerNickname(LocalUserNum);
+}
+
+FString FEnhancedOnlineIdentityDecorator::GetPlayerNickname(const FUniqueNetId& UserId) const
+{
+	return Inner->GetPlayerNickname(UserId);
+}
+
+FString FEnhancedOnlineIdentityDecorator::GetAuthToken(int32 LocalUserNum) const
+{
+	return Inner->GetAuthToken(LocalUserNum);
+}
+
+void FEnhancedOnlineIdentityDecorator::RevokeAuthToken(const FUniqueNetId& LocalUserId, const FOnRevokeAuthTokenCompleteDelegate& Delegate)
+{
+	Inner->RevokeAuthToken(LocalUserId, Delegate);
+}
+
+void FEnhancedOnlineIdentityDecorator::GetUserPrivilege(const FUniqueNetId& LocalUserId, EUserPrivileges::Type Privilege, const FOnGetUserPrivilegeCompleteDelegate& Delegate, EShowPrivilegeResolveUI ShowResolveUI)
+{
+	Inner->GetUserPrivilege(LocalUserId, Privilege, Delegate, ShowResolveUI);
+}
+
+FPlatformUserId FEnhancedOnlineIdentityDecorator::GetPlatformUserIdFromUniqueNetId(const FUniqueNetId& UniqueNetId) const
+{
+	return Inner->GetPlatformUserIdFromUniqueNetId(UniqueNetId);
+}
+
+FString FEnhancedOnlineIdentityDecorator::GetAuthType() const
+{
+	return Inner->GetAuthType();
+}
+
+void FEnhancedOnlineIdentityDecorator::OnInnerLoginComplete(int32 LocalUserNum, bool bWasSuccessful, const FUniqueNetId& UserId, const FString& Error)
+{
+	TriggerOnLoginCompleteDelegates(LocalUserNum, bWasSuccessful, UserId, Error);
+}
+
+void FEnhancedOnlineIdentityDecorator::OnInnerLogoutComplete(int32 LocalUserNum, bool bWasSuccessful)
+{
+	TriggerOnLogoutCompleteDelegates(LocalUserNum, bWasSuccessful);
+}
+
+void FEnhancedOnlineIdentityDecorator::OnInnerLoginStatusChanged(int32 LocalUserNum, ELoginStatus::Type OldStatus, ELoginStatus::Type NewStatus, const FUniqueNetId& NewId)
+{
+	TriggerOnLoginStatusChangedDelegates(LocalUserNum, OldStatus, NewStatus, NewId);
+}
@@ -0,0 +1,54 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/OnlineIdentityInterface.h"
+
+/**
+ * Identity interface that forwards every call to the identity interface of a backend
+ * Base for wrappers that observe or alter the traffic between the subsystem and the backend.
+ * Only the notifications the subsystem listens to are relayed from the backend.
+ */
+class FEnhancedOnlineIdentityDecorator : public IOnlineIdentity
+{
+public:
+	explicit FEnhancedOnlineIdentityDecorator(const IOnlineIdentityPtr& InInner);
+	virtual ~FEnhancedOnlineIdentityDecorator() override;
+
+	/** The wrapped identity interface */
+	const IOnlineIdentityPtr& GetInner() const { return Inner; }
+
+	//~ Begin IOnlineIdentity Interface
+	virtual bool Login(int32 LocalUserNum, const FOnlineAccountCredentials& AccountCredentials) override;
+	virtual bool Logout(int32 LocalUserNum) override;
+	virtual bool AutoLogin(int32 LocalUserNum) override;
+	virtual TSharedPtr<FUserOnlineAccount> GetUserAccount(const FUniqueNetId& UserId) const override;
+	virtual TArray<TSharedPtr<FUserOnlineAccount>> GetAllUserAccounts() const override;
+	virtual FUniqueNetIdPtr GetUniquePlayerId(int32 LocalUserNum) const override;
+	virtual FUniqueNetIdPtr CreateUniquePlayerId(uint8* Bytes, int32 Size) override;
+	virtual FUniqueNetIdPtr CreateUniquePlayerId(const FString& Str) override;
+	virtual ELoginStatus::Type GetLoginStatus(int32 LocalUserNum) const override;
+	virtual ELoginStatus::Type GetLoginStatus(const FUniqueNetId& UserId) const override;
+	virtual FString GetPlayerNickname(int32 LocalUserNum) const override;
+	virtual FString GetPlayerNickname(const FUniqueNetId& UserId) const override;
+	virtual FString GetAuthToken(int32 LocalUserNum) const override;
+	virtual void RevokeAuthToken(const FUniqueNetId& LocalUserId, const FOnRevokeAuthTokenCompleteDelegate& Delegate) override;
+	virtual void GetUserPrivilege(const FUniqueNetId& LocalUserId, EUserPrivileges::Type Privilege, const FOnGetUserPrivilegeCompleteDelegate& Delegate, EShowPrivilegeResolveUI ShowResolveUI = EShowPrivilegeResolveUI::Default) override;
+	virtual FPlatformUserId GetPlatformUserIdFromUniqueNetId(const FUniqueNetId& UniqueNetId) const override;
+	virtual FString GetAuthType() const override;
+	//~ End IOnlineIdentity Interface
+
+protected:
+	/** Notifications of the wrapped backend, relayed to the listeners of this interface */
+	virtual void OnInnerLoginComplete(int32 LocalUserNum, bool bWasSuccessful, const FUniqueNetId& UserId, const FString& Error);
+	virtual void OnInnerLogoutComplete(int32 LocalUserNum, bool bWasSuccessful);
+	virtual void OnInnerLoginStatusChanged(int32 LocalUserNum, ELoginStatus::Type OldStatus, ELoginStatus::Type NewStatus, const FUniqueNetId& NewId);
+
+	IOnlineIdentityPtr Inner;
+
+private:
+	FDelegateHandle LoginCompleteHandles[MAX_LOCAL_PLAYERS];
+	FDelegateHandle LogoutCompleteHandles[MAX_LOCAL_PLAYERS];
+	FDelegateHandle LoginStatusChangedHandles[MAX_LOCAL_PLAYERS];
+};
@@ -0,0 +1,298 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineSessionDecorator.h"
+
+#include "OnlineSessionSettings.h"
+
+FEnhancedOnlineSessionDecorator::FEnhancedOnlineSessionDecorator(const IOnlineSessionPtr& InInner)
+	: Inner(InInner)
+{
+	check(Inner.IsValid());
+
+	CreateSessionCompleteHandle = Inner->AddOnCreateSessionCompleteDelegate_Handle(FOnCreateSessionCompleteDelegate::CreateRaw(this, &FEnhancedOnlineSessionDecorator::OnInnerCreateSessionComplete));
+	StartSessionCompleteHandle = Inner->AddOnStartSessionCompleteDelegate_Handle(FOnStartSessionCompleteDelegate::CreateRaw(this, &FEnhancedOnlineSessionDecorator::OnInnerStartSessionComplete));
+	UpdateSessionCompleteHandle = Inner->AddOnUpdateSessionCompleteDelegate_Handle(FOnUpdateSessionCompleteDelegate::CreateRaw(this, &FEnhancedOnlineSessionDecorator::OnInnerUpdateSessionComplete));
+	EndSessionCompleteHandle = Inner->AddOnEndSessionCompleteDelegate_Handle(FOnEndSessionCompleteDelegate::CreateRaw(this, &FEnhancedOnlineSessionDecorator::OnInnerEndSessionComplete));
+	DestroySessionCompleteHandle = Inner->AddOnDestroySessionCompleteDelegate_Handle(FOnDestroySessionCompleteDelegate::CreateRaw(this, &FEnhancedOnlineSessionDecorator::OnInnerDestroySessionComplete));
+	FindSessionsCompleteHandle = Inner->AddOnFindSessionsCompleteDelegate_Handle(FOnFindSessionsCompleteDelegate::CreateRaw(this, &FEnhancedOnlineSessionDecorator::OnInnerFindSessionsComplete));
+	CancelFindSessionsCompleteHandle = Inner->AddOnCancelFindSessionsCompleteDelegate_Handle(FOnCancelFindSessionsCompleteDelegate::CreateRaw(this, &FEnhancedOnlineSessionDecorator::OnInnerCancelFindSessionsComplete));
+	JoinSessionCompleteHandle = Inner->AddOnJoinSessionCompleteDelegate_Handle(FOnJoinSessionCompleteDelegate::CreateRaw(this, &FEnhancedOnlineSessionDecorator::OnInnerJoinSessionComplete));
+	RegisterPlayersCompleteHandle = Inner->AddOnRegisterPlayersCompleteDelegate_Handle(FOnRegisterPlayersCompleteDelegate::CreateRaw(this, &FEnhancedOnlineSessionDecorator::OnInnerRegisterPlayersComplete));
+	UnregisterPlayersCompleteHandle = Inner->AddOnUnregisterPlayersCompleteDelegate_Handle(FOnUnregisterPlayersCompleteDelegate::CreateRaw(this, &FEnhancedOnlineSessionDecorator::OnInnerUnregisterPlayersComplete));
+	SessionSettingsUpdatedHandle = Inner->AddOnSessionSettingsUpdatedDelegate_Handle(FOnSessionSettingsUpdatedDelegate::CreateRaw(this, &FEnhancedOnlineSessionDecorator::OnInnerSessionSettingsUpdated));
+}
+
+FEnhancedOnlineSessionDecorator::~FEnhancedOnlineSessionDecorator()
+{
+	Inner->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteHandle);
+	Inner->ClearOnStartSessionCompleteDelegate_Handle(StartSessionCompleteHandle);
+	Inner->ClearOnUpdateSessionCompleteDelegate_Handle(UpdateSessionCompleteHandle);
+	Inner->ClearOnEndSessionCompleteDelegate_Handle(EndSessionCompleteHandle);
+	Inner->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteHandle);
+	Inner->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteHandle);
+	Inner->ClearOnCancelFindSessionsCompleteDelegate_Handle(CancelFindSessionsCompleteHandle);
+	Inner->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteHandle);
+	Inner->ClearOnRegisterPlayersCompleteDelegate_Handle(RegisterPlayersCompleteHandle);
+	Inner->ClearOnUnregisterPlayersCompleteDelegate_Handle(UnregisterPlayersCompleteHandle);
+	Inner->ClearOnSessionSettingsUpdatedDelegate_Handle(SessionSettingsUpdatedHandle);
+}
+
+FNamedOnlineSession* FEnhancedOnlineSessionDecorator::GetNamedSession(FName SessionName)
+{
+	return Inner->GetNamedSession(SessionName);
+}
+
+void FEnhancedOnlineSessionDecorator::RemoveNamedSession(FName SessionName)
+{
+	Inner->RemoveNamedSession(SessionName);
+}
+
+bool FEnhancedOnlineSessionDecorator::HasPresenceSession()
+{
+	return Inner->HasPresenceSession();
+}
+
+EOnlineSessionState::Type FEnhancedOnlineSessionDecorator::GetSessionState(FName SessionName) const
+{
+	return Inner->GetSessionState(SessionName);
+}
+
+FUniqueNetIdPtr FEnhancedOnlineSessionDecorator::CreateSessionIdFromString(const FString& SessionIdStr)
+{
+	return Inner->CreateSessionIdFromString(SessionIdStr);
+}
+
+bool FEnhancedOnlineSessionDecorator::CreateSession(int32 HostingPlayerNum, FName SessionName, const FOnlineSessionSettings& NewSessionSettings)
+{
+	return Inner->CreateSession(HostingPlayerNum, SessionName, NewSessionSettings);
+}
+
+bool FEnhancedOnlineSessionDecorator::CreateSession(const FUniqueNetId& HostingPlayerId, FName SessionName, const FOnlineSessionSettings& NewSessionSettings)
+{
+	return Inner->CreateSession(HostingPlayerId, SessionName, NewSessionSettings);
+}
+
+bool FEnhancedOnlineSessionDecorator::StartSession(FName SessionName)
+{
+	return Inner->StartSession(SessionName);
+}
+
+bool FEnhancedOnlineSessionDecorator::UpdateSession(FName SessionName, FOnlineSessionSettings& UpdatedSessionSettings, bool bShouldRefreshOnlineData)
+{
+	return Inner->UpdateSession(SessionName, UpdatedSessionSettings, bShouldRefreshOnlineData);
+}
+
+bool FEnhancedOnlineSessionDecorator::EndSession(FName SessionName)
+{
+	return Inner->EndSession(SessionName);
+}
+
+bool FEnhancedOnlineSessionDecorator::DestroySession(FName SessionName, const FOnDestroySessionCompleteDelegate& CompletionDelegate)
+{
+	return Inner->DestroySession(SessionName, CompletionDelegate);
+}
+
+bool FEnhancedOnlineSessionDecorator::IsPlayerInSession(FName SessionName, const FUniqueNetId& UniqueId)
+{
+	return Inner->IsPlayerInSession(SessionName, UniqueId);
+}
+
+bool FEnhancedOnlineSessionDecorator::StartMatchmaking(const TArray<FUniqueNetIdRef>& LocalPlayers, FName SessionName, const FOnlineSessionSettings& NewSessionSettings, TSharedRef<FOnlineSessionSearch>& SearchSettings)
+{
+	return Inner->StartMatchmaking(LocalPlayers, SessionName, NewSessionSettings, SearchSettings);
+}
+
+bool FEnhancedOnlineSessionDecorator::CancelMatchmaking(int32 SearchingPlayerNum, FName SessionName)
+{
+	return Inner->CancelMatchmaking(SearchingPlayerNum, SessionName);
+}
+
+bool FEnhancedOnlineSessionDecorator::CancelMatchmaking(const FUniqueNetId& SearchingPlayerId, FName SessionName)
+{
+	return Inner->CancelMatchmaking(SearchingPlayerId, SessionName);
+}
+
+bool FEnhancedOnlineSessionDecorator::FindSessions(int32 SearchingPlayerNum, const TSharedRef<FOnlineSessionSearch>& SearchSettings)
+{
+	return Inner->FindSessions(SearchingPlayerNum, SearchSettings);
+}
+
+bool FEnhancedOnlineSessionDecorator::FindSessions(const FUniqueNetId& SearchingPlayerId, const TSharedRef<FOnlineSessionSearch>& SearchSettings)
+{
+	return Inner->FindSessions(SearchingPlayerId, SearchSettings);
+}
+
+bool FEnhancedOnlineSessionDecorator::FindSessionById(const FUniqueNetId& SearchingUserId, const FUniqueNetId& SessionId, const FUniqueNetId& FriendId, const FOnSingleSessionResultCompleteDelegate& CompletionDelegate)
+{
+	return Inner->FindSessionById(SearchingUserId, SessionId, FriendId, CompletionDelegate);
+}
+
+bool FEnhancedOnlineSessionDecorator::CancelFindSessions()
+{
+	return Inner->CancelFindSessions();
+}
+
+bool FEnhancedOnlineSessionDecorator::PingSearchResults(const FOnlineSessionSearchResult& SearchResult)
+{
+	return Inner->PingSearchResults(SearchResult);
+}
+
+bool FEnhancedOnlineSessionDecorator::JoinSession(int32 LocalUserNum, FName SessionName, const FOnlineSessionSearchResult& DesiredSession)
+{
+	return Inner->JoinSession(LocalUserNum, SessionName, DesiredSession);
+}
+
+bool FEnhancedOnlineSessionDecorator::JoinSession(const FUniqueNetId& LocalUserId, FName SessionName, const FOnlineSessionSearchResult& DesiredSession)
+{
+	return Inner->JoinSession(LocalUserId, SessionName, DesiredSession);
+}
+
+bool FEnhancedOnlineSessionDecorator::FindFriendSession(int32 LocalUserNum, const FUniqueNetId& Friend)
+{
+	return Inner->FindFriendSession(LocalUserNum, Friend);
+}
+
+bool FEnhancedOnlineSessionDecorator::FindFriendSession(const FUniqueNetId& LocalUserId, const FUniqueNetId& Friend)
+{
+	return Inner->FindFriendSession(LocalUserId, Friend);
+}
+
+bool FEnhancedOnlineSessionDecorator::FindFriendSession(const FUniqueNetId& LocalUserId, const TArray<FUniqueNetIdRef>& FriendList)
+{
+	return Inner->FindFriendSession(LocalUserId, FriendList);
+}
+
+bool FEnhancedOnlineSessionDecorator::SendSessionInviteToFriend(int32 LocalUserNum, FName SessionName, const FUniqueNetId& Friend)
+{
+	return Inner->SendSessionInviteToFriend(LocalUserNum, SessionName, Friend);
+}
+
+bool FEnhancedOnlineSessionDecorator::SendSessionInviteToFriend(const FUniqueNetId& LocalUserId, FName SessionName, const FUniqueNetId& Friend)
+{
+	return Inner->SendSessionInviteToFriend(LocalUserId, SessionName, Friend);
+}
+
+bool FEnhancedOnlineSessionDecorator::SendSessionInviteToFriends(int32 LocalUserNum, FName SessionName, const TArray<FUniqueNetIdRef>& Friends)
+{
+	return Inner->SendSessionInviteToFriends(LocalUserNum, SessionName, Friends);
+}
+
+bool FEnhancedOnlineSessionDecorator::SendSessionInviteToFriends(const FUniqueNetId& LocalUserId, FName SessionName, const TArray<FUniqueNetIdRef>& Friends)
+{
+	return Inner->SendSessionInviteToFriends(LocalUserId, SessionName, Friends);
+}
+
+bool FEnhancedOnlineSessionDecorator::GetResolvedConnectString(FName SessionName, FString& ConnectInfo, FName PortType)
+{
+	return Inner->GetResolvedConnectString(SessionName, ConnectInfo, PortType);
+}
+
+bool FEnhancedOnlineSessionDecorator::GetResolvedConnectString(const FOnlineSessionSearchResult& SearchResult, FName PortType, FString& ConnectInfo)
+{
+	return Inner->GetResolvedConnectString(SearchResult, PortType, ConnectInfo);
+}
+
+FOnlineSessionSettings* FEnhancedOnlineSessionDecorator::GetSessionSettings(FName SessionName)
+{
+	return Inner->GetSessionSettings(SessionName);
+}
+
+bool FEnhancedOnlineSessionDecorator::RegisterPlayer(FName SessionName, const FUniqueNetId& PlayerId, bool bWasInvited)
+{
+	return Inner->RegisterPlayer(SessionName, PlayerId, bWasInvited);
+}
+
+bool FEnhancedOnlineSessionDecorator::RegisterPlayers(FName SessionName, const TArray<FUniqueNetIdRef>& Players, bool bWasInvited)
+{
+	return Inner->RegisterPlayers(SessionName, Players, bWasInvited);
+}
+
+bool FEnhancedOnlineSessionDecorator::UnregisterPlayer(FName SessionName, const FUniqueNetId& PlayerId)
+{
+	return Inner->UnregisterPlayer(SessionName, PlayerId);
+}
+
+bool FEnhancedOnlineSessionDecorator::UnregisterPlayers(FName SessionName, const TArray<FUniqueNetIdRef>& Players)
+{
+	return Inner->UnregisterPlayers(SessionName, Players);
+}
+
+void FEnhancedOnlineSessionDecorator::RegisterLocalPlayer(const FUniqueNetId& PlayerId, FName SessionName, const FOnRegisterLocalPlayerCompleteDelegate& Delegate)
+{
+	Inner->RegisterLocalPlayer(PlayerId, SessionName, Delegate);
+}
+
+void FEnhancedOnlineSessionDecorator::UnregisterLocalPlayer(const FUniqueNetId& PlayerId, FName SessionName, const FOnUnregisterLocalPlayerCompleteDelegate& Delegate)
+{
+	Inner->UnregisterLocalPlayer(PlayerId, SessionName, Delegate);
+}
+
+void FEnhancedOnlineSessionDecorator::RemovePlayerFromSession(int32 LocalUserNum, FName SessionName, const FUniqueNetId& TargetPlayerId)
+{
+	Inner->RemovePlayerFromSession(LocalUserNum, SessionName, TargetPlayerId);
+}
+
+int32 FEnhancedOnlineSessionDecorator::GetNumSessions()
+{
+	return Inner->GetNumSessions();
+}
+
+void FEnhancedOnlineSessionDecorator::DumpSessionState()
+{
+	Inner->DumpSessionState();
+}
+
+void FEnhancedOnlineSessionDecorator::OnInnerCreateSessionComplete(FName SessionName, bool bWasSuccessful)
+{
+	TriggerOnCreateSessionCompleteDelegates(SessionName, bWasSuccessful);
+}
+
+void FEnhancedOnlineSessionDecorator::OnInnerStartSessionComplete(FName SessionName, bool bWasSuccessful)
+{
+	TriggerOnStartSessionCompleteDelegates(SessionName, bWasSuccessful);
+}
+
+void FEnhancedOnlineSessionDecorator::OnInnerUpdateSessionComplete(FName SessionName, bool bWasSuccessful)
+{
+	TriggerOnUpdateSessionCompleteDelegates(SessionName, bWasSuccessful);
+}
+
+void FEnhancedOnlineSessionDecorator::OnInnerEndSessionComplete(FName SessionName, bool bWasSuccessful)
+{
+	TriggerOnEndSessionCompleteDelegates(SessionName, bWasSuccessful);
+}
+
+void FEnhancedOnlineSessionDecorator::OnInnerDestroySessionComplete(FName SessionName, bool bWasSuccessful)
+{
+	TriggerOnDestroySessionCompleteDelegates(SessionName, bWasSuccessful);
+}
+
+void FEnhancedOnlineSessionDecorator::OnInnerFindSessionsComplete(bool bWasSuccessful)
+{
+	TriggerOnFindSessionsCompleteDelegates(bWasSuccessful);
+}
+
+void FEnhancedOnlineSessionDecorator::OnInnerCancelFindSessionsComplete(bool bWasSuccessful)
+{
+	TriggerOnCancelFindSessionsCompleteDelegates(bWasSuccessful);
+}
+
+void FEnhancedOnlineSessionDecorator::OnInnerJoinSessionComplete(FName SessionName, EOnJoinSessionCompleteResult::Type Result)
+{
+	TriggerOnJoinSessionCompleteDelegates(SessionName, Result);
+}
+
+void FEnhancedOnlineSessionDecorator::OnInnerRegisterPlayersComplete(FName SessionName, const TArray<FUniqueNetIdRef>& Players, bool bWasSuccessful)
+{
+	TriggerOnRegisterPlayersCompleteDelegates(SessionName, Players, bWasSuccessful);
+}
+
+void FEnhancedOnlineSessionDecorator::OnInnerUnregisterPlayersComplete(FName SessionName, const TArray<FUniqueNetIdRef>& Players, bool bWasSuccessful)
+{
+	TriggerOnUnregisterPlayersCompleteDelegates(SessionName, Players, bWasSuccessful);
+}
+
+void FEnhancedOnlineSessionDecorator::OnInnerSessionSettingsUpdated(FName SessionName, const FOnlineSessionSettings& UpdatedSettings)
+{
+	TriggerOnSessionSettingsUpdatedDelegates(SessionName, UpdatedSettings);
+}
@@ -0,0 +1,429 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineTrace.h"
+
+#include "EnhancedOnlineSubsystem.h"
+#include "EnhancedOnlineVariantSerialization.h"
+#include "OnlineSessionSettings.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace EnhancedOnlineTrace
+{
+	static constexpr uint32 FileMagic = 0x454F5452; // 'EOTR'
+	static constexpr int32 FileVersion = 2;
+
+	static int32 ToIndex(EEnhancedTraceMethod Method)
+	{
+		return static_cast<int32>(Method);
+	}
+
+	static FString GetConnectStringKey(const FString& SessionId, FName PortType)
+	{
+		return SessionId + TEXT("|") + PortType.ToString();
+	}
+}
+
+void EnhancedOnlineTrace::WriteSearchResult(FArchive& Ar, const FOnlineSessionSearchResult& SearchResult)
+{
+	const FOnlineSession& Session = SearchResult.Session;
+	const FOnlineSessionSettings& Settings = Session.SessionSettings;
+
+	FString SessionId = Session.SessionInfo.IsValid() ? Session.SessionInfo->GetSessionId().ToString() : FString();
+	FString OwningUserName = Session.OwningUserName;
+	int32 BuildUniqueId = Settings.BuildUniqueId;
+	int32 NumPublicConnections = Settings.NumPublicConnections;
+	int32 NumPrivateConnections = Settings.NumPrivateConnections;
+	int32 NumOpenPublicConnections = Session.NumOpenPublicConnections;
+	int32 NumOpenPrivateConnections = Session.NumOpenPrivateConnections;
+	int32 PingInMs = SearchResult.PingInMs;
+
+	uint16 Flags = 0;
+	Flags |= Settings.bShouldAdvertise ? 1 << 0 : 0;
+	Flags |= Settings.bAllowJoinInProgress ? 1 << 1 : 0;
+	Flags |= Settings.bIsLANMatch ? 1 << 2 : 0;
+	Flags |= Settings.bIsDedicated ? 1 << 3 : 0;
+	Flags |= Settings.bUsesStats ? 1 << 4 : 0;
+	Flags |= Settings.bAllowInvites ? 1 << 5 : 0;
+	Flags |= Settings.bUsesPresence ? 1 << 6 : 0;
+	Flags |= Settings.bAllowJoinViaPresence ? 1 << 7 : 0;
+	Flags |= Settings.bAllowJoinViaPresenceFriendsOnly ? 1 << 8 : 0;
+	Flags |= Settings.bAntiCheatProtected ? 1 << 9 : 0;
+	Flags |= Settings.bUseLobbiesIfAvailable ? 1 << 10 : 0;
+
+	Ar << SessionId;
+	WriteUniqueNetId(Ar, Session.OwningUserId.Get());
+	Ar << OwningUserName << BuildUniqueId << Flags;
+	Ar << NumPublicConnections << NumPrivateConnections << NumOpenPublicConnections << NumOpenPrivateConnections;
+	Ar << PingInMs;
+
+	int32 NumSettings = Settings.Settings.Num();
+	Ar << NumSettings;
+
+	for (const TPair<FName, FOnlineSessionSetting>& Setting : Settings.Settings)
+	{
+		FName Key = Setting.Key;
+		uint8 AdvertisementType = static_cast<uint8>(Setting.Value.AdvertisementType);
+		Ar << Key << AdvertisementType;
+		EnhancedOnlineVariantSerialization::WriteVariantData(Ar, Setting.Value.Data);
+	}
+}
+
+void EnhancedOnlineTrace::ReadSearchResult(FArchive& Ar, FString& OutSessionId, FOnlineSessionSearchResult& OutSearchResult)
+{
+	FOnlineSession& Session = OutSearchResult.Session;
+	FOnlineSessionSettings& Settings = Session.SessionSettings;
+
+	uint16 Flags = 0;
+	int32 NumSettings = 0;
+
+	Ar << OutSessionId;
+	Session.OwningUserId = ReadUniqueNetId(Ar);
+	Ar << Session.OwningUserName << Settings.BuildUniqueId << Flags;
+	Ar << Settings.NumPublicConnections << Settings.NumPrivateConnections << Session.NumOpenPublicConnections << Session.NumOpenPrivateConnections;
+	Ar << OutSearchResult.PingInMs << NumSettings;
+
+	Settings.bShouldAdvertise = (Flags & (1 << 0)) != 0;
+	Settings.bAllowJoinInProgress = (Flags & (1 << 1)) != 0;
+	Settings.bIsLANMatch = (Flags & (1 << 2)) != 0;
+	Settings.bIsDedicated = (Flags & (1 << 3)) != 0;
+	Settings.bUsesStats = (Flags & (1 << 4)) != 0;
+	Settings.bAllowInvites = (Flags & (1 << 5)) != 0;
+	Settings.bUsesPresence = (Flags & (1 << 6)) != 0;
+	Settings.bAllowJoinViaPresence = (Flags & (1 << 7)) != 0;
+	Settings.bAllowJoinViaPresenceFriendsOnly = (Flags & (1 << 8)) != 0;
+	Settings.bAntiCheatProtected = (Flags & (1 << 9)) != 0;
+	Settings.bUseLobbiesIfAvailable = (Flags & (1 << 10)) != 0;
+
+	for (int32 Index = 0; Index < NumSettings && !Ar.IsError(); ++Index)
+	{
+		FName Key;
+		uint8 AdvertisementType = 0;
+		Ar << Key << AdvertisementType;
+
+		FOnlineSessionSetting& Setting = Settings.Settings.Add(Key);
+		Setting.AdvertisementType = static_cast<EOnlineDataAdvertisementType::Type>(AdvertisementType);
+		EnhancedOnlineVariantSerialization::ReadVariantData(Ar, Setting.Data);
+	}
+}
+
+void EnhancedOnlineTrace::WriteUniqueNetId(FArchive& Ar, const FUniqueNetId* UniqueId)
+{
+	FString IdStr = UniqueId ? UniqueId->ToString() : FString();
+	FString Type = UniqueId ? UniqueId->GetType().ToString() : FString();
+	Ar << IdStr << Type;
+}
+
+FUniqueNetIdPtr EnhancedOnlineTrace::ReadUniqueNetId(FArchive& Ar)
+{
+	FString IdStr;
+	FString Type;
+	Ar << IdStr << Type;
+
+	if (IdStr.IsEmpty())
+	{
+		return nullptr;
+	}
+
+	return FUniqueNetIdString::Create(IdStr, FName(*Type));
+}
+
+FString EnhancedOnlineTrace::GetTraceFilePath(const FString& FileName)
+{
+	FString FilePath = FPaths::IsRelative(FileName) ? FPaths::ProjectSavedDir() / TEXT("EnhancedOnline") / TEXT("Traces") / FileName : FileName;
+	if (FPaths::GetExtension(FilePath).IsEmpty())
+	{
+		FilePath += TEXT(".eotrace");
+	}
+
+	return FilePath;
+}
+
+TSharedPtr<FEnhancedOnlineTraceWriter> FEnhancedOnlineTraceWriter::Create(const FString& FilePath)
+{
+	using namespace EnhancedOnlineTrace;
+
+	TUniquePtr<FArchive> FileWriter(IFileManager::Get().CreateFileWriter(*FilePath));
+	if (!FileWriter.IsValid())
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Failed to create the online trace %s."), *FilePath);
+		return nullptr;
+	}
+
+	uint32 Magic = FileMagic;
+	int32 Version = FileVersion;
+	*FileWriter << Magic << Version;
+
+	TSharedPtr<FEnhancedOnlineTraceWriter> Writer = MakeShareable(new FEnhancedOnlineTraceWriter());
+	Writer->FilePath = FilePath;
+	Writer->FileWriter = MoveTemp(FileWriter);
+	Writer->StartTime = FPlatformTime::Seconds();
+	return Writer;
+}
+
+FEnhancedOnlineTraceWriter::~FEnhancedOnlineTraceWriter()
+{
+	if (FileWriter.IsValid())
+	{
+		FileWriter->Close();
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Wrote %d events to the online trace %s."), NumEvents, *FilePath);
+	}
+}
+
+FEnhancedTraceCallToken FEnhancedOnlineTraceWriter::BeginCall(EEnhancedTraceMethod Method)
+{
+	const int32 MethodIndex = EnhancedOnlineTrace::ToIndex(Method);
+
+	FEnhancedTraceCallToken Token;
+	Token.CallId = NextCallId++;
+	Token.StartTime = GetTimeSeconds();
+	Token.NumCallbacks = NumCallbacks[MethodIndex];
+
+	if (NextCallId == 0)
+	{
+		NextCallId = 1;
+	}
+
+	OpenCalls[MethodIndex].Add(Token);
+	return Token;
+}
+
+void FEnhancedOnlineTraceWriter::EndCall(EEnhancedTraceMethod Method, const FEnhancedTraceCallToken& Token, bool bStarted)
+{
+	const int32 MethodIndex = EnhancedOnlineTrace::ToIndex(Method);
+	const bool bAnswered = NumCallbacks[MethodIndex] > Token.NumCallbacks;
+
+	// A rejected call that wasn't answered right away never will be
+	if (!bStarted && !bAnswered)
+	{
+		OpenCalls[MethodIndex].RemoveAll([&Token](const FEnhancedTraceCallToken& OpenCall) { return OpenCall.CallId == Token.CallId; });
+	}
+
+	FEnhancedTraceEvent Event;
+	Event.Type = EEnhancedTraceEventType::Call;
+	Event.Method = Method;
+	Event.TimeSeconds = Token.StartTime;
+	Event.CallId = Token.CallId;
+
+	FMemoryWriter PayloadWriter(Event.Payload);
+	bool bStartedValue = bStarted;
+	bool bAnsweredValue = bStarted || bAnswered;
+	PayloadWriter << bStartedValue << bAnsweredValue;
+
+	WriteEvent(Event);
+}
+
+void FEnhancedOnlineTraceWriter::AddCallback(EEnhancedTraceMethod Method, TArray<uint8>&& Payload)
+{
+	const int32 MethodIndex = EnhancedOnlineTrace::ToIndex(Method);
+
+	FEnhancedTraceEvent Event;
+	Event.Type = EEnhancedTraceEventType::Callback;
+	Event.Method = Method;
+	Event.TimeSeconds = GetTimeSeconds();
+	Event.Payload = MoveTemp(Payload);
+
+	// Callbacks the subsystem didn't ask for answer no call and have no latency
+	if (OpenCalls[MethodIndex].Num() > 0)
+	{
+		Event.CallId = OpenCalls[MethodIndex][0].CallId;
+		Event.LatencySeconds = Event.TimeSeconds - OpenCalls[MethodIndex][0].StartTime;
+		OpenCalls[MethodIndex].RemoveAt(0, 1, false);
+	}
+
+	++NumCallbacks[MethodIndex];
+	WriteEvent(Event);
+}
+
+void FEnhancedOnlineTraceWriter::WriteEvent(FEnhancedTraceEvent& Event)
+{
+	uint8 Type = static_cast<uint8>(Event.Type);
+	uint8 Method = static_cast<uint8>(Event.Method);
+	*FileWriter << Type << Method << Event.CallId << Event.TimeSeconds << Event.LatencySeconds << Event.Payload;
+
+	// Keeps the trace usable when the process doesn't shut down cleanly
+	FileWriter->Flush();
+	++NumEvents;
+}
+
+double FEnhancedOnlineTraceWriter::GetTimeSeconds() const
+{
+	return FPlatformTime::Seconds() - StartTime;
+}
+
+TSharedPtr<FEnhancedOnlineTracePlayer> FEnhancedOnlineTracePlayer::Load(const FString& FilePath, float Speed)
+{
+	using namespace EnhancedOnlineTrace;
+
+	TArray<uint8> FileData;
+	if (!FFileHelper::LoadFileToArray(FileData, *FilePath, FILEREAD_Silent))
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Failed to read the online trace %s."), *FilePath);
+		return nullptr;
+	}
+
+	FMemoryReader FileReader(FileData);
+
+	uint32 Magic = 0;
+	int32 Version = 0;
+	FileReader << Magic << Version;
+
+	if (FileReader.IsError() || Magic != FileMagic || Version != FileVersion)
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("%s is not a valid online trace."), *FilePath);
+		return nullptr;
+	}
+
+	TSharedPtr<FEnhancedOnlineTracePlayer> Player = MakeShareable(new FEnhancedOnlineTracePlayer());
+	Player->FilePath = FilePath;
+	Player->Speed = FMath::Max(Speed, 0.0f);
+
+	int32 NumUnsolicitedCallbacks = 0;
+	while (!FileReader.AtEnd())
+	{
+		FEnhancedTraceEvent Event;
+		uint8 Type = 0;
+		uint8 Method = 0;
+		FileReader << Type << Method << Event.CallId << Event.TimeSeconds << Event.LatencySeconds << Event.Payload;
+
+		// A trace cut off mid-event still replays up to the last complete one
+		if (FileReader.IsError() || Type > static_cast<uint8>(EEnhancedTraceEventType::Callback) || Method >= static_cast<uint8>(EEnhancedTraceMethod::Num))
+		{
+			UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Online trace %s is truncated after %d events."), *FilePath, Player->Events.Num());
+			break;
+		}
+
+		Event.Type = static_cast<EEnhancedTraceEventType>(Type);
+		Event.Method = static_cast<EEnhancedTraceMethod>(Method);
+
+		if (Event.Method == EEnhancedTraceMethod::ResolveConnectString)
+		{
+			FMemoryReader PayloadReader(Event.Payload);
+			FString SessionId;
+			FName PortType;
+			bool bResolved = false;
+			FString ConnectInfo;
+			PayloadReader << SessionId << PortType << bResolved << ConnectInfo;
+
+			if (bResolved)
+			{
+				Player->ConnectStrings.Add(GetConnectStringKey(SessionId, PortType), ConnectInfo);
+			}
+			continue;
+		}
+
+		if (Event.Type == EEnhancedTraceEventType::Callback)
+		{
+			// Nothing replays a callback the subsystem didn't ask for, taking it as an answer would shift all later ones
+			if (Event.CallId == 0)
+			{
+				++NumUnsolicitedCallbacks;
+				continue;
+			}
+
+			Player->CallbackIndices.Add(Event.CallId, Player->Events.Num());
+		}
+
+		Player->Events.Add(MoveTemp(Event));
+	}
+
+	if (NumUnsolicitedCallbacks > 0)
+	{
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Dropped %d callbacks of the online trace %s that answer no call."), NumUnsolicitedCallbacks, *FilePath);
+	}
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Loaded %d events from the online trace %s."), Player->Events.Num(), *FilePath);
+	return Player;
+}
+
+bool FEnhancedOnlineTracePlayer::TakeCall(EEnhancedTraceMethod Method, const FEnhancedTraceEvent*& OutCallback)
+{
+	OutCallback = nullptr;
+
+	const FEnhancedTraceEvent* CallEvent = TakeCallEvent(Method);
+	if (CallEvent == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Online trace %s has no more calls of method %d."), *FilePath, static_cast<int32>(Method));
+		return false;
+	}
+
+	FMemoryReader PayloadReader(CallEvent->Payload);
+	bool bStarted = false;
+	bool bAnswered = false;
+	PayloadReader << bStarted << bAnswered;
+
+	const int32* CallbackIndex = bAnswered ? CallbackIndices.Find(CallEvent->CallId) : nullptr;
+	if (CallbackIndex != nullptr)
+	{
+		OutCallback = &Events[*CallbackIndex];
+	}
+
+	return bStarted;
+}
+
+bool FEnhancedOnlineTracePlayer::ReplayCall(const void* Owner, EEnhancedTraceMethod Method, TUniqueFunction<void(FArchive&)>&& OnCallback)
+{
+	const FEnhancedTraceEvent* CallbackEvent = nullptr;
+	const bool bStarted = TakeCall(Method, CallbackEvent);
+
+	if (CallbackEvent != nullptr)
+	{
+		// Events aren't touched after loading, the pointer stays valid for the lifetime of the player
+		Schedule(Owner, CallbackEvent->LatencySeconds, [CallbackEvent, OnCallback = MoveTemp(OnCallback)]()
+		{
+			FMemoryReader PayloadReader(CallbackEvent->Payload);
+			OnCallback(PayloadReader);
+		});
+	}
+
+	return bStarted;
+}
+
+void FEnhancedOnlineTracePlayer::Schedule(const void* Owner, double LatencySeconds, TUniqueFunction<void()>&& Callback)
+{
+	ScheduledCallbacks.Schedule(Owner, Speed > 0.0f ? LatencySeconds / Speed : 0.0, MoveTemp(Callback));
+}
+
+void FEnhancedOnlineTracePlayer::Cancel(const void* Owner)
+{
+	ScheduledCallbacks.Cancel(Owner);
+}
+
+const FString* FEnhancedOnlineTracePlayer::FindConnectString(const FString& SessionId, FName PortType) const
+{
+	return ConnectStrings.Find(EnhancedOnlineTrace::GetConnectStringKey(SessionId, PortType));
+}
+
+int32 FEnhancedOnlineTracePlayer::GetNumRemainingCalls() const
+{
+	int32 NumRemainingCalls = 0;
+	for (int32 MethodIndex = 0; MethodIndex < static_cast<int32>(EEnhancedTraceMethod::Num); ++MethodIndex)
+	{
+		for (int32 Index = Cursors[MethodIndex]; Index < Events.Num(); ++Index)
+		{
+			if (Events[Index].Type == EEnhancedTraceEventType::Call && static_cast<int32>(Events[Index].Method) == MethodIndex)
+			{
+				++NumRemainingCalls;
+			}
+		}
+	}
+
+	return NumRemainingCalls;
+}
+
+const FEnhancedTraceEvent* FEnhancedOnlineTracePlayer::TakeCallEvent(EEnhancedTraceMethod Method)
+{
+	int32& Cursor = Cursors[static_cast<int32>(Method)];
+	for (; Cursor < Events.Num(); ++Cursor)
+	{
+		if (Events[Cursor].Type == EEnhancedTraceEventType::Call && Events[Cursor].Method == Method)
+		{
+			return &Events[Cursor++];
+		}
+	}
+
+	return nullptr;
+}
@@ -0,0 +1,211 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnhancedOnlineDeferredCallbacks.h"
+#include "OnlineSubsystemTypes.h"
+
+class FOnlineSessionSearchResult;
+
+/**
+ * Backend operation a trace event belongs to
+ */
+enum class EEnhancedTraceMethod : uint8
+{
+	CreateSession,
+	StartSession,
+	UpdateSession,
+	EndSession,
+	DestroySession,
+	FindSessions,
+	FindSessionById,
+	JoinSession,
+	RegisterPlayers,
+	UnregisterPlayers,
+
+	/** Synchronous, the callback carries the result */
+	ResolveConnectString,
+
+	Login,
+	Logout,
+
+	Num
+};
+
+enum class EEnhancedTraceEventType : uint8
+{
+	/** The subsystem called into the backend */
+	Call,
+
+	/** The backend answered */
+	Callback,
+};
+
+/**
+ * A single call or callback captured between the subsystem and the backend
+ */
+struct FEnhancedTraceEvent
+{
+	EEnhancedTraceEventType Type = EEnhancedTraceEventType::Call;
+	EEnhancedTraceMethod Method = EEnhancedTraceMethod::Num;
+
+	/** Seconds since the trace was started */
+	double TimeSeconds = 0.0;
+
+	/** Callbacks only, seconds since the call they answer */
+	double LatencySeconds = 0.0;
+
+	/** Sequence number of a call, or of the call a callback answers. 0 for callbacks the subsystem didn't ask for */
+	uint32 CallId = 0;
+
+	/** Arguments of a call or result of a callback, layout depends on the method */
+	TArray<uint8> Payload;
+};
+
+namespace EnhancedOnlineTrace
+{
+	/** Writes a search result with typed settings, the backend session info is reduced to its id */
+	void WriteSearchResult(FArchive& Ar, const FOnlineSessionSearchResult& SearchResult);
+
+	/** Reads a search result written by WriteSearchResult, the session id is returned separately */
+	void ReadSearchResult(FArchive& Ar, FString& OutSessionId, FOnlineSessionSearchResult& OutSearchResult);
+
+	void WriteUniqueNetId(FArchive& Ar, const FUniqueNetId* UniqueId);
+	FUniqueNetIdPtr ReadUniqueNetId(FArchive& Ar);
+
+	/** Resolves a trace name given on the console, relative names are placed in Saved/EnhancedOnline/Traces/ */
+	FString GetTraceFilePath(const FString& FileName);
+}
+
+/**
+ * Returned by FEnhancedOnlineTraceWriter::BeginCall, identifies the call for EndCall
+ */
+struct FEnhancedTraceCallToken
+{
+	uint32 CallId = 0;
+	double StartTime = 0.0;
+	int32 NumCallbacks = 0;
+};
+
+/**
+ * Appends the traffic between the subsystem and the backend to a trace file
+ * Shared by the recorders of all resolved interfaces, each event is flushed as it is added.
+ */
+class FEnhancedOnlineTraceWriter
+{
+public:
+	/** Creates the trace file, returns null if it can't be written */
+	static TSharedPtr<FEnhancedOnlineTraceWriter> Create(const FString& FilePath);
+
+	~FEnhancedOnlineTraceWriter();
+
+	/** Marks the start of a call, the call itself is written by EndCall */
+	FEnhancedTraceCallToken BeginCall(EEnhancedTraceMethod Method);
+
+	/**
+	 * Writes a call once the backend returned.
+	 * @param bStarted		What the backend returned, false if it rejected the call
+	 */
+	void EndCall(EEnhancedTraceMethod Method, const FEnhancedTraceCallToken& Token, bool bStarted);
+
+	/** Calls into the backend and writes the call, returns what the backend returned */
+	template <typename CallType>
+	bool RecordCall(EEnhancedTraceMethod Method, CallType&& Call)
+	{
+		const FEnhancedTraceCallToken Token = BeginCall(Method);
+		const bool bStarted = Call();
+		EndCall(Method, Token, bStarted);
+		return bStarted;
+	}
+
+	/** Writes the answer to the oldest open call of the method, callbacks while no call is open answer none */
+	void AddCallback(EEnhancedTraceMethod Method, TArray<uint8>&& Payload);
+
+	const FString& GetFilePath() const { return FilePath; }
+	int32 GetNumEvents() const { return NumEvents; }
+
+private:
+	FEnhancedOnlineTraceWriter() = default;
+
+	void WriteEvent(FEnhancedTraceEvent& Event);
+	double GetTimeSeconds() const;
+
+	FString FilePath;
+	TUniquePtr<FArchive> FileWriter;
+	double StartTime = 0.0;
+	int32 NumEvents = 0;
+
+	/** Calls that weren't answered yet, oldest first */
+	TArray<FEnhancedTraceCallToken> OpenCalls[static_cast<int32>(EEnhancedTraceMethod::Num)];
+
+	/** Sequence number of the next call, 0 is left for callbacks that answer no call */
+	uint32 NextCallId = 1;
+
+	/** Number of callbacks written per method, tells EndCall whether a backend answered synchronously */
+	int32 NumCallbacks[static_cast<int32>(EEnhancedTraceMethod::Num)] = {};
+};
+
+/**
+ * Hands out the events of a trace file in recorded order and plays back their latency
+ * Callbacks are dispatched by due time and, for equal times, in the order they were scheduled,
+ * so a replay of the same trace always reaches the subsystem in the same order.
+ */
+class FEnhancedOnlineTracePlayer
+{
+public:
+	/**
+	 * Reads a trace file, returns null if it is missing or invalid.
+	 * @param Speed		Playback speed of the recorded latency, 0 answers every call on the next tick
+	 */
+	static TSharedPtr<FEnhancedOnlineTracePlayer> Load(const FString& FilePath, float Speed);
+
+	/**
+	 * Takes the next recorded call of a method and the callback that answered it.
+	 * @param OutCallback	The recorded answer, null if the backend didn't answer or the trace ran out
+	 * @return What the backend returned to the call, false if the trace has no more calls of the method
+	 */
+	bool TakeCall(EEnhancedTraceMethod Method, const FEnhancedTraceEvent*& OutCallback);
+
+	/**
+	 * Replays a call, its recorded answer is passed to OnCallback after the recorded latency.
+	 * @return What the backend returned to the call
+	 */
+	bool ReplayCall(const void* Owner, EEnhancedTraceMethod Method, TUniqueFunction<void(FArchive&)>&& OnCallback);
+
+	/** Runs a callback after its recorded latency, scaled by the playback speed */
+	void Schedule(const void* Owner, double LatencySeconds, TUniqueFunction<void()>&& Callback);
+
+	/** Drops the callbacks an interface scheduled, called when it is destroyed */
+	void Cancel(const void* Owner);
+
+	/** Recorded result of a synchronous connect string lookup */
+	const FString* FindConnectString(const FString& SessionId, FName PortType) const;
+
+	const FString& GetFilePath() const { return FilePath; }
+	float GetSpeed() const { return Speed; }
+
+	/** Number of recorded calls not replayed yet */
+	int32 GetNumRemainingCalls() const;
+
+private:
+	FEnhancedOnlineTracePlayer() = default;
+
+	const FEnhancedTraceEvent* TakeCallEvent(EEnhancedTraceMethod Method);
+
+	FString FilePath;
+	float Speed = 1.0f;
+
+	TArray<FEnhancedTraceEvent> Events;
+
+	/** Index of the next unplayed call per method */
+	int32 Cursors[static_cast<int32>(EEnhancedTraceMethod::Num)] = {};
+
+	/** Index of the callback that answered a call, by call id */
+	TMap<uint32, int32> CallbackIndices;
+
+	/** Connect strings by session id and port */
+	TMap<FString, FString> ConnectStrings;
+
+	FEnhancedOnlineDeferredCallbacks ScheduledCallbacks;
+};
@@ -0,0 +1,317 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineTraceRecorder.h"
+
+#include "OnlineSessionSettings.h"
+#include "Serialization/MemoryWriter.h"
+
+FEnhancedOnlineSessionRecorder::FEnhancedOnlineSessionRecorder(const IOnlineSessionPtr& InInner, const TSharedRef<FEnhancedOnlineTraceWriter>& InWriter)
+	: FEnhancedOnlineSessionDecorator(InInner)
+	, Writer(InWriter)
+{
+}
+
+bool FEnhancedOnlineSessionRecorder::CreateSession(int32 HostingPlayerNum, FName SessionName, const FOnlineSessionSettings& NewSessionSettings)
+{
+	return Writer->RecordCall(EEnhancedTraceMethod::CreateSession, [&]()
+	{
+		return Inner->CreateSession(HostingPlayerNum, SessionName, NewSessionSettings);
+	});
+}
+
+bool FEnhancedOnlineSessionRecorder::CreateSession(const FUniqueNetId& HostingPlayerId, FName SessionName, const FOnlineSessionSettings& NewSessionSettings)
+{
+	return Writer->RecordCall(EEnhancedTraceMethod::CreateSession, [&]()
+	{
+		return Inner->CreateSession(HostingPlayerId, SessionName, NewSessionSettings);
+	});
+}
+
+bool FEnhancedOnlineSessionRecorder::StartSession(FName SessionName)
+{
+	return Writer->RecordCall(EEnhancedTraceMethod::StartSession, [&]()
+	{
+		return Inner->StartSession(SessionName);
+	});
+}
+
+bool FEnhancedOnlineSessionRecorder::UpdateSession(FName SessionName, FOnlineSessionSettings& UpdatedSessionSettings, bool bShouldRefreshOnlineData)
+{
+	return Writer->RecordCall(EEnhancedTraceMethod::UpdateSession, [&]()
+	{
+		return Inner->UpdateSession(SessionName, UpdatedSessionSettings, bShouldRefreshOnlineData);
+	});
+}
+
+bool FEnhancedOnlineSessionRecorder::EndSession(FName SessionName)
+{
+	return Writer->RecordCall(EEnhancedTraceMethod::EndSession, [&]()
+	{
+		return Inner->EndSession(SessionName);
+	});
+}
+
+bool FEnhancedOnlineSessionRecorder::DestroySession(FName SessionName, const FOnDestroySessionCompleteDelegate& CompletionDelegate)
+{
+	return Writer->RecordCall(EEnhancedTraceMethod::DestroySession, [&]()
+	{
+		return Inner->DestroySession(SessionName, CompletionDelegate);
+	});
+}
+
+bool FEnhancedOnlineSessionRecorder::FindSessions(int32 SearchingPlayerNum, const TSharedRef<FOnlineSessionSearch>& SearchSettings)
+{
+	return RecordFindSessions([&]()
+	{
+		return Inner->FindSessions(SearchingPlayerNum, SearchSettings);
+	}, SearchSettings);
+}
+
+bool FEnhancedOnlineSessionRecorder::FindSessions(const FUniqueNetId& SearchingPlayerId, const TSharedRef<FOnlineSessionSearch>& SearchSettings)
+{
+	return RecordFindSessions([&]()
+	{
+		return Inner->FindSessions(SearchingPlayerId, SearchSettings);
+	}, SearchSettings);
+}
+
+bool FEnhancedOnlineSessionRecorder::FindSessionById(const FUniqueNetId& SearchingUserId, const FUniqueNetId& SessionId, const FUniqueNetId& FriendId, const FOnSingleSessionResultCompleteDelegate& CompletionDelegate)
+{
+	// The result only reaches the caller's delegate
+	const FOnSingleSessionResultCompleteDelegate RecordingDelegate = FOnSingleSessionResultCompleteDelegate::CreateLambda(
+		[Writer = Writer, CompletionDelegate](int32 LocalUserNum, bool bWasSuccessful, const FOnlineSessionSearchResult& SearchResult)
+		{
+			TArray<uint8> Payload;
+			FMemoryWriter PayloadWriter(Payload);
+			bool bSuccess = bWasSuccessful;
+			PayloadWriter << LocalUserNum << bSuccess;
+			EnhancedOnlineTrace::WriteSearchResult(PayloadWriter, SearchResult);
+
+			Writer->AddCallback(EEnhancedTraceMethod::FindSessionById, MoveTemp(Payload));
+			CompletionDelegate.ExecuteIfBound(LocalUserNum, bWasSuccessful, SearchResult);
+		});
+
+	return Writer->RecordCall(EEnhancedTraceMethod::FindSessionById, [&]()
+	{
+		return Inner->FindSessionById(SearchingUserId, SessionId, FriendId, RecordingDelegate);
+	});
+}
+
+bool FEnhancedOnlineSessionRecorder::JoinSession(int32 LocalUserNum, FName SessionName, const FOnlineSessionSearchResult& DesiredSession)
+{
+	return Writer->RecordCall(EEnhancedTraceMethod::JoinSession, [&]()
+	{
+		return Inner->JoinSession(LocalUserNum, SessionName, DesiredSession);
+	});
+}
+
+bool FEnhancedOnlineSessionRecorder::JoinSession(const FUniqueNetId& LocalUserId, FName SessionName, const FOnlineSessionSearchResult& DesiredSession)
+{
+	return Writer->RecordCall(EEnhancedTraceMethod::JoinSession, [&]()
+	{
+		return Inner->JoinSession(LocalUserId, SessionName, DesiredSession);
+	});
+}
+
+bool FEnhancedOnlineSessionRecorder::GetResolvedConnectString(FName SessionName, FString& ConnectInfo, FName PortType)
+{
+	const bool bResolved = Inner->GetResolvedConnectString(SessionName, ConnectInfo, PortType);
+	RecordConnectString(Inner->GetNamedSession(SessionName), PortType, bResolved, ConnectInfo);
+	return bResolved;
+}
+
+bool FEnhancedOnlineSessionRecorder::GetResolvedConnectString(const FOnlineSessionSearchResult& SearchResult, FName PortType, FString& ConnectInfo)
+{
+	const bool bResolved = Inner->GetResolvedConnectString(SearchResult, PortType, ConnectInfo);
+	RecordConnectString(&SearchResult.Session, PortType, bResolved, ConnectInfo);
+	return bResolved;
+}
+
+bool FEnhancedOnlineSessionRecorder::RegisterPlayers(FName SessionName, const TArray<FUniqueNetIdRef>& Players, bool bWasInvited)
+{
+	return Writer->RecordCall(EEnhancedTraceMethod::RegisterPlayers, [&]()
+	{
+		return Inner->RegisterPlayers(SessionName, Players, bWasInvited);
+	});
+}
+
+bool FEnhancedOnlineSessionRecorder::UnregisterPlayers(FName SessionName, const TArray<FUniqueNetIdRef>& Players)
+{
+	return Writer->RecordCall(EEnhancedTraceMethod::UnregisterPlayers, [&]()
+	{
+		return Inner->UnregisterPlayers(SessionName, Players);
+	});
+}
+
+void FEnhancedOnlineSessionRecorder::OnInnerCreateSessionComplete(FName SessionName, bool bWasSuccessful)
+{
+	RecordSessionCallback(EEnhancedTraceMethod::CreateSession, SessionName, bWasSuccessful);
+	FEnhancedOnlineSessionDecorator::OnInnerCreateSessionComplete(SessionName, bWasSuccessful);
+}
+
+void FEnhancedOnlineSessionRecorder::OnInnerStartSessionComplete(FName SessionName, bool bWasSuccessful)
+{
+	RecordSessionCallback(EEnhancedTraceMethod::StartSession, SessionName, bWasSuccessful);
+	FEnhancedOnlineSessionDecorator::OnInnerStartSessionComplete(SessionName, bWasSuccessful);
+}
+
+void FEnhancedOnlineSessionRecorder::OnInnerUpdateSessionComplete(FName SessionName, bool bWasSuccessful)
+{
+	RecordSessionCallback(EEnhancedTraceMethod::UpdateSession, SessionName, bWasSuccessful);
+	FEnhancedOnlineSessionDecorator::OnInnerUpdateSessionComplete(SessionName, bWasSuccessful);
+}
+
+void FEnhancedOnlineSessionRecorder::OnInnerEndSessionComplete(FName SessionName, bool bWasSuccessful)
+{
+	RecordSessionCallback(EEnhancedTraceMethod::EndSession, SessionName, bWasSuccessful);
+	FEnhancedOnlineSessionDecorator::OnInnerEndSessionComplete(SessionName, bWasSuccessful);
+}
+
+void FEnhancedOnlineSessionRecorder::OnInnerDestroySessionComplete(FName SessionName, bool bWasSuccessful)
+{
+	RecordSessionCallback(EEnhancedTraceMethod::DestroySession, SessionName, bWasSuccessful);
+	FEnhancedOnlineSessionDecorator::OnInnerDestroySessionComplete(SessionName, bWasSuccessful);
+}
+
+void FEnhancedOnlineSessionRecorder::OnInnerFindSessionsComplete(bool bWasSuccessful)
+{
+	TArray<uint8> Payload;
+	FMemoryWriter PayloadWriter(Payload);
+
+	bool bSuccess = bWasSuccessful;
+	int32 NumResults = OpenSearches.Num() > 0 ? OpenSearches[0]->SearchResults.Num() : 0;
+	PayloadWriter << bSuccess << NumResults;
+
+	if (OpenSearches.Num() > 0)
+	{
+		for (const FOnlineSessionSearchResult& SearchResult : OpenSearches[0]->SearchResults)
+		{
+			EnhancedOnlineTrace::WriteSearchResult(PayloadWriter, SearchResult);
+		}
+
+		OpenSearches.RemoveAt(0);
+	}
+
+	Writer->AddCallback(EEnhancedTraceMethod::FindSessions, MoveTemp(Payload));
+	FEnhancedOnlineSessionDecorator::OnInnerFindSessionsComplete(bWasSuccessful);
+}
+
+void FEnhancedOnlineSessionRecorder::OnInnerJoinSessionComplete(FName SessionName, EOnJoinSessionCompleteResult::Type Result)
+{
+	TArray<uint8> Payload;
+	FMemoryWriter PayloadWriter(Payload);
+
+	uint8 ResultValue = static_cast<uint8>(Result);
+	PayloadWriter << SessionName << ResultValue;
+
+	Writer->AddCallback(EEnhancedTraceMethod::JoinSession, MoveTemp(Payload));
+	FEnhancedOnlineSessionDecorator::OnInnerJoinSessionComplete(SessionName, Result);
+}
+
+void FEnhancedOnlineSessionRecorder::OnInnerRegisterPlayersComplete(FName SessionName, const TArray<FUniqueNetIdRef>& Players, bool bWasSuccessful)
+{
+	RecordSessionCallback(EEnhancedTraceMethod::RegisterPlayers, SessionName, bWasSuccessful);
+	FEnhancedOnlineSessionDecorator::OnInnerRegisterPlayersComplete(SessionName, Players, bWasSuccessful);
+}
+
+void FEnhancedOnlineSessionRecorder::OnInnerUnregisterPlayersComplete(FName SessionName, const TArray<FUniqueNetIdRef>& Players, bool bWasSuccessful)
+{
+	RecordSessionCallback(EEnhancedTraceMethod::UnregisterPlayers, SessionName, bWasSuccessful);
+	FEnhancedOnlineSessionDecorator::OnInnerUnregisterPlayersComplete(SessionName, Players, bWasSuccessful);
+}
+
+void FEnhancedOnlineSessionRecorder::RecordSessionCallback(EEnhancedTraceMethod Method, FName SessionName, bool bWasSuccessful)
+{
+	// The replay hands the same session id out for the session it creates
+	const FNamedOnlineSession* NamedSession = Inner->GetNamedSession(SessionName);
+	FString SessionId = NamedSession && NamedSession->SessionInfo.IsValid() ? NamedSession->SessionInfo->GetSessionId().ToString() : FString();
+
+	TArray<uint8> Payload;
+	FMemoryWriter PayloadWriter(Payload);
+
+	bool bSuccess = bWasSuccessful;
+	PayloadWriter << SessionName << bSuccess << SessionId;
+
+	Writer->AddCallback(Method, MoveTemp(Payload));
+}
+
+bool FEnhancedOnlineSessionRecorder::RecordFindSessions(TFunctionRef<bool()> Call, const TSharedRef<FOnlineSessionSearch>& SearchSettings)
+{
+	OpenSearches.Add(SearchSettings);
+
+	// A rejected search was either answered right away or never will be
+	const bool bStarted = Writer->RecordCall(EEnhancedTraceMethod::FindSessions, Call);
+	if (!bStarted)
+	{
+		OpenSearches.Remove(SearchSettings);
+	}
+
+	return bStarted;
+}
+
+void FEnhancedOnlineSessionRecorder::RecordConnectString(const FOnlineSession* Session, FName PortType, bool bResolved, const FString& ConnectInfo)
+{
+	if (Session == nullptr || !Session->SessionInfo.IsValid())
+	{
+		return;
+	}
+
+	TArray<uint8> Payload;
+	FMemoryWriter PayloadWriter(Payload);
+
+	FString SessionId = Session->SessionInfo->GetSessionId().ToString();
+	FString ConnectInfoValue = bResolved ? ConnectInfo : FString();
+	PayloadWriter << SessionId << PortType << bResolved << ConnectInfoValue;
+
+	Writer->AddCallback(EEnhancedTraceMethod::ResolveConnectString, MoveTemp(Payload));
+}
+
+FEnhancedOnlineIdentityRecorder::FEnhancedOnlineIdentityRecorder(const IOnlineIdentityPtr& InInner, const TSharedRef<FEnhancedOnlineTraceWriter>& InWriter)
+	: FEnhancedOnlineIdentityDecorator(InInner)
+	, Writer(InWriter)
+{
+}
+
+bool FEnhancedOnlineIdentityRecorder::Login(int32 LocalUserNum, const FOnlineAccountCredentials& AccountCredentials)
+{
+	return Writer->RecordCall(EEnhancedTraceMethod::Login, [&]()
+	{
+		return Inner->Login(LocalUserNum, AccountCredentials);
+	});
+}
+
+bool FEnhancedOnlineIdentityRecorder::Logout(int32 LocalUserNum)
+{
+	return Writer->RecordCall(EEnhancedTraceMethod::Logout, [&]()
+	{
+		return Inner->Logout(LocalUserNum);
+	});
+}
+
+void FEnhancedOnlineIdentityRecorder::OnInnerLoginComplete(int32 LocalUserNum, bool bWasSuccessful, const FUniqueNetId& UserId, const FString& Error)
+{
+	TArray<uint8> Payload;
+	FMemoryWriter PayloadWriter(Payload);
+
+	bool bSuccess = bWasSuccessful;
+	FString ErrorValue = Error;
+	FString Nickname = bWasSuccessful ? Inner->GetPlayerNickname(LocalUserNum) : FString();
+	PayloadWriter << LocalUserNum << bSuccess;
+	EnhancedOnlineTrace::WriteUniqueNetId(PayloadWriter, UserId.IsValid() ? &UserId : nullptr);
+	PayloadWriter << ErrorValue << Nickname;
+
+	Writer->AddCallback(EEnhancedTraceMethod::Login, MoveTemp(Payload));
+	FEnhancedOnlineIdentityDecorator::OnInnerLoginComplete(LocalUserNum, bWasSuccessful, UserId, Error);
+}
+
+void FEnhancedOnlineIdentityRecorder::OnInnerLogoutComplete(int32 LocalUserNum, bool bWasSuccessful)
+{
+	TArray<uint8> Payload;
+	FMemoryWriter PayloadWriter(Payload);
+
+	bool bSuccess = bWasSuccessful;
+	PayloadWriter << LocalUserNum << bSuccess;
+
+	Writer->AddCallback(EEnhancedTraceMethod::Logout, MoveTemp(Payload));
+	FEnhancedOnlineIdentityDecorator::OnInnerLogoutComplete(LocalUserNum, bWasSuccessful);
+}
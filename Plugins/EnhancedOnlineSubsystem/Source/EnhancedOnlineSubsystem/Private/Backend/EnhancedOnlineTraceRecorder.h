@@ -0,0 +1,86 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnhancedOnlineIdentityDecorator.h"
+#include "EnhancedOnlineSessionDecorator.h"
+#include "EnhancedOnlineTrace.h"
+
+/**
+ * Writes the session calls of the subsystem and the answers of the backend to a trace
+ */
+class FEnhancedOnlineSessionRecorder : public FEnhancedOnlineSessionDecorator
+{
+public:
+	FEnhancedOnlineSessionRecorder(const IOnlineSessionPtr& InInner, const TSharedRef<FEnhancedOnlineTraceWriter>& InWriter);
+
+	//~ Begin IOnlineSession Interface
+	virtual bool CreateSession(int32 HostingPlayerNum, FName SessionName, const FOnlineSessionSettings& NewSessionSettings) override;
+	virtual bool CreateSession(const FUniqueNetId& HostingPlayerId, FName SessionName, const FOnlineSessionSettings& NewSessionSettings) override;
+	virtual bool StartSession(FName SessionName) override;
+	virtual bool UpdateSession(FName SessionName, FOnlineSessionSettings& UpdatedSessionSettings, bool bShouldRefreshOnlineData = true) override;
+	virtual bool EndSession(FName SessionName) override;
+	virtual bool DestroySession(FName SessionName, const FOnDestroySessionCompleteDelegate& CompletionDelegate = FOnDestroySessionCompleteDelegate()) override;
+	virtual bool FindSessions(int32 SearchingPlayerNum, const TSharedRef<FOnlineSessionSearch>& SearchSettings) override;
+	virtual bool FindSessions(const FUniqueNetId& SearchingPlayerId, const TSharedRef<FOnlineSessionSearch>& SearchSettings) override;
+	virtual bool FindSessionById(const FUniqueNetId& SearchingUserId, const FUniqueNetId& SessionId, const FUniqueNetId& FriendId, const FOnSingleSessionResultCompleteDelegate& CompletionDelegate) override;
+	virtual bool JoinSession(int32 LocalUserNum, FName SessionName, const FOnlineSessionSearchResult& DesiredSession) override;
+	virtual bool JoinSession(const FUniqueNetId& LocalUserId, FName SessionName, const FOnlineSessionSearchResult& DesiredSession) override;
+	virtual bool GetResolvedConnectString(FName SessionName, FString& ConnectInfo, FName PortType = NAME_GamePort) override;
+	virtual bool GetResolvedConnectString(const FOnlineSessionSearchResult& SearchResult, FName PortType, FString& ConnectInfo) override;
+	virtual bool RegisterPlayers(FName SessionName, const TArray<FUniqueNetIdRef>& Players, bool bWasInvited = false) override;
+	virtual bool UnregisterPlayers(FName SessionName, const TArray<FUniqueNetIdRef>& Players) override;
+	//~ End IOnlineSession Interface
+
+protected:
+	//~ Begin FEnhancedOnlineSessionDecorator Interface
+	virtual void OnInnerCreateSessionComplete(FName SessionName, bool bWasSuccessful) override;
+	virtual void OnInnerStartSessionComplete(FName SessionName, bool bWasSuccessful) override;
+	virtual void OnInnerUpdateSessionComplete(FName SessionName, bool bWasSuccessful) override;
+	virtual void OnInnerEndSessionComplete(FName SessionName, bool bWasSuccessful) override;
+	virtual void OnInnerDestroySessionComplete(FName SessionName, bool bWasSuccessful) override;
+	virtual void OnInnerFindSessionsComplete(bool bWasSuccessful) override;
+	virtual void OnInnerJoinSessionComplete(FName SessionName, EOnJoinSessionCompleteResult::Type Result) override;
+	virtual void OnInnerRegisterPlayersComplete(FName SessionName, const TArray<FUniqueNetIdRef>& Players, bool bWasSuccessful) override;
+	virtual void OnInnerUnregisterPlayersComplete(FName SessionName, const TArray<FUniqueNetIdRef>& Players, bool bWasSuccessful) override;
+	//~ End FEnhancedOnlineSessionDecorator Interface
+
+private:
+	/** Writes the answer to a call on a named session */
+	void RecordSessionCallback(EEnhancedTraceMethod Method, FName SessionName, bool bWasSuccessful);
+
+	/** Writes a search, its results are written once the backend answers */
+	bool RecordFindSessions(TFunctionRef<bool()> Call, const TSharedRef<FOnlineSessionSearch>& SearchSettings);
+
+	void RecordConnectString(const FOnlineSession* Session, FName PortType, bool bResolved, const FString& ConnectInfo);
+
+	TSharedRef<FEnhancedOnlineTraceWriter> Writer;
+
+	/** Searches that weren't answered yet, oldest first */
+	TArray<TSharedRef<FOnlineSessionSearch>> OpenSearches;
+};
+
+/**
+ * Writes the identity calls of the subsystem and the answers of the backend to a trace
+ * Credentials and auth tokens are never written.
+ */
+class FEnhancedOnlineIdentityRecorder : public FEnhancedOnlineIdentityDecorator
+{
+public:
+	FEnhancedOnlineIdentityRecorder(const IOnlineIdentityPtr& InInner, const TSharedRef<FEnhancedOnlineTraceWriter>& InWriter);
+
+	//~ Begin IOnlineIdentity Interface
+	virtual bool Login(int32 LocalUserNum, const FOnlineAccountCredentials& AccountCredentials) override;
+	virtual bool Logout(int32 LocalUserNum) override;
+	//~ End IOnlineIdentity Interface
+
+protected:
+	//~ Begin FEnhancedOnlineIdentityDecorator Interface
+	virtual void OnInnerLoginComplete(int32 LocalUserNum, bool bWasSuccessful, const FUniqueNetId& UserId, const FString& Error) override;
+	virtual void OnInnerLogoutComplete(int32 LocalUserNum, bool bWasSuccessful) override;
+	//~ End FEnhancedOnlineIdentityDecorator Interface
+
+private:
+	TSharedRef<FEnhancedOnlineTraceWriter> Writer;
+};
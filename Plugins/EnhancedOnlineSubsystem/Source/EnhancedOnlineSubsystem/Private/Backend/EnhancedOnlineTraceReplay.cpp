@@ -0,0 +1,577 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineTraceReplay.h"
+
+#include "EnhancedOnlineSubsystem.h"
+#include "OnlineSessionSettings.h"
+
+namespace EnhancedOnlineTraceReplay
+{
+	static const FName ReplayIdType(TEXT("EnhancedReplay"));
+
+	/** Stands in for the backend session info of replayed sessions, only carries the recorded id */
+	class FReplaySessionInfo : public FOnlineSessionInfo
+	{
+	public:
+		explicit FReplaySessionInfo(const FString& InSessionId)
+			: SessionId(FUniqueNetIdString::Create(InSessionId, ReplayIdType))
+		{
+		}
+
+		//~ Begin FOnlineSessionInfo Interface
+		virtual const uint8* GetBytes() const override { return nullptr; }
+		virtual int32 GetSize() const override { return 0; }
+		virtual bool IsValid() const override { return true; }
+		virtual const FUniqueNetId& GetSessionId() const override { return *SessionId; }
+		virtual FString ToString() const override { return SessionId->ToString(); }
+		virtual FString ToDebugString() const override { return FString::Printf(TEXT("Replayed session %s"), *SessionId->ToString()); }
+		//~ End FOnlineSessionInfo Interface
+
+	private:
+		FUniqueNetIdRef SessionId;
+	};
+
+	static void SetSessionId(FOnlineSession& Session, const FString& SessionId)
+	{
+		if (!SessionId.IsEmpty())
+		{
+			Session.SessionInfo = MakeShared<FReplaySessionInfo>(SessionId);
+		}
+	}
+
+	static FString GetSessionId(const FOnlineSession& Session)
+	{
+		return Session.SessionInfo.IsValid() ? Session.SessionInfo->GetSessionId().ToString() : FString();
+	}
+
+	/** Reads the answer to a call on a named session as written by the recorder */
+	static void ReadSessionCallback(FArchive& Reader, bool& bOutWasSuccessful, FString& OutSessionId)
+	{
+		FName RecordedSessionName;
+		Reader << RecordedSessionName << bOutWasSuccessful << OutSessionId;
+	}
+}
+
+FEnhancedOnlineSessionReplay::FEnhancedOnlineSessionReplay(const IOnlineSessionPtr& InInner, const TSharedRef<FEnhancedOnlineTracePlayer>& InPlayer)
+	: FEnhancedOnlineSessionDecorator(InInner)
+	, Player(InPlayer)
+{
+}
+
+FEnhancedOnlineSessionReplay::~FEnhancedOnlineSessionReplay()
+{
+	Player->Cancel(this);
+}
+
+FNamedOnlineSession* FEnhancedOnlineSessionReplay::GetNamedSession(FName SessionName)
+{
+	const TUniquePtr<FNamedOnlineSession>* Session = NamedSessions.Find(SessionName);
+	return Session ? Session->Get() : nullptr;
+}
+
+void FEnhancedOnlineSessionReplay::RemoveNamedSession(FName SessionName)
+{
+	NamedSessions.Remove(SessionName);
+}
+
+EOnlineSessionState::Type FEnhancedOnlineSessionReplay::GetSessionState(FName SessionName) const
+{
+	const TUniquePtr<FNamedOnlineSession>* Session = NamedSessions.Find(SessionName);
+	return Session ? (*Session)->SessionState : EOnlineSessionState::NoSession;
+}
+
+FUniqueNetIdPtr FEnhancedOnlineSessionReplay::CreateSessionIdFromString(const FString& SessionIdStr)
+{
+	return FUniqueNetIdString::Create(SessionIdStr, EnhancedOnlineTraceReplay::ReplayIdType);
+}
+
+bool FEnhancedOnlineSessionReplay::CreateSession(int32 HostingPlayerNum, FName SessionName, const FOnlineSessionSettings& NewSessionSettings)
+{
+	return ReplayCreateSession(nullptr, SessionName, NewSessionSettings);
+}
+
+bool FEnhancedOnlineSessionReplay::CreateSession(const FUniqueNetId& HostingPlayerId, FName SessionName, const FOnlineSessionSettings& NewSessionSettings)
+{
+	return ReplayCreateSession(HostingPlayerId.AsShared(), SessionName, NewSessionSettings);
+}
+
+bool FEnhancedOnlineSessionReplay::StartSession(FName SessionName)
+{
+	const bool bStarted = ReplaySessionCall(EEnhancedTraceMethod::StartSession, SessionName, [this, SessionName](FNamedOnlineSession* Session, bool bWasSuccessful, const FString& SessionId)
+	{
+		if (Session)
+		{
+			Session->SessionState = bWasSuccessful ? EOnlineSessionState::InProgress : EOnlineSessionState::Pending;
+		}
+
+		TriggerOnStartSessionCompleteDelegates(SessionName, bWasSuccessful);
+	});
+
+	FNamedOnlineSession* Session = GetNamedSession(SessionName);
+	if (Session && bStarted)
+	{
+		Session->SessionState = EOnlineSessionState::Starting;
+	}
+
+	return bStarted;
+}
+
+bool FEnhancedOnlineSessionReplay::UpdateSession(FName SessionName, FOnlineSessionSettings& UpdatedSessionSettings, bool bShouldRefreshOnlineData)
+{
+	const bool bStarted = ReplaySessionCall(EEnhancedTraceMethod::UpdateSession, SessionName, [this, SessionName](FNamedOnlineSession* Session, bool bWasSuccessful, const FString& SessionId)
+	{
+		TriggerOnUpdateSessionCompleteDelegates(SessionName, bWasSuccessful);
+	});
+
+	FNamedOnlineSession* Session = GetNamedSession(SessionName);
+	if (Session && bStarted)
+	{
+		Session->SessionSettings = UpdatedSessionSettings;
+	}
+
+	return bStarted;
+}
+
+bool FEnhancedOnlineSessionReplay::EndSession(FName SessionName)
+{
+	const bool bStarted = ReplaySessionCall(EEnhancedTraceMethod::EndSession, SessionName, [this, SessionName](FNamedOnlineSession* Session, bool bWasSuccessful, const FString& SessionId)
+	{
+		if (Session && bWasSuccessful)
+		{
+			Session->SessionState = EOnlineSessionState::Ended;
+		}
+
+		TriggerOnEndSessionCompleteDelegates(SessionName, bWasSuccessful);
+	});
+
+	FNamedOnlineSession* Session = GetNamedSession(SessionName);
+	if (Session && bStarted)
+	{
+		Session->SessionState = EOnlineSessionState::Ending;
+	}
+
+	return bStarted;
+}
+
+bool FEnhancedOnlineSessionReplay::DestroySession(FName SessionName, const FOnDestroySessionCompleteDelegate& CompletionDelegate)
+{
+	const bool bStarted = ReplaySessionCall(EEnhancedTraceMethod::DestroySession, SessionName, [this, SessionName, CompletionDelegate](FNamedOnlineSession* Session, bool bWasSuccessful, const FString& SessionId)
+	{
+		if (bWasSuccessful)
+		{
+			RemoveNamedSession(SessionName);
+		}
+
+		CompletionDelegate.ExecuteIfBound(SessionName, bWasSuccessful);
+		TriggerOnDestroySessionCompleteDelegates(SessionName, bWasSuccessful);
+	});
+
+	FNamedOnlineSession* Session = GetNamedSession(SessionName);
+	if (Session && bStarted)
+	{
+		Session->SessionState = EOnlineSessionState::Destroying;
+	}
+
+	return bStarted;
+}
+
+bool FEnhancedOnlineSessionReplay::IsPlayerInSession(FName SessionName, const FUniqueNetId& UniqueId)
+{
+	const FNamedOnlineSession* Session = GetNamedSession(SessionName);
+	if (Session == nullptr)
+	{
+		return false;
+	}
+
+	return Session->RegisteredPlayers.ContainsByPredicate([&UniqueId](const FUniqueNetIdRef& PlayerId)
+	{
+		return *PlayerId == UniqueId;
+	});
+}
+
+bool FEnhancedOnlineSessionReplay::FindSessions(int32 SearchingPlayerNum, const TSharedRef<FOnlineSessionSearch>& SearchSettings)
+{
+	return ReplayFindSessions(SearchSettings);
+}
+
+bool FEnhancedOnlineSessionReplay::FindSessions(const FUniqueNetId& SearchingPlayerId, const TSharedRef<FOnlineSessionSearch>& SearchSettings)
+{
+	return ReplayFindSessions(SearchSettings);
+}
+
+bool FEnhancedOnlineSessionReplay::FindSessionById(const FUniqueNetId& SearchingUserId, const FUniqueNetId& SessionId, const FUniqueNetId& FriendId, const FOnSingleSessionResultCompleteDelegate& CompletionDelegate)
+{
+	return Player->ReplayCall(this, EEnhancedTraceMethod::FindSessionById, [CompletionDelegate](FArchive& Reader)
+	{
+		int32 LocalUserNum = 0;
+		bool bWasSuccessful = false;
+		FString RecordedSessionId;
+		FOnlineSessionSearchResult SearchResult;
+
+		Reader << LocalUserNum << bWasSuccessful;
+		EnhancedOnlineTrace::ReadSearchResult(Reader, RecordedSessionId, SearchResult);
+		EnhancedOnlineTraceReplay::SetSessionId(SearchResult.Session, RecordedSessionId);
+
+		CompletionDelegate.ExecuteIfBound(LocalUserNum, bWasSuccessful, SearchResult);
+	});
+}
+
+bool FEnhancedOnlineSessionReplay::JoinSession(int32 LocalUserNum, FName SessionName, const FOnlineSessionSearchResult& DesiredSession)
+{
+	return ReplayJoinSession(SessionName, DesiredSession);
+}
+
+bool FEnhancedOnlineSessionReplay::JoinSession(const FUniqueNetId& LocalUserId, FName SessionName, const FOnlineSessionSearchResult& DesiredSession)
+{
+	return ReplayJoinSession(SessionName, DesiredSession);
+}
+
+bool FEnhancedOnlineSessionReplay::GetResolvedConnectString(FName SessionName, FString& ConnectInfo, FName PortType)
+{
+	const FNamedOnlineSession* Session = GetNamedSession(SessionName);
+	const FString* RecordedConnectInfo = Session ? Player->FindConnectString(EnhancedOnlineTraceReplay::GetSessionId(*Session), PortType) : nullptr;
+	if (RecordedConnectInfo == nullptr)
+	{
+		return false;
+	}
+
+	ConnectInfo = *RecordedConnectInfo;
+	return true;
+}
+
+bool FEnhancedOnlineSessionReplay::GetResolvedConnectString(const FOnlineSessionSearchResult& SearchResult, FName PortType, FString& ConnectInfo)
+{
+	const FString* RecordedConnectInfo = Player->FindConnectString(EnhancedOnlineTraceReplay::GetSessionId(SearchResult.Session), PortType);
+	if (RecordedConnectInfo == nullptr)
+	{
+		return false;
+	}
+
+	ConnectInfo = *RecordedConnectInfo;
+	return true;
+}
+
+FOnlineSessionSettings* FEnhancedOnlineSessionReplay::GetSessionSettings(FName SessionName)
+{
+	FNamedOnlineSession* Session = GetNamedSession(SessionName);
+	return Session ? &Session->SessionSettings : nullptr;
+}
+
+bool FEnhancedOnlineSessionReplay::RegisterPlayer(FName SessionName, const FUniqueNetId& PlayerId, bool bWasInvited)
+{
+	return RegisterPlayers(SessionName, { PlayerId.AsShared() }, bWasInvited);
+}
+
+bool FEnhancedOnlineSessionReplay::RegisterPlayers(FName SessionName, const TArray<FUniqueNetIdRef>& Players, bool bWasInvited)
+{
+	return ReplaySessionCall(EEnhancedTraceMethod::RegisterPlayers, SessionName, [this, SessionName, Players](FNamedOnlineSession* Session, bool bWasSuccessful, const FString& SessionId)
+	{
+		if (Session && bWasSuccessful)
+		{
+			for (const FUniqueNetIdRef& PlayerId : Players)
+			{
+				if (!IsPlayerInSession(SessionName, *PlayerId))
+				{
+					Session->RegisteredPlayers.Add(PlayerId);
+				}
+			}
+		}
+
+		TriggerOnRegisterPlayersCompleteDelegates(SessionName, Players, bWasSuccessful);
+	});
+}
+
+bool FEnhancedOnlineSessionReplay::UnregisterPlayer(FName SessionName, const FUniqueNetId& PlayerId)
+{
+	return UnregisterPlayers(SessionName, { PlayerId.AsShared() });
+}
+
+bool FEnhancedOnlineSessionReplay::UnregisterPlayers(FName SessionName, const TArray<FUniqueNetIdRef>& Players)
+{
+	return ReplaySessionCall(EEnhancedTraceMethod::UnregisterPlayers, SessionName, [this, SessionName, Players](FNamedOnlineSession* Session, bool bWasSuccessful, const FString& SessionId)
+	{
+		if (Session && bWasSuccessful)
+		{
+			Session->RegisteredPlayers.RemoveAll([&Players](const FUniqueNetIdRef& RegisteredId)
+			{
+				return Players.ContainsByPredicate([&RegisteredId](const FUniqueNetIdRef& PlayerId) { return *PlayerId == *RegisteredId; });
+			});
+		}
+
+		TriggerOnUnregisterPlayersCompleteDelegates(SessionName, Players, bWasSuccessful);
+	});
+}
+
+int32 FEnhancedOnlineSessionReplay::GetNumSessions()
+{
+	return NamedSessions.Num();
+}
+
+void FEnhancedOnlineSessionReplay::DumpSessionState()
+{
+	UE_LOG(LogEnhancedSubsystem, Display, TEXT("Replaying %s at %.2fx, %d calls left, %d sessions:"), *Player->GetFilePath(), Player->GetSpeed(), Player->GetNumRemainingCalls(), NamedSessions.Num());
+	for (const TPair<FName, TUniquePtr<FNamedOnlineSession>>& Pair : NamedSessions)
+	{
+		UE_LOG(LogEnhancedSubsystem, Display, TEXT("\t%s: %s"), *Pair.Key.ToString(), EOnlineSessionState::ToString(Pair.Value->SessionState));
+	}
+}
+
+bool FEnhancedOnlineSessionReplay::ReplayCreateSession(const FUniqueNetIdPtr& HostingPlayerId, FName SessionName, const FOnlineSessionSettings& NewSessionSettings)
+{
+	// Backends reject a second session under the same name without answering
+	if (GetNamedSession(SessionName))
+	{
+		const FEnhancedTraceEvent* RejectedCallback = nullptr;
+		Player->TakeCall(EEnhancedTraceMethod::CreateSession, RejectedCallback);
+		return false;
+	}
+
+	const bool bStarted = ReplaySessionCall(EEnhancedTraceMethod::CreateSession, SessionName, [this, SessionName](FNamedOnlineSession* Session, bool bWasSuccessful, const FString& SessionId)
+	{
+		if (Session && bWasSuccessful)
+		{
+			EnhancedOnlineTraceReplay::SetSessionId(*Session, SessionId);
+			Session->SessionState = EOnlineSessionState::Pending;
+		}
+		else
+		{
+			RemoveNamedSession(SessionName);
+		}
+
+		TriggerOnCreateSessionCompleteDelegates(SessionName, bWasSuccessful);
+	});
+
+	if (bStarted)
+	{
+		FOnlineSession Session(NewSessionSettings);
+		Session.OwningUserId = HostingPlayerId;
+		Session.NumOpenPublicConnections = NewSessionSettings.NumPublicConnections;
+		Session.NumOpenPrivateConnections = NewSessionSettings.NumPrivateConnections;
+
+		FNamedOnlineSession& NamedSession = AddReplaySession(SessionName, Session);
+		NamedSession.bHosting = true;
+		NamedSession.LocalOwnerId = HostingPlayerId;
+		NamedSession.SessionState = EOnlineSessionState::Creating;
+	}
+
+	return bStarted;
+}
+
+bool FEnhancedOnlineSessionReplay::ReplayFindSessions(const TSharedRef<FOnlineSessionSearch>& SearchSettings)
+{
+	const bool bStarted = Player->ReplayCall(this, EEnhancedTraceMethod::FindSessions, [this, SearchSettings](FArchive& Reader)
+	{
+		bool bWasSuccessful = false;
+		int32 NumResults = 0;
+		Reader << bWasSuccessful << NumResults;
+
+		SearchSettings->SearchResults.Reset(FMath::Max(NumResults, 0));
+		for (int32 Index = 0; Index < NumResults && !Reader.IsError(); ++Index)
+		{
+			FString SessionId;
+			FOnlineSessionSearchResult& SearchResult = SearchSettings->SearchResults.AddDefaulted_GetRef();
+			EnhancedOnlineTrace::ReadSearchResult(Reader, SessionId, SearchResult);
+			EnhancedOnlineTraceReplay::SetSessionId(SearchResult.Session, SessionId);
+		}
+
+		SearchSettings->SearchState = bWasSuccessful ? EOnlineAsyncTaskState::Done : EOnlineAsyncTaskState::Failed;
+		TriggerOnFindSessionsCompleteDelegates(bWasSuccessful);
+	});
+
+	if (bStarted)
+	{
+		SearchSettings->SearchState = EOnlineAsyncTaskState::InProgress;
+	}
+
+	return bStarted;
+}
+
+bool FEnhancedOnlineSessionReplay::ReplayJoinSession(FName SessionName, const FOnlineSessionSearchResult& DesiredSession)
+{
+	const bool bStarted = Player->ReplayCall(this, EEnhancedTraceMethod::JoinSession, [this, SessionName](FArchive& Reader)
+	{
+		FName RecordedSessionName;
+		uint8 Result = 0;
+		Reader << RecordedSessionName << Result;
+
+		const EOnJoinSessionCompleteResult::Type JoinResult = static_cast<EOnJoinSessionCompleteResult::Type>(Result);
+		if (JoinResult != EOnJoinSessionCompleteResult::Success)
+		{
+			RemoveNamedSession(SessionName);
+		}
+		else if (FNamedOnlineSession* Session = GetNamedSession(SessionName))
+		{
+			Session->SessionState = EOnlineSessionState::Pending;
+		}
+
+		TriggerOnJoinSessionCompleteDelegates(SessionName, JoinResult);
+	});
+
+	if (bStarted && GetNamedSession(SessionName) == nullptr)
+	{
+		FNamedOnlineSession& NamedSession = AddReplaySession(SessionName, DesiredSession.Session);
+		NamedSession.bHosting = false;
+		NamedSession.SessionState = EOnlineSessionState::Creating;
+	}
+
+	return bStarted;
+}
+
+bool FEnhancedOnlineSessionReplay::ReplaySessionCall(EEnhancedTraceMethod Method, FName SessionName, TUniqueFunction<void(FNamedOnlineSession*, bool, const FString&)>&& OnComplete)
+{
+	return Player->ReplayCall(this, Method, [this, SessionName, OnComplete = MoveTemp(OnComplete)](FArchive& Reader)
+	{
+		bool bWasSuccessful = false;
+		FString SessionId;
+		EnhancedOnlineTraceReplay::ReadSessionCallback(Reader, bWasSuccessful, SessionId);
+
+		OnComplete(GetNamedSession(SessionName), bWasSuccessful, SessionId);
+	});
+}
+
+FNamedOnlineSession& FEnhancedOnlineSessionReplay::AddReplaySession(FName SessionName, const FOnlineSession& Session)
+{
+	TUniquePtr<FNamedOnlineSession>& NamedSession = NamedSessions.Add(SessionName, MakeUnique<FNamedOnlineSession>(SessionName, Session));
+	return *NamedSession;
+}
+
+FEnhancedOnlineIdentityReplay::FEnhancedOnlineIdentityReplay(const IOnlineIdentityPtr& InInner, const TSharedRef<FEnhancedOnlineTracePlayer>& InPlayer)
+	: FEnhancedOnlineIdentityDecorator(InInner)
+	, Player(InPlayer)
+{
+}
+
+FEnhancedOnlineIdentityReplay::~FEnhancedOnlineIdentityReplay()
+{
+	Player->Cancel(this);
+}
+
+bool FEnhancedOnlineIdentityReplay::Login(int32 LocalUserNum, const FOnlineAccountCredentials& AccountCredentials)
+{
+	if (LocalUserNum < 0 || LocalUserNum >= MAX_LOCAL_PLAYERS)
+	{
+		return false;
+	}
+
+	return Player->ReplayCall(this, EEnhancedTraceMethod::Login, [this, LocalUserNum](FArchive& Reader)
+	{
+		int32 RecordedUserNum = 0;
+		bool bWasSuccessful = false;
+		Reader << RecordedUserNum << bWasSuccessful;
+
+		FUniqueNetIdPtr UserId = EnhancedOnlineTrace::ReadUniqueNetId(Reader);
+		FString Error;
+		FString Nickname;
+		Reader << Error << Nickname;
+
+		if (!UserId.IsValid())
+		{
+			UserId = FUniqueNetIdString::Create(FString(), EnhancedOnlineTraceReplay::ReplayIdType);
+		}
+
+		if (bWasSuccessful)
+		{
+			Users[LocalUserNum].UserId = UserId;
+			Users[LocalUserNum].Nickname = Nickname;
+			SetLoginStatus(LocalUserNum, ELoginStatus::LoggedIn);
+		}
+
+		TriggerOnLoginCompleteDelegates(LocalUserNum, bWasSuccessful, *UserId, Error);
+	});
+}
+
+bool FEnhancedOnlineIdentityReplay::Logout(int32 LocalUserNum)
+{
+	if (LocalUserNum < 0 || LocalUserNum >= MAX_LOCAL_PLAYERS)
+	{
+		return false;
+	}
+
+	return Player->ReplayCall(this, EEnhancedTraceMethod::Logout, [this, LocalUserNum](FArchive& Reader)
+	{
+		int32 RecordedUserNum = 0;
+		bool bWasSuccessful = false;
+		Reader << RecordedUserNum << bWasSuccessful;
+
+		if (bWasSuccessful)
+		{
+			SetLoginStatus(LocalUserNum, ELoginStatus::NotLoggedIn);
+		}
+
+		TriggerOnLogoutCompleteDelegates(LocalUserNum, bWasSuccessful);
+	});
+}
+
+bool FEnhancedOnlineIdentityReplay::AutoLogin(int32 LocalUserNum)
+{
+	return Login(LocalUserNum, FOnlineAccountCredentials());
+}
+
+TSharedPtr<FUserOnlineAccount> FEnhancedOnlineIdentityReplay::GetUserAccount(const FUniqueNetId& UserId) const
+{
+	// Accounts hold auth data, which is never recorded
+	return nullptr;
+}
+
+TArray<TSharedPtr<FUserOnlineAccount>> FEnhancedOnlineIdentityReplay::GetAllUserAccounts() const
+{
+	return TArray<TSharedPtr<FUserOnlineAccount>>();
+}
+
+FUniqueNetIdPtr FEnhancedOnlineIdentityReplay::GetUniquePlayerId(int32 LocalUserNum) const
+{
+	return LocalUserNum >= 0 && LocalUserNum < MAX_LOCAL_PLAYERS ? Users[LocalUserNum].UserId : nullptr;
+}
+
+ELoginStatus::Type FEnhancedOnlineIdentityReplay::GetLoginStatus(int32 LocalUserNum) const
+{
+	return LocalUserNum >= 0 && LocalUserNum < MAX_LOCAL_PLAYERS ? Users[LocalUserNum].LoginStatus : ELoginStatus::NotLoggedIn;
+}
+
+ELoginStatus::Type FEnhancedOnlineIdentityReplay::GetLoginStatus(const FUniqueNetId& UserId) const
+{
+	const FReplayUser* User = FindUser(UserId);
+	return User ? User->LoginStatus : ELoginStatus::NotLoggedIn;
+}
+
+FString FEnhancedOnlineIdentityReplay::GetPlayerNickname(int32 LocalUserNum) const
+{
+	return LocalUserNum >= 0 && LocalUserNum < MAX_LOCAL_PLAYERS ? Users[LocalUserNum].Nickname : FString();
+}
+
+FString FEnhancedOnlineIdentityReplay::GetPlayerNickname(const FUniqueNetId& UserId) const
+{
+	const FReplayUser* User = FindUser(UserId);
+	return User ? User->Nickname : FString();
+}
+
+FString FEnhancedOnlineIdentityReplay::GetAuthToken(int32 LocalUserNum) const
+{
+	return FString();
+}
+
+const FEnhancedOnlineIdentityReplay::FReplayUser* FEnhancedOnlineIdentityReplay::FindUser(const FUniqueNetId& UserId) const
+{
+	for (const FReplayUser& User : Users)
+	{
+		if (User.UserId.IsValid() && *User.UserId == UserId)
+		{
+			return &User;
+		}
+	}
+
+	return nullptr;
+}
+
+void FEnhancedOnlineIdentityReplay::SetLoginStatus(int32 LocalUserNum, ELoginStatus::Type NewStatus)
+{
+	FReplayUser& User = Users[LocalUserNum];
+
+	const ELoginStatus::Type OldStatus = User.LoginStatus;
+	User.LoginStatus = NewStatus;
+
+	if (OldStatus != NewStatus && User.UserId.IsValid())
+	{
+		TriggerOnLoginStatusChangedDelegates(LocalUserNum, OldStatus, NewStatus, *User.UserId);
+	}
+}
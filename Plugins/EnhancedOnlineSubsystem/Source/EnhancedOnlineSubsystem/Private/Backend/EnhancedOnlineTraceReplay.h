@@ -0,0 +1,100 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnhancedOnlineIdentityDecorator.h"
+#include "EnhancedOnlineSessionDecorator.h"
+#include "EnhancedOnlineTrace.h"
+
+/**
+ * Answers the session calls of the subsystem from a trace instead of the backend
+ * Named sessions are kept by the replay, calls that aren't traced still reach the backend.
+ */
+class FEnhancedOnlineSessionReplay : public FEnhancedOnlineSessionDecorator
+{
+public:
+	FEnhancedOnlineSessionReplay(const IOnlineSessionPtr& InInner, const TSharedRef<FEnhancedOnlineTracePlayer>& InPlayer);
+	virtual ~FEnhancedOnlineSessionReplay() override;
+
+	//~ Begin IOnlineSession Interface
+	virtual FNamedOnlineSession* GetNamedSession(FName SessionName) override;
+	virtual void RemoveNamedSession(FName SessionName) override;
+	virtual EOnlineSessionState::Type GetSessionState(FName SessionName) const override;
+	virtual FUniqueNetIdPtr CreateSessionIdFromString(const FString& SessionIdStr) override;
+	virtual bool CreateSession(int32 HostingPlayerNum, FName SessionName, const FOnlineSessionSettings& NewSessionSettings) override;
+	virtual bool CreateSession(const FUniqueNetId& HostingPlayerId, FName SessionName, const FOnlineSessionSettings& NewSessionSettings) override;
+	virtual bool StartSession(FName SessionName) override;
+	virtual bool UpdateSession(FName SessionName, FOnlineSessionSettings& UpdatedSessionSettings, bool bShouldRefreshOnlineData = true) override;
+	virtual bool EndSession(FName SessionName) override;
+	virtual bool DestroySession(FName SessionName, const FOnDestroySessionCompleteDelegate& CompletionDelegate = FOnDestroySessionCompleteDelegate()) override;
+	virtual bool IsPlayerInSession(FName SessionName, const FUniqueNetId& UniqueId) override;
+	virtual bool FindSessions(int32 SearchingPlayerNum, const TSharedRef<FOnlineSessionSearch>& SearchSettings) override;
+	virtual bool FindSessions(const FUniqueNetId& SearchingPlayerId, const TSharedRef<FOnlineSessionSearch>& SearchSettings) override;
+	virtual bool FindSessionById(const FUniqueNetId& SearchingUserId, const FUniqueNetId& SessionId, const FUniqueNetId& FriendId, const FOnSingleSessionResultCompleteDelegate& CompletionDelegate) override;
+	virtual bool JoinSession(int32 LocalUserNum, FName SessionName, const FOnlineSessionSearchResult& DesiredSession) override;
+	virtual bool JoinSession(const FUniqueNetId& LocalUserId, FName SessionName, const FOnlineSessionSearchResult& DesiredSession) override;
+	virtual bool GetResolvedConnectString(FName SessionName, FString& ConnectInfo, FName PortType = NAME_GamePort) override;
+	virtual bool GetResolvedConnectString(const FOnlineSessionSearchResult& SearchResult, FName PortType, FString& ConnectInfo) override;
+	virtual FOnlineSessionSettings* GetSessionSettings(FName SessionName) override;
+	virtual bool RegisterPlayer(FName SessionName, const FUniqueNetId& PlayerId, bool bWasInvited) override;
+	virtual bool RegisterPlayers(FName SessionName, const TArray<FUniqueNetIdRef>& Players, bool bWasInvited = false) override;
+	virtual bool UnregisterPlayer(FName SessionName, const FUniqueNetId& PlayerId) override;
+	virtual bool UnregisterPlayers(FName SessionName, const TArray<FUniqueNetIdRef>& Players) override;
+	virtual int32 GetNumSessions() override;
+	virtual void DumpSessionState() override;
+	//~ End IOnlineSession Interface
+
+private:
+	bool ReplayCreateSession(const FUniqueNetIdPtr& HostingPlayerId, FName SessionName, const FOnlineSessionSettings& NewSessionSettings);
+	bool ReplayFindSessions(const TSharedRef<FOnlineSessionSearch>& SearchSettings);
+	bool ReplayJoinSession(FName SessionName, const FOnlineSessionSearchResult& DesiredSession);
+
+	/** Replays a call on a named session, OnComplete gets the session if it still exists and the recorded result */
+	bool ReplaySessionCall(EEnhancedTraceMethod Method, FName SessionName, TUniqueFunction<void(FNamedOnlineSession*, bool, const FString&)>&& OnComplete);
+
+	FNamedOnlineSession& AddReplaySession(FName SessionName, const FOnlineSession& Session);
+
+	TSharedRef<FEnhancedOnlineTracePlayer> Player;
+
+	TMap<FName, TUniquePtr<FNamedOnlineSession>> NamedSessions;
+};
+
+/**
+ * Answers the identity calls of the subsystem from a trace instead of the backend
+ */
+class FEnhancedOnlineIdentityReplay : public FEnhancedOnlineIdentityDecorator
+{
+public:
+	FEnhancedOnlineIdentityReplay(const IOnlineIdentityPtr& InInner, const TSharedRef<FEnhancedOnlineTracePlayer>& InPlayer);
+	virtual ~FEnhancedOnlineIdentityReplay() override;
+
+	//~ Begin IOnlineIdentity Interface
+	virtual bool Login(int32 LocalUserNum, const FOnlineAccountCredentials& AccountCredentials) override;
+	virtual bool Logout(int32 LocalUserNum) override;
+	virtual bool AutoLogin(int32 LocalUserNum) override;
+	virtual TSharedPtr<FUserOnlineAccount> GetUserAccount(const FUniqueNetId& UserId) const override;
+	virtual TArray<TSharedPtr<FUserOnlineAccount>> GetAllUserAccounts() const override;
+	virtual FUniqueNetIdPtr GetUniquePlayerId(int32 LocalUserNum) const override;
+	virtual ELoginStatus::Type GetLoginStatus(int32 LocalUserNum) const override;
+	virtual ELoginStatus::Type GetLoginStatus(const FUniqueNetId& UserId) const override;
+	virtual FString GetPlayerNickname(int32 LocalUserNum) const override;
+	virtual FString GetPlayerNickname(const FUniqueNetId& UserId) const override;
+	virtual FString GetAuthToken(int32 LocalUserNum) const override;
+	//~ End IOnlineIdentity Interface
+
+private:
+	struct FReplayUser
+	{
+		ELoginStatus::Type LoginStatus = ELoginStatus::NotLoggedIn;
+		FUniqueNetIdPtr UserId;
+		FString Nickname;
+	};
+
+	const FReplayUser* FindUser(const FUniqueNetId& UserId) const;
+	void SetLoginStatus(int32 LocalUserNum, ELoginStatus::Type NewStatus);
+
+	TSharedRef<FEnhancedOnlineTracePlayer> Player;
+
+	FReplayUser Users[MAX_LOCAL_PLAYERS];
+};
@@ -0,0 +1,411 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "Benchmarks/EnhancedOnlineBenchmarks.h"
+
+#if !UE_BUILD_SHIPPING
+#include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineSearchDecoding.h"
+#include "EnhancedOnlineSubsystem.h"
+#include "EnhancedOnlineTypes.h"
+#include "Dom/JsonObject.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Online/OnlineSessionNames.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "UObject/StrongObjectPtr.h"
+
+namespace EnhancedOnlineBenchmarks
+{
+	/** Samples taken per benchmark, the median is compared against the baseline */
+	static constexpr int32 NumSamples = 9;
+
+	/** Minimum length of a sample, short benchmarks are repeated until they take this long */
+	static constexpr double MinSampleSeconds = 0.002;
+
+	/** Everything the benchmarks compute ends up here, so the optimizer can't drop the work */
+	static int64 BenchmarkSink = 0;
+
+	static double TimeIterations(int32 NumIterations, TFunctionRef<void()> Body)
+	{
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			Body();
+		}
+		return FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+	}
+
+	static void Measure(const TCHAR* Name, int32 Size, const FString& Filter, TArray<FEnhancedBenchmarkResult>& OutResults, TFunctionRef<void()> Body)
+	{
+		if (!Filter.IsEmpty() && !FCString::Stristr(Name, *Filter))
+		{
+			return;
+		}
+
+		// The first runs warm up the caches and the allocator, they also find how many runs a sample needs
+		int32 NumIterations = 1;
+		while (TimeIterations(NumIterations, Body) < MinSampleSeconds && NumIterations < (1 << 20))
+		{
+			NumIterations *= 2;
+		}
+
+		TArray<double> SampleNs;
+		SampleNs.Reserve(NumSamples);
+		for (int32 Sample = 0; Sample < NumSamples; ++Sample)
+		{
+			SampleNs.Add(TimeIterations(NumIterations, Body) * 1.0e9 / NumIterations);
+		}
+		SampleNs.Sort();
+
+		FEnhancedBenchmarkResult& Result = OutResults.AddDefaulted_GetRef();
+		Result.Name = Name;
+		Result.Size = Size;
+		Result.NumIterations = NumIterations;
+		Result.MedianNs = SampleNs[NumSamples / 2];
+		Result.MinNs = SampleNs[0];
+
+		UE_LOG(LogEnhancedSubsystem, Display, TEXT("%-32s %6d %14.1f ns (min %.1f ns, %d per sample)"),
+			Name, Size, Result.MedianNs, Result.MinNs, NumIterations);
+	}
+
+	static void RunRequestBenchmarks(const FString& Filter, TArray<FEnhancedBenchmarkResult>& OutResults)
+	{
+		TStrongObjectPtr<UEnhancedOnlineRequest_Session> SessionRequest(NewObject<UEnhancedOnlineRequest_Session>());
+		SessionRequest->OnlineMode = EEnhancedSessionOnlineMode::LAN;
+		SessionRequest->TravelURLOperators = { TEXT("Game=/Game/Modes/Deathmatch"), TEXT("MaxPlayers=16"), TEXT("Region=eu-west") };
+
+		Measure(TEXT("Request.GetTravelURL"), 1, Filter, OutResults, [&SessionRequest]()
+		{
+			const FURL TravelURL = SessionRequest->GetTravelURL();
+			BenchmarkSink += TravelURL.Op.Num();
+		});
+
+		Measure(TEXT("SessionSettings.Construct"), 1, Filter, OutResults, []()
+		{
+			const FEnhancedOnlineSessionSettings SessionSettings(false, true, 16, true);
+			BenchmarkSink += SessionSettings.NumPublicConnections;
+		});
+
+		TStrongObjectPtr<UEnhancedOnlineRequest_FindSessions> FindRequest(NewObject<UEnhancedOnlineRequest_FindSessions>());
+		FindRequest->OnlineMode = EEnhancedSessionOnlineMode::Online;
+		FindRequest->bFindLobbies = true;
+		FindRequest->MaxSearchResults = 100;
+		FindRequest->SearchKeyword = TEXT("default");
+		FindRequest->QueryFilters.Add(FEnhancedSessionQueryFilter::MakeString(SETTING_GAMEMODE, EEnhancedSessionQueryComparison::Equals, TEXT("Deathmatch")));
+		FindRequest->QueryFilters.Add(FEnhancedSessionQueryFilter::MakeString(SETTING_MAPNAME, EEnhancedSessionQueryComparison::NotEquals, TEXT("Arena")));
+		FindRequest->QueryFilters.Add(FEnhancedSessionQueryFilter::MakeInt(SETTING_NUMPLAYERS, EEnhancedSessionQueryComparison::LessThan, 16));
+		FindRequest->QueryFilters.Add(FEnhancedSessionQueryFilter::MakeInt(SETTING_NUMPLAYERS, EEnhancedSessionQueryComparison::GreaterThan, 0));
+
+		Measure(TEXT("SearchSettings.Construct"), 1, Filter, OutResults, [&FindRequest]()
+		{
+			const TSharedRef<FEnhancedOnlineSearchSettings> SearchSettings = MakeShared<FEnhancedOnlineSearchSettings>(FindRequest.Get());
+			BenchmarkSink += SearchSettings->ClientQueryFilters.Num();
+		});
+	}
+
+	static void RunSearchResultBenchmarks(int32 NumResults, const FString& Filter, TArray<FEnhancedBenchmarkResult>& OutResults)
+	{
+		TArray<FOnlineSessionSearchResult> SearchResults;
+		EnhancedOnlineSearchDecoding::MakeBenchmarkSearchResults(NumResults, SearchResults);
+
+		// Same work as a search answer with a string table, serial so worker threads don't add noise
+		Measure(TEXT("SearchResults.Convert"), NumResults, Filter, OutResults, [&SearchResults]()
+		{
+			FEnhancedSearchDecodeOptions Options;
+			Options.bParallel = false;
+			Options.StringTable = MakeShared<FEnhancedSessionStringTable>();
+
+			TArray<FEnhancedDecodedSearchResult> DecodedResults;
+			EnhancedOnlineSearchDecoding::DecodeSearchResults(SearchResults, Options, DecodedResults);
+
+			for (FEnhancedDecodedSearchResult& Decoded : DecodedResults)
+			{
+				UEnhancedSessionSearchResult* NewResult = NewObject<UEnhancedSessionSearchResult>();
+				NewResult->StoredSearchResult = SearchResults[Decoded.SourceIndex];
+				NewResult->SetCompactSessionSettings(MoveTemp(Decoded.CompactSettings));
+				BenchmarkSink += NewResult->StoredSearchResult.PingInMs;
+			}
+		});
+
+		// The conversion leaves thousands of unreferenced results behind, they shouldn't be collected during the next benchmark
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+		TArray<TStrongObjectPtr<UEnhancedSessionSearchResult>> RawResults;
+		TArray<TStrongObjectPtr<UEnhancedSessionSearchResult>> CompactResults;
+		const TSharedRef<FEnhancedSessionStringTable> StringTable = MakeShared<FEnhancedSessionStringTable>();
+		for (const FOnlineSessionSearchResult& SearchResult : SearchResults)
+		{
+			UEnhancedSessionSearchResult* RawResult = NewObject<UEnhancedSessionSearchResult>();
+			RawResult->StoredSearchResult = SearchResult;
+			RawResults.Emplace(RawResult);
+
+			UEnhancedSessionSearchResult* CompactResult = NewObject<UEnhancedSessionSearchResult>();
+			CompactResult->StoredSearchResult = SearchResult;
+			CompactResult->CompactSessionSettings(StringTable);
+			CompactResults.Emplace(CompactResult);
+		}
+
+		Measure(TEXT("SearchResults.FriendlyName"), NumResults, Filter, OutResults, [&RawResults]()
+		{
+			for (const TStrongObjectPtr<UEnhancedSessionSearchResult>& Result : RawResults)
+			{
+				BenchmarkSink += Result->GetSessionFriendlyName().Len();
+			}
+		});
+
+		Measure(TEXT("SearchResults.FriendlyNameCompact"), NumResults, Filter, OutResults, [&CompactResults]()
+		{
+			for (const TStrongObjectPtr<UEnhancedSessionSearchResult>& Result : CompactResults)
+			{
+				BenchmarkSink += Result->GetSessionFriendlyName().Len();
+			}
+		});
+	}
+
+	/** Baselines are checked in with the plugin, one per platform since the timings depend on the hardware */
+	static FString GetBaselinePath()
+	{
+		const TSharedPtr<IPlugin> Plugin = IPluginManager::Get().FindPlugin(TEXT("EnhancedOnlineSubsystem"));
+		const FString BaseDir = Plugin.IsValid() ? Plugin->GetBaseDir() : FPaths::ProjectPluginsDir() / TEXT("EnhancedOnlineSubsystem");
+		return BaseDir / TEXT("Benchmarks") / FString::Printf(TEXT("Baseline_%s.json"), FPlatformProperties::IniPlatformName());
+	}
+
+	static FString ResultsToJson(const TArray<FEnhancedBenchmarkResult>& Results)
+	{
+		FString Json;
+		const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("Platform"), FString(FPlatformProperties::IniPlatformName()));
+		Writer->WriteValue(TEXT("Cpu"), FPlatformMisc::GetCPUBrand().TrimStartAndEnd());
+		Writer->WriteValue(TEXT("Time"), FDateTime::UtcNow().ToIso8601());
+		Writer->WriteArrayStart(TEXT("Results"));
+		for (const FEnhancedBenchmarkResult& Result : Results)
+		{
+			Writer->WriteObjectStart();
+			Writer->WriteValue(TEXT("Name"), Result.Name);
+			Writer->WriteValue(TEXT("Size"), Result.Size);
+			Writer->WriteValue(TEXT("Iterations"), Result.NumIterations);
+			Writer->WriteValue(TEXT("MedianNs"), Result.MedianNs);
+			Writer->WriteValue(TEXT("MinNs"), Result.MinNs);
+			Writer->WriteObjectEnd();
+		}
+		Writer->WriteArrayEnd();
+		Writer->WriteObjectEnd();
+		Writer->Close();
+
+		return Json;
+	}
+
+	static FString ResultsToCsv(const TArray<FEnhancedBenchmarkResult>& Results)
+	{
+		FString Csv = TEXT("Name,Size,Iterations,MedianNs,MinNs\n");
+		for (const FEnhancedBenchmarkResult& Result : Results)
+		{
+			Csv += FString::Printf(TEXT("%s,%d,%d,%.1f,%.1f\n"), *Result.Name, Result.Size, Result.NumIterations, Result.MedianNs, Result.MinNs);
+		}
+		return Csv;
+	}
+
+	/** Reads the median of every benchmark in the baseline, keyed like FEnhancedBenchmarkResult::GetKey */
+	static bool LoadBaseline(const FString& FilePath, TMap<FString, double>& OutMedianNs)
+	{
+		FString Json;
+		if (!FFileHelper::LoadFileToString(Json, *FilePath))
+		{
+			return false;
+		}
+
+		TSharedPtr<FJsonObject> Root;
+		if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Json), Root) || !Root.IsValid())
+		{
+			UE_LOG(LogEnhancedSubsystem, Error, TEXT("The benchmark baseline %s is not valid json."), *FilePath);
+			return false;
+		}
+
+		const TArray<TSharedPtr<FJsonValue>>* Results = nullptr;
+		if (Root->TryGetArrayField(TEXT("Results"), Results))
+		{
+			for (const TSharedPtr<FJsonValue>& Value : *Results)
+			{
+				const TSharedPtr<FJsonObject>* Result = nullptr;
+				if (Value->TryGetObject(Result))
+				{
+					FEnhancedBenchmarkResult Entry;
+					Entry.Name = (*Result)->GetStringField(TEXT("Name"));
+					Entry.Size = (*Result)->GetIntegerField(TEXT("Size"));
+					OutMedianNs.Add(Entry.GetKey(), (*Result)->GetNumberField(TEXT("MedianNs")));
+				}
+			}
+		}
+
+		return true;
+	}
+
+	static int32 CompareToBaseline(const TArray<FEnhancedBenchmarkResult>& Results, const TMap<FString, double>& BaselineNs, float ThresholdPercent, bool bRequireBaseline, TArray<FString>& OutErrors)
+	{
+		int32 NumRegressions = 0;
+		for (const FEnhancedBenchmarkResult& Result : Results)
+		{
+			const double* BaseNs = BaselineNs.Find(Result.GetKey());
+			if (!BaseNs || *BaseNs <= 0.0)
+			{
+				if (bRequireBaseline)
+				{
+					OutErrors.Add(FString::Printf(TEXT("%s has no baseline, record one on the reference machine with -WriteBaseline."), *Result.GetKey()));
+				}
+				else
+				{
+					UE_LOG(LogEnhancedSubsystem, Display, TEXT("%s has no baseline yet."), *Result.GetKey());
+				}
+				continue;
+			}
+
+			const double ChangePercent = (Result.MedianNs - *BaseNs) / *BaseNs * 100.0;
+			if (ChangePercent > ThresholdPercent)
+			{
+				OutErrors.Add(FString::Printf(TEXT("%s regressed by %.1f%%: %.1f ns, baseline %.1f ns."), *Result.GetKey(), ChangePercent, Result.MedianNs, *BaseNs));
+				++NumRegressions;
+			}
+			else if (ChangePercent < -ThresholdPercent)
+			{
+				UE_LOG(LogEnhancedSubsystem, Display, TEXT("%s improved by %.1f%%: %.1f ns, baseline %.1f ns."), *Result.GetKey(), -ChangePercent, Result.MedianNs, *BaseNs);
+			}
+		}
+
+		return NumRegressions;
+	}
+
+	bool Run(const FString& Params, TArray<FString>& OutErrors)
+	{
+		TArray<int32> Sizes;
+		FString SizesParam;
+		if (FParse::Value(*Params, TEXT("Sizes="), SizesParam, false))
+		{
+			TArray<FString> SizeStrings;
+			SizesParam.ParseIntoArray(SizeStrings, TEXT(","));
+			for (const FString& SizeString : SizeStrings)
+			{
+				Sizes.Add(FMath::Max(1, FCString::Atoi(*SizeString)));
+			}
+		}
+		if (Sizes.Num() == 0)
+		{
+			Sizes = { 10, 100, 1000 };
+		}
+
+		FString Filter;
+		FParse::Value(*Params, TEXT("Filter="), Filter);
+
+		float ThresholdPercent = 15.0f;
+		FParse::Value(*Params, TEXT("Threshold="), ThresholdPercent);
+
+		FString OutputName = FString::Printf(TEXT("Benchmarks_%s"), *FDateTime::Now().ToString());
+		FParse::Value(*Params, TEXT("Output="), OutputName);
+
+		const bool bWriteBaseline = FParse::Param(*Params, TEXT("WriteBaseline"));
+
+		const bool bRequireBaselineParam = FParse::Param(*Params, TEXT("RequireBaseline"));
+
+		TArray<FEnhancedBenchmarkResult> Results;
+		RunRequestBenchmarks(Filter, Results);
+		for (int32 NumResults : Sizes)
+		{
+			RunSearchResultBenchmarks(NumResults, Filter, Results);
+		}
+		UE_LOG(LogEnhancedSubsystem, Verbose, TEXT("Benchmark checksum %lld."), BenchmarkSink);
+
+		if (Results.Num() == 0)
+		{
+			UE_LOG(LogEnhancedSubsystem, Warning, TEXT("No benchmark matches the filter %s."), *Filter);
+			return true;
+		}
+
+		const FString Json = ResultsToJson(Results);
+		const FString OutputPath = FPaths::ProjectSavedDir() / TEXT("EnhancedOnline") / TEXT("Benchmarks") / OutputName;
+		if (!FFileHelper::SaveStringToFile(Json, *(OutputPath + TEXT(".json"))) || !FFileHelper::SaveStringToFile(ResultsToCsv(Results), *(OutputPath + TEXT(".csv"))))
+		{
+			OutErrors.Add(FString::Printf(TEXT("Failed to write the benchmark results to %s."), *OutputPath));
+			return false;
+		}
+		UE_LOG(LogEnhancedSubsystem, Display, TEXT("Wrote the benchmark results to %s.json and .csv."), *OutputPath);
+
+		const FString BaselinePath = GetBaselinePath();
+		if (bWriteBaseline)
+		{
+			if (!FFileHelper::SaveStringToFile(Json, *BaselinePath))
+			{
+				OutErrors.Add(FString::Printf(TEXT("Failed to write the benchmark baseline %s."), *BaselinePath));
+				return false;
+			}
+
+			UE_LOG(LogEnhancedSubsystem, Display, TEXT("Wrote the benchmark baseline %s."), *BaselinePath);
+			return true;
+		}
+
+		TMap<FString, double> BaselineNs;
+		if (!LoadBaseline(BaselinePath, BaselineNs))
+		{
+			// A build machine without a baseline file would pass every run without comparing anything
+			if (bRequireBaselineParam || GIsBuildMachine)
+			{
+				OutErrors.Add(FString::Printf(TEXT("No benchmark baseline at %s, record one on the reference machine with -WriteBaseline."), *BaselinePath));
+				return false;
+			}
+
+			UE_LOG(LogEnhancedSubsystem, Warning, TEXT("No benchmark baseline at %s, record one on the reference machine with -WriteBaseline."), *BaselinePath);
+			return true;
+		}
+
+		// Build machines only gate once the baseline of their platform was recorded, the checked-in placeholders have no results yet
+		const bool bRequireBaseline = bRequireBaselineParam || (GIsBuildMachine && BaselineNs.Num() > 0);
+		if (BaselineNs.Num() == 0 && !bRequireBaseline)
+		{
+			UE_LOG(LogEnhancedSubsystem, Warning, TEXT("The benchmark baseline %s has no results yet, record them on the reference machine with -WriteBaseline."), *BaselinePath);
+		}
+
+		const int32 NumErrors = OutErrors.Num();
+		const int32 NumRegressions = CompareToBaseline(Results, BaselineNs, ThresholdPercent, bRequireBaseline, OutErrors);
+		UE_LOG(LogEnhancedSubsystem, Display, TEXT("%d of %d benchmarks regressed by more than %.1f%%."), NumRegressions, Results.Num(), ThresholdPercent);
+		return OutErrors.Num() == NumErrors;
+	}
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEnhancedOnlineBenchmarksTest, "EnhancedOnline.Benchmarks",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ServerContext | EAutomationTestFlags::CommandletContext | EAutomationTestFlags::PerfFilter)
+
+bool FEnhancedOnlineBenchmarksTest::RunTest(const FString& Parameters)
+{
+	TArray<FString> Errors;
+	const bool bPassed = EnhancedOnlineBenchmarks::Run(Parameters, Errors);
+
+	for (const FString& Error : Errors)
+	{
+		AddError(Error);
+	}
+
+	return bPassed;
+}
+#endif
+
+static FAutoConsoleCommand CmdEnhancedBenchmarksRun(
+	TEXT("EnhancedOnline.Benchmarks.Run"),
+	TEXT("Times the hot paths of the plugin and compares them against the checked-in baseline. Usage: EnhancedOnline.Benchmarks.Run [-Sizes=10,100,1000] [-Filter=Name] [-Threshold=15] [-Output=Name] [-WriteBaseline]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		TArray<FString> Errors;
+		if (!EnhancedOnlineBenchmarks::Run(FString::Join(Args, TEXT(" ")), Errors))
+		{
+			for (const FString& Error : Errors)
+			{
+				UE_LOG(LogEnhancedSubsystem, Error, TEXT("%s"), *Error);
+			}
+			UE_LOG(LogEnhancedSubsystem, Error, TEXT("The benchmarks failed with %d errors."), Errors.Num());
+		}
+	}));
+#endif
@@ -0,0 +1,47 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if !UE_BUILD_SHIPPING
+/**
+ * Timing of a single benchmark at one size
+ */
+struct FEnhancedBenchmarkResult
+{
+	FString Name;
+
+	/** Number of items a single run works on, 1 for benchmarks without a size */
+	int32 Size = 1;
+
+	/** Runs timed together in every sample, so a sample is well above the timer resolution */
+	int32 NumIterations = 0;
+
+	/** Nanoseconds a single run takes, median and fastest of the samples */
+	double MedianNs = 0.0;
+	double MinNs = 0.0;
+
+	/** Identifies the result in the baseline */
+	FString GetKey() const
+	{
+		return FString::Printf(TEXT("%s@%d"), *Name, Size);
+	}
+};
+
+namespace EnhancedOnlineBenchmarks
+{
+	/**
+	 * Times the hot paths of the plugin, writes the results as json and csv and compares them against the checked-in baseline.
+	 *	-Sizes=10,100,1000		Numbers of search results the sized benchmarks run at
+	 *	-Filter=<Name>			Only runs benchmarks whose name contains this
+	 *	-Threshold=<Percent>	Slowdown against the baseline that counts as a regression
+	 *	-Output=<Name>			File name of the results in Saved/EnhancedOnline/Benchmarks/
+	 *	-WriteBaseline			Replaces the baseline of this platform with the results
+	 *	-RequireBaseline		Fails if the baseline or a benchmark in it is missing, on for build machines once the baseline has results
+	 * @param OutErrors		Regressions and everything else that failed the run, for the caller to report
+	 * @return False if a benchmark regressed or the results could not be checked
+	 */
+	bool Run(const FString& Params, TArray<FString>& OutErrors);
+}
+#endif
@@ -0,0 +1,33 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineBenchmarkCommandlet.h"
+
+#include "EnhancedOnlineSubsystem.h"
+#include "Benchmarks/EnhancedOnlineBenchmarks.h"
+
+UEnhancedOnlineBenchmarkCommandlet::UEnhancedOnlineBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UEnhancedOnlineBenchmarkCommandlet::Main(const FString& Params)
+{
+#if UE_BUILD_SHIPPING
+	UE_LOG(LogEnhancedSubsystem, Error, TEXT("The benchmarks are not compiled into shipping builds."));
+	return 1;
+#else
+	// Regressions and results that could not be checked both fail the run
+	TArray<FString> Errors;
+	const bool bPassed = EnhancedOnlineBenchmarks::Run(Params, Errors);
+
+	for (const FString& Error : Errors)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("%s"), *Error);
+	}
+
+	return bPassed ? 0 : 1;
+#endif
+}
@@ -0,0 +1,32 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "EnhancedOnlineBenchmarkCommandlet.generated.h"
+
+/**
+ * Runs the microbenchmarks of the plugin, fails if one of them regressed against the checked-in baseline.
+ * Takes the same parameters as EnhancedOnline.Benchmarks.Run, not available in shipping builds.
+ *
+ * UnrealEditor-Cmd <Project> -run=EnhancedOnlineBenchmark -Sizes=10,100,1000 -Threshold=15
+ *	-Filter=<Name>			Only runs benchmarks whose name contains this
+ *	-Output=<Name>			File name of the json and csv results in Saved/EnhancedOnline/Benchmarks/
+ *	-WriteBaseline			Records the baseline of this platform, run on the reference machine
+ *	-RequireBaseline		Fails without a baseline, implied by -BuildMachine once the checked-in baseline has results
+ *
+ * The same run is registered as the automation test EnhancedOnline.Benchmarks, e.g. -ExecCmds="Automation RunTests EnhancedOnline.Benchmarks"
+ */
+UCLASS()
+class UEnhancedOnlineBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UEnhancedOnlineBenchmarkCommandlet();
+
+	//~ Begin UCommandlet Interface
+	virtual int32 Main(const FString& Params) override;
+	//~ End UCommandlet Interface
+};
@@ -0,0 +1,1035 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineLoadTestCommandlet.h"
+
+#include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineSessionsSubsystem.h"
+#include "EnhancedOnlineSubsystem.h"
+#include "OnlineSubsystem.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Containers/Ticker.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/StrongObjectPtr.h"
+
+#if WITH_EDITOR
+namespace EnhancedOnlineLoadTest
+{
+	enum class EStep : uint8
+	{
+		Login,
+		Find,
+		Join,
+		Leave,
+		Logout,
+		Host,
+
+		Num
+	};
+
+	static const TCHAR* GetStepName(EStep Step)
+	{
+		switch (Step)
+		{
+		case EStep::Login: return TEXT("Login");
+		case EStep::Find: return TEXT("Find");
+		case EStep::Join: return TEXT("Join");
+		case EStep::Leave: return TEXT("Leave");
+		case EStep::Logout: return TEXT("Logout");
+		case EStep::Host: return TEXT("Host");
+		default: return TEXT("Unknown");
+		}
+	}
+
+	/** Steps a bot runs per arrival */
+	struct FScenario
+	{
+		FString Name;
+		float Weight = 1.0f;
+		TArray<EStep> Steps;
+	};
+
+	static bool MakeScenario(const FString& Name, float Weight, FScenario& OutScenario)
+	{
+		OutScenario.Name = Name;
+		OutScenario.Weight = Weight;
+
+		if (Name.Equals(TEXT("Login"), ESearchCase::IgnoreCase))
+		{
+			OutScenario.Steps = { EStep::Login, EStep::Logout };
+		}
+		else if (Name.Equals(TEXT("Browse"), ESearchCase::IgnoreCase))
+		{
+			OutScenario.Steps = { EStep::Login, EStep::Find, EStep::Logout };
+		}
+		else if (Name.Equals(TEXT("Join"), ESearchCase::IgnoreCase))
+		{
+			OutScenario.Steps = { EStep::Login, EStep::Find, EStep::Join, EStep::Leave, EStep::Logout };
+		}
+		else
+		{
+			return false;
+		}
+
+		return true;
+	}
+
+	struct FOptions
+	{
+		FString Backend;
+		int32 NumBots = 100;
+		int32 NumHosts = 0;
+		int32 HostSlots = 64;
+		float ArrivalRate = 10.0f;
+		float DurationSeconds = 60.0f;
+		float StepTimeoutSeconds = 30.0f;
+		float TickIntervalSeconds = 0.01f;
+		float MaxErrorRate = -1.0f;
+		float HostRetryDelaySeconds = 5.0f;
+		int32 MaxSearchResults = 50;
+		FString Keyword;
+		FString ReportFile;
+		bool bLAN = false;
+		bool bReserveSlots = true;
+		TArray<FScenario> Scenarios;
+	};
+
+	struct FStepStats
+	{
+		int32 NumStarted = 0;
+		int32 NumSucceeded = 0;
+		int32 NumFailed = 0;
+		int32 NumTimedOut = 0;
+
+		/** Milliseconds of every successful step */
+		TArray<double> LatenciesMs;
+
+		/** Number of failures per reason */
+		TMap<FString, int32> Errors;
+
+		float GetErrorRate() const
+		{
+			const int32 NumFinished = NumSucceeded + NumFailed + NumTimedOut;
+			return NumFinished > 0 ? 100.0f * (NumFailed + NumTimedOut) / NumFinished : 0.0f;
+		}
+	};
+
+	/** Nearest rank percentile of sorted values */
+	static double GetPercentile(const TArray<double>& SortedValues, double Percentile)
+	{
+		if (SortedValues.Num() == 0)
+		{
+			return 0.0;
+		}
+
+		const int32 Index = FMath::CeilToInt(Percentile * SortedValues.Num()) - 1;
+		return SortedValues[FMath::Clamp(Index, 0, SortedValues.Num() - 1)];
+	}
+
+	/**
+	 * A simulated user, a game instance with a local player and its own instance of the backend
+	 */
+	struct FBot
+	{
+		int32 Index = 0;
+
+		/** Bumped whenever a step ends or the bot restarts, answers to older steps are ignored */
+		uint32 Serial = 0;
+
+		/** Number of game instances the bot went through, keeps the world names unique */
+		int32 Generation = 0;
+
+		FName BackendName;
+
+		TStrongObjectPtr<UGameInstance> GameInstance;
+		TWeakObjectPtr<UEnhancedOnlineSessionsSubsystem> Subsystem;
+		TWeakObjectPtr<APlayerController> PlayerController;
+
+		/** Scenario of the current run, null while the bot is idle */
+		const FScenario* Scenario = nullptr;
+		int32 StepIndex = INDEX_NONE;
+		bool bStepInFlight = false;
+		bool bRunFailed = false;
+		double StepStartTime = 0.0;
+
+		TStrongObjectPtr<UEnhancedOnlineRequestBase> Request;
+		TStrongObjectPtr<UEnhancedSessionSearchResult> SessionToJoin;
+		FName JoinedSessionName;
+
+		/** Host bots keep their session for the whole test and take no arrivals */
+		bool bHost = false;
+		bool bHosting = false;
+
+		/** A host whose run failed gets a fresh game instance at this time */
+		bool bRestartPending = false;
+		double RestartTime = 0.0;
+
+		bool IsIdle() const { return Scenario == nullptr; }
+		EStep GetStep() const { return Scenario->Steps[StepIndex]; }
+	};
+
+	class FLoadTest
+	{
+	public:
+		explicit FLoadTest(const FOptions& InOptions);
+
+		bool Start();
+		void Stop();
+
+		void Tick(double Now, float DeltaSeconds);
+		bool IsFinished(double Now) const;
+
+		/** Logs the summary, writes the report and returns whether the error rates stayed within the limit */
+		bool Report(double Now) const;
+
+	private:
+		bool StartBot(FBot& Bot);
+		void StopBot(FBot& Bot);
+
+		void StartRun(FBot& Bot, double Now);
+		void StartStep(FBot& Bot, double Now);
+		void CompleteStep(FBot& Bot, uint32 Serial, bool bWasSuccessful, const FString& Error);
+		void TimeOutStep(FBot& Bot);
+		void FinishRun(FBot& Bot);
+
+		bool IssueLogin(FBot& Bot);
+		bool IssueFind(FBot& Bot);
+		bool IssueJoin(FBot& Bot);
+		bool IssueLeave(FBot& Bot);
+		bool IssueLogout(FBot& Bot);
+		bool IssueHost(FBot& Bot);
+
+		/** Starts the host bots that are idle, returns whether all of them are hosting */
+		bool TickHosts(double Now);
+
+		const FScenario& PickScenario() const;
+		void LogProgress(double Now) const;
+
+		FOptions Options;
+		TArray<TUniquePtr<FBot>> Bots;
+		TArray<TUniquePtr<FBot>> Hosts;
+		FScenario HostScenario;
+		FStepStats Stats[static_cast<int32>(EStep::Num)];
+
+		/** Start of the arrivals, which wait until the hosts are up */
+		double StartTime = 0.0;
+		bool bArrivalsStarted = false;
+		double LastProgressTime = 0.0;
+		double LastGarbageCollectionTime = 0.0;
+		float PendingArrivals = 0.0f;
+
+		int32 NumRunsStarted = 0;
+		int32 NumRunsCompleted = 0;
+
+		/** Arrivals that found every bot busy */
+		int32 NumArrivalsDropped = 0;
+	};
+
+	FLoadTest::FLoadTest(const FOptions& InOptions)
+		: Options(InOptions)
+	{
+		HostScenario.Name = TEXT("Host");
+		HostScenario.Steps = { EStep::Login, EStep::Host };
+	}
+
+	bool FLoadTest::Start()
+	{
+		Hosts.Reserve(Options.NumHosts);
+		for (int32 Index = 0; Index < Options.NumHosts; ++Index)
+		{
+			FBot& Host = *Hosts.Add_GetRef(MakeUnique<FBot>());
+			Host.Index = Index;
+			Host.bHost = true;
+			Host.BackendName = FName(*FString::Printf(TEXT("%s:LoadTestHost%d"), *Options.Backend, Index));
+
+			if (!StartBot(Host))
+			{
+				return false;
+			}
+		}
+
+		Bots.Reserve(Options.NumBots);
+		for (int32 Index = 0; Index < Options.NumBots; ++Index)
+		{
+			FBot& Bot = *Bots.Add_GetRef(MakeUnique<FBot>());
+			Bot.Index = Index;
+			Bot.BackendName = FName(*FString::Printf(TEXT("%s:LoadTestBot%d"), *Options.Backend, Index));
+
+			if (!StartBot(Bot))
+			{
+				return false;
+			}
+		}
+
+		StartTime = FPlatformTime::Seconds();
+		LastProgressTime = StartTime;
+		LastGarbageCollectionTime = StartTime;
+
+		UE_LOG(LogEnhancedSubsystem, Display, TEXT("Started %d load test bots and %d hosts on backend %s."), Bots.Num(), Hosts.Num(), Options.Backend.IsEmpty() ? TEXT("<default>") : *Options.Backend);
+		return true;
+	}
+
+	void FLoadTest::Stop()
+	{
+		for (const TUniquePtr<FBot>& Bot : Bots)
+		{
+			StopBot(*Bot);
+		}
+		Bots.Reset();
+
+		for (const TUniquePtr<FBot>& Host : Hosts)
+		{
+			StopBot(*Host);
+		}
+		Hosts.Reset();
+	}
+
+	bool FLoadTest::StartBot(FBot& Bot)
+	{
+		UGameInstance* GameInstance = NewObject<UGameInstance>(GEngine);
+		GameInstance->InitializeStandalone(FName(*FString::Printf(TEXT("%s%d_%d"), Bot.bHost ? TEXT("LoadTestHost") : TEXT("LoadTestBot"), Bot.Index, Bot.Generation++)));
+
+		UEnhancedOnlineSessionsSubsystem* Subsystem = GameInstance->GetSubsystem<UEnhancedOnlineSessionsSubsystem>();
+		UWorld* World = GameInstance->GetWorld();
+		if (Subsystem == nullptr || World == nullptr)
+		{
+			UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to create the game instance of load test %s %d."), Bot.bHost ? TEXT("host") : TEXT("bot"), Bot.Index);
+			GameInstance->Shutdown();
+			return false;
+		}
+
+		Subsystem->SetDefaultOnlineBackend(Bot.BackendName);
+
+		// Requests look for the player controller of the local user, there is no viewport to spawn it through
+		ULocalPlayer* LocalPlayer = NewObject<ULocalPlayer>(GEngine, GEngine->LocalPlayerClass);
+		GameInstance->AddLocalPlayer(LocalPlayer, FPlatformMisc::GetPlatformUserForUserIndex(0));
+
+		APlayerController* PlayerController = World->SpawnActor<APlayerController>();
+		PlayerController->Player = LocalPlayer;
+		LocalPlayer->PlayerController = PlayerController;
+
+		Bot.GameInstance.Reset(GameInstance);
+		Bot.Subsystem = Subsystem;
+		Bot.PlayerController = PlayerController;
+		return true;
+	}
+
+	void FLoadTest::StopBot(FBot& Bot)
+	{
+		++Bot.Serial;
+		Bot.Request.Reset();
+		Bot.SessionToJoin.Reset();
+
+		if (UGameInstance* GameInstance = Bot.GameInstance.Get())
+		{
+			UWorld* World = GameInstance->GetWorld();
+			GameInstance->Shutdown();
+
+			if (World)
+			{
+				World->DestroyWorld(false);
+				GEngine->DestroyWorldContext(World);
+			}
+		}
+
+		Bot.GameInstance.Reset();
+		Bot.Subsystem.Reset();
+		Bot.PlayerController.Reset();
+		Bot.bHosting = false;
+
+		// The next game instance starts with a fresh backend, nothing of the timed out step may answer it
+		IOnlineSubsystem::Destroy(Bot.BackendName);
+	}
+
+	void FLoadTest::Tick(double Now, float DeltaSeconds)
+	{
+		const bool bHostsReady = TickHosts(Now);
+
+		// Searches before the hosts are up would only measure an empty backend
+		if (!bArrivalsStarted && (bHostsReady || Now - StartTime > Options.StepTimeoutSeconds))
+		{
+			if (!bHostsReady)
+			{
+				UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Not every load test host is up after %.0fs, starting the arrivals anyway."), Options.StepTimeoutSeconds);
+			}
+
+			bArrivalsStarted = true;
+			StartTime = Now;
+			LastProgressTime = Now;
+		}
+
+		if (!bArrivalsStarted)
+		{
+			PendingArrivals = 0.0f;
+		}
+		else if (Now - StartTime < Options.DurationSeconds)
+		{
+			PendingArrivals += Options.ArrivalRate * DeltaSeconds;
+		}
+		else
+		{
+			PendingArrivals = 0.0f;
+		}
+
+		for (const TUniquePtr<FBot>& Bot : Bots)
+		{
+			if (PendingArrivals >= 1.0f && Bot->IsIdle() && Bot->GameInstance.IsValid())
+			{
+				PendingArrivals -= 1.0f;
+				StartRun(*Bot, Now);
+			}
+		}
+
+		// Arrivals don't queue up, a busy fleet is part of the result
+		while (PendingArrivals >= 1.0f)
+		{
+			PendingArrivals -= 1.0f;
+			++NumArrivalsDropped;
+		}
+
+		for (const TUniquePtr<FBot>& Bot : Bots)
+		{
+			if (Bot->IsIdle())
+			{
+				continue;
+			}
+
+			if (!Bot->bStepInFlight)
+			{
+				StartStep(*Bot, Now);
+			}
+			else if (Now - Bot->StepStartTime > Options.StepTimeoutSeconds)
+			{
+				TimeOutStep(*Bot);
+			}
+		}
+
+		for (const TArray<TUniquePtr<FBot>>* Fleet : { &Hosts, &Bots })
+		{
+			for (const TUniquePtr<FBot>& Bot : *Fleet)
+			{
+				if (UWorld* World = Bot->GameInstance.IsValid() ? Bot->GameInstance->GetWorld() : nullptr)
+				{
+					World->Tick(LEVELTICK_All, DeltaSeconds);
+				}
+			}
+		}
+
+		if (Now - LastGarbageCollectionTime > 30.0)
+		{
+			LastGarbageCollectionTime = Now;
+			CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+		}
+
+		if (Now - LastProgressTime > 10.0)
+		{
+			LastProgressTime = Now;
+			LogProgress(Now);
+		}
+	}
+
+	bool FLoadTest::TickHosts(double Now)
+	{
+		bool bAllHosting = true;
+		for (const TUniquePtr<FBot>& Host : Hosts)
+		{
+			bAllHosting &= Host->bHosting;
+
+			// Hosts stay in their empty world, the travel to the session map is dropped
+			UWorld* World = Host->bHosting && Host->GameInstance.IsValid() ? Host->GameInstance->GetWorld() : nullptr;
+			if (World && !World->NextURL.IsEmpty())
+			{
+				World->NextURL.Empty();
+			}
+
+			if (!Host->IsIdle())
+			{
+				if (!Host->bStepInFlight)
+				{
+					StartStep(*Host, Now);
+				}
+				else if (Now - Host->StepStartTime > Options.StepTimeoutSeconds)
+				{
+					TimeOutStep(*Host);
+				}
+			}
+			else if (!Host->bHosting && Now >= Host->RestartTime)
+			{
+				// Restarted here rather than in the failed callback, which still runs inside the game instance
+				if (Host->bRestartPending)
+				{
+					Host->bRestartPending = false;
+					StopBot(*Host);
+					StartBot(*Host);
+				}
+
+				if (Host->GameInstance.IsValid())
+				{
+					StartRun(*Host, Now);
+				}
+			}
+		}
+
+		return bAllHosting;
+	}
+
+	bool FLoadTest::IsFinished(double Now) const
+	{
+		if (!bArrivalsStarted || Now - StartTime < Options.DurationSeconds)
+		{
+			return false;
+		}
+
+		return !Bots.ContainsByPredicate([](const TUniquePtr<FBot>& Bot)
+		{
+			return !Bot->IsIdle();
+		});
+	}
+
+	void FLoadTest::StartRun(FBot& Bot, double Now)
+	{
+		Bot.Scenario = Bot.bHost ? &HostScenario : &PickScenario();
+		Bot.StepIndex = 0;
+		Bot.bRunFailed = false;
+		NumRunsStarted += Bot.bHost ? 0 : 1;
+
+		StartStep(Bot, Now);
+	}
+
+	void FLoadTest::StartStep(FBot& Bot, double Now)
+	{
+		const EStep Step = Bot.GetStep();
+		FStepStats& StepStats = Stats[static_cast<int32>(Step)];
+		++StepStats.NumStarted;
+
+		Bot.bStepInFlight = true;
+		Bot.StepStartTime = Now;
+		Bot.Request.Reset();
+
+		bool bIssued = false;
+		switch (Step)
+		{
+		case EStep::Login: bIssued = IssueLogin(Bot); break;
+		case EStep::Find: bIssued = IssueFind(Bot); break;
+		case EStep::Join: bIssued = IssueJoin(Bot); break;
+		case EStep::Leave: bIssued = IssueLeave(Bot); break;
+		case EStep::Logout: bIssued = IssueLogout(Bot); break;
+		case EStep::Host: bIssued = IssueHost(Bot); break;
+		default: break;
+		}
+
+		if (!bIssued && Bot.bStepInFlight)
+		{
+			CompleteStep(Bot, Bot.Serial, false, TEXT("The step could not be issued."));
+		}
+	}
+
+	void FLoadTest::CompleteStep(FBot& Bot, uint32 Serial, bool bWasSuccessful, const FString& Error)
+	{
+		if (Serial != Bot.Serial || !Bot.bStepInFlight)
+		{
+			return;
+		}
+
+		++Bot.Serial;
+		Bot.bStepInFlight = false;
+		Bot.Request.Reset();
+
+		const EStep Step = Bot.GetStep();
+		FStepStats& StepStats = Stats[static_cast<int32>(Step)];
+
+		if (bWasSuccessful)
+		{
+			++StepStats.NumSucceeded;
+			StepStats.LatenciesMs.Add((FPlatformTime::Seconds() - Bot.StepStartTime) * 1000.0);
+		}
+		else
+		{
+			++StepStats.NumFailed;
+			++StepStats.Errors.FindOrAdd(Error);
+			Bot.bRunFailed = true;
+		}
+
+		// A failed step skips ahead to the logout, so the next run starts logged out
+		int32 NextStepIndex = Bot.StepIndex + 1;
+		if (!bWasSuccessful)
+		{
+			const int32 LogoutIndex = Bot.Scenario->Steps.Find(EStep::Logout);
+			NextStepIndex = Step != EStep::Login && LogoutIndex > Bot.StepIndex ? LogoutIndex : Bot.Scenario->Steps.Num();
+		}
+
+		if (NextStepIndex >= Bot.Scenario->Steps.Num())
+		{
+			FinishRun(Bot);
+		}
+		else
+		{
+			// Started on the next tick, answers given from within a call don't nest the next step into it
+			Bot.StepIndex = NextStepIndex;
+		}
+	}
+
+	void FLoadTest::TimeOutStep(FBot& Bot)
+	{
+		FStepStats& StepStats = Stats[static_cast<int32>(Bot.GetStep())];
+		++StepStats.NumTimedOut;
+		Bot.bRunFailed = true;
+
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Load test %s %d timed out in step %s, restarting it."), Bot.bHost ? TEXT("host") : TEXT("bot"), Bot.Index, GetStepName(Bot.GetStep()));
+
+		// The subsystem still waits for the answer, only a fresh game instance can take the next run
+		FinishRun(Bot);
+		StopBot(Bot);
+		StartBot(Bot);
+		Bot.bRestartPending = false;
+	}
+
+	void FLoadTest::FinishRun(FBot& Bot)
+	{
+		if (Bot.bHost)
+		{
+			Bot.bHosting = !Bot.bRunFailed;
+			Bot.bRestartPending = Bot.bRunFailed;
+			Bot.RestartTime = FPlatformTime::Seconds() + Options.HostRetryDelaySeconds;
+		}
+		else if (!Bot.bRunFailed)
+		{
+			++NumRunsCompleted;
+		}
+
+		Bot.Scenario = nullptr;
+		Bot.StepIndex = INDEX_NONE;
+		Bot.bStepInFlight = false;
+		Bot.Request.Reset();
+		Bot.SessionToJoin.Reset();
+		Bot.JoinedSessionName = NAME_None;
+	}
+
+	bool FLoadTest::IssueLogin(FBot& Bot)
+	{
+		UEnhancedOnlineSessionsSubsystem* Subsystem = Bot.Subsystem.Get();
+		if (Subsystem == nullptr)
+		{
+			return false;
+		}
+
+		UEnhancedOnlineRequest_LoginUser* Request = NewObject<UEnhancedOnlineRequest_LoginUser>(Bot.PlayerController.Get());
+		Request->ConstructRequest();
+		Request->LocalUserIndex = 0;
+		Request->bInvalidateOnCompletion = true;
+		Request->AuthType = EEnhancedLoginAuthType::Developer;
+		Request->UserId = FString::Printf(TEXT("%s%d"), Bot.bHost ? TEXT("LoadTestHost") : TEXT("LoadTestBot"), Bot.Index);
+
+		const uint32 Serial = Bot.Serial;
+		Request->OnUserLoginCompleted.AddLambda([this, &Bot, Serial](int32 LocalUserIndex)
+		{
+			CompleteStep(Bot, Serial, true, FString());
+		});
+		Request->OnRequestFailedDelegate.AddLambda([this, &Bot, Serial](const FString& Reason)
+		{
+			CompleteStep(Bot, Serial, false, Reason);
+		});
+
+		Bot.Request.Reset(Request);
+		Subsystem->LoginOnlineUser(Request);
+		return true;
+	}
+
+	bool FLoadTest::IssueFind(FBot& Bot)
+	{
+		UEnhancedOnlineSessionsSubsystem* Subsystem = Bot.Subsystem.Get();
+		if (Subsystem == nullptr)
+		{
+			return false;
+		}
+
+		UEnhancedOnlineRequest_FindSessions* Request = NewObject<UEnhancedOnlineRequest_FindSessions>(Bot.PlayerController.Get());
+		Request->ConstructRequest();
+		Request->LocalUserIndex = 0;
+		Request->bInvalidateOnCompletion = true;
+		Request->OnlineMode = Options.bLAN ? EEnhancedSessionOnlineMode::LAN : EEnhancedSessionOnlineMode::Online;
+		Request->MaxSearchResults = Options.MaxSearchResults;
+		Request->SearchKeyword = Options.Keyword;
+
+		const uint32 Serial = Bot.Serial;
+		Request->OnFindOnlineSessionsCompleted.AddLambda([this, &Bot, Serial](const TArray<UEnhancedSessionSearchResult*>& SearchResults)
+		{
+			if (Serial == Bot.Serial)
+			{
+				Bot.SessionToJoin.Reset(SearchResults.Num() > 0 ? SearchResults[FMath::RandHelper(SearchResults.Num())] : nullptr);
+			}
+
+			CompleteStep(Bot, Serial, true, FString());
+		});
+		Request->OnRequestFailedDelegate.AddLambda([this, &Bot, Serial](const FString& Reason)
+		{
+			CompleteStep(Bot, Serial, false, Reason);
+		});
+
+		Bot.Request.Reset(Request);
+		Subsystem->FindOnlineSessions(Request);
+		return true;
+	}
+
+	bool FLoadTest::IssueJoin(FBot& Bot)
+	{
+		UEnhancedOnlineSessionsSubsystem* Subsystem = Bot.Subsystem.Get();
+		if (Subsystem == nullptr)
+		{
+			return false;
+		}
+
+		if (!Bot.SessionToJoin.IsValid())
+		{
+			CompleteStep(Bot, Bot.Serial, false, TEXT("The search found no session to join."));
+			return true;
+		}
+
+		UEnhancedOnlineRequest_JoinSession* Request = NewObject<UEnhancedOnlineRequest_JoinSession>(Bot.PlayerController.Get());
+		Request->ConstructRequest();
+		Request->LocalUserIndex = 0;
+		Request->bInvalidateOnCompletion = true;
+		Request->SessionToJoin = Bot.SessionToJoin.Get();
+		Request->bReserveSlot = Options.bReserveSlots;
+
+		const uint32 Serial = Bot.Serial;
+		Request->OnJoinSessionCompleted.AddLambda([this, &Bot, Serial](const FName SessionName)
+		{
+			if (Serial == Bot.Serial)
+			{
+				Bot.JoinedSessionName = SessionName;
+			}
+
+			CompleteStep(Bot, Serial, true, FString());
+		});
+		Request->OnRequestFailedDelegate.AddLambda([this, &Bot, Serial](const FString& Reason)
+		{
+			CompleteStep(Bot, Serial, false, Reason);
+		});
+
+		Bot.Request.Reset(Request);
+		Subsystem->JoinOnlineSession(Request);
+		return true;
+	}
+
+	bool FLoadTest::IssueLeave(FBot& Bot)
+	{
+		UEnhancedOnlineSessionsSubsystem* Subsystem = Bot.Subsystem.Get();
+		IOnlineSessionPtr Sessions = Subsystem ? Subsystem->GetOnlineInterfaces().Sessions : nullptr;
+		if (!Sessions.IsValid())
+		{
+			return false;
+		}
+
+		// Bots stay in their empty world, the travel the join started is dropped
+		if (FWorldContext* WorldContext = Bot.GameInstance->GetWorldContext())
+		{
+			WorldContext->TravelURL.Empty();
+		}
+
+		// The subsystem has no leave request, the game destroys the joined session itself before travelling back
+		const uint32 Serial = Bot.Serial;
+		const FName SessionName = Bot.JoinedSessionName.IsNone() ? FName(NAME_GameSession) : Bot.JoinedSessionName;
+
+		return Sessions->DestroySession(SessionName, FOnDestroySessionCompleteDelegate::CreateLambda([this, &Bot, Serial](FName, bool bWasSuccessful)
+		{
+			CompleteStep(Bot, Serial, bWasSuccessful, TEXT("The backend failed to destroy the joined session."));
+		}));
+	}
+
+	bool FLoadTest::IssueLogout(FBot& Bot)
+	{
+		UEnhancedOnlineSessionsSubsystem* Subsystem = Bot.Subsystem.Get();
+		if (Subsystem == nullptr)
+		{
+			return false;
+		}
+
+		UEnhancedOnlineRequest_LogoutUser* Request = NewObject<UEnhancedOnlineRequest_LogoutUser>(Bot.PlayerController.Get());
+		Request->ConstructRequest();
+		Request->LocalUserIndex = 0;
+		Request->bInvalidateOnCompletion = true;
+
+		const uint32 Serial = Bot.Serial;
+		Request->OnUserLogoutCompleted.AddLambda([this, &Bot, Serial](int32 LocalUserIndex)
+		{
+			CompleteStep(Bot, Serial, true, FString());
+		});
+		Request->OnRequestFailedDelegate.AddLambda([this, &Bot, Serial](const FString& Reason)
+		{
+			CompleteStep(Bot, Serial, false, Reason);
+		});
+
+		Bot.Request.Reset(Request);
+		Subsystem->LogoutOnlineUser(Request);
+		return true;
+	}
+
+	bool FLoadTest::IssueHost(FBot& Bot)
+	{
+		UEnhancedOnlineSessionsSubsystem* Subsystem = Bot.Subsystem.Get();
+		if (Subsystem == nullptr)
+		{
+			return false;
+		}
+
+		UEnhancedOnlineRequest_CreateSession* Request = NewObject<UEnhancedOnlineRequest_CreateSession>(Bot.PlayerController.Get());
+		Request->ConstructRequest();
+		Request->LocalUserIndex = 0;
+		Request->bInvalidateOnCompletion = true;
+		Request->OnlineMode = Options.bLAN ? EEnhancedSessionOnlineMode::LAN : EEnhancedSessionOnlineMode::Online;
+		Request->MaxPlayerCount = Options.HostSlots;
+		Request->SearchKeyword = Options.Keyword;
+		Request->FriendlyName = FString::Printf(TEXT("LoadTestHost%d"), Bot.Index);
+		Request->bAllowJoinInProgress = true;
+
+		const uint32 Serial = Bot.Serial;
+		Request->OnCreateSessionCompleted.AddLambda([this, &Bot, Serial](int32 LocalUserIndex, const FName SessionName)
+		{
+			CompleteStep(Bot, Serial, true, FString());
+		});
+		Request->OnRequestFailedDelegate.AddLambda([this, &Bot, Serial](const FString& Reason)
+		{
+			CompleteStep(Bot, Serial, false, Reason);
+		});
+
+		Bot.Request.Reset(Request);
+		Subsystem->HostOnlineSession(Request);
+		return true;
+	}
+
+	const FScenario& FLoadTest::PickScenario() const
+	{
+		float TotalWeight = 0.0f;
+		for (const FScenario& Scenario : Options.Scenarios)
+		{
+			TotalWeight += Scenario.Weight;
+		}
+
+		float Pick = FMath::FRand() * TotalWeight;
+		for (const FScenario& Scenario : Options.Scenarios)
+		{
+			Pick -= Scenario.Weight;
+			if (Pick <= 0.0f)
+			{
+				return Scenario;
+			}
+		}
+
+		return Options.Scenarios.Last();
+	}
+
+	void FLoadTest::LogProgress(double Now) const
+	{
+		int32 NumBusy = 0;
+		for (const TUniquePtr<FBot>& Bot : Bots)
+		{
+			NumBusy += Bot->IsIdle() ? 0 : 1;
+		}
+
+		int32 NumHosting = 0;
+		for (const TUniquePtr<FBot>& Host : Hosts)
+		{
+			NumHosting += Host->bHosting ? 1 : 0;
+		}
+
+		UE_LOG(LogEnhancedSubsystem, Display, TEXT("Load test at %.0fs: %d of %d bots busy, %d of %d hosts up, %d runs started, %d completed, %d arrivals dropped."),
+			Now - StartTime, NumBusy, Bots.Num(), NumHosting, Hosts.Num(), NumRunsStarted, NumRunsCompleted, NumArrivalsDropped);
+	}
+
+	bool FLoadTest::Report(double Now) const
+	{
+		const double ElapsedSeconds = FMath::Max(Now - StartTime, 0.001);
+		bool bWithinErrorRate = true;
+
+		FString Csv = TEXT("Step,Started,Succeeded,Failed,TimedOut,ErrorRatePercent,ThroughputPerSecond,P50Ms,P90Ms,P99Ms,MaxMs\n");
+
+		UE_LOG(LogEnhancedSubsystem, Display, TEXT("Load test finished after %.1fs: %d runs started, %d completed, %d arrivals dropped."),
+			ElapsedSeconds, NumRunsStarted, NumRunsCompleted, NumArrivalsDropped);
+		UE_LOG(LogEnhancedSubsystem, Display, TEXT("  %-8s %8s %8s %8s %8s %7s %9s %9s %9s %9s %9s"),
+			TEXT("Step"), TEXT("Started"), TEXT("Ok"), TEXT("Failed"), TEXT("TimedOut"), TEXT("Error%"), TEXT("Ops/s"), TEXT("P50ms"), TEXT("P90ms"), TEXT("P99ms"), TEXT("Maxms"));
+
+		for (int32 StepIndex = 0; StepIndex < static_cast<int32>(EStep::Num); ++StepIndex)
+		{
+			const FStepStats& StepStats = Stats[StepIndex];
+			if (StepStats.NumStarted == 0)
+			{
+				continue;
+			}
+
+			TArray<double> SortedLatencies = StepStats.LatenciesMs;
+			SortedLatencies.Sort();
+
+			const TCHAR* StepName = GetStepName(static_cast<EStep>(StepIndex));
+			const float ErrorRate = StepStats.GetErrorRate();
+			const double Throughput = StepStats.NumSucceeded / ElapsedSeconds;
+			const double P50 = GetPercentile(SortedLatencies, 0.50);
+			const double P90 = GetPercentile(SortedLatencies, 0.90);
+			const double P99 = GetPercentile(SortedLatencies, 0.99);
+			const double Max = SortedLatencies.Num() > 0 ? SortedLatencies.Last() : 0.0;
+
+			UE_LOG(LogEnhancedSubsystem, Display, TEXT("  %-8s %8d %8d %8d %8d %6.1f%% %9.2f %9.1f %9.1f %9.1f %9.1f"),
+				StepName, StepStats.NumStarted, StepStats.NumSucceeded, StepStats.NumFailed, StepStats.NumTimedOut, ErrorRate, Throughput, P50, P90, P99, Max);
+
+			for (const TPair<FString, int32>& Error : StepStats.Errors)
+			{
+				UE_LOG(LogEnhancedSubsystem, Display, TEXT("    %dx %s"), Error.Value, *Error.Key);
+			}
+
+			Csv += FString::Printf(TEXT("%s,%d,%d,%d,%d,%.2f,%.3f,%.1f,%.1f,%.1f,%.1f\n"),
+				StepName, StepStats.NumStarted, StepStats.NumSucceeded, StepStats.NumFailed, StepStats.NumTimedOut, ErrorRate, Throughput, P50, P90, P99, Max);
+
+			if (Options.MaxErrorRate >= 0.0f && ErrorRate > Options.MaxErrorRate)
+			{
+				UE_LOG(LogEnhancedSubsystem, Error, TEXT("Step %s failed %.1f%% of the time, more than the allowed %.1f%%."), StepName, ErrorRate, Options.MaxErrorRate);
+				bWithinErrorRate = false;
+			}
+		}
+
+		if (!Options.ReportFile.IsEmpty())
+		{
+			const FString ReportPath = FPaths::IsRelative(Options.ReportFile) ? FPaths::ProjectSavedDir() / TEXT("EnhancedOnline") / TEXT("LoadTests") / Options.ReportFile : Options.ReportFile;
+			if (FFileHelper::SaveStringToFile(Csv, *ReportPath))
+			{
+				UE_LOG(LogEnhancedSubsystem, Display, TEXT("Wrote the load test report to %s."), *ReportPath);
+			}
+			else
+			{
+				UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to write the load test report to %s."), *ReportPath);
+			}
+		}
+
+		return bWithinErrorRate;
+	}
+
+	static bool ParseOptions(const FString& Params, FOptions& OutOptions)
+	{
+		FParse::Value(*Params, TEXT("Backend="), OutOptions.Backend);
+		FParse::Value(*Params, TEXT("Bots="), OutOptions.NumBots);
+		FParse::Value(*Params, TEXT("Hosts="), OutOptions.NumHosts);
+		FParse::Value(*Params, TEXT("HostSlots="), OutOptions.HostSlots);
+		FParse::Value(*Params, TEXT("ArrivalRate="), OutOptions.ArrivalRate);
+		FParse::Value(*Params, TEXT("Duration="), OutOptions.DurationSeconds);
+		FParse::Value(*Params, TEXT("StepTimeout="), OutOptions.StepTimeoutSeconds);
+		FParse::Value(*Params, TEXT("TickInterval="), OutOptions.TickIntervalSeconds);
+		FParse::Value(*Params, TEXT("MaxErrorRate="), OutOptions.MaxErrorRate);
+		FParse::Value(*Params, TEXT("MaxSearchResults="), OutOptions.MaxSearchResults);
+		FParse::Value(*Params, TEXT("Keyword="), OutOptions.Keyword);
+		FParse::Value(*Params, TEXT("Report="), OutOptions.ReportFile);
+		OutOptions.bLAN = FParse::Param(*Params, TEXT("LAN"));
+		OutOptions.bReserveSlots = !FParse::Param(*Params, TEXT("NoReserve"));
+
+		FString Mix = TEXT("Join:1");
+		FParse::Value(*Params, TEXT("Mix="), Mix, false);
+
+		TArray<FString> Entries;
+		Mix.ParseIntoArray(Entries, TEXT(","));
+		for (const FString& Entry : Entries)
+		{
+			FString Name = Entry;
+			FString WeightString;
+			Entry.Split(TEXT(":"), &Name, &WeightString);
+
+			const float Weight = WeightString.IsEmpty() ? 1.0f : FCString::Atof(*WeightString);
+			FScenario Scenario;
+			if (!MakeScenario(Name.TrimStartAndEnd(), Weight, Scenario) || Weight <= 0.0f)
+			{
+				UE_LOG(LogEnhancedSubsystem, Error, TEXT("Invalid load test scenario %s, expected Login, Browse or Join with a positive weight."), *Entry);
+				return false;
+			}
+
+			OutOptions.Scenarios.Add(MoveTemp(Scenario));
+		}
+
+		if (OutOptions.Scenarios.Num() == 0 || OutOptions.NumBots <= 0 || OutOptions.ArrivalRate <= 0.0f)
+		{
+			UE_LOG(LogEnhancedSubsystem, Error, TEXT("The load test needs at least one scenario, one bot and a positive arrival rate."));
+			return false;
+		}
+
+		if (OutOptions.NumHosts > 0 && OutOptions.bReserveSlots)
+		{
+			UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Load test hosts run no reservation beacon, joins to them will fail without -NoReserve."));
+		}
+
+		return true;
+	}
+}
+#endif
+
+UEnhancedOnlineLoadTestCommandlet::UEnhancedOnlineLoadTestCommandlet()
+{
+	IsClient = true;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UEnhancedOnlineLoadTestCommandlet::Main(const FString& Params)
+{
+#if !WITH_EDITOR
+	UE_LOG(LogEnhancedSubsystem, Error, TEXT("The load test only runs in editor builds, use UnrealEditor-Cmd."));
+	return 1;
+#else
+	using namespace EnhancedOnlineLoadTest;
+
+	FOptions Options;
+	if (!ParseOptions(Params, Options))
+	{
+		return 1;
+	}
+
+	// Every bot is local user 0, they would share the cached auth token and overwrite each other's trace
+	if (IConsoleVariable* AutoLoginVariable = IConsoleManager::Get().FindConsoleVariable(TEXT("EnhancedOnline.Identity.AutoLogin")))
+	{
+		AutoLoginVariable->Set(false, ECVF_SetByCommandline);
+	}
+	if (IConsoleVariable* RecordFileVariable = IConsoleManager::Get().FindConsoleVariable(TEXT("EnhancedOnline.Trace.RecordFile")))
+	{
+		if (!RecordFileVariable->GetString().IsEmpty())
+		{
+			UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Backend traces can't be recorded by load test bots, EnhancedOnline.Trace.RecordFile is ignored."));
+			RecordFileVariable->Set(TEXT(""), ECVF_SetByCommandline);
+		}
+	}
+
+	FLoadTest LoadTest(Options);
+	if (!LoadTest.Start())
+	{
+		LoadTest.Stop();
+		return 1;
+	}
+
+	double LastTime = FPlatformTime::Seconds();
+	double Now = LastTime;
+	while (!IsEngineExitRequested())
+	{
+		Now = FPlatformTime::Seconds();
+		const float DeltaSeconds = static_cast<float>(Now - LastTime);
+		LastTime = Now;
+
+		FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+		FTSTicker::GetCoreTicker().Tick(DeltaSeconds);
+		LoadTest.Tick(Now, DeltaSeconds);
+		++GFrameCounter;
+
+		if (LoadTest.IsFinished(Now))
+		{
+			break;
+		}
+
+		FPlatformProcess::Sleep(Options.TickIntervalSeconds);
+	}
+
+	const bool bWithinErrorRate = LoadTest.Report(Now);
+	LoadTest.Stop();
+
+	return bWithinErrorRate ? 0 : 1;
+#endif
+}
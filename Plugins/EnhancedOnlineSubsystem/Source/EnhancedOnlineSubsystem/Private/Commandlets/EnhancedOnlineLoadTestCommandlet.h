@@ -0,0 +1,38 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "EnhancedOnlineLoadTestCommandlet.generated.h"
+
+/**
+ * Drives many simulated users through the subsystem to see how a backend holds up under load.
+ * Every bot is a game instance with its own instance of the backend, so hundreds of them fit into one process.
+ * Reports throughput, latency percentiles and error rates per step. Only runs in editor builds.
+ *
+ * The bots need sessions to find, either hosted by a server running against the same backend or by host bots in this process.
+ *
+ * UnrealEditor-Cmd <Project> -run=EnhancedOnlineLoadTest -Backend=NULL -Bots=200 -ArrivalRate=20 -Duration=120
+ *	-Mix=Join:70,Browse:20,Login:10		Weights of the scenarios run per arrival
+ *										Login: login, logout. Browse: login, find, logout. Join: login, find, join, leave, logout
+ *	-StepTimeout=30						Seconds a step may take, the bot is restarted after a timeout
+ *	-Keyword=<Keyword> -LAN -NoReserve	Search keyword, LAN searches and joins without a slot reservation
+ *	-Hosts=<Count>						Host bots that log in and host a session under the keyword before the arrivals start
+ *										They don't run a reservation beacon, so join them with -NoReserve. The NULL backend only finds them with -LAN
+ *	-HostSlots=64						Players a hosted session takes
+ *	-Report=<File>						Writes the summary as csv, relative names are placed in Saved/EnhancedOnline/LoadTests/
+ *	-MaxErrorRate=<Percent>				Fails the run if a step failed more often
+ */
+UCLASS()
+class UEnhancedOnlineLoadTestCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UEnhancedOnlineLoadTestCommandlet();
+
+	//~ Begin UCommandlet Interface
+	virtual int32 Main(const FString& Params) override;
+	//~ End UCommandlet Interface
+};
@@ -0,0 +1,272 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedCompactSessionSettings.h"
+
+#include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineSubsystem.h"
+#include "Algo/BinarySearch.h"
+#include "UObject/UObjectIterator.h"
+
+int32 FEnhancedSessionStringTable::Intern(const FString& Value)
+{
+	// Most strings repeat, so the shared lock is usually enough
+	{
+		FReadScopeLock ReadLock(Lock);
+		if (const int32* Index = Indices.Find(Value))
+		{
+			return *Index;
+		}
+	}
+
+	FWriteScopeLock WriteLock(Lock);
+	if (const int32* Index = Indices.Find(Value))
+	{
+		return *Index;
+	}
+
+	const int32 Index = Strings.Add(Value);
+	Indices.Add(Value, Index);
+	return Index;
+}
+
+SIZE_T FEnhancedSessionStringTable::GetAllocatedSize() const
+{
+	SIZE_T Size = Strings.GetAllocatedSize() + Indices.GetAllocatedSize();
+	for (const FString& String : Strings)
+	{
+		// Once for the array and once for the lookup key
+		Size += String.GetAllocatedSize() * 2;
+	}
+	return Size;
+}
+
+void FEnhancedCompactSessionSettings::Compact(const FSessionSettings& Settings, const TSharedRef<FEnhancedSessionStringTable>& InStringTable)
+{
+	StringTable = InStringTable;
+	Attributes.Reset(Settings.Num());
+	Blobs.Reset();
+
+	for (const TPair<FName, FOnlineSessionSetting>& Setting : Settings)
+	{
+		const FVariantData& Data = Setting.Value.Data;
+
+		FAttribute& Attribute = Attributes.AddDefaulted_GetRef();
+		Attribute.Key = Setting.Key;
+		Attribute.SettingId = Setting.Value.ID;
+		Attribute.Type = Data.GetType();
+		Attribute.AdvertisementType = Setting.Value.AdvertisementType;
+
+		switch (Attribute.Type)
+		{
+		case EOnlineKeyValuePairDataType::Int32:
+			{
+				int32 Value = 0;
+				Data.GetValue(Value);
+				Attribute.IntValue = Value;
+				break;
+			}
+		case EOnlineKeyValuePairDataType::UInt32:
+			{
+				uint32 Value = 0;
+				Data.GetValue(Value);
+				Attribute.IntValue = Value;
+				break;
+			}
+		case EOnlineKeyValuePairDataType::Int64:
+			Data.GetValue(Attribute.IntValue);
+			break;
+		case EOnlineKeyValuePairDataType::UInt64:
+			{
+				uint64 Value = 0;
+				Data.GetValue(Value);
+				Attribute.IntValue = static_cast<int64>(Value);
+				break;
+			}
+		case EOnlineKeyValuePairDataType::Bool:
+			{
+				bool bValue = false;
+				Data.GetValue(bValue);
+				Attribute.IntValue = bValue ? 1 : 0;
+				break;
+			}
+		case EOnlineKeyValuePairDataType::Float:
+			{
+				float Value = 0.0f;
+				Data.GetValue(Value);
+				Attribute.DoubleValue = Value;
+				break;
+			}
+		case EOnlineKeyValuePairDataType::Double:
+			Data.GetValue(Attribute.DoubleValue);
+			break;
+		case EOnlineKeyValuePairDataType::Blob:
+			Attribute.BlobIndex = Blobs.AddDefaulted();
+			Data.GetValue(Blobs[Attribute.BlobIndex]);
+			break;
+		case EOnlineKeyValuePairDataType::Empty:
+			break;
+		default:
+			// Strings and json are interned by their string representation
+			Attribute.Type = Attribute.Type == EOnlineKeyValuePairDataType::Json ? EOnlineKeyValuePairDataType::Json : EOnlineKeyValuePairDataType::String;
+			Attribute.StringIndex = StringTable->Intern(Data.ToString());
+			break;
+		}
+	}
+
+	Attributes.Sort([](const FAttribute& A, const FAttribute& B) { return A.Key.FastLess(B.Key); });
+	Attributes.Shrink();
+	Blobs.Shrink();
+}
+
+void FEnhancedCompactSessionSettings::Restore(FSessionSettings& OutSettings) const
+{
+	OutSettings.Reset();
+	OutSettings.Reserve(Attributes.Num());
+
+	for (const FAttribute& Attribute : Attributes)
+	{
+		FOnlineSessionSetting Setting;
+		Setting.ID = Attribute.SettingId;
+		Setting.AdvertisementType = Attribute.AdvertisementType;
+
+		switch (Attribute.Type)
+		{
+		case EOnlineKeyValuePairDataType::Int32:
+			Setting.Data.SetValue(static_cast<int32>(Attribute.IntValue));
+			break;
+		case EOnlineKeyValuePairDataType::UInt32:
+			Setting.Data.SetValue(static_cast<uint32>(Attribute.IntValue));
+			break;
+		case EOnlineKeyValuePairDataType::Int64:
+			Setting.Data.SetValue(Attribute.IntValue);
+			break;
+		case EOnlineKeyValuePairDataType::UInt64:
+			Setting.Data.SetValue(static_cast<uint64>(Attribute.IntValue));
+			break;
+		case EOnlineKeyValuePairDataType::Bool:
+			Setting.Data.SetValue(Attribute.IntValue != 0);
+			break;
+		case EOnlineKeyValuePairDataType::Float:
+			Setting.Data.SetValue(static_cast<float>(Attribute.DoubleValue));
+			break;
+		case EOnlineKeyValuePairDataType::Double:
+			Setting.Data.SetValue(Attribute.DoubleValue);
+			break;
+		case EOnlineKeyValuePairDataType::Json:
+			Setting.Data.SetJsonValueFromString(StringTable->Get(Attribute.StringIndex));
+			break;
+		case EOnlineKeyValuePairDataType::String:
+			Setting.Data.SetValue(StringTable->Get(Attribute.StringIndex));
+			break;
+		case EOnlineKeyValuePairDataType::Blob:
+			Setting.Data.SetValue(Blobs[Attribute.BlobIndex]);
+			break;
+		default:
+			break;
+		}
+
+		OutSettings.Add(Attribute.Key, MoveTemp(Setting));
+	}
+}
+
+const FEnhancedCompactSessionSettings::FAttribute* FEnhancedCompactSessionSettings::FindAttribute(FName Key) const
+{
+	const int32 Index = Algo::LowerBound(Attributes, Key, [](const FAttribute& Attribute, FName Value) { return Attribute.Key.FastLess(Value); });
+	return Attributes.IsValidIndex(Index) && Attributes[Index].Key == Key ? &Attributes[Index] : nullptr;
+}
+
+bool FEnhancedCompactSessionSettings::Get(FName Key, FString& OutValue) const
+{
+	const FAttribute* Attribute = FindAttribute(Key);
+	if (Attribute == nullptr || Attribute->Type != EOnlineKeyValuePairDataType::String)
+	{
+		return false;
+	}
+
+	OutValue = StringTable->Get(Attribute->StringIndex);
+	return true;
+}
+
+void FEnhancedCompactSessionSettings::Reset()
+{
+	Attributes.Empty();
+	Blobs.Empty();
+	StringTable.Reset();
+}
+
+SIZE_T FEnhancedCompactSessionSettings::GetAllocatedSize() const
+{
+	SIZE_T Size = Attributes.GetAllocatedSize() + Blobs.GetAllocatedSize();
+	for (const TArray<uint8>& Blob : Blobs)
+	{
+		Size += Blob.GetAllocatedSize();
+	}
+	return Size;
+}
+
+SIZE_T FEnhancedCompactSessionSettings::GetRawAllocatedSize(const FSessionSettings& Settings)
+{
+	SIZE_T Size = Settings.GetAllocatedSize();
+	for (const TPair<FName, FOnlineSessionSetting>& Setting : Settings)
+	{
+		const EOnlineKeyValuePairDataType::Type Type = Setting.Value.Data.GetType();
+		if (Type == EOnlineKeyValuePairDataType::String || Type == EOnlineKeyValuePairDataType::Json || Type == EOnlineKeyValuePairDataType::Blob)
+		{
+			Size += Setting.Value.Data.ToString().GetAllocatedSize();
+		}
+	}
+	return Size;
+}
+
+static FAutoConsoleCommand CmdEnhancedSessionsMemoryReport(
+	TEXT("EnhancedOnline.Sessions.MemoryReport"),
+	TEXT("Compares the memory used by the settings of all live search results in the raw and in the compact representation."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		int32 NumResults = 0;
+		int32 NumCompact = 0;
+		SIZE_T RawSize = 0;
+		SIZE_T CompactSize = 0;
+		TSet<const FEnhancedSessionStringTable*> StringTables;
+
+		for (TObjectIterator<UEnhancedSessionSearchResult> It; It; ++It)
+		{
+			const UEnhancedSessionSearchResult* Result = *It;
+			const FSessionSettings& RawSettings = Result->StoredSearchResult.Session.SessionSettings.Settings;
+			++NumResults;
+
+			if (Result->IsCompact())
+			{
+				++NumCompact;
+
+				FSessionSettings RestoredSettings;
+				Result->CompactSettings.Restore(RestoredSettings);
+				RawSize += FEnhancedCompactSessionSettings::GetRawAllocatedSize(RestoredSettings);
+				CompactSize += Result->CompactSettings.GetAllocatedSize();
+				StringTables.Add(Result->CompactSettings.GetStringTable().Get());
+			}
+			else
+			{
+				RawSize += FEnhancedCompactSessionSettings::GetRawAllocatedSize(RawSettings);
+
+				// Every raw result would get its own table, which is the worst case
+				TSharedRef<FEnhancedSessionStringTable> StringTable = MakeShared<FEnhancedSessionStringTable>();
+				FEnhancedCompactSessionSettings CompactSettings;
+				CompactSettings.Compact(RawSettings, StringTable);
+				CompactSize += CompactSettings.GetAllocatedSize() + StringTable->GetAllocatedSize();
+			}
+		}
+
+		for (const FEnhancedSessionStringTable* StringTable : StringTables)
+		{
+			CompactSize += StringTable ? StringTable->GetAllocatedSize() : 0;
+		}
+
+		UE_LOG(LogEnhancedSubsystem, Display, TEXT("Session settings of %d search results (%d compact):"), NumResults, NumCompact);
+		UE_LOG(LogEnhancedSubsystem, Display, TEXT("\tRaw:     %8.1f KiB"), RawSize / 1024.0);
+		UE_LOG(LogEnhancedSubsystem, Display, TEXT("\tCompact: %8.1f KiB (%d shared string tables)"), CompactSize / 1024.0, StringTables.Num());
+		if (RawSize > 0)
+		{
+			UE_LOG(LogEnhancedSubsystem, Display, TEXT("\tSaved:   %8.1f%%"), 100.0 * (1.0 - static_cast<double>(CompactSize) / RawSize));
+		}
+	}));
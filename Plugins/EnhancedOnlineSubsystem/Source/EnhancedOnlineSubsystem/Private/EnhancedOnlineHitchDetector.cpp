@@ -0,0 +1,179 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineHitchDetector.h"
+
+#include "EnhancedOnlineSubsystem.h"
+#include "Algo/Sort.h"
+
+static TAutoConsoleVariable<float> CVarEnhancedHitchThresholdMs(
+	TEXT("EnhancedOnline.Hitch.ThresholdMs"),
+	1.0f,
+	TEXT("Online callbacks that take longer than this many milliseconds on the game thread are recorded as hitches. 0 disables recording."));
+
+static TAutoConsoleVariable<bool> CVarEnhancedHitchLog(
+	TEXT("EnhancedOnline.Hitch.Log"),
+	true,
+	TEXT("Whether a warning is logged for every recorded hitch."));
+
+namespace EnhancedOnlineHitchDetector
+{
+	struct FHitch
+	{
+		const TCHAR* CallbackName = nullptr;
+		FString RequestType;
+		FString Listener;
+		int32 ResultCount = INDEX_NONE;
+		double DurationMs = 0.0;
+		FDateTime Time;
+	};
+
+	/** Number of hitches kept, older ones are overwritten */
+	static constexpr int32 MaxHitches = 256;
+
+	/** Rolling history of recorded hitches, only touched on the game thread */
+	static TArray<FHitch> Hitches;
+	static int32 NextHitchIndex = 0;
+
+	/** Innermost scope that is currently open, only touched on the game thread */
+	static FEnhancedOnlineHitchScope* CurrentScope = nullptr;
+
+	static void Record(FHitch&& Hitch)
+	{
+		if (CVarEnhancedHitchLog.GetValueOnGameThread())
+		{
+			UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Hitch in %s: %.2f ms (Request: %s, Results: %d, Listener: %s)"),
+				Hitch.CallbackName, Hitch.DurationMs, *Hitch.RequestType, Hitch.ResultCount, *Hitch.Listener);
+		}
+
+		if (Hitches.Num() < MaxHitches)
+		{
+			Hitches.Add(MoveTemp(Hitch));
+		}
+		else
+		{
+			Hitches[NextHitchIndex] = MoveTemp(Hitch);
+		}
+		NextHitchIndex = (NextHitchIndex + 1) % MaxHitches;
+	}
+}
+
+FEnhancedOnlineHitchScope::FEnhancedOnlineHitchScope(const TCHAR* InCallbackName, const UObject* InRequest)
+	: CallbackName(InCallbackName)
+	, Parent(EnhancedOnlineHitchDetector::CurrentScope)
+	, StartCycles(FPlatformTime::Cycles64())
+{
+	EnhancedOnlineHitchDetector::CurrentScope = this;
+	SetRequest(InRequest);
+}
+
+FEnhancedOnlineHitchScope::~FEnhancedOnlineHitchScope()
+{
+	const uint64 TotalCycles = FPlatformTime::Cycles64() - StartCycles;
+
+	// The parent only counts the time it spent outside of this scope
+	EnhancedOnlineHitchDetector::CurrentScope = Parent;
+	if (Parent)
+	{
+		Parent->ChildCycles += TotalCycles;
+	}
+
+	const double DurationMs = FPlatformTime::ToMilliseconds64(TotalCycles - FMath::Min(ChildCycles, TotalCycles));
+	const float ThresholdMs = CVarEnhancedHitchThresholdMs.GetValueOnGameThread();
+	if (ThresholdMs <= 0.0f || DurationMs < ThresholdMs)
+	{
+		return;
+	}
+
+	EnhancedOnlineHitchDetector::FHitch Hitch;
+	Hitch.CallbackName = CallbackName;
+	Hitch.RequestType = RequestClass ? RequestClass->GetName() : TEXT("None");
+	Hitch.ResultCount = ResultCount;
+	Hitch.DurationMs = DurationMs;
+	Hitch.Time = FDateTime::Now();
+
+	if (const UObject* Listener = ListenerObject.Get())
+	{
+		Hitch.Listener = FString::Printf(TEXT("%s::%s"), *Listener->GetName(), *ListenerFunction.ToString());
+	}
+	else
+	{
+		Hitch.Listener = TEXT("None");
+	}
+
+	EnhancedOnlineHitchDetector::Record(MoveTemp(Hitch));
+}
+
+void FEnhancedOnlineHitchScope::SetRequest(const UObject* InRequest)
+{
+	RequestClass = InRequest ? InRequest->GetClass() : nullptr;
+}
+
+void FEnhancedOnlineHitchScope::SetListener(const FScriptDelegate& Delegate)
+{
+	ListenerObject = Delegate.GetUObject();
+	ListenerFunction = Delegate.GetFunctionName();
+}
+
+static FAutoConsoleCommand CmdEnhancedHitchReport(
+	TEXT("EnhancedOnline.Hitch.Report"),
+	TEXT("Lists the slowest recent online callbacks. Usage: EnhancedOnline.Hitch.Report [Count], defaults to 10."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		using namespace EnhancedOnlineHitchDetector;
+
+		const int32 Count = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 10;
+
+		if (Hitches.Num() == 0)
+		{
+			UE_LOG(LogEnhancedSubsystem, Display, TEXT("No online callback hitches recorded."));
+			return;
+		}
+
+		struct FCallbackStats
+		{
+			int32 Num = 0;
+			double TotalMs = 0.0;
+			double WorstMs = 0.0;
+		};
+
+		TMap<FString, FCallbackStats> StatsByCallback;
+		for (const FHitch& Hitch : Hitches)
+		{
+			FCallbackStats& Stats = StatsByCallback.FindOrAdd(Hitch.CallbackName);
+			++Stats.Num;
+			Stats.TotalMs += Hitch.DurationMs;
+			Stats.WorstMs = FMath::Max(Stats.WorstMs, Hitch.DurationMs);
+		}
+		StatsByCallback.ValueSort([](const FCallbackStats& A, const FCallbackStats& B) { return A.WorstMs > B.WorstMs; });
+
+		UE_LOG(LogEnhancedSubsystem, Display, TEXT("%d online callback hitches recorded, by callback:"), Hitches.Num());
+		for (const TPair<FString, FCallbackStats>& Pair : StatsByCallback)
+		{
+			UE_LOG(LogEnhancedSubsystem, Display, TEXT("\t%-48s %4d hitches, worst %8.2f ms, average %8.2f ms"),
+				*Pair.Key, Pair.Value.Num, Pair.Value.WorstMs, Pair.Value.TotalMs / Pair.Value.Num);
+		}
+
+		TArray<const FHitch*> WorstHitches;
+		for (const FHitch& Hitch : Hitches)
+		{
+			WorstHitches.Add(&Hitch);
+		}
+		Algo::Sort(WorstHitches, [](const FHitch* A, const FHitch* B) { return A->DurationMs > B->DurationMs; });
+
+		UE_LOG(LogEnhancedSubsystem, Display, TEXT("Worst %d:"), FMath::Min(Count, WorstHitches.Num()));
+		for (int32 Index = 0; Index < Count && Index < WorstHitches.Num(); ++Index)
+		{
+			const FHitch& Hitch = *WorstHitches[Index];
+			UE_LOG(LogEnhancedSubsystem, Display, TEXT("\t%8.2f ms %s (Request: %s, Results: %d, Listener: %s) at %s"),
+				Hitch.DurationMs, Hitch.CallbackName, *Hitch.RequestType, Hitch.ResultCount, *Hitch.Listener, *Hitch.Time.ToString());
+		}
+	}));
+
+static FAutoConsoleCommand CmdEnhancedHitchReset(
+	TEXT("EnhancedOnline.Hitch.Reset"),
+	TEXT("Clears the recorded online callback hitches."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		EnhancedOnlineHitchDetector::Hitches.Reset();
+		EnhancedOnlineHitchDetector::NextHitchIndex = 0;
+	}));
@@ -0,0 +1,43 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Times an online callback on the game thread and records it if it takes longer than EnhancedOnline.Hitch.ThresholdMs.
+ * The worst recent offenders are listed by EnhancedOnline.Hitch.Report.
+ * Scopes may nest, the time spent in an inner scope is only counted for the inner one.
+ */
+class FEnhancedOnlineHitchScope
+{
+public:
+	/**
+	 * @param InCallbackName	Name of the callback, must outlive the scope
+	 * @param InRequest			The request the callback belongs to, if any
+	 */
+	FEnhancedOnlineHitchScope(const TCHAR* InCallbackName, const UObject* InRequest = nullptr);
+	~FEnhancedOnlineHitchScope();
+
+	void SetRequest(const UObject* InRequest);
+	void SetResultCount(int32 InResultCount) { ResultCount = InResultCount; }
+
+	/** Remembers the Blueprint function bound to the delegate that is about to be executed */
+	void SetListener(const FScriptDelegate& Delegate);
+
+private:
+	const TCHAR* CallbackName;
+	const UClass* RequestClass = nullptr;
+	int32 ResultCount = INDEX_NONE;
+
+	TWeakObjectPtr<UObject> ListenerObject;
+	FName ListenerFunction;
+
+	/** The scope this one is nested in, null for the outermost one */
+	FEnhancedOnlineHitchScope* Parent;
+
+	/** Cycles spent in the scopes nested in this one */
+	uint64 ChildCycles = 0;
+
+	uint64 StartCycles;
+};
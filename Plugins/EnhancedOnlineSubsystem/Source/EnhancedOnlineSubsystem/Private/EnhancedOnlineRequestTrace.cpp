@@ -0,0 +1,186 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineRequestTrace.h"
+
+#if ENHANCEDONLINE_TRACE_ENABLED
+#include "EnhancedOnlineRequests.h"
+#include "OnlineSessionSettings.h"
+#include "ProfilingDebugging/MiscTrace.h"
+
+UE_TRACE_CHANNEL_DEFINE(EnhancedOnlineChannel)
+
+UE_TRACE_EVENT_BEGIN(EnhancedOnline, RequestBegin)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, RequestId)
+	UE_TRACE_EVENT_FIELD(int32, LocalUserIndex)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, Type)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(EnhancedOnline, RequestDispatch)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, RequestId)
+	UE_TRACE_EVENT_FIELD(uint32, PayloadSize)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, Call)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(EnhancedOnline, RequestCallback)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, RequestId)
+	UE_TRACE_EVENT_FIELD(uint32, PayloadSize)
+	UE_TRACE_EVENT_FIELD(bool, bWasSuccessful)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, Call)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(EnhancedOnline, RequestEnd)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, RequestId)
+	UE_TRACE_EVENT_FIELD(bool, bWasSuccessful)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, Reason)
+UE_TRACE_EVENT_END()
+
+namespace EnhancedOnlineRequestTrace
+{
+	/** Only touched on the game thread, 0 is left for requests that aren't traced */
+	static uint32 NextRequestId = 1;
+
+	static FString GetRequestType(const UEnhancedOnlineRequestBase* Request)
+	{
+		FString Type = Request->GetClass()->GetName();
+		Type.RemoveFromStart(TEXT("EnhancedOnlineRequest_"));
+		return Type;
+	}
+
+	/** Unique per request, so overlapping requests of the same type get regions of their own */
+	static FString GetRegionName(const UEnhancedOnlineRequestBase* Request, uint32 RequestId)
+	{
+		return FString::Printf(TEXT("EnhancedOnline %s #%u (User %d)"), *GetRequestType(Request), RequestId, Request->LocalUserIndex);
+	}
+
+	/** Strings and blobs would have to be copied to be measured, they count as a typical size instead */
+	static constexpr uint32 EstimatedDynamicSize = 16;
+
+	static uint32 GetSettingSize(FName Key, const FVariantData& Data)
+	{
+		uint32 ValueSize = 0;
+		switch (Data.GetType())
+		{
+		case EOnlineKeyValuePairDataType::Bool: ValueSize = 1; break;
+		case EOnlineKeyValuePairDataType::Int32:
+		case EOnlineKeyValuePairDataType::UInt32:
+		case EOnlineKeyValuePairDataType::Float: ValueSize = 4; break;
+		case EOnlineKeyValuePairDataType::Int64:
+		case EOnlineKeyValuePairDataType::UInt64:
+		case EOnlineKeyValuePairDataType::Double: ValueSize = 8; break;
+		case EOnlineKeyValuePairDataType::String:
+		case EOnlineKeyValuePairDataType::Blob:
+		case EOnlineKeyValuePairDataType::Json: ValueSize = EstimatedDynamicSize; break;
+		default: break;
+		}
+
+		return Key.GetStringLength() + ValueSize;
+	}
+}
+
+void FEnhancedOnlineRequestTrace::OutputBegin(UEnhancedOnlineRequestBase* Request)
+{
+	if (Request == nullptr || Request->TraceRequestId != 0)
+	{
+		return;
+	}
+
+	using namespace EnhancedOnlineRequestTrace;
+
+	Request->TraceRequestId = NextRequestId++;
+	if (NextRequestId == 0)
+	{
+		NextRequestId = 1;
+	}
+
+	const FString Type = GetRequestType(Request);
+	UE_TRACE_LOG(EnhancedOnline, RequestBegin, EnhancedOnlineChannel)
+		<< RequestBegin.Cycle(FPlatformTime::Cycles64())
+		<< RequestBegin.RequestId(Request->TraceRequestId)
+		<< RequestBegin.LocalUserIndex(Request->LocalUserIndex)
+		<< RequestBegin.Type(*Type, Type.Len());
+
+	TRACE_BEGIN_REGION(*GetRegionName(Request, Request->TraceRequestId));
+}
+
+void FEnhancedOnlineRequestTrace::OutputDispatch(const UEnhancedOnlineRequestBase* Request, const TCHAR* Call, uint32 PayloadSize)
+{
+	if (Request == nullptr || Request->TraceRequestId == 0)
+	{
+		return;
+	}
+
+	UE_TRACE_LOG(EnhancedOnline, RequestDispatch, EnhancedOnlineChannel)
+		<< RequestDispatch.Cycle(FPlatformTime::Cycles64())
+		<< RequestDispatch.RequestId(Request->TraceRequestId)
+		<< RequestDispatch.PayloadSize(PayloadSize)
+		<< RequestDispatch.Call(Call);
+}
+
+void FEnhancedOnlineRequestTrace::OutputCallback(const UEnhancedOnlineRequestBase* Request, const TCHAR* Call, bool bWasSuccessful, uint32 PayloadSize)
+{
+	if (Request == nullptr || Request->TraceRequestId == 0)
+	{
+		return;
+	}
+
+	UE_TRACE_LOG(EnhancedOnline, RequestCallback, EnhancedOnlineChannel)
+		<< RequestCallback.Cycle(FPlatformTime::Cycles64())
+		<< RequestCallback.RequestId(Request->TraceRequestId)
+		<< RequestCallback.PayloadSize(PayloadSize)
+		<< RequestCallback.bWasSuccessful(bWasSuccessful)
+		<< RequestCallback.Call(Call);
+}
+
+void FEnhancedOnlineRequestTrace::OutputEnd(UEnhancedOnlineRequestBase* Request, bool bWasSuccessful, const TCHAR* Reason)
+{
+	if (Request == nullptr || Request->TraceRequestId == 0)
+	{
+		return;
+	}
+
+	const uint32 RequestId = Request->TraceRequestId;
+	Request->TraceRequestId = 0;
+
+	UE_TRACE_LOG(EnhancedOnline, RequestEnd, EnhancedOnlineChannel)
+		<< RequestEnd.Cycle(FPlatformTime::Cycles64())
+		<< RequestEnd.RequestId(RequestId)
+		<< RequestEnd.bWasSuccessful(bWasSuccessful)
+		<< RequestEnd.Reason(Reason);
+
+	TRACE_END_REGION(*EnhancedOnlineRequestTrace::GetRegionName(Request, RequestId));
+}
+
+uint32 FEnhancedOnlineRequestTrace::GetPayloadSize(const FOnlineSessionSettings& SessionSettings)
+{
+	uint32 PayloadSize = 0;
+	for (const TPair<FName, FOnlineSessionSetting>& Setting : SessionSettings.Settings)
+	{
+		PayloadSize += EnhancedOnlineRequestTrace::GetSettingSize(Setting.Key, Setting.Value.Data);
+	}
+	return PayloadSize;
+}
+
+uint32 FEnhancedOnlineRequestTrace::GetPayloadSize(const FOnlineSearchSettings& QuerySettings)
+{
+	uint32 PayloadSize = 0;
+	for (const TPair<FName, FOnlineSessionSearchParam>& Param : QuerySettings.SearchParams)
+	{
+		PayloadSize += EnhancedOnlineRequestTrace::GetSettingSize(Param.Key, Param.Value.Data);
+	}
+	return PayloadSize;
+}
+
+uint32 FEnhancedOnlineRequestTrace::GetPayloadSize(const TArray<FOnlineSessionSearchResult>& SearchResults)
+{
+	uint32 PayloadSize = 0;
+	for (const FOnlineSessionSearchResult& SearchResult : SearchResults)
+	{
+		PayloadSize += GetPayloadSize(SearchResult.Session.SessionSettings);
+	}
+	return PayloadSize;
+}
+#endif
@@ -0,0 +1,86 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineReservationBeacon.h"
+
+#include "EnhancedOnlineSessionsSubsystem.h"
+#include "EnhancedOnlineSubsystem.h"
+
+bool AEnhancedOnlineReservationBeaconClient::RequestReservation(const FString& ConnectString, const FUniqueNetIdRepl& InPlayerId)
+{
+	PlayerId = InPlayerId;
+	bResponded = false;
+	RoundTripMs = 0.0f;
+
+	FURL URL(nullptr, *ConnectString, TRAVEL_Absolute);
+	return URL.Valid && InitClient(URL);
+}
+
+void AEnhancedOnlineReservationBeaconClient::OnConnected()
+{
+	Super::OnConnected();
+
+	UE_LOG(LogEnhancedSubsystem, Verbose, TEXT("Connected to the reservation beacon, asking for a slot for %s."), *PlayerId.ToString());
+	RequestSentTime = FPlatformTime::Seconds();
+	ServerRequestReservation(PlayerId);
+}
+
+void AEnhancedOnlineReservationBeaconClient::OnFailure()
+{
+	if (!bResponded)
+	{
+		bResponded = true;
+		OnReservationResponse.ExecuteIfBound(EEnhancedSlotReservationResult::HostUnreachable, FString(), TEXT("Could not reach the host to reserve a slot."));
+	}
+
+	Super::OnFailure();
+}
+
+void AEnhancedOnlineReservationBeaconClient::ServerRequestReservation_Implementation(const FUniqueNetIdRepl& RequestingPlayerId)
+{
+	FString Token;
+	FString Error;
+	bool bGranted = false;
+
+	if (AEnhancedOnlineReservationBeaconHostObject* HostObject = Cast<AEnhancedOnlineReservationBeaconHostObject>(GetBeaconOwner()))
+	{
+		bGranted = HostObject->ReserveSlot(RequestingPlayerId, Token, Error);
+	}
+	else
+	{
+		Error = TEXT("The host does not take reservations.");
+	}
+
+	ClientReservationResponse(bGranted, Token, Error);
+}
+
+void AEnhancedOnlineReservationBeaconClient::ClientReservationResponse_Implementation(bool bGranted, const FString& Token, const FString& Error)
+{
+	if (bResponded)
+	{
+		return;
+	}
+
+	bResponded = true;
+	RoundTripMs = (FPlatformTime::Seconds() - RequestSentTime) * 1000.0;
+	OnReservationResponse.ExecuteIfBound(bGranted ? EEnhancedSlotReservationResult::Granted : EEnhancedSlotReservationResult::Refused, Token, Error);
+}
+
+AEnhancedOnlineReservationBeaconHostObject::AEnhancedOnlineReservationBeaconHostObject()
+{
+	ClientBeaconActorClass = AEnhancedOnlineReservationBeaconClient::StaticClass();
+	BeaconTypeName = ClientBeaconActorClass->GetName();
+
+	PrimaryActorTick.bCanEverTick = false;
+}
+
+bool AEnhancedOnlineReservationBeaconHostObject::ReserveSlot(const FUniqueNetIdRepl& PlayerId, FString& OutToken, FString& OutError)
+{
+	UEnhancedOnlineSessionsSubsystem* Subsystem = UEnhancedOnlineSessionsSubsystem::Get(this);
+	if (Subsystem == nullptr)
+	{
+		OutError = TEXT("The host does not take reservations.");
+		return false;
+	}
+
+	return Subsystem->ReserveSessionSlot(PlayerId, OutToken, OutError);
+}
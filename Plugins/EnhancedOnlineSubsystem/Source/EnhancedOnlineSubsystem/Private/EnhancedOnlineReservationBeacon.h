@@ -0,0 +1,91 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OnlineBeaconClient.h"
+#include "OnlineBeaconHostObject.h"
+#include "GameFramework/OnlineReplStructs.h"
+#include "EnhancedOnlineReservationBeacon.generated.h"
+
+/**
+ * How the host answered a slot reservation request
+ */
+enum class EEnhancedSlotReservationResult : uint8
+{
+	Granted,
+	Refused,
+	HostUnreachable,
+};
+
+/**
+ * Delegate for when the host answered a slot reservation request
+ * @param Result	Whether a slot was reserved
+ * @param Token		The token to travel with, empty unless a slot was reserved
+ * @param Error		Why no slot was reserved
+ */
+DECLARE_DELEGATE_ThreeParams(FOnEnhancedSlotReservationResponse, EEnhancedSlotReservationResult /* Result */, const FString& /* Token */, const FString& /* Error */);
+
+/**
+ * Short lived beacon connection a client opens to ask the host for a slot before it joins the session
+ */
+UCLASS(Transient, NotPlaceable)
+class AEnhancedOnlineReservationBeaconClient : public AOnlineBeaconClient
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Connects to the reservation beacon of the host and asks for a slot.
+	 * @param ConnectString		The address of the host beacon
+	 * @param InPlayerId		The player the slot is for
+	 * @return Whether the connection could be started, the answer arrives through OnReservationResponse
+	 */
+	bool RequestReservation(const FString& ConnectString, const FUniqueNetIdRepl& InPlayerId);
+
+	/** Called once with the answer of the host, or with HostUnreachable if the connection failed before that */
+	FOnEnhancedSlotReservationResponse OnReservationResponse;
+
+	/** Milliseconds between asking for a slot and the answer, 0 until the host answered */
+	float GetRoundTripMs() const { return RoundTripMs; }
+
+	//~ Begin AOnlineBeaconClient Interface
+	virtual void OnConnected() override;
+	virtual void OnFailure() override;
+	//~ End AOnlineBeaconClient Interface
+
+protected:
+	UFUNCTION(Server, Reliable)
+	void ServerRequestReservation(const FUniqueNetIdRepl& RequestingPlayerId);
+
+	UFUNCTION(Client, Reliable)
+	void ClientReservationResponse(bool bGranted, const FString& Token, const FString& Error);
+
+private:
+	/** The player the slot is requested for */
+	FUniqueNetIdRepl PlayerId;
+
+	/** Whether OnReservationResponse was already called */
+	bool bResponded = false;
+
+	/** Platform time the reservation was asked for */
+	double RequestSentTime = 0.0;
+
+	/** Round trip of the reservation request, a ping sample of the host */
+	float RoundTripMs = 0.0f;
+};
+
+/**
+ * Host side of the reservation beacon, hands out slot tokens of the sessions subsystem
+ */
+UCLASS(Transient, NotPlaceable)
+class AEnhancedOnlineReservationBeaconHostObject : public AOnlineBeaconHostObject
+{
+	GENERATED_BODY()
+
+public:
+	AEnhancedOnlineReservationBeaconHostObject();
+
+	/** Reserves a slot of the hosted session, returns false with the reason if the session can't take the player */
+	bool ReserveSlot(const FUniqueNetIdRepl& PlayerId, FString& OutToken, FString& OutError);
+};
@@ -0,0 +1,274 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineSearchDecoding.h"
+
+#include "EnhancedOnlineSubsystem.h"
+#include "EnhancedOnlineTypes.h"
+#include "OnlineSessionSettings.h"
+#include "Algo/StableSort.h"
+#include "Async/ParallelFor.h"
+#include "Online/OnlineSessionNames.h"
+
+namespace EnhancedOnlineSearchDecoding
+{
+	void DecodeSearchResults(const TArray<FOnlineSessionSearchResult>& SearchResults, const FEnhancedSearchDecodeOptions& Options, TArray<FEnhancedDecodedSearchResult>& OutDecoded)
+	{
+		OutDecoded.Reset();
+		OutDecoded.SetNum(SearchResults.Num());
+
+		// Every result writes its own slot, so the order doesn't depend on scheduling
+		ParallelFor(TEXT("EnhancedOnline.DecodeSearchResults"), SearchResults.Num(), 64, [&SearchResults, &Options, &OutDecoded](int32 Index)
+		{
+			const FOnlineSessionSearchResult& SearchResult = SearchResults[Index];
+			FEnhancedDecodedSearchResult& Decoded = OutDecoded[Index];
+
+			if (Options.Filter && !Options.Filter(SearchResult))
+			{
+				return;
+			}
+
+			Decoded.SourceIndex = Index;
+			Decoded.Score = Options.Scorer ? Options.Scorer(SearchResult) : 0.0f;
+
+			if (Options.bFilterAndScoreOnly)
+			{
+				return;
+			}
+
+			Decoded.OwningUserId = SearchResult.Session.OwningUserId.IsValid() ? SearchResult.Session.OwningUserId->ToString() : TEXT("Unknown");
+
+			if (Options.StringTable.IsValid())
+			{
+				Decoded.CompactSettings.Compact(SearchResult.Session.SessionSettings.Settings, Options.StringTable.ToSharedRef());
+			}
+		}, Options.bParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+
+		OutDecoded.RemoveAll([](const FEnhancedDecodedSearchResult& Decoded) { return Decoded.SourceIndex == INDEX_NONE; });
+
+		if (Options.Scorer)
+		{
+			Algo::StableSortBy(OutDecoded, &FEnhancedDecodedSearchResult::Score, TGreater<float>());
+		}
+	}
+
+	void ReorderSearchResults(TArray<FOnlineSessionSearchResult>& SearchResults, const TArray<FEnhancedDecodedSearchResult>& Decoded)
+	{
+		TArray<FOnlineSessionSearchResult> Reordered;
+		Reordered.Reserve(Decoded.Num());
+		for (const FEnhancedDecodedSearchResult& Result : Decoded)
+		{
+			Reordered.Add(MoveTemp(SearchResults[Result.SourceIndex]));
+		}
+		SearchResults = MoveTemp(Reordered);
+	}
+
+	void MergeByPing(TArray<TArray<FOnlineSessionSearchResult>>& Shards, int32 MaxResults, TArray<FOnlineSessionSearchResult>& OutMerged)
+	{
+		struct FCursor
+		{
+			int32 Shard;
+			int32 Index;
+			int32 PingInMs;
+		};
+
+		const auto NearestFirst = [](const FCursor& A, const FCursor& B)
+		{
+			return A.PingInMs != B.PingInMs ? A.PingInMs < B.PingInMs : A.Shard < B.Shard;
+		};
+
+		// One cursor per shard, the heap top is always the nearest result not merged yet
+		TArray<FCursor> Heap;
+		Heap.Reserve(Shards.Num());
+
+		int32 NumResults = 0;
+		for (int32 ShardIndex = 0; ShardIndex < Shards.Num(); ++ShardIndex)
+		{
+			NumResults += Shards[ShardIndex].Num();
+			if (Shards[ShardIndex].Num() > 0)
+			{
+				Heap.HeapPush(FCursor{ ShardIndex, 0, Shards[ShardIndex][0].PingInMs }, NearestFirst);
+			}
+		}
+
+		const int32 Limit = MaxResults > 0 ? FMath::Min(MaxResults, NumResults) : NumResults;
+		OutMerged.Reset(Limit);
+
+		TSet<FString> MergedSessionIds;
+		MergedSessionIds.Reserve(Limit);
+
+		while (Heap.Num() > 0 && OutMerged.Num() < Limit)
+		{
+			FCursor Cursor;
+			Heap.HeapPop(Cursor, NearestFirst);
+
+			TArray<FOnlineSessionSearchResult>& Shard = Shards[Cursor.Shard];
+			FOnlineSessionSearchResult& SearchResult = Shard[Cursor.Index];
+
+			bool bAlreadyMerged = false;
+			if (SearchResult.IsValid())
+			{
+				MergedSessionIds.Add(SearchResult.GetSessionIdStr(), &bAlreadyMerged);
+			}
+
+			if (!bAlreadyMerged)
+			{
+				OutMerged.Add(MoveTemp(SearchResult));
+			}
+
+			if (++Cursor.Index < Shard.Num())
+			{
+				Cursor.PingInMs = Shard[Cursor.Index].PingInMs;
+				Heap.HeapPush(Cursor, NearestFirst);
+			}
+		}
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+namespace EnhancedOnlineSearchDecoding
+{
+	void MakeBenchmarkSearchResults(int32 NumResults, TArray<FOnlineSessionSearchResult>& OutSearchResults)
+	{
+		static const TCHAR* GameModes[] = { TEXT("Deathmatch"), TEXT("TeamDeathmatch"), TEXT("CaptureTheFlag"), TEXT("Elimination") };
+		static const TCHAR* MapNames[] = { TEXT("Arena"), TEXT("Canyon"), TEXT("Docks"), TEXT("Factory"), TEXT("Harbor"), TEXT("Ruins"), TEXT("Station"), TEXT("Tower") };
+
+		FRandomStream Random(NumResults);
+
+		OutSearchResults.SetNum(NumResults);
+		for (int32 Index = 0; Index < NumResults; ++Index)
+		{
+			FOnlineSessionSearchResult& SearchResult = OutSearchResults[Index];
+			FOnlineSessionSettings& Settings = SearchResult.Session.SessionSettings;
+
+			SearchResult.PingInMs = Random.RandRange(10, 400);
+			SearchResult.Session.OwningUserName = FString::Printf(TEXT("Host%d"), Index);
+			Settings.NumPublicConnections = 16;
+			SearchResult.Session.NumOpenPublicConnections = Random.RandRange(0, 16);
+
+			Settings.Set(SETTING_GAMEMODE, FString(GameModes[Random.RandHelper(UE_ARRAY_COUNT(GameModes))]), EOnlineDataAdvertisementType::ViaOnlineService);
+			Settings.Set(SETTING_MAPNAME, FString(MapNames[Random.RandHelper(UE_ARRAY_COUNT(MapNames))]), EOnlineDataAdvertisementType::ViaOnlineService);
+			Settings.Set(SEARCH_KEYWORDS, FString(TEXT("default")), EOnlineDataAdvertisementType::ViaOnlineService);
+			Settings.Set(SETTING_SESSION_TEMPLATE_NAME, FString(TEXT("GameSession")), EOnlineDataAdvertisementType::DontAdvertise);
+			Settings.Set(SETTING_FRIENDLYNAME, FString::Printf(TEXT("Server #%d"), Index), EOnlineDataAdvertisementType::ViaOnlineService);
+			Settings.Set(SETTING_MATCHING_TIMEOUT, 120.0f, EOnlineDataAdvertisementType::ViaOnlineService);
+			Settings.Set(SETTING_NUMPLAYERS, 16 - SearchResult.Session.NumOpenPublicConnections, EOnlineDataAdvertisementType::ViaOnlineService);
+			Settings.Set(SETTING_MATCHSTATE, FString(TEXT("InProgress")), EOnlineDataAdvertisementType::ViaOnlineService);
+		}
+	}
+
+	static double RunBenchmarkDecode(const TArray<FOnlineSessionSearchResult>& SearchResults, bool bParallel, TArray<FEnhancedDecodedSearchResult>& OutDecoded)
+	{
+		FEnhancedSearchDecodeOptions Options;
+		Options.bParallel = bParallel;
+		Options.StringTable = MakeShared<FEnhancedSessionStringTable>();
+		Options.Filter = [](const FOnlineSessionSearchResult& SearchResult) { return SearchResult.PingInMs < 300 && SearchResult.Session.NumOpenPublicConnections > 0; };
+		Options.Scorer = [](const FOnlineSessionSearchResult& SearchResult)
+		{
+			FString GameMode;
+			SearchResult.Session.SessionSettings.Get(SETTING_GAMEMODE, GameMode);
+			return (1.0f - SearchResult.PingInMs / 300.0f) + (GameMode == TEXT("Deathmatch") ? 1.0f : 0.0f);
+		};
+
+		const double StartTime = FPlatformTime::Seconds();
+		DecodeSearchResults(SearchResults, Options, OutDecoded);
+		return (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	}
+}
+
+static FAutoConsoleCommand CmdEnhancedSessionsBenchmarkDecode(
+	TEXT("EnhancedOnline.Sessions.BenchmarkDecode"),
+	TEXT("Compares serial and parallel decoding of synthetic search results. Usage: EnhancedOnline.Sessions.BenchmarkDecode [NumResults...], defaults to 1000 10000 100000."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		using namespace EnhancedOnlineSearchDecoding;
+
+		TArray<int32> Counts;
+		for (const FString& Arg : Args)
+		{
+			Counts.Add(FMath::Max(1, FCString::Atoi(*Arg)));
+		}
+		if (Counts.Num() == 0)
+		{
+			Counts = { 1000, 10000, 100000 };
+		}
+
+		for (int32 NumResults : Counts)
+		{
+			TArray<FOnlineSessionSearchResult> SearchResults;
+			MakeBenchmarkSearchResults(NumResults, SearchResults);
+
+			TArray<FEnhancedDecodedSearchResult> SerialDecoded;
+			TArray<FEnhancedDecodedSearchResult> ParallelDecoded;
+
+			// Best of three to keep allocator warm-up out of the numbers
+			double SerialMs = TNumericLimits<double>::Max();
+			double ParallelMs = TNumericLimits<double>::Max();
+			for (int32 Run = 0; Run < 3; ++Run)
+			{
+				SerialMs = FMath::Min(SerialMs, RunBenchmarkDecode(SearchResults, false, SerialDecoded));
+				ParallelMs = FMath::Min(ParallelMs, RunBenchmarkDecode(SearchResults, true, ParallelDecoded));
+			}
+
+			bool bSameOrder = SerialDecoded.Num() == ParallelDecoded.Num();
+			for (int32 Index = 0; bSameOrder && Index < SerialDecoded.Num(); ++Index)
+			{
+				bSameOrder = SerialDecoded[Index].SourceIndex == ParallelDecoded[Index].SourceIndex;
+			}
+
+			UE_LOG(LogEnhancedSubsystem, Display, TEXT("Decoded %7d results (%7d kept): serial %8.2f ms, parallel %8.2f ms, speedup %.2fx%s"),
+				NumResults, ParallelDecoded.Num(), SerialMs, ParallelMs, ParallelMs > 0.0 ? SerialMs / ParallelMs : 0.0,
+				bSameOrder ? TEXT("") : TEXT(", ORDER MISMATCH"));
+		}
+	}));
+
+#if WITH_DEV_AUTOMATION_TESTS
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEnhancedSearchDecodingListOrderTest, "EnhancedOnline.SearchDecoding.ListOrder",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ServerContext | EAutomationTestFlags::CommandletContext | EAutomationTestFlags::EngineFilter)
+
+bool FEnhancedSearchDecodingListOrderTest::RunTest(const FString& Parameters)
+{
+	using namespace EnhancedOnlineSearchDecoding;
+
+	TArray<FOnlineSessionSearchResult> SearchResults;
+	MakeBenchmarkSearchResults(1000, SearchResults);
+
+	FEnhancedSearchDecodeOptions ObjectOptions;
+	ObjectOptions.StringTable = MakeShared<FEnhancedSessionStringTable>();
+	ObjectOptions.Filter = [](const FOnlineSessionSearchResult& SearchResult) { return SearchResult.Session.NumOpenPublicConnections > 0; };
+	// Coarse scores, so the ties have to keep the backend order on both paths
+	ObjectOptions.Scorer = [](const FOnlineSessionSearchResult& SearchResult) { return static_cast<float>(SearchResult.PingInMs / 50); };
+
+	// The objects are wrapped in decoded order
+	TArray<FEnhancedDecodedSearchResult> ObjectDecoded;
+	DecodeSearchResults(SearchResults, ObjectOptions, ObjectDecoded);
+
+	FEnhancedSearchDecodeOptions ListOptions;
+	ListOptions.Filter = ObjectOptions.Filter;
+	ListOptions.Scorer = ObjectOptions.Scorer;
+	ListOptions.bFilterAndScoreOnly = true;
+
+	TArray<FEnhancedDecodedSearchResult> ListDecoded;
+	DecodeSearchResults(SearchResults, ListOptions, ListDecoded);
+
+	TArray<FOnlineSessionSearchResult> ListResults = SearchResults;
+	ReorderSearchResults(ListResults, ListDecoded);
+
+	if (!TestEqual(TEXT("Number of results"), ListResults.Num(), ObjectDecoded.Num()))
+	{
+		return false;
+	}
+
+	for (int32 Index = 0; Index < ListResults.Num(); ++Index)
+	{
+		const FOnlineSessionSearchResult& ObjectResult = SearchResults[ObjectDecoded[Index].SourceIndex];
+		if (!TestEqual(FString::Printf(TEXT("Session at %d"), Index), ListResults[Index].Session.OwningUserName, ObjectResult.Session.OwningUserName))
+		{
+			return false;
+		}
+	}
+
+	TestTrue(TEXT("Raw results skip the owner id"), ListDecoded.Num() == 0 || ListDecoded[0].OwningUserId.IsEmpty());
+	return true;
+}
+#endif
+#endif
@@ -0,0 +1,107 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnhancedCompactSessionSettings.h"
+#include "OnlineSessionSettings.h"
+
+/**
+ * A raw search result after decoding, ready to be wrapped on the game thread
+ */
+struct FEnhancedDecodedSearchResult
+{
+	/** Index of the raw search result */
+	int32 SourceIndex = INDEX_NONE;
+
+	float Score = 0.0f;
+
+	FString OwningUserId;
+
+	/** Only filled if the decoding was asked to compact */
+	FEnhancedCompactSessionSettings CompactSettings;
+};
+
+/**
+ * Specifies how raw search results are decoded
+ */
+struct FEnhancedSearchDecodeOptions
+{
+	/** Called on worker threads, returning false drops the result */
+	TFunction<bool(const FOnlineSessionSearchResult&)> Filter;
+
+	/** Called on worker threads, results are sorted by score with the highest first */
+	TFunction<float(const FOnlineSessionSearchResult&)> Scorer;
+
+	/** Compacts the session settings into this table if set */
+	TSharedPtr<FEnhancedSessionStringTable> StringTable;
+
+	/** Whether to spread the work across worker threads */
+	bool bParallel = true;
+
+	/** Only filters and scores, for results that stay raw. The owner id and compact settings are left empty */
+	bool bFilterAndScoreOnly = false;
+};
+
+/**
+ * Decoded results that are still being wrapped into search result objects, spread across frames
+ */
+struct FEnhancedPendingSearchMaterialization
+{
+	TArray<FEnhancedDecodedSearchResult> DecodedResults;
+
+	/** Index of the next decoded result to wrap */
+	int32 NextIndex = 0;
+
+	/** Keeps the string table alive for logging, the wrapped results hold their own reference */
+	TSharedPtr<FEnhancedSessionStringTable> StringTable;
+
+	int32 NumSearchResults = 0;
+};
+
+/**
+ * A search that queries every region on its own and merges the answers by ping
+ */
+struct FEnhancedRegionSearch
+{
+	TArray<FString> Regions;
+
+	/** Index of the next region to query */
+	int32 NextRegion = 0;
+
+	/** The region being queried right now */
+	FString CurrentRegion;
+	TSharedPtr<FOnlineSessionSearch> CurrentQuery;
+
+	/** Results of every region that answered, each sorted by ping */
+	TArray<TArray<FOnlineSessionSearchResult>> Shards;
+
+	int32 NumFailedRegions = 0;
+
+	/** Platform time the first region was queried at */
+	double StartTime = 0.0;
+};
+
+namespace EnhancedOnlineSearchDecoding
+{
+	/**
+	 * Decodes, filters and scores raw search results.
+	 * The output is deterministic: it keeps the order of the backend, or is sorted by score with ties in backend order.
+	 */
+	void DecodeSearchResults(const TArray<FOnlineSessionSearchResult>& SearchResults, const FEnhancedSearchDecodeOptions& Options, TArray<FEnhancedDecodedSearchResult>& OutDecoded);
+
+	/** Moves raw search results into the order of their decoded results, results that were filtered out are dropped */
+	void ReorderSearchResults(TArray<FOnlineSessionSearchResult>& SearchResults, const TArray<FEnhancedDecodedSearchResult>& Decoded);
+
+	/**
+	 * Merges search results that are each sorted by ping into a single list, nearest first.
+	 * Ties keep the order of the shards and a session found in several shards is only kept once.
+	 * Results are moved out of the shards, only as many as MaxResults are looked at. MaxResults <= 0 merges everything.
+	 */
+	void MergeByPing(TArray<TArray<FOnlineSessionSearchResult>>& Shards, int32 MaxResults, TArray<FOnlineSessionSearchResult>& OutMerged);
+
+#if !UE_BUILD_SHIPPING
+	/** Fills synthetic search results with typical session settings, the same count always yields the same results */
+	void MakeBenchmarkSearchResults(int32 NumResults, TArray<FOnlineSessionSearchResult>& OutSearchResults);
+#endif
+}
@@ -3,21 +3,120 @@
 
 #include "EnhancedOnlineSessionsSubsystem.h"
 
+#include "EnhancedOnlineReservationBeacon.h"
+#include "EnhancedOnlineStateSnapshotSlot.h"
+#include "EnhancedOnlineSubsystem.h"
+#include "OnlineBeaconHost.h"
 #include "OnlineSessionSettings.h"
 #include "OnlineSubsystemUtils.h"
+#include "TimerManager.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GameFramework/GameModeBase.h"
 #include "Interfaces/OnlineSessionInterface.h"
 #include "Kismet/GameplayStatics.h"
 #include "Online/OnlineSessionNames.h"
+#include "Persistence/EnhancedOnlinePingHistory.h"
 
 class IOnlineSubsystem;
 
 void UEnhancedOnlineSessionsSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
+
+	WorldCleanupDelegateHandle = FWorldDelegates::OnWorldCleanup.AddUObject(this, &ThisClass::HandleWorldCleanup);
+	GameModePostLoginDelegateHandle = FGameModeEvents::GameModePostLoginEvent.AddUObject(this, &ThisClass::HandleGameModePostLogin);
+	GameModeLogoutDelegateHandle = FGameModeEvents::GameModeLogoutEvent.AddUObject(this, &ThisClass::HandleGameModeLogout);
+	GameModeInitializedDelegateHandle = FGameModeEvents::GameModeInitializedEvent.AddUObject(this, &ThisClass::HandleGameModeInitialized);
+	GameModePreLoginDelegateHandle = FGameModeEvents::GameModePreLoginEvent.AddUObject(this, &ThisClass::HandleGameModePreLogin);
+
+	PingHistory = MakeShared<FEnhancedOnlinePingHistory>();
+	PingHistory->Load();
+
+	// Readers on other threads may still hold the subsystem, so the slot is only released with it
+	if (!StateSnapshotSlot.IsValid())
+	{
+		StateSnapshotSlot = MakeShared<FEnhancedOnlineStateSnapshotSlot, ESPMode::ThreadSafe>();
+	}
+	MarkStateSnapshotDirty();
+
+	// Before the first interfaces are resolved, the auto login is traced and can run into faults
+	StartBackendTrace();
+	StartBackendFaults();
+
+	// Warm up the default backend so the first request doesn't pay for it
+	GetOnlineInterfaces();
+
+	StartAutoLogin();
 }
 
 void UEnhancedOnlineSessionsSubsystem::Deinitialize()
 {
+	StopPresencePublishing();
+	GetGameInstance()->GetTimerManager().ClearTimer(MatchmakingRetryTimerHandle);
+	GetGameInstance()->GetTimerManager().ClearTimer(MaterializeTimerHandle);
+	GetGameInstance()->GetTimerManager().ClearTimer(LobbyHandoffTimerHandle);
+	GetGameInstance()->GetTimerManager().ClearTimer(StateSnapshotTimerHandle);
+	StopDedicatedSessionHeartbeat();
+	StopConnectionPingSampling();
+
+	// A search that is still running or publishing its results would never answer its request
+	if (SearchSettings.IsValid())
+	{
+		UEnhancedOnlineRequest_FindSessions* Request = SearchSettings->Request;
+		if (Request->Sessions.IsValid())
+		{
+			Request->Sessions->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsDelegateHandle);
+		}
+		FindSessionsDelegateHandle.Reset();
+
+		PendingRegionSearch.Reset();
+		PendingMaterialization.Reset();
+		MaterializedSearchResults.Reset();
+		SearchSettings = nullptr;
+
+		Request->FailRequest(TEXT("The subsystem was shut down before the search completed."));
+	}
+
+	if (PingHistory.IsValid())
+	{
+		PingHistory->Save();
+		PingHistory->WaitForSave();
+	}
+
+	GetGameInstance()->GetTimerManager().ClearTimer(PlayerRegistryFlushTimerHandle);
+	FGameModeEvents::GameModePostLoginEvent.Remove(GameModePostLoginDelegateHandle);
+	FGameModeEvents::GameModeLogoutEvent.Remove(GameModeLogoutDelegateHandle);
+	FGameModeEvents::GameModeInitializedEvent.Remove(GameModeInitializedDelegateHandle);
+	FGameModeEvents::GameModePreLoginEvent.Remove(GameModePreLoginDelegateHandle);
+
+	StopReservationBeacon();
+	if (PendingReservationBeacon)
+	{
+		PendingReservationBeacon->OnReservationResponse.Unbind();
+		PendingReservationBeacon->DestroyBeacon();
+		PendingReservationBeacon = nullptr;
+	}
+
+	if (IOnlineSessionPtr Sessions = GetOnlineInterfaces().Sessions)
+	{
+		Sessions->ClearOnRegisterPlayersCompleteDelegate_Handle(RegisterPlayersDelegateHandle);
+		Sessions->ClearOnUnregisterPlayersCompleteDelegate_Handle(UnregisterPlayersDelegateHandle);
+		Sessions->ClearOnUpdateSessionCompleteDelegate_Handle(LobbyHandoffUpdateDelegateHandle);
+		Sessions->ClearOnSessionSettingsUpdatedDelegate_Handle(LobbySettingsUpdatedDelegateHandle);
+	}
+	RegisterPlayersDelegateHandle.Reset();
+	UnregisterPlayersDelegateHandle.Reset();
+	LobbyHandoffUpdateDelegateHandle.Reset();
+	LobbySettingsUpdatedDelegateHandle.Reset();
+
+	FWorldDelegates::OnWorldCleanup.Remove(WorldCleanupDelegateHandle);
+	WorldCleanupDelegateHandle.Reset();
+	InvalidateOnlineInterfaces();
+	StopBackendFaults();
+	StopBackendTrace();
+
 	Super::Deinitialize();
 }
 
@@ -33,3 +132,101 @@ bool UEnhancedOnlineSessionsSubsystem::ShouldCreateSubsystem(UObject* Outer) con
 
 	return ChildClasses.Num() == 0;
 }
+
+UEnhancedOnlineSessionsSubsystem* UEnhancedOnlineSessionsSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	const UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+
+	return GameInstance ? GameInstance->GetSubsystem<UEnhancedOnlineSessionsSubsystem>() : nullptr;
+}
+
+FEnhancedOnlineInterfaceHandles UEnhancedOnlineSessionsSubsystem::GetOnlineInterfaces(FName SubsystemName)
+{
+	if (const FEnhancedOnlineInterfaceHandles* Handles = OnlineInterfaceTable.Find(SubsystemName))
+	{
+		if (Handles->IsValid() && Handles->World.Get() == GetWorld())
+		{
+			return *Handles;
+		}
+	}
+
+	return ResolveOnlineInterfaces(SubsystemName);
+}
+
+void UEnhancedOnlineSessionsSubsystem::InvalidateOnlineInterfaces()
+{
+	OnlineInterfaceTable.Reset();
+}
+
+void UEnhancedOnlineSessionsSubsystem::SetDefaultOnlineBackend(FName BackendName)
+{
+	if (DefaultOnlineBackend != BackendName)
+	{
+		DefaultOnlineBackend = BackendName;
+		InvalidateOnlineInterfaces();
+	}
+}
+
+FName UEnhancedOnlineSessionsSubsystem::GetActiveSessionName(const IOnlineSessionPtr& Sessions)
+{
+	if (Sessions.IsValid() && Sessions->GetNamedSession(NAME_GameSession) == nullptr && Sessions->GetNamedSession(NAME_PartySession) != nullptr)
+	{
+		return NAME_PartySession;
+	}
+
+	return NAME_GameSession;
+}
+
+FEnhancedOnlineInterfaceHandles UEnhancedOnlineSessionsSubsystem::ResolveOnlineInterfaces(FName SubsystemName)
+{
+	UWorld* World = GetWorld();
+
+	FEnhancedOnlineInterfaceHandles& Handles = OnlineInterfaceTable.FindOrAdd(SubsystemName);
+	Handles = FEnhancedOnlineInterfaceHandles();
+	Handles.World = World;
+	Handles.OnlineSub = Online::GetSubsystem(World, SubsystemName.IsNone() ? DefaultOnlineBackend : SubsystemName);
+
+	if (Handles.OnlineSub)
+	{
+		Handles.Sessions = Handles.OnlineSub->GetSessionInterface();
+		Handles.Identity = Handles.OnlineSub->GetIdentityInterface();
+		Handles.Presence = Handles.OnlineSub->GetPresenceInterface();
+		WrapTracedInterfaces(SubsystemName, Handles);
+		WrapFaultInjectedInterfaces(SubsystemName, Handles);
+
+		UE_LOG(LogEnhancedSubsystem, Verbose, TEXT("Resolved online interfaces for backend %s."), *Handles.OnlineSub->GetSubsystemName().ToString());
+	}
+	else
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Failed to resolve online subsystem %s."), *SubsystemName.ToString());
+	}
+
+	return Handles;
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+	// Reservations outlive the beacon, players holding one may be travelling to the next map
+	if (ReservationBeaconHost && ReservationBeaconHost->GetWorld() == World)
+	{
+		StopReservationBeacon();
+	}
+
+	if (PendingReservationBeacon && PendingReservationBeacon->GetWorld() == World)
+	{
+		PendingReservationBeacon->OnReservationResponse.Unbind();
+		PendingReservationBeacon = nullptr;
+	}
+
+	for (auto It = OnlineInterfaceTable.CreateIterator(); It; ++It)
+	{
+		if (It->Value.World.Get() == World)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	// Hosted sessions usually end with their world
+	MarkStateSnapshotDirty();
+}
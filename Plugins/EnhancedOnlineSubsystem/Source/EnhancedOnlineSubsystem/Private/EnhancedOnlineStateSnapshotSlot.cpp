@@ -0,0 +1,79 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineStateSnapshotSlot.h"
+
+FEnhancedOnlineStateSnapshotSlot::~FEnhancedOnlineStateSnapshotSlot()
+{
+	delete Current.exchange(nullptr);
+
+	for (TArray<FEnhancedOnlineStateSnapshotPtr*>& RetiredHolders : Retired)
+	{
+		for (FEnhancedOnlineStateSnapshotPtr* Holder : RetiredHolders)
+		{
+			delete Holder;
+		}
+	}
+}
+
+FEnhancedOnlineStateSnapshotPtr FEnhancedOnlineStateSnapshotSlot::Get() const
+{
+	// Announced before the load, so Publish never deletes a holder a reader may have loaded.
+	// The epoch is checked again, a reader that announced itself in an epoch that just ended retries in the new one.
+	uint32 ReaderEpoch = Epoch.load();
+	for (;;)
+	{
+		NumActiveReaders[ReaderEpoch & 1].fetch_add(1);
+
+		const uint32 CurrentEpoch = Epoch.load();
+		if (CurrentEpoch == ReaderEpoch)
+		{
+			break;
+		}
+
+		NumActiveReaders[ReaderEpoch & 1].fetch_sub(1);
+		ReaderEpoch = CurrentEpoch;
+	}
+
+	FEnhancedOnlineStateSnapshotPtr Snapshot;
+	if (const FEnhancedOnlineStateSnapshotPtr* Holder = Current.load())
+	{
+		Snapshot = *Holder;
+	}
+
+	NumActiveReaders[ReaderEpoch & 1].fetch_sub(1);
+	return Snapshot;
+}
+
+void FEnhancedOnlineStateSnapshotSlot::Publish(FEnhancedOnlineStateSnapshotPtr Snapshot)
+{
+	check(IsInGameThread());
+
+	if (FEnhancedOnlineStateSnapshotPtr* Previous = Current.exchange(new FEnhancedOnlineStateSnapshotPtr(MoveTemp(Snapshot))))
+	{
+		Retired[Epoch.load() & 1].Add(Previous);
+	}
+
+	ReclaimRetired();
+}
+
+void FEnhancedOnlineStateSnapshotSlot::ReclaimRetired()
+{
+	// Readers of the current epoch announced themselves after the holders of the previous epoch were replaced,
+	// so they can't have loaded them. Once the readers of the previous epoch are done those holders are free.
+	// Busy readers only delay this until the next publish, they never wait for the game thread.
+	const uint32 CurrentEpoch = Epoch.load();
+	const uint32 PreviousParity = (CurrentEpoch + 1) & 1;
+	if (NumActiveReaders[PreviousParity].load() != 0)
+	{
+		return;
+	}
+
+	for (FEnhancedOnlineStateSnapshotPtr* Holder : Retired[PreviousParity])
+	{
+		delete Holder;
+	}
+	Retired[PreviousParity].Reset();
+
+	// New readers move to the drained counter, the readers left in this epoch drain on their own
+	Epoch.store(CurrentEpoch + 1);
+}
@@ -0,0 +1,45 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnhancedOnlineStateSnapshot.h"
+#include <atomic>
+
+/**
+ * Holds the published state snapshot, readers on any thread get it without taking a lock
+ * The game thread swaps in new snapshots, replaced ones live on as long as a reader holds them.
+ * Readers announce themselves in one of two epochs, a publish only waits for the readers of the previous epoch,
+ * so steady reading on other threads never keeps replaced holders alive for more than one publish.
+ */
+class FEnhancedOnlineStateSnapshotSlot
+{
+public:
+	FEnhancedOnlineStateSnapshotSlot() = default;
+	~FEnhancedOnlineStateSnapshotSlot();
+
+	FEnhancedOnlineStateSnapshotSlot(const FEnhancedOnlineStateSnapshotSlot&) = delete;
+	FEnhancedOnlineStateSnapshotSlot& operator=(const FEnhancedOnlineStateSnapshotSlot&) = delete;
+
+	/** Returns the current snapshot, null before the first publish. Any thread */
+	FEnhancedOnlineStateSnapshotPtr Get() const;
+
+	/** Replaces the current snapshot. Game thread only */
+	void Publish(FEnhancedOnlineStateSnapshotPtr Snapshot);
+
+private:
+	/** Deletes the replaced holders once no reader can still be copying from them */
+	void ReclaimRetired();
+
+	/** Heap holder of the current snapshot pointer, a holder never changes once it was published */
+	std::atomic<FEnhancedOnlineStateSnapshotPtr*> Current{nullptr};
+
+	/** Epoch new readers announce themselves in, advanced by the game thread */
+	std::atomic<uint32> Epoch{0};
+
+	/** Readers between loading Current and copying the snapshot pointer out of it, by epoch parity */
+	mutable std::atomic<int32> NumActiveReaders[2] = {{0}, {0}};
+
+	/** Holders replaced by Publish that were not deleted yet, by parity of the epoch they were replaced in */
+	TArray<FEnhancedOnlineStateSnapshotPtr*> Retired[2];
+};
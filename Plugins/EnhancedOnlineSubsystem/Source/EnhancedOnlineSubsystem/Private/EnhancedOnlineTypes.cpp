@@ -0,0 +1,179 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineTypes.h"
+
+#include "Online/OnlineSessionNames.h"
+
+namespace EnhancedOnlineQuery
+{
+	static EOnlineComparisonOp::Type ToComparisonOp(EEnhancedSessionQueryComparison Comparison)
+	{
+		switch (Comparison)
+		{
+		case EEnhancedSessionQueryComparison::NotEquals:			return EOnlineComparisonOp::NotEquals;
+		case EEnhancedSessionQueryComparison::GreaterThan:			return EOnlineComparisonOp::GreaterThan;
+		case EEnhancedSessionQueryComparison::GreaterThanEquals:	return EOnlineComparisonOp::GreaterThanEquals;
+		case EEnhancedSessionQueryComparison::LessThan:				return EOnlineComparisonOp::LessThan;
+		case EEnhancedSessionQueryComparison::LessThanEquals:		return EOnlineComparisonOp::LessThanEquals;
+		default:													return EOnlineComparisonOp::Equals;
+		}
+	}
+
+	template <typename ValueType>
+	static bool Compare(EEnhancedSessionQueryComparison Comparison, const ValueType& Value, const ValueType& Expected)
+	{
+		switch (Comparison)
+		{
+		case EEnhancedSessionQueryComparison::NotEquals:			return !(Value == Expected);
+		case EEnhancedSessionQueryComparison::GreaterThan:			return Expected < Value;
+		case EEnhancedSessionQueryComparison::GreaterThanEquals:	return !(Value < Expected);
+		case EEnhancedSessionQueryComparison::LessThan:				return Value < Expected;
+		case EEnhancedSessionQueryComparison::LessThanEquals:		return !(Expected < Value);
+		default:													return Value == Expected;
+		}
+	}
+
+	static bool GetNumber(const FVariantData& Data, double& OutValue)
+	{
+		switch (Data.GetType())
+		{
+		case EOnlineKeyValuePairDataType::Int32:
+			{
+				int32 Value = 0;
+				Data.GetValue(Value);
+				OutValue = Value;
+				return true;
+			}
+		case EOnlineKeyValuePairDataType::UInt32:
+			{
+				uint32 Value = 0;
+				Data.GetValue(Value);
+				OutValue = Value;
+				return true;
+			}
+		case EOnlineKeyValuePairDataType::Int64:
+			{
+				int64 Value = 0;
+				Data.GetValue(Value);
+				OutValue = static_cast<double>(Value);
+				return true;
+			}
+		case EOnlineKeyValuePairDataType::UInt64:
+			{
+				uint64 Value = 0;
+				Data.GetValue(Value);
+				OutValue = static_cast<double>(Value);
+				return true;
+			}
+		case EOnlineKeyValuePairDataType::Float:
+			{
+				float Value = 0.0f;
+				Data.GetValue(Value);
+				OutValue = Value;
+				return true;
+			}
+		case EOnlineKeyValuePairDataType::Double:
+			Data.GetValue(OutValue);
+			return true;
+		default:
+			return false;
+		}
+	}
+}
+
+FEnhancedSessionQueryFilter FEnhancedSessionQueryFilter::MakeInt(FName InKey, EEnhancedSessionQueryComparison InComparison, int32 InValue)
+{
+	FEnhancedSessionQueryFilter Filter;
+	Filter.Key = InKey;
+	Filter.Comparison = InComparison;
+	Filter.ValueType = EEnhancedSessionQueryValueType::Int;
+	Filter.IntValue = InValue;
+	return Filter;
+}
+
+FEnhancedSessionQueryFilter FEnhancedSessionQueryFilter::MakeString(FName InKey, EEnhancedSessionQueryComparison InComparison, const FString& InValue)
+{
+	FEnhancedSessionQueryFilter Filter;
+	Filter.Key = InKey;
+	Filter.Comparison = InComparison;
+	Filter.ValueType = EEnhancedSessionQueryValueType::String;
+	Filter.StringValue = InValue;
+	return Filter;
+}
+
+FEnhancedSessionQueryFilter FEnhancedSessionQueryFilter::MakeBool(FName InKey, bool bInValue)
+{
+	FEnhancedSessionQueryFilter Filter;
+	Filter.Key = InKey;
+	Filter.ValueType = EEnhancedSessionQueryValueType::Bool;
+	Filter.bBoolValue = bInValue;
+	return Filter;
+}
+
+void FEnhancedSessionQueryFilter::ApplyTo(FOnlineSearchSettings& QuerySettings) const
+{
+	const EOnlineComparisonOp::Type ComparisonOp = EnhancedOnlineQuery::ToComparisonOp(Comparison);
+
+	switch (ValueType)
+	{
+	case EEnhancedSessionQueryValueType::Int:
+		QuerySettings.Set(Key, IntValue, ComparisonOp);
+		break;
+	case EEnhancedSessionQueryValueType::String:
+		QuerySettings.Set(Key, StringValue, ComparisonOp);
+		break;
+	case EEnhancedSessionQueryValueType::Bool:
+		QuerySettings.Set(Key, bBoolValue, ComparisonOp);
+		break;
+	}
+}
+
+bool FEnhancedSessionQueryFilter::Matches(const FOnlineSessionSearchResult& SearchResult) const
+{
+	using namespace EnhancedOnlineQuery;
+
+	// Not a session setting, backends read it as the minimum number of open slots
+	if (Key == SEARCH_MINSLOTSAVAILABLE)
+	{
+		return SearchResult.Session.NumOpenPublicConnections >= IntValue;
+	}
+
+	const FOnlineSessionSetting* Setting = SearchResult.Session.SessionSettings.Settings.Find(Key);
+	if (Setting == nullptr)
+	{
+		return Comparison == EEnhancedSessionQueryComparison::NotEquals;
+	}
+
+	switch (ValueType)
+	{
+	case EEnhancedSessionQueryValueType::Int:
+		{
+			double Value = 0.0;
+			return GetNumber(Setting->Data, Value) && Compare<double>(Comparison, Value, IntValue);
+		}
+	case EEnhancedSessionQueryValueType::String:
+		{
+			if (Setting->Data.GetType() != EOnlineKeyValuePairDataType::String)
+			{
+				return false;
+			}
+
+			FString Value;
+			Setting->Data.GetValue(Value);
+			return Compare<FString>(Comparison, Value, StringValue);
+		}
+	case EEnhancedSessionQueryValueType::Bool:
+		{
+			if (Setting->Data.GetType() != EOnlineKeyValuePairDataType::Bool)
+			{
+				return false;
+			}
+
+			bool bValue = false;
+			Setting->Data.GetValue(bValue);
+			return Compare<bool>(Comparison, bValue, bBoolValue);
+		}
+	default:
+		return false;
+	}
+}
@@ -0,0 +1,43 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineVariantSerialization.h"
+
+void EnhancedOnlineVariantSerialization::WriteVariantData(FArchive& Ar, const FVariantData& Data)
+{
+	uint8 Type = static_cast<uint8>(Data.GetType());
+	Ar << Type;
+
+	switch (Data.GetType())
+	{
+	case EOnlineKeyValuePairDataType::Int32:	{ int32 Value = 0; Data.GetValue(Value); Ar << Value; break; }
+	case EOnlineKeyValuePairDataType::UInt32:	{ uint32 Value = 0; Data.GetValue(Value); Ar << Value; break; }
+	case EOnlineKeyValuePairDataType::Int64:	{ int64 Value = 0; Data.GetValue(Value); Ar << Value; break; }
+	case EOnlineKeyValuePairDataType::UInt64:	{ uint64 Value = 0; Data.GetValue(Value); Ar << Value; break; }
+	case EOnlineKeyValuePairDataType::Float:	{ float Value = 0.0f; Data.GetValue(Value); Ar << Value; break; }
+	case EOnlineKeyValuePairDataType::Double:	{ double Value = 0.0; Data.GetValue(Value); Ar << Value; break; }
+	case EOnlineKeyValuePairDataType::Bool:		{ bool bValue = false; Data.GetValue(bValue); Ar << bValue; break; }
+	case EOnlineKeyValuePairDataType::Blob:		{ TArray<uint8> Value; Data.GetValue(Value); Ar << Value; break; }
+	case EOnlineKeyValuePairDataType::Empty:	break;
+	default:									{ FString Value = Data.ToString(); Ar << Value; break; }
+	}
+}
+
+void EnhancedOnlineVariantSerialization::ReadVariantData(FArchive& Ar, FVariantData& OutData)
+{
+	uint8 Type = 0;
+	Ar << Type;
+
+	switch (static_cast<EOnlineKeyValuePairDataType::Type>(Type))
+	{
+	case EOnlineKeyValuePairDataType::Int32:	{ int32 Value = 0; Ar << Value; OutData.SetValue(Value); break; }
+	case EOnlineKeyValuePairDataType::UInt32:	{ uint32 Value = 0; Ar << Value; OutData.SetValue(Value); break; }
+	case EOnlineKeyValuePairDataType::Int64:	{ int64 Value = 0; Ar << Value; OutData.SetValue(Value); break; }
+	case EOnlineKeyValuePairDataType::UInt64:	{ uint64 Value = 0; Ar << Value; OutData.SetValue(Value); break; }
+	case EOnlineKeyValuePairDataType::Float:	{ float Value = 0.0f; Ar << Value; OutData.SetValue(Value); break; }
+	case EOnlineKeyValuePairDataType::Double:	{ double Value = 0.0; Ar << Value; OutData.SetValue(Value); break; }
+	case EOnlineKeyValuePairDataType::Bool:		{ bool bValue = false; Ar << bValue; OutData.SetValue(bValue); break; }
+	case EOnlineKeyValuePairDataType::Blob:		{ TArray<uint8> Value; Ar << Value; OutData.SetValue(Value); break; }
+	case EOnlineKeyValuePairDataType::Empty:	OutData.Empty(); break;
+	default:									{ FString Value; Ar << Value; OutData.SetValue(Value); break; }
+	}
+}
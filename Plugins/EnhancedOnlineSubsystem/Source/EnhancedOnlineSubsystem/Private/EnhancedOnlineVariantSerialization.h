@@ -0,0 +1,13 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OnlineKeyValuePair.h"
+
+namespace EnhancedOnlineVariantSerialization
+{
+	/** Writes a setting value with its type, so it is read back as the same type. Changing the layout changes every file that stores settings */
+	void WriteVariantData(FArchive& Ar, const FVariantData& Data);
+	void ReadVariantData(FArchive& Ar, FVariantData& OutData);
+}
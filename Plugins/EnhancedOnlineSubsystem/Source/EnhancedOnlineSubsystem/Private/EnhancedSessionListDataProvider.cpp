@@ -0,0 +1,294 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedSessionListDataProvider.h"
+
+#include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineSessionsSubsystem.h"
+#include "Persistence/EnhancedOnlineServerListCache.h"
+#include "OnlineSessionSettings.h"
+#include "Algo/StableSort.h"
+
+namespace EnhancedSessionList
+{
+	static FString GetFriendlyName(const FOnlineSessionSearchResult& SearchResult)
+	{
+		FString FriendlyName;
+		if (SearchResult.Session.SessionSettings.Get(SETTING_FRIENDLYNAME, FriendlyName))
+		{
+			return FriendlyName;
+		}
+
+		return SearchResult.Session.OwningUserName;
+	}
+}
+
+void UEnhancedSessionListDataProvider::SetSearchResults(TArray<FOnlineSessionSearchResult>&& InSearchResults)
+{
+	if (bShowingLastKnownSessions)
+	{
+		MergeIntoLastKnownSessions(InSearchResults);
+	}
+	else
+	{
+		MaterializedItems.Reset();
+	}
+
+	SearchResults = MoveTemp(InSearchResults);
+	LastKnownSessionIds.Reset();
+	bShowingLastKnownSessions = false;
+
+	RebuildView();
+}
+
+bool UEnhancedSessionListDataProvider::ShowLastKnownSessions()
+{
+	FEnhancedOnlineServerListSnapshot Snapshot;
+	if (!FEnhancedOnlineServerListCache::Load(Snapshot))
+	{
+		return false;
+	}
+
+	SearchResults = MoveTemp(Snapshot.SearchResults);
+	LastKnownSessionIds = MoveTemp(Snapshot.SessionIds);
+	bShowingLastKnownSessions = true;
+	MaterializedItems.Reset();
+
+	RebuildView();
+	return true;
+}
+
+void UEnhancedSessionListDataProvider::MergeIntoLastKnownSessions(TArray<FOnlineSessionSearchResult>& FreshResults)
+{
+	TMap<FString, int32> LastKnownIndices;
+	LastKnownIndices.Reserve(LastKnownSessionIds.Num());
+	for (int32 Index = 0; Index < LastKnownSessionIds.Num(); ++Index)
+	{
+		LastKnownIndices.Add(LastKnownSessionIds[Index], Index);
+	}
+
+	// Sessions that were already listed keep their position, new ones are appended
+	TArray<int32> PreviousIndices;
+	PreviousIndices.SetNumUninitialized(FreshResults.Num());
+	for (int32 Index = 0; Index < FreshResults.Num(); ++Index)
+	{
+		const int32* PreviousIndex = LastKnownIndices.Find(FreshResults[Index].GetSessionIdStr());
+		PreviousIndices[Index] = PreviousIndex ? *PreviousIndex : MAX_int32;
+	}
+
+	TArray<int32> Order;
+	Order.SetNumUninitialized(FreshResults.Num());
+	for (int32 Index = 0; Index < Order.Num(); ++Index)
+	{
+		Order[Index] = Index;
+	}
+	Algo::StableSortBy(Order, [&PreviousIndices](int32 Index) { return PreviousIndices[Index]; });
+
+	TArray<FOnlineSessionSearchResult> OrderedResults;
+	OrderedResults.Reserve(FreshResults.Num());
+	for (int32 Index : Order)
+	{
+		OrderedResults.Add(MoveTemp(FreshResults[Index]));
+	}
+	FreshResults = MoveTemp(OrderedResults);
+
+	// Refresh the items in place so the widgets showing them don't need to be rebuilt
+	TMap<int32, TObjectPtr<UEnhancedSessionSearchResult>> RefreshedItems;
+	const UEnhancedOnlineSessionsSubsystem* Subsystem = UEnhancedOnlineSessionsSubsystem::Get(this);
+	for (int32 Index = 0; Index < Order.Num(); ++Index)
+	{
+		const int32 PreviousIndex = PreviousIndices[Order[Index]];
+		if (TObjectPtr<UEnhancedSessionSearchResult>* Item = MaterializedItems.Find(PreviousIndex))
+		{
+			(*Item)->StoredSearchResult = FreshResults[Index];
+			(*Item)->bIsStale = false;
+			if (Subsystem)
+			{
+				Subsystem->ApplyPingEstimate(*Item);
+			}
+			RefreshedItems.Add(Index, *Item);
+		}
+	}
+
+	MaterializedItems = MoveTemp(RefreshedItems);
+}
+
+void UEnhancedSessionListDataProvider::Reset()
+{
+	SetSearchResults(TArray<FOnlineSessionSearchResult>());
+}
+
+int32 UEnhancedSessionListDataProvider::GetNumSearchResults() const
+{
+	return SearchResults.Num();
+}
+
+const FOnlineSessionSearchResult* UEnhancedSessionListDataProvider::GetSearchResult(int32 Index) const
+{
+	return View.IsValidIndex(Index) ? &SearchResults[View[Index]] : nullptr;
+}
+
+TArray<UEnhancedSessionSearchResult*> UEnhancedSessionListDataProvider::GetItemsInRange(int32 FirstIndex, int32 Count)
+{
+	TArray<UEnhancedSessionSearchResult*> Items;
+
+	FirstIndex = FMath::Clamp(FirstIndex, 0, View.Num());
+	Count = FMath::Clamp(Count, 0, View.Num() - FirstIndex);
+
+	Items.Reserve(Count);
+	for (int32 Index = FirstIndex; Index < FirstIndex + Count; ++Index)
+	{
+		Items.Add(MaterializeItem(View[Index]));
+	}
+
+	ReleaseItemsOutsideOf(FirstIndex, Count);
+
+	return Items;
+}
+
+UEnhancedSessionSearchResult* UEnhancedSessionListDataProvider::GetItem(int32 Index)
+{
+	return View.IsValidIndex(Index) ? MaterializeItem(View[Index]) : nullptr;
+}
+
+void UEnhancedSessionListDataProvider::SetSortMode(EEnhancedSessionSortMode InSortMode, bool bInDescending)
+{
+	if (SortMode == InSortMode && bSortDescending == bInDescending)
+	{
+		return;
+	}
+
+	SortMode = InSortMode;
+	bSortDescending = bInDescending;
+
+	RebuildView();
+}
+
+void UEnhancedSessionListDataProvider::SetFilter(const FString& InNameFilter, bool bInHideFullSessions, int32 InMaxPingInMs)
+{
+	if (NameFilter == InNameFilter && bHideFullSessions == bInHideFullSessions && MaxPingInMs == InMaxPingInMs)
+	{
+		return;
+	}
+
+	NameFilter = InNameFilter;
+	bHideFullSessions = bInHideFullSessions;
+	MaxPingInMs = InMaxPingInMs;
+
+	RebuildView();
+}
+
+bool UEnhancedSessionListDataProvider::PassesFilter(const FOnlineSessionSearchResult& SearchResult) const
+{
+	if (bHideFullSessions && SearchResult.Session.NumOpenPublicConnections <= 0)
+	{
+		return false;
+	}
+
+	if (MaxPingInMs > 0 && SearchResult.PingInMs > MaxPingInMs)
+	{
+		return false;
+	}
+
+	if (!NameFilter.IsEmpty() && !EnhancedSessionList::GetFriendlyName(SearchResult).Contains(NameFilter))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+void UEnhancedSessionListDataProvider::RebuildView()
+{
+	View.Reset();
+
+	if (SearchResults.Num() > 0)
+	{
+		View.Reserve(SearchResults.Num());
+		for (int32 Index = 0; Index < SearchResults.Num(); ++Index)
+		{
+			if (PassesFilter(SearchResults[Index]))
+			{
+				View.Add(Index);
+			}
+		}
+
+		if (SortMode == EEnhancedSessionSortMode::FriendlyName)
+		{
+			// Resolve every name once instead of on every comparison
+			TArray<FString> Names;
+			Names.SetNum(SearchResults.Num());
+			for (int32 Index : View)
+			{
+				Names[Index] = EnhancedSessionList::GetFriendlyName(SearchResults[Index]);
+			}
+
+			Algo::StableSort(View, [this, &Names](int32 A, int32 B)
+			{
+				const int32 Compare = Names[A].Compare(Names[B], ESearchCase::IgnoreCase);
+				return bSortDescending ? Compare > 0 : Compare < 0;
+			});
+		}
+		else if (SortMode != EEnhancedSessionSortMode::None)
+		{
+			auto GetSortKey = [this](int32 Index) -> int32
+			{
+				const FOnlineSessionSearchResult& SearchResult = SearchResults[Index];
+				return SortMode == EEnhancedSessionSortMode::Ping ? SearchResult.PingInMs : SearchResult.Session.NumOpenPublicConnections;
+			};
+
+			Algo::StableSort(View, [this, &GetSortKey](int32 A, int32 B)
+			{
+				return bSortDescending ? GetSortKey(A) > GetSortKey(B) : GetSortKey(A) < GetSortKey(B);
+			});
+		}
+	}
+
+	OnListChanged.Broadcast();
+}
+
+UEnhancedSessionSearchResult* UEnhancedSessionListDataProvider::MaterializeItem(int32 SearchResultIndex)
+{
+	if (TObjectPtr<UEnhancedSessionSearchResult>* Existing = MaterializedItems.Find(SearchResultIndex))
+	{
+		return *Existing;
+	}
+
+	UEnhancedSessionSearchResult* Item = NewObject<UEnhancedSessionSearchResult>(this);
+	Item->StoredSearchResult = SearchResults[SearchResultIndex];
+	Item->bIsStale = bShowingLastKnownSessions;
+
+	if (const UEnhancedOnlineSessionsSubsystem* Subsystem = UEnhancedOnlineSessionsSubsystem::Get(this))
+	{
+		Subsystem->ApplyPingEstimate(Item);
+	}
+
+	MaterializedItems.Add(SearchResultIndex, Item);
+	return Item;
+}
+
+void UEnhancedSessionListDataProvider::ReleaseItemsOutsideOf(int32 FirstIndex, int32 Count)
+{
+	// Keep one page above and below so scrolling back doesn't materialize again
+	const int32 KeepFirst = FMath::Max(0, FirstIndex - Count);
+	const int32 KeepLast = FMath::Min(View.Num(), FirstIndex + Count * 2);
+
+	if (MaterializedItems.Num() <= KeepLast - KeepFirst)
+	{
+		return;
+	}
+
+	TSet<int32> KeepIndices;
+	KeepIndices.Reserve(KeepLast - KeepFirst);
+	for (int32 Index = KeepFirst; Index < KeepLast; ++Index)
+	{
+		KeepIndices.Add(View[Index]);
+	}
+
+	for (auto It = MaterializedItems.CreateIterator(); It; ++It)
+	{
+		if (!KeepIndices.Contains(It.Key()))
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
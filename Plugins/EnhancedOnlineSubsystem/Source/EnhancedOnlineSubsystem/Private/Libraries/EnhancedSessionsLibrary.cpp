@@ -3,6 +3,7 @@
 
 #include "Libraries/EnhancedSessionsLibrary.h"
 
+#include "EnhancedOnlineHitchDetector.h"
 #include "EnhancedOnlineRequests.h"
 
 
@@ -11,6 +12,9 @@ void UEnhancedSessionsLibrary::SetupFailureDelegate(UEnhancedOnlineRequestBase*
 	Request->OnRequestFailedDelegate.AddLambda(
 		[OnFailedDelegate, Request] (const FString& Reason)
 		{
+			FEnhancedOnlineHitchScope HitchScope(TEXT("OnFailedDelegate"), Request);
+			HitchScope.SetListener(OnFailedDelegate);
+
 			if (OnFailedDelegate.IsBound())
 			{
 				OnFailedDelegate.Execute(Reason);
@@ -25,6 +29,11 @@ int32 UEnhancedSessionsLibrary::GetPingInMs(UEnhancedSessionSearchResult* Search
 	return SearchResult->GetPingInMs();
 }
 
+float UEnhancedSessionsLibrary::GetPingConfidence(UEnhancedSessionSearchResult* SearchResult)
+{
+	return SearchResult->GetPingConfidence();
+}
+
 int32 UEnhancedSessionsLibrary::GetMaxPlayers(UEnhancedSessionSearchResult* SearchResult)
 {
 	return SearchResult->GetMaxPlayers();
@@ -40,6 +49,11 @@ FString UEnhancedSessionsLibrary::GetSessionFriendlyName(UEnhancedSessionSearchR
 	return SearchResult->GetSessionFriendlyName();
 }
 
+bool UEnhancedSessionsLibrary::IsSessionStale(UEnhancedSessionSearchResult* SearchResult)
+{
+	return SearchResult->IsStale();
+}
+
 UEnhancedOnlineRequest_CreateSession* UEnhancedSessionsLibrary::ConstructOnlineHostSessionRequest(
 	UObject* WorldContextObject, const EEnhancedSessionOnlineMode OnlineMode, const int32 MaxPlayerCount,
 	FPrimaryAssetId MapId, TArray<FString> TravelURLOperators, const FString FriendlyName, const FString SearchKeyword, const bool bUseLobbiesIfAvailable,
@@ -95,6 +109,9 @@ UEnhancedOnlineRequest_CreateLobby* UEnhancedSessionsLibrary::ConstructOnlineHos
 	Request->OnCreateSessionCompleted.AddLambda(
 		[OnSucceededDelegate, Request] (int32 LocalUserIndex, const FName SessionName)
 		{
+			FEnhancedOnlineHitchScope HitchScope(TEXT("OnHostLobbySucceeded"), Request);
+			HitchScope.SetListener(OnSucceededDelegate);
+
 			if (OnSucceededDelegate.IsBound())
 			{
 				OnSucceededDelegate.Execute(SessionName, LocalUserIndex);
@@ -110,7 +127,7 @@ UEnhancedOnlineRequest_FindSessions* UEnhancedSessionsLibrary::ConstructOnlineFi
 	UObject* WorldContextObject, const EEnhancedSessionOnlineMode OnlineMode, const int32 MaxSearchResults,
 	const bool bFindLobbies, const FString SearchKeyword, const int32 LocalUserIndex,
 	const bool bInvalidateOnCompletion, FBPOnFindSessionsSuceeeded OnSucceededDelegate,
-	FBPOnRequestFailedWithLog OnFailedDelegate)
+	FBPOnRequestFailedWithLog OnFailedDelegate, const FBPOnFindSessionsProgress& OnProgressDelegate)
 {
 	UEnhancedOnlineRequest_FindSessions* Request = NewObject<UEnhancedOnlineRequest_FindSessions>(WorldContextObject);
 	Request->ConstructRequest();
@@ -127,6 +144,10 @@ UEnhancedOnlineRequest_FindSessions* UEnhancedSessionsLibrary::ConstructOnlineFi
 	Request->OnFindOnlineSessionsCompleted.AddLambda(
 		[OnSucceededDelegate, Request] ( const TArray<UEnhancedSessionSearchResult*>& SearchResults)
 		{
+			FEnhancedOnlineHitchScope HitchScope(TEXT("OnFindSessionsSucceeded"), Request);
+			HitchScope.SetListener(OnSucceededDelegate);
+			HitchScope.SetResultCount(SearchResults.Num());
+
 			if (OnSucceededDelegate.IsBound())
 			{
 				OnSucceededDelegate.Execute(SearchResults);
@@ -135,6 +156,19 @@ UEnhancedOnlineRequest_FindSessions* UEnhancedSessionsLibrary::ConstructOnlineFi
 			Request->CompleteRequest();
 		});
 
+	if (OnProgressDelegate.IsBound())
+	{
+		Request->OnFindOnlineSessionsProgress.AddLambda(
+			[OnProgressDelegate, Request] (const TArray<UEnhancedSessionSearchResult*>& NewResults, int32 NumCompleted, int32 NumTotal)
+			{
+				FEnhancedOnlineHitchScope HitchScope(TEXT("OnFindSessionsProgress"), Request);
+				HitchScope.SetListener(OnProgressDelegate);
+				HitchScope.SetResultCount(NewResults.Num());
+
+				OnProgressDelegate.ExecuteIfBound(NewResults, NumCompleted, NumTotal);
+			});
+	}
+
 	return Request;
 }
 
@@ -153,6 +187,106 @@ UEnhancedOnlineRequest_JoinSession* UEnhancedSessionsLibrary::ConstructOnlineJoi
 	return Request;
 }
 
+UEnhancedOnlineRequest_RejoinLastSession* UEnhancedSessionsLibrary::ConstructOnlineRejoinLastSessionRequest(
+	UObject* WorldContextObject, const bool bAllowSearchFallback, const int32 LocalUserIndex, const bool bInvalidateOnCompletion,
+	FBPOnRejoinSessionSucceeded OnSucceededDelegate, FBPOnRequestFailedWithLog OnFailedDelegate)
+{
+	UEnhancedOnlineRequest_RejoinLastSession* Request = NewObject<UEnhancedOnlineRequest_RejoinLastSession>(WorldContextObject);
+	Request->ConstructRequest();
+
+	Request->LocalUserIndex = LocalUserIndex;
+	Request->bInvalidateOnCompletion = bInvalidateOnCompletion;
+	Request->bAllowSearchFallback = bAllowSearchFallback;
+
+	SetupFailureDelegate(Request, OnFailedDelegate);
+
+	Request->OnRejoinSessionCompleted.AddLambda(
+		[OnSucceededDelegate, Request] (bool bUsedSearchFallback)
+		{
+			FEnhancedOnlineHitchScope HitchScope(TEXT("OnRejoinSessionSucceeded"), Request);
+			HitchScope.SetListener(OnSucceededDelegate);
+
+			if (OnSucceededDelegate.IsBound())
+			{
+				OnSucceededDelegate.Execute(bUsedSearchFallback);
+			}
+
+			Request->CompleteRequest();
+		});
+
+	return Request;
+}
+
+UEnhancedOnlineRequest_Matchmake* UEnhancedSessionsLibrary::ConstructOnlineMatchmakeRequest(
+	UObject* WorldContextObject, const EEnhancedSessionOnlineMode OnlineMode, const bool bFindLobbies,
+	const FString SearchKeyword, const FString GameModeAdvertisementName, const int32 MaxPingInMs, const float TimeBudgetSeconds,
+	UEnhancedOnlineRequest_CreateSession* HostFallbackTemplate, const int32 LocalUserIndex, const bool bInvalidateOnCompletion,
+	FBPOnMatchmakingSucceeded OnSucceededDelegate, FBPOnRequestFailedWithLog OnFailedDelegate)
+{
+	UEnhancedOnlineRequest_Matchmake* Request = NewObject<UEnhancedOnlineRequest_Matchmake>(WorldContextObject);
+	Request->ConstructRequest();
+
+	Request->LocalUserIndex = LocalUserIndex;
+	Request->bInvalidateOnCompletion = bInvalidateOnCompletion;
+	Request->OnlineMode = OnlineMode;
+	Request->bFindLobbies = bFindLobbies;
+	Request->SearchKeyword = SearchKeyword;
+	Request->GameModeAdvertisementName = GameModeAdvertisementName;
+	Request->MaxPingInMs = MaxPingInMs;
+	Request->TimeBudgetSeconds = TimeBudgetSeconds;
+	Request->HostFallbackTemplate = HostFallbackTemplate;
+
+	SetupFailureDelegate(Request, OnFailedDelegate);
+
+	Request->OnMatchmakingCompleted.AddLambda(
+		[OnSucceededDelegate, Request] (EEnhancedMatchmakingResult Result)
+		{
+			FEnhancedOnlineHitchScope HitchScope(TEXT("OnMatchmakingSucceeded"), Request);
+			HitchScope.SetListener(OnSucceededDelegate);
+
+			if (OnSucceededDelegate.IsBound())
+			{
+				OnSucceededDelegate.Execute(Result);
+			}
+
+			Request->CompleteRequest();
+		});
+
+	return Request;
+}
+
+UEnhancedOnlineRequest_LobbyHandoff* UEnhancedSessionsLibrary::ConstructOnlineLobbyHandoffRequest(
+	UObject* WorldContextObject, UEnhancedOnlineRequest_CreateSession* GameSessionTemplate, UEnhancedSessionSearchResult* GameSessionToClaim,
+	const int32 LocalUserIndex, const bool bInvalidateOnCompletion, FBPOnLobbyHandoffSucceeded OnSucceededDelegate,
+	FBPOnRequestFailedWithLog OnFailedDelegate)
+{
+	UEnhancedOnlineRequest_LobbyHandoff* Request = NewObject<UEnhancedOnlineRequest_LobbyHandoff>(WorldContextObject);
+	Request->ConstructRequest();
+
+	Request->LocalUserIndex = LocalUserIndex;
+	Request->bInvalidateOnCompletion = bInvalidateOnCompletion;
+	Request->GameSessionTemplate = GameSessionTemplate;
+	Request->GameSessionToClaim = GameSessionToClaim;
+
+	SetupFailureDelegate(Request, OnFailedDelegate);
+
+	Request->OnLobbyHandoffCompleted.AddLambda(
+		[OnSucceededDelegate, Request] (const FString& ConnectString)
+		{
+			FEnhancedOnlineHitchScope HitchScope(TEXT("OnLobbyHandoffSucceeded"), Request);
+			HitchScope.SetListener(OnSucceededDelegate);
+
+			if (OnSucceededDelegate.IsBound())
+			{
+				OnSucceededDelegate.Execute(ConnectString);
+			}
+
+			Request->CompleteRequest();
+		});
+
+	return Request;
+}
+
 UEnhancedOnlineRequest_StartSession* UEnhancedSessionsLibrary::ConstructOnlineStartSessionRequest(
 	UObject* WorldContextObject, const bool bInvalidateOnCompletion,
 	FBPOnStartSessionRequestSucceeded OnSucceededDelegate, FBPOnRequestFailedWithLog OnFailedDelegate)
@@ -167,6 +301,9 @@ UEnhancedOnlineRequest_StartSession* UEnhancedSessionsLibrary::ConstructOnlineSt
 	Request->OnStartSessionCompleted.AddLambda(
 		[OnSucceededDelegate, Request] (FName SessionName, bool bWasSuccessful)
 		{
+			FEnhancedOnlineHitchScope HitchScope(TEXT("OnStartSessionSucceeded"), Request);
+			HitchScope.SetListener(OnSucceededDelegate);
+
 			if (OnSucceededDelegate.IsBound())
 			{
 				OnSucceededDelegate.Execute(SessionName);
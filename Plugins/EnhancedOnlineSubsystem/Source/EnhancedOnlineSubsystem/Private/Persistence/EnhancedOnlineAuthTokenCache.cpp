@@ -0,0 +1,131 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineAuthTokenCache.h"
+
+#include "EnhancedOnlineSubsystem.h"
+#include "HAL/FileManager.h"
+#include "Misc/AES.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace EnhancedOnlineAuthTokenCache
+{
+	static constexpr uint32 FileMagic = 0x454F4154; // 'EOAT'
+	static constexpr int32 FileVersion = 1;
+
+	/**
+	 * Derives a key that is bound to this machine and project, so the file is useless when copied elsewhere.
+	 * Anyone on the same machine can derive it too, see FEnhancedOnlineAuthTokenCache.
+	 */
+	static FAESKey MakeKey()
+	{
+		const FString Seed = FString::Printf(TEXT("%s|%s|EnhancedOnlineAuthTokenCache"), *FPlatformMisc::GetLoginId(), FApp::GetProjectName());
+		const FTCHARToUTF8 SeedUtf8(*Seed);
+
+		uint8 FirstHash[FSHA1::DigestSize];
+		FSHA1::HashBuffer(SeedUtf8.Get(), SeedUtf8.Length(), FirstHash);
+
+		uint8 SecondHash[FSHA1::DigestSize];
+		FSHA1::HashBuffer(FirstHash, sizeof(FirstHash), SecondHash);
+
+		FAESKey Key;
+		FMemory::Memcpy(Key.Key, FirstHash, FSHA1::DigestSize);
+		FMemory::Memcpy(Key.Key + FSHA1::DigestSize, SecondHash, FAESKey::KeySize - FSHA1::DigestSize);
+		return Key;
+	}
+}
+
+FString FEnhancedOnlineAuthTokenCache::GetCacheFilePath(int32 LocalUserIndex)
+{
+	return FPaths::ProjectSavedDir() / TEXT("EnhancedOnline") / FString::Printf(TEXT("AuthToken_%d.bin"), LocalUserIndex);
+}
+
+bool FEnhancedOnlineAuthTokenCache::Load(int32 LocalUserIndex, FEnhancedOnlineCachedAuthToken& OutToken)
+{
+	using namespace EnhancedOnlineAuthTokenCache;
+
+	TArray<uint8> FileData;
+	if (!FFileHelper::LoadFileToArray(FileData, *GetCacheFilePath(LocalUserIndex), FILEREAD_Silent))
+	{
+		return false;
+	}
+
+	FMemoryReader FileReader(FileData);
+
+	uint32 Magic = 0;
+	int32 Version = 0;
+	int32 PayloadSize = 0;
+	FileReader << Magic << Version << PayloadSize;
+
+	const int32 EncryptedSize = FileData.Num() - static_cast<int32>(FileReader.Tell());
+	if (FileReader.IsError() || Magic != FileMagic || Version != FileVersion
+		|| PayloadSize <= 0 || EncryptedSize < PayloadSize || EncryptedSize % static_cast<int32>(FAES::AESBlockSize) != 0)
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Discarding invalid auth token cache for local user %d."), LocalUserIndex);
+		Clear(LocalUserIndex);
+		return false;
+	}
+
+	TArray<uint8> Payload(FileData.GetData() + FileReader.Tell(), EncryptedSize);
+	FAES::DecryptData(Payload.GetData(), Payload.Num(), MakeKey());
+	Payload.SetNum(PayloadSize);
+
+	FMemoryReader PayloadReader(Payload);
+
+	uint32 PayloadMagic = 0;
+	uint8 AuthType = 0;
+	PayloadReader << PayloadMagic << AuthType << OutToken.UserId << OutToken.Token;
+
+	if (PayloadReader.IsError() || PayloadMagic != FileMagic)
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Failed to decrypt auth token cache for local user %d."), LocalUserIndex);
+		Clear(LocalUserIndex);
+		return false;
+	}
+
+	OutToken.AuthType = static_cast<EEnhancedLoginAuthType>(AuthType);
+	return OutToken.AuthType == EEnhancedLoginAuthType::PersistentAuth || OutToken.AuthType == EEnhancedLoginAuthType::RefreshToken;
+}
+
+bool FEnhancedOnlineAuthTokenCache::Save(int32 LocalUserIndex, const FEnhancedOnlineCachedAuthToken& Token)
+{
+	using namespace EnhancedOnlineAuthTokenCache;
+
+	TArray<uint8> Payload;
+	FMemoryWriter PayloadWriter(Payload);
+
+	uint32 PayloadMagic = FileMagic;
+	uint8 AuthType = static_cast<uint8>(Token.AuthType);
+	FString UserId = Token.UserId;
+	FString TokenString = Token.Token;
+	PayloadWriter << PayloadMagic << AuthType << UserId << TokenString;
+
+	int32 PayloadSize = Payload.Num();
+	Payload.SetNumZeroed(Align(PayloadSize, FAES::AESBlockSize));
+	FAES::EncryptData(Payload.GetData(), Payload.Num(), MakeKey());
+
+	TArray<uint8> FileData;
+	FMemoryWriter FileWriter(FileData);
+
+	uint32 Magic = FileMagic;
+	int32 Version = FileVersion;
+	FileWriter << Magic << Version << PayloadSize;
+	FileWriter.Serialize(Payload.GetData(), Payload.Num());
+
+	if (!FFileHelper::SaveArrayToFile(FileData, *GetCacheFilePath(LocalUserIndex)))
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Failed to write auth token cache for local user %d."), LocalUserIndex);
+		return false;
+	}
+
+	return true;
+}
+
+void FEnhancedOnlineAuthTokenCache::Clear(int32 LocalUserIndex)
+{
+	IFileManager::Get().Delete(*GetCacheFilePath(LocalUserIndex), false, false, true);
+}
@@ -0,0 +1,46 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnhancedOnlineTypes.h"
+
+/**
+ * Credentials that can be used to log a user back in without any user interaction
+ */
+struct FEnhancedOnlineCachedAuthToken
+{
+	/** The type of authentication the token is valid for, either PersistentAuth or RefreshToken */
+	EEnhancedLoginAuthType AuthType = EEnhancedLoginAuthType::PersistentAuth;
+
+	/** The user id the token belongs to */
+	FString UserId;
+
+	/** The token itself, empty for PersistentAuth since the platform keeps that one */
+	FString Token;
+};
+
+/**
+ * Local, machine-bound cache for login tokens, stored per local user in Saved/EnhancedOnline/
+ *
+ * This is obfuscation, not encryption: the AES key is derived from the login id of the machine and the project name,
+ * both of which anyone with access to the machine can read. It keeps the token out of plain sight and makes a copied
+ * file useless on another machine, but it does not protect the token from a local attacker and the file carries no MAC.
+ * Platforms that need real protection should keep the refresh token in their own secure storage and disable
+ * EnhancedOnline.Identity.AutoLogin.
+ */
+class FEnhancedOnlineAuthTokenCache
+{
+public:
+	/** Returns true if a cached token for the local user could be read and deobfuscated */
+	static bool Load(int32 LocalUserIndex, FEnhancedOnlineCachedAuthToken& OutToken);
+
+	/** Obfuscates and writes the token for the local user, replacing any previous one */
+	static bool Save(int32 LocalUserIndex, const FEnhancedOnlineCachedAuthToken& Token);
+
+	/** Deletes the cached token of the local user */
+	static void Clear(int32 LocalUserIndex);
+
+private:
+	static FString GetCacheFilePath(int32 LocalUserIndex);
+};
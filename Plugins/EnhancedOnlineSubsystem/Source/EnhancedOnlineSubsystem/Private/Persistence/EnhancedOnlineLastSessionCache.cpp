@@ -0,0 +1,135 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineLastSessionCache.h"
+
+#include "EnhancedOnlineSubsystem.h"
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace EnhancedOnlineLastSessionCache
+{
+	static constexpr uint32 FileMagic = 0x454F4C53; // 'EOLS'
+	static constexpr int32 FileVersion = 1;
+
+	/** Latest record per local user, ahead of the file while it is written. Unset if the user has none. Only used on the game thread */
+	static TMap<int32, TOptional<FEnhancedOnlineLastSessionRecord>> KnownRecords;
+
+	static uint32 NextWriteSerial = 1;
+
+	/** Serial of the last write per local user, a write that runs late never replaces a newer one */
+	static TMap<int32, uint32> WrittenSerials;
+	static FCriticalSection WriteCriticalSection;
+}
+
+FString FEnhancedOnlineLastSessionCache::GetCacheFilePath(int32 LocalUserIndex)
+{
+	return FPaths::ProjectSavedDir() / TEXT("EnhancedOnline") / FString::Printf(TEXT("LastSession_%d.bin"), LocalUserIndex);
+}
+
+bool FEnhancedOnlineLastSessionCache::Load(int32 LocalUserIndex, FEnhancedOnlineLastSessionRecord& OutRecord)
+{
+	using namespace EnhancedOnlineLastSessionCache;
+
+	if (const TOptional<FEnhancedOnlineLastSessionRecord>* KnownRecord = KnownRecords.Find(LocalUserIndex))
+	{
+		if (KnownRecord->IsSet())
+		{
+			OutRecord = KnownRecord->GetValue();
+		}
+		return KnownRecord->IsSet();
+	}
+
+	TArray<uint8> FileData;
+	if (!FFileHelper::LoadFileToArray(FileData, *GetCacheFilePath(LocalUserIndex), FILEREAD_Silent))
+	{
+		KnownRecords.Add(LocalUserIndex);
+		return false;
+	}
+
+	FMemoryReader FileReader(FileData);
+
+	uint32 Magic = 0;
+	int32 Version = 0;
+	int64 JoinedAtTicks = 0;
+	FileReader << Magic << Version;
+
+	if (!FileReader.IsError() && Magic == FileMagic && Version == FileVersion)
+	{
+		FileReader << OutRecord.SessionId << OutRecord.ConnectString << OutRecord.OwningUserName << OutRecord.SearchKeyword << JoinedAtTicks;
+	}
+
+	if (FileReader.IsError() || Magic != FileMagic || Version != FileVersion || OutRecord.SessionId.IsEmpty())
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Discarding invalid last session record for local user %d."), LocalUserIndex);
+		Clear(LocalUserIndex);
+		return false;
+	}
+
+	OutRecord.JoinedAt = FDateTime(JoinedAtTicks);
+	KnownRecords.Add(LocalUserIndex, OutRecord);
+	return true;
+}
+
+void FEnhancedOnlineLastSessionCache::Save(int32 LocalUserIndex, const FEnhancedOnlineLastSessionRecord& Record)
+{
+	using namespace EnhancedOnlineLastSessionCache;
+
+	KnownRecords.Add(LocalUserIndex, Record);
+
+	TArray<uint8> FileData;
+	FMemoryWriter FileWriter(FileData);
+
+	uint32 Magic = FileMagic;
+	int32 Version = FileVersion;
+	FString SessionId = Record.SessionId;
+	FString ConnectString = Record.ConnectString;
+	FString OwningUserName = Record.OwningUserName;
+	FString SearchKeyword = Record.SearchKeyword;
+	int64 JoinedAtTicks = Record.JoinedAt.GetTicks();
+	FileWriter << Magic << Version << SessionId << ConnectString << OwningUserName << SearchKeyword << JoinedAtTicks;
+
+	WriteAsync(LocalUserIndex, MoveTemp(FileData));
+}
+
+void FEnhancedOnlineLastSessionCache::Clear(int32 LocalUserIndex)
+{
+	using namespace EnhancedOnlineLastSessionCache;
+
+	KnownRecords.Add(LocalUserIndex);
+	WriteAsync(LocalUserIndex, TArray<uint8>());
+}
+
+void FEnhancedOnlineLastSessionCache::WriteAsync(int32 LocalUserIndex, TArray<uint8>&& FileData)
+{
+	using namespace EnhancedOnlineLastSessionCache;
+
+	// Joins complete on the game thread, only the record is built there
+	Async(EAsyncExecution::ThreadPool, [LocalUserIndex, Serial = NextWriteSerial++, FilePath = GetCacheFilePath(LocalUserIndex), FileData = MoveTemp(FileData)]()
+	{
+		FScopeLock Lock(&WriteCriticalSection);
+
+		uint32& WrittenSerial = WrittenSerials.FindOrAdd(LocalUserIndex);
+		if (Serial < WrittenSerial)
+		{
+			return;
+		}
+		WrittenSerial = Serial;
+
+		if (FileData.Num() == 0)
+		{
+			IFileManager::Get().Delete(*FilePath, false, false, true);
+			return;
+		}
+
+		// Written next to the record and moved over it, a crash mid-write leaves the previous record intact
+		const FString TempFilePath = FilePath + TEXT(".tmp");
+		if (!FFileHelper::SaveArrayToFile(FileData, *TempFilePath) || !IFileManager::Get().Move(*FilePath, *TempFilePath, true, true))
+		{
+			UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Failed to write last session record for local user %d."), LocalUserIndex);
+		}
+	});
+}
@@ -0,0 +1,49 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * The game session a local user joined last, enough to get back into it after a disconnect or a crash
+ */
+struct FEnhancedOnlineLastSessionRecord
+{
+	/** Backend session id */
+	FString SessionId;
+
+	/** The address that was resolved when the session was joined */
+	FString ConnectString;
+
+	/** Name of the session owner, used to recognize the session if its id changed */
+	FString OwningUserName;
+
+	/** The keyword the session was advertised with, narrows the fallback search */
+	FString SearchKeyword;
+
+	/** When the session was joined */
+	FDateTime JoinedAt;
+};
+
+/**
+ * Record of the last joined session, written as soon as the join succeeds so it survives a crash
+ * Stored per local user in Saved/EnhancedOnline/, the files are written on worker threads
+ */
+class FEnhancedOnlineLastSessionCache
+{
+public:
+	/** Returns true if a record for the local user could be read, the file is only read once per run */
+	static bool Load(int32 LocalUserIndex, FEnhancedOnlineLastSessionRecord& OutRecord);
+
+	/** Replaces the record of the local user, the file is written in the background */
+	static void Save(int32 LocalUserIndex, const FEnhancedOnlineLastSessionRecord& Record);
+
+	/** Deletes the record of the local user */
+	static void Clear(int32 LocalUserIndex);
+
+private:
+	static FString GetCacheFilePath(int32 LocalUserIndex);
+
+	/** Writes the file of the local user on a worker thread, empty data deletes it */
+	static void WriteAsync(int32 LocalUserIndex, TArray<uint8>&& FileData);
+};
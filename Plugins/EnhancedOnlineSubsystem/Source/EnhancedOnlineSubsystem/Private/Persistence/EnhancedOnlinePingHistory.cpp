@@ -0,0 +1,268 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlinePingHistory.h"
+
+#include "EnhancedOnlineSubsystem.h"
+#include "OnlineSessionSettings.h"
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+static TAutoConsoleVariable<float> CVarEnhancedPingSmoothingFactor(
+	TEXT("EnhancedOnline.Ping.SmoothingFactor"),
+	0.25f,
+	TEXT("How much a single ping sample moves the average of its host, between 0 and 1. Search pings count half."));
+
+static TAutoConsoleVariable<float> CVarEnhancedPingHalfLifeHours(
+	TEXT("EnhancedOnline.Ping.HalfLifeHours"),
+	72.0f,
+	TEXT("The confidence in the ping history of a host halves every this many hours without a sample. 0 never ages the history."));
+
+static TAutoConsoleVariable<int32> CVarEnhancedPingMaxHosts(
+	TEXT("EnhancedOnline.Ping.MaxHosts"),
+	256,
+	TEXT("Maximum number of hosts in the ping history, the ones sampled longest ago are dropped first."));
+
+namespace EnhancedOnlinePingHistory
+{
+	static constexpr uint32 FileMagic = 0x454F5048; // 'EOPH'
+	static constexpr int32 FileVersion = 1;
+
+	/** The sample weight is capped so a long known host still follows a changed route */
+	static constexpr float MaxSampleWeight = 32.0f;
+
+	static float GetSourceWeight(EEnhancedPingSource Source)
+	{
+		return Source == EEnhancedPingSource::Search ? 0.5f : 1.0f;
+	}
+
+	/** 1 for a fresh entry, falling towards 0 the longer the host wasn't sampled */
+	static float GetAgeFactor(const FEnhancedPingHistoryEntry& Entry)
+	{
+		const float HalfLifeHours = CVarEnhancedPingHalfLifeHours.GetValueOnGameThread();
+		if (HalfLifeHours <= 0.0f)
+		{
+			return 1.0f;
+		}
+
+		const double AgeHours = FMath::Max((FDateTime::UtcNow() - Entry.LastSampleAt).GetTotalHours(), 0.0);
+		return FMath::Exp2(-AgeHours / HalfLifeHours);
+	}
+
+	static FCriticalSection SaveCriticalSection;
+}
+
+FEnhancedOnlinePingHistory::~FEnhancedOnlinePingHistory()
+{
+	WaitForSave();
+}
+
+FString FEnhancedOnlinePingHistory::GetCacheFilePath()
+{
+	return FPaths::ProjectSavedDir() / TEXT("EnhancedOnline") / TEXT("PingHistory.bin");
+}
+
+FString FEnhancedOnlinePingHistory::GetHostKey(const FOnlineSessionSearchResult& SearchResult)
+{
+	// The owner outlives the session, a host that restarts its session keeps its history
+	if (SearchResult.Session.OwningUserId.IsValid())
+	{
+		return SearchResult.Session.OwningUserId->ToString();
+	}
+
+	return SearchResult.GetSessionIdStr();
+}
+
+void FEnhancedOnlinePingHistory::AddSample(const FString& HostKey, float PingMs, EEnhancedPingSource Source)
+{
+	using namespace EnhancedOnlinePingHistory;
+
+	if (HostKey.IsEmpty() || PingMs <= 0.0f || PingMs >= MAX_QUERY_PING)
+	{
+		return;
+	}
+
+	const float SourceWeight = GetSourceWeight(Source);
+
+	FEnhancedPingHistoryEntry* Entry = Entries.Find(HostKey);
+	if (Entry == nullptr)
+	{
+		// Some headroom, so a full history isn't sorted again for every new host
+		const int32 MaxHosts = FMath::Max(CVarEnhancedPingMaxHosts.GetValueOnGameThread(), 0);
+		if (Entries.Num() >= MaxHosts + MaxHosts / 4 + 1)
+		{
+			Prune();
+		}
+
+		Entry = &Entries.Add(HostKey);
+		Entry->SmoothedPingMs = PingMs;
+		Entry->DeviationMs = PingMs * 0.5f;
+	}
+	else
+	{
+		// An old average is worth less than a new sample
+		const float SmoothingFactor = FMath::Clamp(CVarEnhancedPingSmoothingFactor.GetValueOnGameThread(), 0.0f, 1.0f) * SourceWeight;
+		const float Alpha = FMath::Max(SmoothingFactor, 1.0f - GetAgeFactor(*Entry));
+
+		Entry->DeviationMs += Alpha * (FMath::Abs(PingMs - Entry->SmoothedPingMs) - Entry->DeviationMs);
+		Entry->SmoothedPingMs += Alpha * (PingMs - Entry->SmoothedPingMs);
+	}
+
+	Entry->SampleWeight = FMath::Min(Entry->SampleWeight + SourceWeight, MaxSampleWeight);
+	Entry->LastSampleAt = FDateTime::UtcNow();
+	bDirty = true;
+}
+
+bool FEnhancedOnlinePingHistory::GetEstimate(const FString& HostKey, float& OutPingMs, float& OutConfidence) const
+{
+	using namespace EnhancedOnlinePingHistory;
+
+	const FEnhancedPingHistoryEntry* Entry = Entries.Find(HostKey);
+	if (Entry == nullptr)
+	{
+		return false;
+	}
+
+	const float SampleFactor = 1.0f - FMath::Exp(-Entry->SampleWeight / 4.0f);
+	const float StabilityFactor = Entry->SmoothedPingMs / FMath::Max(Entry->SmoothedPingMs + Entry->DeviationMs, UE_KINDA_SMALL_NUMBER);
+
+	OutPingMs = Entry->SmoothedPingMs;
+	OutConfidence = FMath::Clamp(SampleFactor * StabilityFactor * GetAgeFactor(*Entry), 0.0f, 1.0f);
+	return true;
+}
+
+bool FEnhancedOnlinePingHistory::Load()
+{
+	using namespace EnhancedOnlinePingHistory;
+
+	TArray<uint8> FileData;
+	if (!FFileHelper::LoadFileToArray(FileData, *GetCacheFilePath(), FILEREAD_Silent))
+	{
+		return false;
+	}
+
+	FMemoryReader FileReader(FileData);
+
+	uint32 Magic = 0;
+	int32 Version = 0;
+	int32 NumEntries = 0;
+	FileReader << Magic << Version;
+
+	if (!FileReader.IsError() && Magic == FileMagic && Version == FileVersion)
+	{
+		FileReader << NumEntries;
+	}
+
+	if (FileReader.IsError() || Magic != FileMagic || Version != FileVersion || NumEntries < 0)
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Discarding invalid ping history."));
+		IFileManager::Get().Delete(*GetCacheFilePath(), false, false, true);
+		return false;
+	}
+
+	TMap<FString, FEnhancedPingHistoryEntry> LoadedEntries;
+	LoadedEntries.Reserve(NumEntries);
+
+	for (int32 Index = 0; Index < NumEntries && !FileReader.IsError(); ++Index)
+	{
+		FString HostKey;
+		FEnhancedPingHistoryEntry Entry;
+		int64 LastSampleTicks = 0;
+		FileReader << HostKey << Entry.SmoothedPingMs << Entry.DeviationMs << Entry.SampleWeight << LastSampleTicks;
+
+		Entry.LastSampleAt = FDateTime(LastSampleTicks);
+		LoadedEntries.Add(MoveTemp(HostKey), Entry);
+	}
+
+	if (FileReader.IsError())
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Discarding truncated ping history."));
+		return false;
+	}
+
+	Entries = MoveTemp(LoadedEntries);
+	bDirty = false;
+
+	UE_LOG(LogEnhancedSubsystem, Verbose, TEXT("Loaded the ping history of %d hosts."), Entries.Num());
+	return true;
+}
+
+void FEnhancedOnlinePingHistory::Save()
+{
+	using namespace EnhancedOnlinePingHistory;
+
+	if (!bDirty)
+	{
+		return;
+	}
+
+	Prune();
+
+	TArray<uint8> FileData;
+	FMemoryWriter FileWriter(FileData);
+
+	uint32 Magic = FileMagic;
+	int32 Version = FileVersion;
+	int32 NumEntries = Entries.Num();
+	FileWriter << Magic << Version << NumEntries;
+
+	for (const TPair<FString, FEnhancedPingHistoryEntry>& Pair : Entries)
+	{
+		FString HostKey = Pair.Key;
+		FEnhancedPingHistoryEntry Entry = Pair.Value;
+		int64 LastSampleTicks = Entry.LastSampleAt.GetTicks();
+		FileWriter << HostKey << Entry.SmoothedPingMs << Entry.DeviationMs << Entry.SampleWeight << LastSampleTicks;
+	}
+
+	bDirty = false;
+
+	// Only the file write leaves the game thread
+	PendingSave = Async(EAsyncExecution::ThreadPool, [FilePath = GetCacheFilePath(), FileData = MoveTemp(FileData)]()
+	{
+		FScopeLock Lock(&SaveCriticalSection);
+
+		// Written next to the history and moved over it, a crash mid-write leaves the previous history intact
+		const FString TempFilePath = FilePath + TEXT(".tmp");
+		if (!FFileHelper::SaveArrayToFile(FileData, *TempFilePath) || !IFileManager::Get().Move(*FilePath, *TempFilePath, true, true))
+		{
+			UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Failed to write the ping history."));
+		}
+	});
+}
+
+void FEnhancedOnlinePingHistory::WaitForSave()
+{
+	if (PendingSave.IsValid())
+	{
+		PendingSave.Wait();
+		PendingSave.Reset();
+	}
+}
+
+void FEnhancedOnlinePingHistory::Prune()
+{
+	const int32 MaxHosts = FMath::Max(CVarEnhancedPingMaxHosts.GetValueOnGameThread(), 0);
+	if (Entries.Num() <= MaxHosts)
+	{
+		return;
+	}
+
+	Entries.ValueSort([](const FEnhancedPingHistoryEntry& A, const FEnhancedPingHistoryEntry& B)
+	{
+		return A.LastSampleAt > B.LastSampleAt;
+	});
+
+	int32 Index = 0;
+	for (auto It = Entries.CreateIterator(); It; ++It)
+	{
+		if (Index++ >= MaxHosts)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	Entries.Compact();
+}
@@ -0,0 +1,91 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+
+class FOnlineSessionSearchResult;
+
+/**
+ * Where a ping sample was measured, decides how much it moves the average
+ */
+enum class EEnhancedPingSource : uint8
+{
+	/** Ping reported by the backend with a search result, coarse and often bucketed */
+	Search,
+
+	/** Round trip of a request to the host, e.g. the slot reservation */
+	Probe,
+
+	/** Latency of the game connection after joining */
+	Connection,
+};
+
+/**
+ * Exponentially weighted round trip time of a single host
+ */
+struct FEnhancedPingHistoryEntry
+{
+	/** Weighted average of the samples */
+	float SmoothedPingMs = 0.0f;
+
+	/** Weighted average of the distance of the samples to the average */
+	float DeviationMs = 0.0f;
+
+	/** Sum of the weights of all samples, capped */
+	float SampleWeight = 0.0f;
+
+	/** When the last sample was added */
+	FDateTime LastSampleAt;
+};
+
+/**
+ * Round trip times per host, kept between searches and between runs
+ * Stored in Saved/EnhancedOnline/
+ */
+class FEnhancedOnlinePingHistory
+{
+public:
+	~FEnhancedOnlinePingHistory();
+
+	/** Returns the key a host is tracked under, its owner id if it has one */
+	static FString GetHostKey(const FOnlineSessionSearchResult& SearchResult);
+
+	/** Folds a sample into the average of the host, invalid pings are ignored. Drops the oldest hosts once there are too many */
+	void AddSample(const FString& HostKey, float PingMs, EEnhancedPingSource Source);
+
+	/**
+	 * Returns the smoothed ping of a host.
+	 * @param OutPingMs			The smoothed ping
+	 * @param OutConfidence		Between 0 and 1, rises with the number of samples and drops with their spread and age
+	 * @return False if nothing is known about the host
+	 */
+	bool GetEstimate(const FString& HostKey, float& OutPingMs, float& OutConfidence) const;
+
+	/** Number of hosts with a history */
+	int32 Num() const { return Entries.Num(); }
+
+	/** Reads the history written by the last run, returns false if there is none */
+	bool Load();
+
+	/** Writes the history on a worker thread if samples were added since it was last written */
+	void Save();
+
+	/** Blocks until the last write finished, so a history saved on shutdown isn't lost */
+	void WaitForSave();
+
+private:
+	static FString GetCacheFilePath();
+
+	/** Drops the hosts that were sampled longest ago until the history fits EnhancedOnline.Ping.MaxHosts */
+	void Prune();
+
+	/** The write started by the last save */
+	TFuture<void> PendingSave;
+
+	TMap<FString, FEnhancedPingHistoryEntry> Entries;
+
+	/** Whether samples were added since the history was last written */
+	bool bDirty = false;
+};
@@ -0,0 +1,198 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineServerListCache.h"
+
+#include "EnhancedOnlineSubsystem.h"
+#include "EnhancedOnlineVariantSerialization.h"
+#include "Async/Async.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+static TAutoConsoleVariable<int32> CVarEnhancedServerListMaxCachedSessions(
+	TEXT("EnhancedOnline.ServerList.MaxCachedSessions"),
+	500,
+	TEXT("Maximum number of sessions persisted as the last known server list. 0 disables the snapshot."));
+
+namespace EnhancedOnlineServerListCache
+{
+	static constexpr uint32 FileMagic = 0x454F534C; // 'EOSL'
+	static constexpr int32 FileVersion = 2;
+
+	/** Writes everything that is needed to display a session */
+	static void WriteSearchResult(FArchive& Ar, const FOnlineSessionSearchResult& SearchResult)
+	{
+		const FOnlineSession& Session = SearchResult.Session;
+		const FOnlineSessionSettings& Settings = Session.SessionSettings;
+
+		FString SessionId = SearchResult.GetSessionIdStr();
+		FString OwningUserName = Session.OwningUserName;
+		int32 NumPublicConnections = Settings.NumPublicConnections;
+		int32 NumPrivateConnections = Settings.NumPrivateConnections;
+		int32 NumOpenPublicConnections = Session.NumOpenPublicConnections;
+		int32 NumOpenPrivateConnections = Session.NumOpenPrivateConnections;
+		int32 PingInMs = SearchResult.PingInMs;
+		int32 NumSettings = Settings.Settings.Num();
+
+		Ar << SessionId << OwningUserName;
+		Ar << NumPublicConnections << NumPrivateConnections << NumOpenPublicConnections << NumOpenPrivateConnections;
+		Ar << PingInMs << NumSettings;
+
+		for (const TPair<FName, FOnlineSessionSetting>& Setting : Settings.Settings)
+		{
+			FName Key = Setting.Key;
+			Ar << Key;
+			EnhancedOnlineVariantSerialization::WriteVariantData(Ar, Setting.Value.Data);
+		}
+	}
+
+	/** Reads a session written by WriteSearchResult, settings keep the type they were written with */
+	static void ReadSearchResult(FArchive& Ar, FString& OutSessionId, FOnlineSessionSearchResult& OutSearchResult)
+	{
+		FOnlineSession& Session = OutSearchResult.Session;
+		FOnlineSessionSettings& Settings = Session.SessionSettings;
+
+		int32 NumSettings = 0;
+
+		Ar << OutSessionId << Session.OwningUserName;
+		Ar << Settings.NumPublicConnections << Settings.NumPrivateConnections << Session.NumOpenPublicConnections << Session.NumOpenPrivateConnections;
+		Ar << OutSearchResult.PingInMs << NumSettings;
+
+		for (int32 Index = 0; Index < NumSettings && !Ar.IsError(); ++Index)
+		{
+			FName Key;
+			Ar << Key;
+
+			FOnlineSessionSetting& Setting = Settings.Settings.Add(Key);
+			Setting.AdvertisementType = EOnlineDataAdvertisementType::ViaOnlineService;
+			EnhancedOnlineVariantSerialization::ReadVariantData(Ar, Setting.Data);
+		}
+	}
+
+	/** Used when the platform can't map files */
+	static bool LoadWithoutMapping(const FString& FilePath, TArray<uint8>& OutFileData)
+	{
+		return FFileHelper::LoadFileToArray(OutFileData, *FilePath, FILEREAD_Silent);
+	}
+
+	static FCriticalSection SaveCriticalSection;
+}
+
+FString FEnhancedOnlineServerListCache::GetCacheFilePath()
+{
+	return FPaths::ProjectSavedDir() / TEXT("EnhancedOnline") / TEXT("ServerList.bin");
+}
+
+bool FEnhancedOnlineServerListCache::Load(FEnhancedOnlineServerListSnapshot& OutSnapshot)
+{
+	using namespace EnhancedOnlineServerListCache;
+
+	const FString FilePath = GetCacheFilePath();
+
+	TUniquePtr<IMappedFileHandle> MappedFile(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*FilePath));
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	TArray<uint8> FileData;
+	TArrayView<const uint8> FileView;
+
+	if (MappedFile.IsValid() && MappedFile->GetFileSize() > 0)
+	{
+		MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+	}
+
+	if (MappedRegion.IsValid())
+	{
+		FileView = MakeArrayView(MappedRegion->GetMappedPtr(), static_cast<int32>(MappedRegion->GetMappedSize()));
+	}
+	else if (LoadWithoutMapping(FilePath, FileData))
+	{
+		FileView = FileData;
+	}
+	else
+	{
+		return false;
+	}
+
+	FMemoryReaderView Reader(FileView);
+
+	uint32 Magic = 0;
+	int32 Version = 0;
+	int64 SavedAtTicks = 0;
+	int32 NumSessions = 0;
+	Reader << Magic << Version << SavedAtTicks << NumSessions;
+
+	// Every session takes at least a few bytes, anything above that is a corrupt count
+	if (Reader.IsError() || Magic != FileMagic || Version != FileVersion || NumSessions < 0 || NumSessions > FileView.Num())
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Discarding invalid server list snapshot."));
+
+		MappedRegion.Reset();
+		MappedFile.Reset();
+		Clear();
+		return false;
+	}
+
+	OutSnapshot.SavedAt = FDateTime(SavedAtTicks);
+	OutSnapshot.SessionIds.SetNum(NumSessions);
+	OutSnapshot.SearchResults.SetNum(NumSessions);
+
+	for (int32 Index = 0; Index < NumSessions && !Reader.IsError(); ++Index)
+	{
+		ReadSearchResult(Reader, OutSnapshot.SessionIds[Index], OutSnapshot.SearchResults[Index]);
+	}
+
+	if (Reader.IsError())
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Server list snapshot is truncated, discarding it."));
+		OutSnapshot = FEnhancedOnlineServerListSnapshot();
+		return false;
+	}
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Loaded %d sessions from the server list snapshot of %s."), NumSessions, *OutSnapshot.SavedAt.ToString());
+	return true;
+}
+
+void FEnhancedOnlineServerListCache::Save(const TArray<FOnlineSessionSearchResult>& SearchResults)
+{
+	using namespace EnhancedOnlineServerListCache;
+
+	const int32 MaxSessions = CVarEnhancedServerListMaxCachedSessions.GetValueOnGameThread();
+	if (MaxSessions <= 0)
+	{
+		return;
+	}
+
+	TArray<uint8> FileData;
+	FMemoryWriter Writer(FileData);
+
+	uint32 Magic = FileMagic;
+	int32 Version = FileVersion;
+	int64 SavedAtTicks = FDateTime::UtcNow().GetTicks();
+	int32 NumSessions = FMath::Min(SearchResults.Num(), MaxSessions);
+	Writer << Magic << Version << SavedAtTicks << NumSessions;
+
+	for (int32 Index = 0; Index < NumSessions; ++Index)
+	{
+		WriteSearchResult(Writer, SearchResults[Index]);
+	}
+
+	// Only the file write leaves the game thread
+	Async(EAsyncExecution::ThreadPool, [FilePath = GetCacheFilePath(), FileData = MoveTemp(FileData)]()
+	{
+		FScopeLock Lock(&SaveCriticalSection);
+
+		const FString TempFilePath = FilePath + TEXT(".tmp");
+		if (!FFileHelper::SaveArrayToFile(FileData, *TempFilePath) || !IFileManager::Get().Move(*FilePath, *TempFilePath, true, true))
+		{
+			UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Failed to write the server list snapshot."));
+		}
+	});
+}
+
+void FEnhancedOnlineServerListCache::Clear()
+{
+	IFileManager::Get().Delete(*GetCacheFilePath(), false, false, true);
+}
@@ -0,0 +1,41 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OnlineSessionSettings.h"
+
+/**
+ * The last known server list, good enough to be displayed but not to be joined
+ */
+struct FEnhancedOnlineServerListSnapshot
+{
+	/** When the snapshot was written */
+	FDateTime SavedAt;
+
+	/** Backend session ids, parallel to the search results */
+	TArray<FString> SessionIds;
+
+	/** Search results without any backend session info */
+	TArray<FOnlineSessionSearchResult> SearchResults;
+};
+
+/**
+ * Versioned binary snapshot of the most recent session search
+ * Stored in Saved/EnhancedOnline/
+ */
+class FEnhancedOnlineServerListCache
+{
+public:
+	/** Reads the snapshot through a memory mapped file, returns false if there is none */
+	static bool Load(FEnhancedOnlineServerListSnapshot& OutSnapshot);
+
+	/** Serializes the search results and writes them on a worker thread, replacing the previous snapshot */
+	static void Save(const TArray<FOnlineSessionSearchResult>& SearchResults);
+
+	/** Deletes the snapshot */
+	static void Clear();
+
+private:
+	static FString GetCacheFilePath();
+};
@@ -0,0 +1,175 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineSessionsSubsystem.h"
+
+#include "EnhancedOnlineHitchDetector.h"
+#include "EnhancedOnlineSubsystem.h"
+#include "OnlineSessionSettings.h"
+#include "TimerManager.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GameFramework/GameMode.h"
+#include "Online/OnlineSessionNames.h"
+
+static TAutoConsoleVariable<float> CVarEnhancedDedicatedHeartbeatInterval(
+	TEXT("EnhancedOnline.Dedicated.HeartbeatInterval"),
+	15.0f,
+	TEXT("Interval in seconds at which a dedicated server pushes changed player count, map and match state through UpdateSession."));
+
+void UEnhancedOnlineSessionsSubsystem::MarkDedicatedSessionDirty()
+{
+	bDedicatedSessionDirty = true;
+}
+
+void UEnhancedOnlineSessionsSubsystem::StartDedicatedSessionHeartbeat(FName SessionName)
+{
+	StopDedicatedSessionHeartbeat();
+
+	DedicatedSessionName = SessionName;
+	AdvertisedDedicatedState = FEnhancedDedicatedSessionAdvertisement();
+	bDedicatedSessionDirty = false;
+
+	const float Interval = FMath::Max(1.0f, CVarEnhancedDedicatedHeartbeatInterval.GetValueOnGameThread());
+	GetGameInstance()->GetTimerManager().SetTimer(DedicatedHeartbeatTimerHandle, this, &ThisClass::TickDedicatedSessionHeartbeat, Interval, true);
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Started dedicated session heartbeat for %s every %.1f seconds."), *SessionName.ToString(), Interval);
+}
+
+void UEnhancedOnlineSessionsSubsystem::StopDedicatedSessionHeartbeat()
+{
+	if (UGameInstance* GameInstance = GetGameInstance())
+	{
+		GameInstance->GetTimerManager().ClearTimer(DedicatedHeartbeatTimerHandle);
+	}
+
+	if (UpdateSessionDelegateHandle.IsValid())
+	{
+		if (IOnlineSessionPtr Sessions = GetOnlineInterfaces().Sessions)
+		{
+			Sessions->ClearOnUpdateSessionCompleteDelegate_Handle(UpdateSessionDelegateHandle);
+		}
+		UpdateSessionDelegateHandle.Reset();
+	}
+
+	DedicatedSessionName = NAME_None;
+	bDedicatedUpdateInFlight = false;
+}
+
+void UEnhancedOnlineSessionsSubsystem::GatherDedicatedSessionAdvertisement(FEnhancedDedicatedSessionAdvertisement& OutAdvertisement) const
+{
+	const UWorld* World = GetWorld();
+	if (World == nullptr)
+	{
+		return;
+	}
+
+	OutAdvertisement.MapName = UWorld::RemovePIEPrefix(World->GetMapName());
+
+	if (const AGameModeBase* GameMode = World->GetAuthGameMode())
+	{
+		OutAdvertisement.NumPlayers = GameMode->GetNumPlayers();
+
+		if (const AGameMode* MatchGameMode = Cast<AGameMode>(GameMode))
+		{
+			OutAdvertisement.MatchState = MatchGameMode->GetMatchState();
+		}
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::TickDedicatedSessionHeartbeat()
+{
+	if (DedicatedSessionName.IsNone() || bDedicatedUpdateInFlight)
+	{
+		return;
+	}
+
+	IOnlineSessionPtr Sessions = GetOnlineInterfaces().Sessions;
+	if (!Sessions.IsValid())
+	{
+		return;
+	}
+
+	FOnlineSessionSettings* CurrentSettings = Sessions->GetSessionSettings(DedicatedSessionName);
+	if (CurrentSettings == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Dedicated session %s no longer exists, stopping heartbeat."), *DedicatedSessionName.ToString());
+		StopDedicatedSessionHeartbeat();
+		return;
+	}
+
+	FEnhancedDedicatedSessionAdvertisement Current;
+	GatherDedicatedSessionAdvertisement(Current);
+
+	// Only touch the settings that actually changed since the last accepted update
+	FOnlineSessionSettings UpdatedSettings = *CurrentSettings;
+	int32 NumChanges = 0;
+
+	if (Current.NumPlayers != AdvertisedDedicatedState.NumPlayers)
+	{
+		UpdatedSettings.Set(SETTING_NUMPLAYERS, Current.NumPlayers, EOnlineDataAdvertisementType::ViaOnlineService);
+		++NumChanges;
+	}
+
+	if (Current.MapName != AdvertisedDedicatedState.MapName)
+	{
+		UpdatedSettings.Set(SETTING_MAPNAME, Current.MapName, EOnlineDataAdvertisementType::ViaOnlineService);
+		++NumChanges;
+	}
+
+	if (Current.MatchState != AdvertisedDedicatedState.MatchState)
+	{
+		UpdatedSettings.Set(SETTING_MATCHSTATE, Current.MatchState.ToString(), EOnlineDataAdvertisementType::ViaOnlineService);
+		++NumChanges;
+	}
+
+	if (NumChanges == 0 && !bDedicatedSessionDirty)
+	{
+		return;
+	}
+
+	bDedicatedSessionDirty = false;
+	bDedicatedUpdateInFlight = true;
+	InFlightDedicatedState = Current;
+
+	UpdateSessionDelegateHandle = Sessions->AddOnUpdateSessionCompleteDelegate_Handle(FOnUpdateSessionCompleteDelegate::CreateUObject(this, &ThisClass::HandleUpdateDedicatedSessionComplete));
+
+	UE_LOG(LogEnhancedSubsystem, Verbose, TEXT("Updating dedicated session %s: %d players, map %s, match state %s."),
+		*DedicatedSessionName.ToString(), Current.NumPlayers, *Current.MapName, *Current.MatchState.ToString());
+
+	if (!Sessions->UpdateSession(DedicatedSessionName, UpdatedSettings, true))
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Failed to update dedicated session %s."), *DedicatedSessionName.ToString());
+
+		Sessions->ClearOnUpdateSessionCompleteDelegate_Handle(UpdateSessionDelegateHandle);
+		UpdateSessionDelegateHandle.Reset();
+		bDedicatedUpdateInFlight = false;
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleUpdateDedicatedSessionComplete(FName SessionName, bool bWasSuccessful)
+{
+	FEnhancedOnlineHitchScope HitchScope(TEXT("HandleUpdateDedicatedSessionComplete"));
+	MarkStateSnapshotDirty();
+
+	if (SessionName != DedicatedSessionName)
+	{
+		return;
+	}
+
+	if (IOnlineSessionPtr Sessions = GetOnlineInterfaces().Sessions)
+	{
+		Sessions->ClearOnUpdateSessionCompleteDelegate_Handle(UpdateSessionDelegateHandle);
+	}
+	UpdateSessionDelegateHandle.Reset();
+	bDedicatedUpdateInFlight = false;
+
+	if (bWasSuccessful)
+	{
+		AdvertisedDedicatedState = InFlightDedicatedState;
+	}
+	else
+	{
+		// Whatever didn't make it is picked up again by the next heartbeat
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Dedicated session %s update was rejected by the backend."), *SessionName.ToString());
+	}
+}
@@ -0,0 +1,50 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineSessionsSubsystem.h"
+
+#include "Backend/EnhancedOnlineFaultInjector.h"
+
+void UEnhancedOnlineSessionsSubsystem::StartBackendFaults()
+{
+	FaultInjector = FEnhancedOnlineFaultInjector::Create();
+}
+
+void UEnhancedOnlineSessionsSubsystem::StopBackendFaults()
+{
+	FaultInterfaceTable.Reset();
+	FaultInjector.Reset();
+}
+
+void UEnhancedOnlineSessionsSubsystem::WrapFaultInjectedInterfaces(FName SubsystemName, FEnhancedOnlineInterfaceHandles& Handles)
+{
+	if (!FaultInjector.IsValid())
+	{
+		return;
+	}
+
+	// Wraps the traced interfaces, so traces keep the answers as the backend gave them
+	FEnhancedOnlineInterfaceHandles& Faulted = FaultInterfaceTable.FindOrAdd(SubsystemName);
+	if (Faulted.OnlineSub != Handles.OnlineSub)
+	{
+		Faulted = FEnhancedOnlineInterfaceHandles();
+		Faulted.OnlineSub = Handles.OnlineSub;
+
+		if (Handles.Sessions.IsValid())
+		{
+			Faulted.Sessions = MakeShared<FEnhancedOnlineSessionFaultInjector, ESPMode::ThreadSafe>(Handles.Sessions, FaultInjector.ToSharedRef());
+		}
+		if (Handles.Identity.IsValid())
+		{
+			Faulted.Identity = MakeShared<FEnhancedOnlineIdentityFaultInjector, ESPMode::ThreadSafe>(Handles.Identity, FaultInjector.ToSharedRef());
+		}
+	}
+
+	if (Faulted.Sessions.IsValid())
+	{
+		Handles.Sessions = Faulted.Sessions;
+	}
+	if (Faulted.Identity.IsValid())
+	{
+		Handles.Identity = Faulted.Identity;
+	}
+}
@@ -2,9 +2,42 @@
 
 #include "EnhancedOnlineRequests.h"
 #include "EnhancedOnlineSessionsSubsystem.h"
+#include "EnhancedOnlineHitchDetector.h"
 #include "EnhancedOnlineSubsystem.h"
 #include "Kismet/GameplayStatics.h"
 #include "Engine/LocalPlayer.h"
+#include "Interfaces/OnlineIdentityInterface.h"
+#include "Persistence/EnhancedOnlineAuthTokenCache.h"
+
+static TAutoConsoleVariable<bool> CVarEnhancedAutoLogin(
+	TEXT("EnhancedOnline.Identity.AutoLogin"),
+	true,
+	TEXT("Whether to cache persistent auth / refresh tokens and use them to log in while the game is loading."));
+
+static TAutoConsoleVariable<FString> CVarEnhancedAuthRejectionErrors(
+	TEXT("EnhancedOnline.Identity.AuthRejectionErrors"),
+	TEXT("InvalidAuth,InvalidCredentials,InvalidToken,InvalidRefreshToken,Expired,AccessDenied,InvalidUser"),
+	TEXT("Comma separated parts of backend login errors that mean the cached credentials were rejected. Only those delete the cached token, any other failure keeps it for the next start."));
+
+namespace EnhancedOnlineIdentity
+{
+	/** Whether the backend turned down the credentials themselves, as opposed to e.g. being unreachable */
+	static bool IsAuthRejection(const FString& Error)
+	{
+		TArray<FString> RejectionErrors;
+		CVarEnhancedAuthRejectionErrors.GetValueOnGameThread().ParseIntoArray(RejectionErrors, TEXT(","));
+
+		for (const FString& RejectionError : RejectionErrors)
+		{
+			if (Error.Contains(RejectionError.TrimStartAndEnd()))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+}
 
 void UEnhancedOnlineSessionsSubsystem::LoginOnlineUser(UEnhancedOnlineRequest_LoginUser* Request)
 {
@@ -14,10 +47,19 @@ void UEnhancedOnlineSessionsSubsystem::LoginOnlineUser(UEnhancedOnlineRequest_Lo
 		return;
 	}
 
+	TRACE_ENHANCED_REQUEST_BEGIN(Request);
+
+	if (bAutoLoginPending)
+	{
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Auto login is still running, deferring login request."));
+		DeferredLoginRequests.AddUnique(Request);
+		return;
+	}
+
 	if (IsValid(PendingLoginRequest))
 	{
 		UE_LOG(LogEnhancedSubsystem, Error, TEXT("A login request is already pending."));
-		Request->OnRequestFailedDelegate.Broadcast(TEXT("A login request is already pending."));
+		Request->FailRequest(TEXT("A login request is already pending."));
 		return;
 	}
 
@@ -25,7 +67,7 @@ void UEnhancedOnlineSessionsSubsystem::LoginOnlineUser(UEnhancedOnlineRequest_Lo
 	if (PlayerController == nullptr)
 	{
 		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Login Online User was called with a bad local user index."));
-		Request->OnRequestFailedDelegate.Broadcast(TEXT("Login Online User was called with a bad local user index."));
+		Request->FailRequest(TEXT("Login Online User was called with a bad local user index."));
 		return;
 	}
 
@@ -33,7 +75,7 @@ void UEnhancedOnlineSessionsSubsystem::LoginOnlineUser(UEnhancedOnlineRequest_Lo
 	if (LocalPlayer == nullptr)
 	{
 		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Login Online User was called with a bad local user index: %d."), Request->LocalUserIndex);
-		Request->OnRequestFailedDelegate.Broadcast(FString::Printf(TEXT("Login Online User was called with a bad local user index: %d."), Request->LocalUserIndex));
+		Request->FailRequest(FString::Printf(TEXT("Login Online User was called with a bad local user index: %d."), Request->LocalUserIndex));
 		return;
 	}
 
@@ -45,6 +87,7 @@ void UEnhancedOnlineSessionsSubsystem::LoginOnlineUserInternal(ULocalPlayer* Loc
 	if (Request->Identity->GetLoginStatus(0) == ELoginStatus::LoggedIn)
 	{
 		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Login Online User was called with a user that is already logged in."));
+		TRACE_ENHANCED_REQUEST_END(Request, true, TEXT("Already logged in"));
 		Request->OnUserLoginCompleted.Broadcast(0);
 		return;
 	}
@@ -61,20 +104,106 @@ void UEnhancedOnlineSessionsSubsystem::LoginOnlineUserInternal(ULocalPlayer* Loc
 	Credentials.Token = Request->AuthToken;
 	Credentials.Id = Request->UserId;
 
-	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Logging in user with type: %s, token: %s, id: %s"), *Credentials.Type, *Credentials.Token, *Credentials.Id);
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Logging in user with type: %s, token: %s, id: %s"), *Credentials.Type, Credentials.Token.IsEmpty() ? TEXT("none") : TEXT("<redacted>"), *Credentials.Id);
 
+	TRACE_ENHANCED_REQUEST_DISPATCH(Request, TEXT("Login"), Credentials.Type.Len() + Credentials.Id.Len() + Credentials.Token.Len());
 	if (!Request->Identity->Login(0, Credentials))
 	{
 		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Login Online User failed."));
-		Request->OnRequestFailedDelegate.Broadcast(TEXT("Login Online User failed."));
+
+		Request->Identity->ClearOnLoginCompleteDelegate_Handle(0, LoginDelegateHandle);
+		LoginDelegateHandle.Reset();
+		PendingLoginRequest = nullptr;
+
+		Request->FailRequest(TEXT("Login Online User failed."));
 		Request->InvalidateRequest();
 	}
 }
 
+void UEnhancedOnlineSessionsSubsystem::StartAutoLogin()
+{
+	if (!CVarEnhancedAutoLogin.GetValueOnGameThread() || IsRunningDedicatedServer())
+	{
+		return;
+	}
+
+	FEnhancedOnlineCachedAuthToken CachedToken;
+	if (!FEnhancedOnlineAuthTokenCache::Load(0, CachedToken))
+	{
+		return;
+	}
+
+	IOnlineIdentityPtr Identity = GetOnlineInterfaces().Identity;
+	if (!Identity.IsValid() || Identity->GetLoginStatus(0) == ELoginStatus::LoggedIn)
+	{
+		return;
+	}
+
+	UEnhancedOnlineRequest_LoginUser* Request = NewObject<UEnhancedOnlineRequest_LoginUser>(this);
+	Request->ConstructRequest();
+
+	Request->AuthType = CachedToken.AuthType;
+	Request->UserId = CachedToken.UserId;
+	Request->AuthToken = CachedToken.Token;
+	Request->LocalUserIndex = 0;
+	Request->bInvalidateOnCompletion = true;
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Starting auto login with cached credentials."));
+
+	bAutoLoginPending = true;
+	TRACE_ENHANCED_REQUEST_BEGIN(Request);
+	LoginOnlineUserInternal(nullptr, Request);
+
+	// Login could not even be started, the token is kept since the backend never saw it
+	if (PendingLoginRequest != Request)
+	{
+		bAutoLoginPending = false;
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::CacheLoginCredentials(int32 LocalUserNum, const FUniqueNetId& UserId, EEnhancedLoginAuthType AuthType)
+{
+	if (!CVarEnhancedAutoLogin.GetValueOnGameThread())
+	{
+		return;
+	}
+
+	IOnlineIdentityPtr Identity = GetOnlineInterfaces().Identity;
+	if (!Identity.IsValid())
+	{
+		return;
+	}
+
+	FEnhancedOnlineCachedAuthToken CachedToken;
+	CachedToken.UserId = UserId.ToString();
+
+	FString RefreshToken;
+	TSharedPtr<FUserOnlineAccount> UserAccount = Identity->GetUserAccount(UserId);
+	if (UserAccount.IsValid() && UserAccount->GetAuthAttribute(AUTH_ATTR_REFRESH_TOKEN, RefreshToken) && !RefreshToken.IsEmpty())
+	{
+		CachedToken.AuthType = EEnhancedLoginAuthType::RefreshToken;
+		CachedToken.Token = RefreshToken;
+	}
+	else if (AuthType == EEnhancedLoginAuthType::AccountPortal || AuthType == EEnhancedLoginAuthType::PersistentAuth)
+	{
+		// The platform keeps the persistent auth itself, we only need to remember to use it
+		CachedToken.AuthType = EEnhancedLoginAuthType::PersistentAuth;
+	}
+	else
+	{
+		return;
+	}
+
+	FEnhancedOnlineAuthTokenCache::Save(LocalUserNum, CachedToken);
+}
+
 void UEnhancedOnlineSessionsSubsystem::HandleLoginComplete(int32 LocalUserNum, bool bWasSuccessful, const FUniqueNetId& UserId, const FString& Error)
 {
-	IOnlineSubsystem* OnlineSub = Online::GetSubsystem(GetWorld());
-	IOnlineIdentityPtr Identity = OnlineSub->GetIdentityInterface();
+	FEnhancedOnlineHitchScope HitchScope(TEXT("HandleLoginComplete"), PendingLoginRequest);
+	TRACE_ENHANCED_REQUEST_CALLBACK(PendingLoginRequest, TEXT("Login"), bWasSuccessful, UserId.IsValid() ? UserId.ToString().Len() : 0);
+	MarkStateSnapshotDirty();
+
+	IOnlineIdentityPtr Identity = GetOnlineInterfaces().Identity;
 
 	if (bWasSuccessful)
 	{
@@ -82,6 +211,7 @@ void UEnhancedOnlineSessionsSubsystem::HandleLoginComplete(int32 LocalUserNum, b
 
 		if (PendingLoginRequest)
 		{
+			CacheLoginCredentials(LocalUserNum, UserId, PendingLoginRequest->AuthType);
 			PendingLoginRequest->OnUserLoginCompleted.Broadcast(LocalUserNum);
 		}
 		else
@@ -95,7 +225,7 @@ void UEnhancedOnlineSessionsSubsystem::HandleLoginComplete(int32 LocalUserNum, b
 
 		if (PendingLoginRequest)
 		{
-			PendingLoginRequest->OnRequestFailedDelegate.Broadcast(Error);
+			PendingLoginRequest->FailRequest(Error);
 		}
 		else
 		{
@@ -106,12 +236,31 @@ void UEnhancedOnlineSessionsSubsystem::HandleLoginComplete(int32 LocalUserNum, b
 	Identity->ClearOnLoginCompleteDelegate_Handle(LocalUserNum, LoginDelegateHandle);
 	LoginDelegateHandle.Reset();
 
-	if (PendingSessionRequest)
+	if (PendingLoginRequest)
 	{
 		PendingLoginRequest->CompleteRequest();
 	}
 
-	PendingSessionRequest = nullptr;
+	PendingLoginRequest = nullptr;
+
+	if (bAutoLoginPending)
+	{
+		bAutoLoginPending = false;
+
+		// A backend that is down or unreachable doesn't make the token invalid
+		if (!bWasSuccessful && EnhancedOnlineIdentity::IsAuthRejection(Error))
+		{
+			UE_LOG(LogEnhancedSubsystem, Log, TEXT("Cached credentials of local user %d were rejected, deleting them."), LocalUserNum);
+			FEnhancedOnlineAuthTokenCache::Clear(LocalUserNum);
+		}
+
+		// Requests issued during the auto login either complete right away or retry with their own credentials
+		TArray<TObjectPtr<UEnhancedOnlineRequest_LoginUser>> Deferred = MoveTemp(DeferredLoginRequests);
+		for (UEnhancedOnlineRequest_LoginUser* DeferredRequest : Deferred)
+		{
+			LoginOnlineUser(DeferredRequest);
+		}
+	}
 }
 
 void UEnhancedOnlineSessionsSubsystem::LogoutOnlineUser(UEnhancedOnlineRequest_LogoutUser* Request)
@@ -122,10 +271,12 @@ void UEnhancedOnlineSessionsSubsystem::LogoutOnlineUser(UEnhancedOnlineRequest_L
 		return;
 	}
 
+	TRACE_ENHANCED_REQUEST_BEGIN(Request);
+
 	if (IsValid(PendingLoginRequest))
 	{
 		UE_LOG(LogEnhancedSubsystem, Error, TEXT("A logout request is already pending."));
-		Request->OnRequestFailedDelegate.Broadcast(TEXT("A logout request is already pending."));
+		Request->FailRequest(TEXT("A logout request is already pending."));
 		return;
 	}
 
@@ -133,7 +284,7 @@ void UEnhancedOnlineSessionsSubsystem::LogoutOnlineUser(UEnhancedOnlineRequest_L
 	if (PlayerController == nullptr)
 	{
 		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Logout Online User was called with a bad local user index."));
-		Request->OnRequestFailedDelegate.Broadcast(TEXT("Logout Online User was called with a bad local user index."));
+		Request->FailRequest(TEXT("Logout Online User was called with a bad local user index."));
 		return;
 	}
 
@@ -141,7 +292,7 @@ void UEnhancedOnlineSessionsSubsystem::LogoutOnlineUser(UEnhancedOnlineRequest_L
 	if (LocalPlayer == nullptr)
 	{
 		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Logout Online User was called with a bad local user index: %d."), Request->LocalUserIndex);
-		Request->OnRequestFailedDelegate.Broadcast(FString::Printf(TEXT("Logout Online User was called with a bad local user index: %d."), Request->LocalUserIndex));
+		Request->FailRequest(FString::Printf(TEXT("Logout Online User was called with a bad local user index: %d."), Request->LocalUserIndex));
 		return;
 	}
 
@@ -153,6 +304,7 @@ void UEnhancedOnlineSessionsSubsystem::LogoutOnlineUserInternal(ULocalPlayer* Lo
 	if (Request->Identity->GetLoginStatus(0) != ELoginStatus::LoggedIn)
 	{
 		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Logout Online User was called with a user that is already logged out."));
+		TRACE_ENHANCED_REQUEST_END(Request, true, TEXT("Already logged out"));
 		Request->OnUserLogoutCompleted.Broadcast(LocalPlayer->GetControllerId());
 		return;
 	}
@@ -162,23 +314,29 @@ void UEnhancedOnlineSessionsSubsystem::LogoutOnlineUserInternal(ULocalPlayer* Lo
 
 	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Logging out user."));
 
+	TRACE_ENHANCED_REQUEST_DISPATCH(Request, TEXT("Logout"), 0);
 	if (!Request->Identity->Logout(0))
 	{
 		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Logout Online User failed."));
-		Request->OnRequestFailedDelegate.Broadcast(TEXT("Logout Online User failed."));
+		Request->FailRequest(TEXT("Logout Online User failed."));
 		Request->InvalidateRequest();
 	}
 }
 
 void UEnhancedOnlineSessionsSubsystem::HandleLogoutComplete(int32 LocalUserNum, bool bWasSuccessful)
 {
-	IOnlineSubsystem* OnlineSub = Online::GetSubsystem(GetWorld());
-	IOnlineIdentityPtr Identity = OnlineSub->GetIdentityInterface();
+	FEnhancedOnlineHitchScope HitchScope(TEXT("HandleLogoutComplete"), PendingLogoutRequest);
+	TRACE_ENHANCED_REQUEST_CALLBACK(PendingLogoutRequest, TEXT("Logout"), bWasSuccessful, 0);
+	MarkStateSnapshotDirty();
+
+	IOnlineIdentityPtr Identity = GetOnlineInterfaces().Identity;
 
 	if (bWasSuccessful)
 	{
 		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Logout Online User succeeded."));
 
+		FEnhancedOnlineAuthTokenCache::Clear(LocalUserNum);
+
 		if (PendingLogoutRequest)
 		{
 			PendingLogoutRequest->OnUserLogoutCompleted.Broadcast(LocalUserNum);
@@ -194,7 +352,7 @@ void UEnhancedOnlineSessionsSubsystem::HandleLogoutComplete(int32 LocalUserNum,
 
 		if (PendingLogoutRequest)
 		{
-			PendingLogoutRequest->OnRequestFailedDelegate.Broadcast(TEXT("Logout Online User failed."));
+			PendingLogoutRequest->FailRequest(TEXT("Logout Online User failed."));
 		}
 		else
 		{
@@ -0,0 +1,267 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineSessionsSubsystem.h"
+
+#include "EnhancedOnlineHitchDetector.h"
+#include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineSubsystem.h"
+#include "OnlineSessionSettings.h"
+#include "TimerManager.h"
+#include "Engine/GameInstance.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Kismet/GameplayStatics.h"
+#include "Online/OnlineSessionNames.h"
+
+static TAutoConsoleVariable<float> CVarEnhancedLobbyHandoffGraceSeconds(
+	TEXT("EnhancedOnline.Lobby.HandoffGraceSeconds"),
+	2.0f,
+	TEXT("Seconds the lobby host waits after publishing a handoff before it leaves the lobby and travels, so every member receives the update."));
+
+void UEnhancedOnlineSessionsSubsystem::HandoffLobbyToGameSession(UEnhancedOnlineRequest_LobbyHandoff* Request)
+{
+	if (Request == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Handoff Lobby was called with a bad request."));
+		return;
+	}
+
+	TRACE_ENHANCED_REQUEST_BEGIN(Request);
+
+	if (IsValid(PendingLobbyHandoffRequest))
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("A lobby handoff is already in progress."));
+		Request->FailRequest(TEXT("A lobby handoff is already in progress."));
+		return;
+	}
+
+	IOnlineSessionPtr Sessions = Request->Sessions;
+	const FNamedOnlineSession* Lobby = Sessions.IsValid() ? Sessions->GetNamedSession(NAME_PartySession) : nullptr;
+	if (Lobby == nullptr || !Lobby->bHosting)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Only the host of a lobby can hand it off."));
+		Request->FailRequest(TEXT("Only the host of a lobby can hand it off."));
+		return;
+	}
+
+	if (Request->GameSessionToClaim)
+	{
+		if (Request->GameSessionToClaim->IsStale())
+		{
+			UE_LOG(LogEnhancedSubsystem, Error, TEXT("Cannot hand a lobby off to a session from the last known server list."));
+			Request->FailRequest(TEXT("Cannot hand a lobby off to a session from the last known server list."));
+			return;
+		}
+
+		const FOnlineSessionSearchResult& GameSession = Request->GameSessionToClaim->StoredSearchResult;
+
+		FString ConnectString;
+		if (!Sessions->GetResolvedConnectString(GameSession, NAME_GamePort, ConnectString))
+		{
+			UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to resolve the address of the game session to hand the lobby off to."));
+			Request->FailRequest(TEXT("Failed to resolve the address of the game session to hand the lobby off to."));
+			return;
+		}
+
+		PendingLobbyHandoffRequest = Request;
+
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Handing lobby off to game session %s..."), *GameSession.GetSessionIdStr());
+		PublishLobbyHandoff(ConnectString, GameSession.GetSessionIdStr(), false);
+	}
+	else if (UEnhancedOnlineRequest_CreateSession* Template = Request->GameSessionTemplate)
+	{
+		if (IsValid(PendingSessionRequest))
+		{
+			UE_LOG(LogEnhancedSubsystem, Error, TEXT("A session is already being hosted."));
+			Request->FailRequest(TEXT("A session is already being hosted."));
+			return;
+		}
+
+		if (Template->bIsDedicated || Template->OnlineMode == EEnhancedSessionOnlineMode::Offline)
+		{
+			UE_LOG(LogEnhancedSubsystem, Error, TEXT("The game session of a lobby handoff has to be hosted online by the lobby host."));
+			Request->FailRequest(TEXT("The game session of a lobby handoff has to be hosted online by the lobby host."));
+			return;
+		}
+
+		APlayerController* PlayerController = UGameplayStatics::GetPlayerController(Request->GetWorld(), Request->LocalUserIndex);
+		ULocalPlayer* LocalPlayer = PlayerController ? PlayerController->GetLocalPlayer() : nullptr;
+		if (LocalPlayer == nullptr)
+		{
+			UE_LOG(LogEnhancedSubsystem, Error, TEXT("Handoff Lobby was called with a bad local user index: %d."), Request->LocalUserIndex);
+			Request->FailRequest(FString::Printf(TEXT("Handoff Lobby was called with a bad local user index: %d."), Request->LocalUserIndex));
+			return;
+		}
+
+		PendingLobbyHandoffRequest = Request;
+
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Creating the game session to hand the lobby off to..."));
+		HostOnlineSessionInternal(LocalPlayer, Template);
+
+		// The session could not even be requested, the template already reported why
+		if (PendingSessionRequest == nullptr && PendingLobbyHandoffRequest)
+		{
+			FailLobbyHandoff(TEXT("Failed to create the game session for the lobby handoff."));
+		}
+	}
+	else
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Handoff Lobby needs either a game session template or a game session to claim."));
+		Request->FailRequest(TEXT("Handoff Lobby needs either a game session template or a game session to claim."));
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::PublishLobbyHandoff(const FString& ConnectString, const FString& GameSessionId, bool bFollowHost)
+{
+	IOnlineSessionPtr Sessions = GetOnlineInterfaces().Sessions;
+	const FNamedOnlineSession* Lobby = Sessions.IsValid() ? Sessions->GetNamedSession(NAME_PartySession) : nullptr;
+	if (Lobby == nullptr)
+	{
+		FailLobbyHandoff(TEXT("The lobby went away before it could be handed off."));
+		return;
+	}
+
+	LobbyHandoffConnectString = ConnectString;
+	bLobbyHandoffFollowsHost = bFollowHost;
+
+	// Every member receives this as one settings update, nobody has to search for the game session
+	FOnlineSessionSettings UpdatedSettings = Lobby->SessionSettings;
+	UpdatedSettings.bAllowJoinInProgress = false;
+	UpdatedSettings.Set(SETTING_HANDOFF_CONNECT, ConnectString, EOnlineDataAdvertisementType::ViaOnlineService);
+	UpdatedSettings.Set(SETTING_HANDOFF_SESSIONID, GameSessionId, EOnlineDataAdvertisementType::ViaOnlineService);
+	UpdatedSettings.Set(SETTING_HANDOFF_FOLLOWHOST, bFollowHost, EOnlineDataAdvertisementType::ViaOnlineService);
+
+	LobbyHandoffUpdateDelegateHandle = Sessions->AddOnUpdateSessionCompleteDelegate_Handle(FOnUpdateSessionCompleteDelegate::CreateUObject(this, &ThisClass::HandleLobbyHandoffPublished));
+
+	TRACE_ENHANCED_REQUEST_DISPATCH(PendingLobbyHandoffRequest, TEXT("UpdateLobby"), FEnhancedOnlineRequestTrace::GetPayloadSize(UpdatedSettings));
+	if (!Sessions->UpdateSession(NAME_PartySession, UpdatedSettings, true))
+	{
+		Sessions->ClearOnUpdateSessionCompleteDelegate_Handle(LobbyHandoffUpdateDelegateHandle);
+		LobbyHandoffUpdateDelegateHandle.Reset();
+
+		FailLobbyHandoff(TEXT("Failed to publish the lobby handoff."));
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleLobbyHandoffPublished(FName SessionName, bool bWasSuccessful)
+{
+	if (SessionName != NAME_PartySession)
+	{
+		return;
+	}
+
+	FEnhancedOnlineHitchScope HitchScope(TEXT("HandleLobbyHandoffPublished"), PendingLobbyHandoffRequest);
+	TRACE_ENHANCED_REQUEST_CALLBACK(PendingLobbyHandoffRequest, TEXT("UpdateLobby"), bWasSuccessful, 0);
+
+	if (IOnlineSessionPtr Sessions = GetOnlineInterfaces().Sessions)
+	{
+		Sessions->ClearOnUpdateSessionCompleteDelegate_Handle(LobbyHandoffUpdateDelegateHandle);
+	}
+	LobbyHandoffUpdateDelegateHandle.Reset();
+
+	if (!bWasSuccessful)
+	{
+		FailLobbyHandoff(TEXT("Failed to publish the lobby handoff."));
+		return;
+	}
+
+	const float GraceSeconds = CVarEnhancedLobbyHandoffGraceSeconds.GetValueOnGameThread();
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Published lobby handoff to %s, leaving the lobby in %.1f seconds."), *LobbyHandoffConnectString, GraceSeconds);
+
+	if (GraceSeconds > 0.0f)
+	{
+		GetGameInstance()->GetTimerManager().SetTimer(LobbyHandoffTimerHandle, FTimerDelegate::CreateUObject(this, &ThisClass::FinishLobbyHandoff), GraceSeconds, false);
+	}
+	else
+	{
+		FinishLobbyHandoff();
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::FinishLobbyHandoff()
+{
+	if (IOnlineSessionPtr Sessions = GetOnlineInterfaces().Sessions)
+	{
+		Sessions->DestroySession(NAME_PartySession);
+	}
+
+	UEnhancedOnlineRequest_LobbyHandoff* Request = PendingLobbyHandoffRequest;
+	PendingLobbyHandoffRequest = nullptr;
+
+	if (Request)
+	{
+		Request->OnLobbyHandoffCompleted.Broadcast(LobbyHandoffConnectString);
+		Request->CompleteRequest();
+	}
+
+	if (bLobbyHandoffFollowsHost)
+	{
+		// Members are still connected to the host and come along
+		if (!PendingTravelURL.ToString().IsEmpty())
+		{
+			GetWorld()->ServerTravel(PendingTravelURL.ToString());
+		}
+	}
+	else if (APlayerController* PlayerController = UGameplayStatics::GetPlayerController(GetWorld(), Request ? Request->LocalUserIndex : LobbyLocalUserIndex))
+	{
+		PlayerController->ClientTravel(LobbyHandoffConnectString, TRAVEL_Absolute);
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::FailLobbyHandoff(const FString& Error)
+{
+	UE_LOG(LogEnhancedSubsystem, Error, TEXT("%s"), *Error);
+
+	UEnhancedOnlineRequest_LobbyHandoff* Request = PendingLobbyHandoffRequest;
+	PendingLobbyHandoffRequest = nullptr;
+
+	if (Request)
+	{
+		Request->FailRequest(Error);
+		Request->CompleteRequest();
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleLobbySettingsUpdated(FName SessionName, const FOnlineSessionSettings& UpdatedSettings)
+{
+	if (SessionName != NAME_PartySession)
+	{
+		return;
+	}
+
+	FString ConnectString;
+	if (!UpdatedSettings.Get(SETTING_HANDOFF_CONNECT, ConnectString) || ConnectString.IsEmpty())
+	{
+		return;
+	}
+
+	IOnlineSessionPtr Sessions = GetOnlineInterfaces().Sessions;
+	const FNamedOnlineSession* Lobby = Sessions.IsValid() ? Sessions->GetNamedSession(NAME_PartySession) : nullptr;
+	if (Lobby == nullptr || Lobby->bHosting)
+	{
+		return;
+	}
+
+	FEnhancedOnlineHitchScope HitchScope(TEXT("HandleLobbySettingsUpdated"));
+
+	bool bFollowHost = false;
+	UpdatedSettings.Get(SETTING_HANDOFF_FOLLOWHOST, bFollowHost);
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Lobby was handed off to %s."), *ConnectString);
+
+	Sessions->ClearOnSessionSettingsUpdatedDelegate_Handle(LobbySettingsUpdatedDelegateHandle);
+	LobbySettingsUpdatedDelegateHandle.Reset();
+	Sessions->DestroySession(NAME_PartySession);
+
+	OnLobbyHandoffReceived.Broadcast(ConnectString);
+
+	// When the host owns the game session its server travel takes the members along
+	if (!bFollowHost)
+	{
+		if (APlayerController* PlayerController = UGameplayStatics::GetPlayerController(GetWorld(), LobbyLocalUserIndex))
+		{
+			PlayerController->ClientTravel(ConnectString, TRAVEL_Absolute);
+		}
+	}
+}
@@ -0,0 +1,270 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineSessionsSubsystem.h"
+
+#include "EnhancedOnlineHitchDetector.h"
+#include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineSubsystem.h"
+#include "TimerManager.h"
+#include "Algo/StableSort.h"
+#include "Engine/GameInstance.h"
+
+static TAutoConsoleVariable<int32> CVarEnhancedMatchmakingMaxWidenLevel(
+	TEXT("EnhancedOnline.Matchmaking.MaxWidenLevel"),
+	3,
+	TEXT("How often the matchmaking criteria may be widened before the searches keep using the widest criteria."));
+
+void UEnhancedOnlineSessionsSubsystem::StartMatchmaking(UEnhancedOnlineRequest_Matchmake* Request)
+{
+	if (Request == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Start Matchmaking was called with a bad request."));
+		return;
+	}
+
+	// The searches, joins and hosts of the matchmaking are traced as requests of their own
+	TRACE_ENHANCED_REQUEST_BEGIN(Request);
+
+	if (IsValid(PendingMatchmakeRequest))
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Matchmaking is already in progress."));
+		Request->FailRequest(TEXT("Matchmaking is already in progress."));
+		return;
+	}
+
+	PendingMatchmakeRequest = Request;
+	MatchmakingCandidates.Reset();
+	MatchmakingCandidateIndex = 0;
+	MatchmakingWidenLevel = 0;
+	MatchmakingStartTime = FPlatformTime::Seconds();
+	MarkStateSnapshotDirty();
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Started matchmaking with a budget of %.1f seconds."), Request->TimeBudgetSeconds);
+
+	IssueMatchmakingSearch();
+}
+
+void UEnhancedOnlineSessionsSubsystem::CancelMatchmaking()
+{
+	if (PendingMatchmakeRequest == nullptr)
+	{
+		return;
+	}
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Matchmaking was cancelled."));
+	FinishMatchmaking(false, EEnhancedMatchmakingResult::Cancelled, TEXT("Matchmaking was cancelled."));
+}
+
+void UEnhancedOnlineSessionsSubsystem::IssueMatchmakingSearch()
+{
+	UEnhancedOnlineRequest_Matchmake* Request = PendingMatchmakeRequest;
+	if (Request == nullptr)
+	{
+		return;
+	}
+
+	UEnhancedOnlineRequest_FindSessions* FindRequest = NewObject<UEnhancedOnlineRequest_FindSessions>(Request);
+	FindRequest->ConstructRequest();
+	FindRequest->bInvalidateOnCompletion = false;
+	FindRequest->LocalUserIndex = Request->LocalUserIndex;
+	FindRequest->OnlineMode = Request->OnlineMode;
+	FindRequest->bFindLobbies = Request->bFindLobbies;
+	FindRequest->MaxSearchResults = Request->MaxSearchResults;
+	FindRequest->SearchKeyword = Request->GetSearchKeyword(MatchmakingWidenLevel);
+	FindRequest->WithMinOpenSlots(1);
+
+	FindRequest->OnFindOnlineSessionsCompleted.AddWeakLambda(this, [this, Request](const TArray<UEnhancedSessionSearchResult*>& Results)
+	{
+		if (PendingMatchmakeRequest == Request)
+		{
+			HandleMatchmakingSearchComplete(Results);
+		}
+	});
+
+	FindRequest->OnRequestFailedDelegate.AddWeakLambda(this, [this, Request](const FString& Reason)
+	{
+		if (PendingMatchmakeRequest == Request)
+		{
+			UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Matchmaking search failed: %s"), *Reason);
+			WidenMatchmakingCriteria();
+		}
+	});
+
+	UE_LOG(LogEnhancedSubsystem, Verbose, TEXT("Matchmaking search at widen level %d."), MatchmakingWidenLevel);
+
+	FindOnlineSessions(FindRequest);
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleMatchmakingSearchComplete(const TArray<UEnhancedSessionSearchResult*>& Results)
+{
+	FEnhancedOnlineHitchScope HitchScope(TEXT("HandleMatchmakingSearchComplete"), PendingMatchmakeRequest);
+	HitchScope.SetResultCount(Results.Num());
+
+	const UEnhancedOnlineRequest_Matchmake* Request = PendingMatchmakeRequest;
+
+	TArray<TPair<float, UEnhancedSessionSearchResult*>> ScoredResults;
+	ScoredResults.Reserve(Results.Num());
+
+	for (UEnhancedSessionSearchResult* Result : Results)
+	{
+		if (Result == nullptr)
+		{
+			continue;
+		}
+
+		const float Score = Request->ScoreSearchResult(Result, MatchmakingWidenLevel);
+		if (Score >= 0.0f)
+		{
+			ScoredResults.Emplace(Score, Result);
+		}
+	}
+
+	// Stable so equally scored sessions keep the order of the backend
+	Algo::StableSortBy(ScoredResults, [](const TPair<float, UEnhancedSessionSearchResult*>& Pair) { return Pair.Key; }, TGreater<float>());
+
+	MatchmakingCandidates.Reset(ScoredResults.Num());
+	for (const TPair<float, UEnhancedSessionSearchResult*>& Pair : ScoredResults)
+	{
+		MatchmakingCandidates.Add(Pair.Value);
+	}
+	MatchmakingCandidateIndex = 0;
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Matchmaking found %d sessions, %d fit the criteria at widen level %d."), Results.Num(), MatchmakingCandidates.Num(), MatchmakingWidenLevel);
+
+	TryNextMatchmakingCandidate();
+}
+
+void UEnhancedOnlineSessionsSubsystem::TryNextMatchmakingCandidate()
+{
+	UEnhancedOnlineRequest_Matchmake* Request = PendingMatchmakeRequest;
+	if (Request == nullptr)
+	{
+		return;
+	}
+
+	if (!MatchmakingCandidates.IsValidIndex(MatchmakingCandidateIndex))
+	{
+		MatchmakingCandidates.Reset();
+		WidenMatchmakingCriteria();
+		return;
+	}
+
+	UEnhancedSessionSearchResult* Candidate = MatchmakingCandidates[MatchmakingCandidateIndex++];
+
+	UEnhancedOnlineRequest_JoinSession* JoinRequest = NewObject<UEnhancedOnlineRequest_JoinSession>(Request);
+	JoinRequest->ConstructRequest();
+	JoinRequest->bInvalidateOnCompletion = false;
+	JoinRequest->LocalUserIndex = Request->LocalUserIndex;
+	JoinRequest->SessionToJoin = Candidate;
+
+	JoinRequest->OnJoinSessionCompleted.AddWeakLambda(this, [this, Request](const FName SessionName)
+	{
+		if (PendingMatchmakeRequest == Request)
+		{
+			FinishMatchmaking(true, EEnhancedMatchmakingResult::Joined, FString());
+		}
+	});
+
+	// Fail over to the next best session right away
+	JoinRequest->OnRequestFailedDelegate.AddWeakLambda(this, [this, Request](const FString& Reason)
+	{
+		if (PendingMatchmakeRequest == Request)
+		{
+			UE_LOG(LogEnhancedSubsystem, Log, TEXT("Matchmaking join failed (%s), trying the next session."), *Reason);
+			TryNextMatchmakingCandidate();
+		}
+	});
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Matchmaking is joining %s (%d ms)."), *Candidate->GetSessionFriendlyName(), Candidate->GetPingInMs());
+
+	JoinOnlineSession(JoinRequest);
+}
+
+void UEnhancedOnlineSessionsSubsystem::WidenMatchmakingCriteria()
+{
+	const UEnhancedOnlineRequest_Matchmake* Request = PendingMatchmakeRequest;
+	if (Request == nullptr)
+	{
+		return;
+	}
+
+	const double Elapsed = FPlatformTime::Seconds() - MatchmakingStartTime;
+	const float RetryDelay = FMath::Max(0.1f, Request->WidenIntervalSeconds);
+
+	if (Elapsed + RetryDelay >= Request->TimeBudgetSeconds)
+	{
+		HostMatchmakingFallback();
+		return;
+	}
+
+	MatchmakingWidenLevel = FMath::Min(MatchmakingWidenLevel + 1, FMath::Max(0, CVarEnhancedMatchmakingMaxWidenLevel.GetValueOnGameThread()));
+
+	GetGameInstance()->GetTimerManager().SetTimer(MatchmakingRetryTimerHandle, this, &ThisClass::IssueMatchmakingSearch, RetryDelay, false);
+}
+
+void UEnhancedOnlineSessionsSubsystem::HostMatchmakingFallback()
+{
+	UEnhancedOnlineRequest_Matchmake* Request = PendingMatchmakeRequest;
+	UEnhancedOnlineRequest_CreateSession* Template = Request ? Request->HostFallbackTemplate.Get() : nullptr;
+
+	if (Template == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Matchmaking found no session within its time budget."));
+		FinishMatchmaking(false, EEnhancedMatchmakingResult::Hosted, TEXT("No session could be joined within the time budget."));
+		return;
+	}
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Matchmaking found no session within its time budget, hosting one instead."));
+
+	Template->OnCreateSessionCompleted.AddWeakLambda(this, [this, Request](int32 LocalUserIndex, const FName SessionName)
+	{
+		if (PendingMatchmakeRequest == Request)
+		{
+			FinishMatchmaking(true, EEnhancedMatchmakingResult::Hosted, FString());
+		}
+	});
+
+	Template->OnRequestFailedDelegate.AddWeakLambda(this, [this, Request](const FString& Reason)
+	{
+		if (PendingMatchmakeRequest == Request)
+		{
+			FinishMatchmaking(false, EEnhancedMatchmakingResult::Hosted, Reason);
+		}
+	});
+
+	HostOnlineSession(Template);
+}
+
+void UEnhancedOnlineSessionsSubsystem::FinishMatchmaking(bool bWasSuccessful, EEnhancedMatchmakingResult Result, const FString& Error)
+{
+	UEnhancedOnlineRequest_Matchmake* Request = PendingMatchmakeRequest;
+
+	if (UGameInstance* GameInstance = GetGameInstance())
+	{
+		GameInstance->GetTimerManager().ClearTimer(MatchmakingRetryTimerHandle);
+	}
+
+	PendingMatchmakeRequest = nullptr;
+	MatchmakingCandidates.Reset();
+	MatchmakingCandidateIndex = 0;
+	MarkStateSnapshotDirty();
+
+	if (Request == nullptr)
+	{
+		return;
+	}
+
+	if (bWasSuccessful)
+	{
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Matchmaking %s a session after %.1f seconds."),
+			Result == EEnhancedMatchmakingResult::Hosted ? TEXT("hosted") : TEXT("joined"), FPlatformTime::Seconds() - MatchmakingStartTime);
+
+		Request->OnMatchmakingCompleted.Broadcast(Result);
+	}
+	else
+	{
+		Request->FailRequest(Error);
+	}
+
+	Request->CompleteRequest();
+}
@@ -0,0 +1,118 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineSessionsSubsystem.h"
+
+#include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineSubsystem.h"
+#include "OnlineSessionSettings.h"
+#include "TimerManager.h"
+#include "Persistence/EnhancedOnlinePingHistory.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "Kismet/GameplayStatics.h"
+
+static TAutoConsoleVariable<float> CVarEnhancedPingConnectionSampleInterval(
+	TEXT("EnhancedOnline.Ping.ConnectionSampleInterval"),
+	5.0f,
+	TEXT("Time in seconds between two samples of the game connection latency after joining a session. 0 disables connection samples."));
+
+static TAutoConsoleVariable<int32> CVarEnhancedPingConnectionSamples(
+	TEXT("EnhancedOnline.Ping.ConnectionSamples"),
+	12,
+	TEXT("How often the game connection latency is sampled after joining a session, including the samples while still travelling."));
+
+static TAutoConsoleVariable<int32> CVarEnhancedPingMaxSearchSamples(
+	TEXT("EnhancedOnline.Ping.MaxSearchSamples"),
+	32,
+	TEXT("Maximum number of results of a search whose ping is added to the ping history, in the order the backend returned them."));
+
+void UEnhancedOnlineSessionsSubsystem::ApplyPingEstimate(UEnhancedSessionSearchResult* SearchResult) const
+{
+	if (SearchResult == nullptr || !PingHistory.IsValid())
+	{
+		return;
+	}
+
+	float SmoothedPingInMs = 0.0f;
+	float PingConfidence = 0.0f;
+	if (PingHistory->GetEstimate(FEnhancedOnlinePingHistory::GetHostKey(SearchResult->StoredSearchResult), SmoothedPingInMs, PingConfidence))
+	{
+		SearchResult->SetPingEstimate(SmoothedPingInMs, PingConfidence);
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::RecordSearchPings(const TArray<FOnlineSessionSearchResult>& SearchResults)
+{
+	// Large searches would otherwise hash every host on the game thread, only the front of the list is likely joined
+	const int32 NumSamples = FMath::Min(SearchResults.Num(), FMath::Max(CVarEnhancedPingMaxSearchSamples.GetValueOnGameThread(), 0));
+	for (int32 Index = 0; Index < NumSamples; ++Index)
+	{
+		AddPingSample(SearchResults[Index], SearchResults[Index].PingInMs, EEnhancedPingSource::Search);
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::AddPingSample(const FOnlineSessionSearchResult& SearchResult, float PingInMs, EEnhancedPingSource Source)
+{
+	if (PingHistory.IsValid())
+	{
+		PingHistory->AddSample(FEnhancedOnlinePingHistory::GetHostKey(SearchResult), PingInMs, Source);
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::StartConnectionPingSampling(const FOnlineSessionSearchResult& SearchResult, int32 LocalUserIndex)
+{
+	StopConnectionPingSampling();
+
+	const float Interval = CVarEnhancedPingConnectionSampleInterval.GetValueOnGameThread();
+	if (Interval <= 0.0f || !PingHistory.IsValid())
+	{
+		return;
+	}
+
+	ConnectionPingHostKey = FEnhancedOnlinePingHistory::GetHostKey(SearchResult);
+	ConnectionPingLocalUserIndex = LocalUserIndex;
+	NumConnectionPingTicks = 0;
+
+	GetGameInstance()->GetTimerManager().SetTimer(ConnectionPingTimerHandle, this, &ThisClass::SampleConnectionPing, Interval, true);
+}
+
+void UEnhancedOnlineSessionsSubsystem::SampleConnectionPing()
+{
+	// Until the client arrived on the host there is no connection to sample
+	const UWorld* World = GetWorld();
+	if (World && World->GetNetMode() == NM_Client)
+	{
+		const APlayerController* PlayerController = UGameplayStatics::GetPlayerController(World, ConnectionPingLocalUserIndex);
+		const APlayerState* PlayerState = PlayerController ? PlayerController->PlayerState : nullptr;
+
+		if (PlayerState && PingHistory.IsValid())
+		{
+			PingHistory->AddSample(ConnectionPingHostKey, PlayerState->GetPingInMilliseconds(), EEnhancedPingSource::Connection);
+		}
+	}
+
+	if (++NumConnectionPingTicks >= CVarEnhancedPingConnectionSamples.GetValueOnGameThread())
+	{
+		StopConnectionPingSampling();
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::StopConnectionPingSampling()
+{
+	if (ConnectionPingHostKey.IsEmpty())
+	{
+		return;
+	}
+
+	GetGameInstance()->GetTimerManager().ClearTimer(ConnectionPingTimerHandle);
+	ConnectionPingHostKey.Reset();
+	NumConnectionPingTicks = 0;
+
+	// Written once per join rather than per sample, off the game thread
+	if (PingHistory.IsValid())
+	{
+		PingHistory->Save();
+	}
+}
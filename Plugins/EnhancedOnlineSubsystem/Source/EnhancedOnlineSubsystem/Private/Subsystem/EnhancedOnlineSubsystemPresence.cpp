@@ -0,0 +1,227 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineSessionsSubsystem.h"
+
+#include "EnhancedOnlineHitchDetector.h"
+#include "EnhancedOnlineSubsystem.h"
+#include "TimerManager.h"
+#include "Engine/GameInstance.h"
+#include "Interfaces/OnlineIdentityInterface.h"
+#include "Interfaces/OnlinePresenceInterface.h"
+
+static TAutoConsoleVariable<float> CVarEnhancedPresenceMinPublishInterval(
+	TEXT("EnhancedOnline.Presence.MinPublishInterval"),
+	5.0f,
+	TEXT("Minimum time in seconds between two rich presence writes to the presence backend."));
+
+static EOnlinePresenceState::Type ToOnlinePresenceState(EBlueprintEnhancedPresenceState State)
+{
+	switch (State)
+	{
+	case EBlueprintEnhancedPresenceState::Online:
+		return EOnlinePresenceState::Online;
+	case EBlueprintEnhancedPresenceState::Away:
+		return EOnlinePresenceState::Away;
+	case EBlueprintEnhancedPresenceState::ExtendedAway:
+		return EOnlinePresenceState::ExtendedAway;
+	case EBlueprintEnhancedPresenceState::DoNotDisturb:
+		return EOnlinePresenceState::DoNotDisturb;
+	case EBlueprintEnhancedPresenceState::Chat:
+		return EOnlinePresenceState::Chat;
+	case EBlueprintEnhancedPresenceState::Offline:
+	default:
+		return EOnlinePresenceState::Offline;
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::UpdateOnlinePresence(int32 LocalUserIndex, EBlueprintEnhancedPresenceState PresenceState, const FString& StatusString)
+{
+	FEnhancedPresencePublishState& State = PresenceStates.FindOrAdd(LocalUserIndex);
+	State.Pending.Info.PresenceState = PresenceState;
+	State.Pending.Info.StatusString = StatusString;
+	State.Pending.Info.bIsOnline = PresenceState != EBlueprintEnhancedPresenceState::Offline;
+
+	State.bDirty = true;
+	SchedulePresencePublish(LocalUserIndex);
+}
+
+void UEnhancedOnlineSessionsSubsystem::SetOnlinePresenceProperty(int32 LocalUserIndex, const FString& Key, const FString& Value)
+{
+	if (Key.IsEmpty())
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Set Online Presence Property was called with an empty key."));
+		return;
+	}
+
+	FEnhancedPresencePublishState& State = PresenceStates.FindOrAdd(LocalUserIndex);
+	State.Pending.Properties.Add(Key, Value);
+
+	State.bDirty = true;
+	SchedulePresencePublish(LocalUserIndex);
+}
+
+FEnhancedOnlineFriendPresenceInfo UEnhancedOnlineSessionsSubsystem::GetPublishedOnlinePresence(int32 LocalUserIndex) const
+{
+	const FEnhancedPresencePublishState* State = PresenceStates.Find(LocalUserIndex);
+	return State ? State->Published.Info : FEnhancedOnlineFriendPresenceInfo();
+}
+
+void UEnhancedOnlineSessionsSubsystem::SchedulePresencePublish(int32 LocalUserIndex)
+{
+	FEnhancedPresencePublishState* State = PresenceStates.Find(LocalUserIndex);
+
+	// The completion handler reschedules once the current write returns
+	if (State == nullptr || State->bWriteInFlight)
+	{
+		return;
+	}
+
+	FTimerManager& TimerManager = GetGameInstance()->GetTimerManager();
+	if (TimerManager.IsTimerActive(State->PublishTimerHandle))
+	{
+		return;
+	}
+
+	const double MinInterval = FMath::Max(0.0f, CVarEnhancedPresenceMinPublishInterval.GetValueOnGameThread());
+	const double Delay = (State->LastPublishTime + MinInterval) - FPlatformTime::Seconds();
+
+	if (Delay <= 0.0)
+	{
+		PublishPendingPresence(LocalUserIndex);
+	}
+	else
+	{
+		TimerManager.SetTimer(State->PublishTimerHandle, FTimerDelegate::CreateUObject(this, &ThisClass::PublishPendingPresence, LocalUserIndex), static_cast<float>(Delay), false);
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::PublishPendingPresence(int32 LocalUserIndex)
+{
+	FEnhancedPresencePublishState* State = PresenceStates.Find(LocalUserIndex);
+	if (State == nullptr)
+	{
+		return;
+	}
+
+	State->PublishTimerHandle.Invalidate();
+
+	if (!State->bDirty || State->bWriteInFlight)
+	{
+		return;
+	}
+
+	State->bDirty = false;
+
+	if (State->Pending.Equals(State->Published))
+	{
+		UE_LOG(LogEnhancedSubsystem, Verbose, TEXT("Skipping presence publish of local user %d, nothing changed."), LocalUserIndex);
+		return;
+	}
+
+	const FEnhancedOnlineInterfaceHandles Interfaces = GetOnlineInterfaces();
+	IOnlinePresencePtr Presence = Interfaces.Presence;
+	IOnlineIdentityPtr Identity = Interfaces.Identity;
+	if (!Presence.IsValid() || !Identity.IsValid())
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Presence is not supported by the current online subsystem."));
+		return;
+	}
+
+	FUniqueNetIdPtr UserId = Identity->GetUniquePlayerId(LocalUserIndex);
+	if (!UserId.IsValid())
+	{
+		// Keep the update pending until the user is logged in, the login status change publishes it
+		State->bDirty = true;
+		if (!State->LoginStatusChangedDelegateHandle.IsValid())
+		{
+			State->LoginStatusChangedDelegateHandle = Identity->AddOnLoginStatusChangedDelegate_Handle(LocalUserIndex, FOnLoginStatusChangedDelegate::CreateUObject(this, &ThisClass::HandlePresenceLoginStatusChanged));
+		}
+
+		UE_LOG(LogEnhancedSubsystem, Verbose, TEXT("Deferring presence publish, local user %d is not logged in."), LocalUserIndex);
+		return;
+	}
+
+	FOnlineUserPresenceStatus Status;
+	Status.State = ToOnlinePresenceState(State->Pending.Info.PresenceState);
+	Status.StatusStr = State->Pending.Info.StatusString;
+	for (const TPair<FString, FString>& Property : State->Pending.Properties)
+	{
+		Status.Properties.Add(Property.Key, FVariantData(Property.Value));
+	}
+
+	State->InFlight = State->Pending;
+	State->bWriteInFlight = true;
+	State->LastPublishTime = FPlatformTime::Seconds();
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Publishing presence of local user %d: %s"), LocalUserIndex, *Status.ToDebugString());
+
+	Presence->SetPresence(*UserId, Status, IOnlinePresence::FOnPresenceTaskCompleteDelegate::CreateUObject(this, &ThisClass::HandlePublishPresenceComplete, LocalUserIndex));
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandlePublishPresenceComplete(const FUniqueNetId& UserId, bool bWasSuccessful, int32 LocalUserIndex)
+{
+	FEnhancedOnlineHitchScope HitchScope(TEXT("HandlePublishPresenceComplete"));
+
+	FEnhancedPresencePublishState* State = PresenceStates.Find(LocalUserIndex);
+	if (State == nullptr)
+	{
+		return;
+	}
+
+	State->bWriteInFlight = false;
+
+	if (bWasSuccessful)
+	{
+		State->Published = State->InFlight;
+	}
+	else
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Failed to publish presence for user %s."), *UserId.ToString());
+
+		// Retry with whatever is pending now once the interval has passed
+		State->bDirty = true;
+	}
+
+	if (State->bDirty)
+	{
+		SchedulePresencePublish(LocalUserIndex);
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandlePresenceLoginStatusChanged(int32 LocalUserNum, ELoginStatus::Type OldStatus, ELoginStatus::Type NewStatus, const FUniqueNetId& NewId)
+{
+	FEnhancedPresencePublishState* State = PresenceStates.Find(LocalUserNum);
+	if (State == nullptr || NewStatus != ELoginStatus::LoggedIn)
+	{
+		return;
+	}
+
+	if (IOnlineIdentityPtr Identity = GetOnlineInterfaces().Identity)
+	{
+		Identity->ClearOnLoginStatusChangedDelegate_Handle(LocalUserNum, State->LoginStatusChangedDelegateHandle);
+	}
+	State->LoginStatusChangedDelegateHandle.Reset();
+
+	if (State->bDirty)
+	{
+		UE_LOG(LogEnhancedSubsystem, Verbose, TEXT("Local user %d logged in, publishing the deferred presence."), LocalUserNum);
+		SchedulePresencePublish(LocalUserNum);
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::StopPresencePublishing()
+{
+	IOnlineIdentityPtr Identity = GetOnlineInterfaces().Identity;
+
+	for (TPair<int32, FEnhancedPresencePublishState>& Pair : PresenceStates)
+	{
+		GetGameInstance()->GetTimerManager().ClearTimer(Pair.Value.PublishTimerHandle);
+
+		if (Identity.IsValid() && Pair.Value.LoginStatusChangedDelegateHandle.IsValid())
+		{
+			Identity->ClearOnLoginStatusChangedDelegate_Handle(Pair.Key, Pair.Value.LoginStatusChangedDelegateHandle);
+		}
+	}
+
+	PresenceStates.Reset();
+}
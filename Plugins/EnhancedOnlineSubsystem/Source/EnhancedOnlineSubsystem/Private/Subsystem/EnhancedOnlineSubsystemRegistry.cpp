@@ -0,0 +1,302 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineSessionsSubsystem.h"
+
+#include "EnhancedOnlineHitchDetector.h"
+#include "EnhancedOnlineSubsystem.h"
+#include "OnlineSessionSettings.h"
+#include "TimerManager.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+
+static TAutoConsoleVariable<float> CVarEnhancedRegistryFlushInterval(
+	TEXT("EnhancedOnline.Registry.FlushInterval"),
+	0.25f,
+	TEXT("Delay in seconds used to batch joining and leaving players into a single RegisterPlayers / UnregisterPlayers call."));
+
+static TAutoConsoleVariable<int32> CVarEnhancedRegistryMaxRetries(
+	TEXT("EnhancedOnline.Registry.MaxRetries"),
+	5,
+	TEXT("Number of times a player whose RegisterPlayers / UnregisterPlayers call failed is retried before it is given up on."));
+
+static TAutoConsoleVariable<float> CVarEnhancedRegistryMaxRetryDelay(
+	TEXT("EnhancedOnline.Registry.MaxRetryDelay"),
+	30.0f,
+	TEXT("Upper bound in seconds of the delay between retries of a failed registry call, the delay doubles with every failure."));
+
+static TAutoConsoleVariable<bool> CVarEnhancedRegistryAutoRegister(
+	TEXT("EnhancedOnline.Registry.AutoRegister"),
+	true,
+	TEXT("Whether players are registered with the hosted session on PostLogin and unregistered on Logout automatically."));
+
+namespace EnhancedOnlineRegistry
+{
+	static bool ContainsPlayer(const TArray<FUniqueNetIdRef>& Players, const FUniqueNetId& PlayerId)
+	{
+		return Players.ContainsByPredicate([&PlayerId](const FUniqueNetIdRef& Other) { return *Other == PlayerId; });
+	}
+
+	static void RemovePlayer(TArray<FUniqueNetIdRef>& Players, const FUniqueNetId& PlayerId)
+	{
+		Players.RemoveAll([&PlayerId](const FUniqueNetIdRef& Other) { return *Other == PlayerId; });
+	}
+
+	/** Counts a failed call for the player, returns how many failed in a row */
+	static int32 AddFailure(TArray<TPair<FUniqueNetIdRef, int32>>& Failures, const FUniqueNetIdRef& PlayerId)
+	{
+		for (TPair<FUniqueNetIdRef, int32>& Failure : Failures)
+		{
+			if (*Failure.Key == *PlayerId)
+			{
+				return ++Failure.Value;
+			}
+		}
+
+		Failures.Emplace(PlayerId, 1);
+		return 1;
+	}
+
+	static void RemoveFailures(TArray<TPair<FUniqueNetIdRef, int32>>& Failures, const TArray<FUniqueNetIdRef>& Players)
+	{
+		Failures.RemoveAll([&Players](const TPair<FUniqueNetIdRef, int32>& Failure) { return ContainsPlayer(Players, *Failure.Key); });
+	}
+
+	static FUniqueNetIdPtr GetPlayerId(const AController* Controller)
+	{
+		const APlayerState* PlayerState = Controller ? Controller->GetPlayerState<APlayerState>() : nullptr;
+		return PlayerState ? PlayerState->GetUniqueId().GetUniqueNetId() : nullptr;
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::RegisterSessionPlayer(APlayerController* PlayerController)
+{
+	using namespace EnhancedOnlineRegistry;
+
+	FUniqueNetIdPtr PlayerId = GetPlayerId(PlayerController);
+	if (!PlayerId.IsValid())
+	{
+		return;
+	}
+
+	// A join cancels a leave that hasn't been sent yet
+	RemovePlayer(PendingPlayerUnregistrations, *PlayerId);
+	if (!ContainsPlayer(PendingPlayerRegistrations, *PlayerId))
+	{
+		PendingPlayerRegistrations.Add(PlayerId.ToSharedRef());
+	}
+
+	ScheduleSessionPlayerRegistryFlush();
+}
+
+void UEnhancedOnlineSessionsSubsystem::UnregisterSessionPlayer(AController* Controller)
+{
+	using namespace EnhancedOnlineRegistry;
+
+	FUniqueNetIdPtr PlayerId = GetPlayerId(Controller);
+	if (!PlayerId.IsValid())
+	{
+		return;
+	}
+
+	RemovePlayer(PendingPlayerRegistrations, *PlayerId);
+	if (!ContainsPlayer(PendingPlayerUnregistrations, *PlayerId))
+	{
+		PendingPlayerUnregistrations.Add(PlayerId.ToSharedRef());
+	}
+
+	ScheduleSessionPlayerRegistryFlush();
+}
+
+void UEnhancedOnlineSessionsSubsystem::ScheduleSessionPlayerRegistryFlush()
+{
+	FTimerManager& TimerManager = GetGameInstance()->GetTimerManager();
+	const float Interval = FMath::Max(0.01f, CVarEnhancedRegistryFlushInterval.GetValueOnGameThread());
+
+	// Players joining or leaving don't wait for the backoff of a retry
+	if (!TimerManager.IsTimerActive(PlayerRegistryFlushTimerHandle) || TimerManager.GetTimerRemaining(PlayerRegistryFlushTimerHandle) > Interval)
+	{
+		TimerManager.SetTimer(PlayerRegistryFlushTimerHandle, this, &ThisClass::FlushSessionPlayerRegistry, Interval, false);
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::RetrySessionPlayerRegistry(FName SessionName, const TArray<FUniqueNetIdRef>& Players, bool bRegister)
+{
+	using namespace EnhancedOnlineRegistry;
+
+	IOnlineSessionPtr Sessions = GetOnlineInterfaces().Sessions;
+	if (!Sessions.IsValid() || Sessions->GetNamedSession(SessionName) == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Verbose, TEXT("Session %s is gone, not retrying %d players."), *SessionName.ToString(), Players.Num());
+		RemoveFailures(PlayerRegistryFailures, Players);
+		return;
+	}
+
+	const int32 MaxRetries = FMath::Max(0, CVarEnhancedRegistryMaxRetries.GetValueOnGameThread());
+	TArray<FUniqueNetIdRef>& Pending = bRegister ? PendingPlayerRegistrations : PendingPlayerUnregistrations;
+	const TArray<FUniqueNetIdRef>& Opposite = bRegister ? PendingPlayerUnregistrations : PendingPlayerRegistrations;
+
+	// Retry everyone that didn't change its mind in the meantime
+	int32 MaxFailures = 0;
+	for (const FUniqueNetIdRef& PlayerId : Players)
+	{
+		if (ContainsPlayer(Opposite, *PlayerId) || ContainsPlayer(Pending, *PlayerId))
+		{
+			continue;
+		}
+
+		const int32 NumFailures = AddFailure(PlayerRegistryFailures, PlayerId);
+		if (NumFailures > MaxRetries)
+		{
+			UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Giving up on %s %s after %d failed attempts."), bRegister ? TEXT("registering") : TEXT("unregistering"), *PlayerId->ToString(), NumFailures);
+			RemoveFailures(PlayerRegistryFailures, { PlayerId });
+			continue;
+		}
+
+		Pending.Add(PlayerId);
+		MaxFailures = FMath::Max(MaxFailures, NumFailures);
+	}
+
+	if (MaxFailures == 0)
+	{
+		return;
+	}
+
+	FTimerManager& TimerManager = GetGameInstance()->GetTimerManager();
+	if (!TimerManager.IsTimerActive(PlayerRegistryFlushTimerHandle))
+	{
+		const float Interval = FMath::Max(0.01f, CVarEnhancedRegistryFlushInterval.GetValueOnGameThread());
+		const float Delay = FMath::Min(Interval * FMath::Pow(2.0f, static_cast<float>(MaxFailures)), FMath::Max(Interval, CVarEnhancedRegistryMaxRetryDelay.GetValueOnGameThread()));
+		TimerManager.SetTimer(PlayerRegistryFlushTimerHandle, this, &ThisClass::FlushSessionPlayerRegistry, Delay, false);
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::FlushSessionPlayerRegistry()
+{
+	using namespace EnhancedOnlineRegistry;
+
+	GetGameInstance()->GetTimerManager().ClearTimer(PlayerRegistryFlushTimerHandle);
+
+	if (PendingPlayerRegistrations.Num() == 0 && PendingPlayerUnregistrations.Num() == 0)
+	{
+		return;
+	}
+
+	IOnlineSessionPtr Sessions = GetOnlineInterfaces().Sessions;
+	FNamedOnlineSession* Session = Sessions.IsValid() ? Sessions->GetNamedSession(GetActiveSessionName(Sessions)) : nullptr;
+	if (Session == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Verbose, TEXT("No hosted session, dropping %d pending registrations and %d unregistrations."), PendingPlayerRegistrations.Num(), PendingPlayerUnregistrations.Num());
+		PendingPlayerRegistrations.Reset();
+		PendingPlayerUnregistrations.Reset();
+		PlayerRegistryFailures.Reset();
+		return;
+	}
+
+	// Reconcile with the members the backend already knows about
+	TArray<FUniqueNetIdRef> ToRegister;
+	for (const FUniqueNetIdRef& PlayerId : PendingPlayerRegistrations)
+	{
+		if (!ContainsPlayer(Session->RegisteredPlayers, *PlayerId))
+		{
+			ToRegister.Add(PlayerId);
+		}
+	}
+
+	TArray<FUniqueNetIdRef> ToUnregister;
+	for (const FUniqueNetIdRef& PlayerId : PendingPlayerUnregistrations)
+	{
+		if (ContainsPlayer(Session->RegisteredPlayers, *PlayerId))
+		{
+			ToUnregister.Add(PlayerId);
+		}
+	}
+
+	PendingPlayerRegistrations.Reset();
+	PendingPlayerUnregistrations.Reset();
+
+	if (ToRegister.Num() > 0)
+	{
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Registering %d players with session %s."), ToRegister.Num(), *Session->SessionName.ToString());
+
+		if (!RegisterPlayersDelegateHandle.IsValid())
+		{
+			RegisterPlayersDelegateHandle = Sessions->AddOnRegisterPlayersCompleteDelegate_Handle(FOnRegisterPlayersCompleteDelegate::CreateUObject(this, &ThisClass::HandleRegisterPlayersComplete));
+		}
+
+		Sessions->RegisterPlayers(Session->SessionName, ToRegister, false);
+	}
+
+	if (ToUnregister.Num() > 0)
+	{
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Unregistering %d players from session %s."), ToUnregister.Num(), *Session->SessionName.ToString());
+
+		if (!UnregisterPlayersDelegateHandle.IsValid())
+		{
+			UnregisterPlayersDelegateHandle = Sessions->AddOnUnregisterPlayersCompleteDelegate_Handle(FOnUnregisterPlayersCompleteDelegate::CreateUObject(this, &ThisClass::HandleUnregisterPlayersComplete));
+		}
+
+		Sessions->UnregisterPlayers(Session->SessionName, ToUnregister);
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleRegisterPlayersComplete(FName SessionName, const TArray<FUniqueNetIdRef>& Players, bool bWasSuccessful)
+{
+	FEnhancedOnlineHitchScope HitchScope(TEXT("HandleRegisterPlayersComplete"));
+	HitchScope.SetResultCount(Players.Num());
+	MarkStateSnapshotDirty();
+
+	using namespace EnhancedOnlineRegistry;
+
+	if (bWasSuccessful)
+	{
+		RemoveFailures(PlayerRegistryFailures, Players);
+		return;
+	}
+
+	UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Failed to register %d players with session %s."), Players.Num(), *SessionName.ToString());
+	RetrySessionPlayerRegistry(SessionName, Players, true);
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleUnregisterPlayersComplete(FName SessionName, const TArray<FUniqueNetIdRef>& Players, bool bWasSuccessful)
+{
+	FEnhancedOnlineHitchScope HitchScope(TEXT("HandleUnregisterPlayersComplete"));
+	HitchScope.SetResultCount(Players.Num());
+	MarkStateSnapshotDirty();
+
+	using namespace EnhancedOnlineRegistry;
+
+	if (bWasSuccessful)
+	{
+		RemoveFailures(PlayerRegistryFailures, Players);
+		return;
+	}
+
+	UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Failed to unregister %d players from session %s."), Players.Num(), *SessionName.ToString());
+	RetrySessionPlayerRegistry(SessionName, Players, false);
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleGameModePostLogin(AGameModeBase* GameMode, APlayerController* NewPlayer)
+{
+	if (GameMode == nullptr || GameMode->GetGameInstance() != GetGameInstance())
+	{
+		return;
+	}
+
+	ConsumeSlotReservation(GameMode, NewPlayer);
+
+	if (CVarEnhancedRegistryAutoRegister.GetValueOnGameThread())
+	{
+		RegisterSessionPlayer(NewPlayer);
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleGameModeLogout(AGameModeBase* GameMode, AController* Exiting)
+{
+	if (GameMode && GameMode->GetGameInstance() == GetGameInstance() && CVarEnhancedRegistryAutoRegister.GetValueOnGameThread())
+	{
+		UnregisterSessionPlayer(Exiting);
+	}
+}
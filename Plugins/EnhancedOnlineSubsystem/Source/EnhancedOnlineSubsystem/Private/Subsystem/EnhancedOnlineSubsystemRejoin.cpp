@@ -0,0 +1,278 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineSessionsSubsystem.h"
+
+#include "EnhancedOnlineHitchDetector.h"
+#include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineSubsystem.h"
+#include "OnlineSessionSettings.h"
+#include "Engine/LocalPlayer.h"
+#include "GameFramework/PlayerController.h"
+#include "Kismet/GameplayStatics.h"
+#include "Online/OnlineSessionNames.h"
+#include "Persistence/EnhancedOnlineLastSessionCache.h"
+
+static TAutoConsoleVariable<float> CVarEnhancedRejoinMaxRecordAgeMinutes(
+	TEXT("EnhancedOnline.Rejoin.MaxRecordAgeMinutes"),
+	60.0f,
+	TEXT("The last joined session is only rejoined within this many minutes after joining it. 0 keeps the record forever."));
+
+namespace EnhancedOnlineRejoin
+{
+	static bool IsRecordExpired(const FEnhancedOnlineLastSessionRecord& Record)
+	{
+		const float MaxAgeMinutes = CVarEnhancedRejoinMaxRecordAgeMinutes.GetValueOnGameThread();
+		return MaxAgeMinutes > 0.0f && (FDateTime::UtcNow() - Record.JoinedAt).GetTotalMinutes() > MaxAgeMinutes;
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::RecordLastSession(int32 LocalUserIndex, const FOnlineSessionSearchResult& SearchResult, const FString& ConnectString)
+{
+	FEnhancedOnlineLastSessionRecord Record;
+	Record.SessionId = SearchResult.GetSessionIdStr();
+	Record.ConnectString = ConnectString;
+	Record.OwningUserName = SearchResult.Session.OwningUserName;
+	Record.JoinedAt = FDateTime::UtcNow();
+	SearchResult.Session.SessionSettings.Get(SEARCH_KEYWORDS, Record.SearchKeyword);
+
+	if (Record.SessionId.IsEmpty())
+	{
+		return;
+	}
+
+	UE_LOG(LogEnhancedSubsystem, Verbose, TEXT("Recording session %s (%s) as the last session of local user %d."), *Record.SessionId, *Record.ConnectString, LocalUserIndex);
+	FEnhancedOnlineLastSessionCache::Save(LocalUserIndex, Record);
+}
+
+bool UEnhancedOnlineSessionsSubsystem::HasLastSession(int32 LocalUserIndex) const
+{
+	FEnhancedOnlineLastSessionRecord Record;
+	return FEnhancedOnlineLastSessionCache::Load(LocalUserIndex, Record) && !EnhancedOnlineRejoin::IsRecordExpired(Record);
+}
+
+void UEnhancedOnlineSessionsSubsystem::ForgetLastSession(int32 LocalUserIndex)
+{
+	FEnhancedOnlineLastSessionCache::Clear(LocalUserIndex);
+}
+
+void UEnhancedOnlineSessionsSubsystem::RejoinLastSession(UEnhancedOnlineRequest_RejoinLastSession* Request)
+{
+	if (Request == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Rejoin Last Session was called with a bad request."));
+		return;
+	}
+
+	TRACE_ENHANCED_REQUEST_BEGIN(Request);
+
+	if (IsValid(PendingRejoinRequest))
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("A rejoin is already in progress."));
+		Request->FailRequest(TEXT("A rejoin is already in progress."));
+		return;
+	}
+
+	TSharedRef<FEnhancedOnlineLastSessionRecord> Record = MakeShared<FEnhancedOnlineLastSessionRecord>();
+	if (!FEnhancedOnlineLastSessionCache::Load(Request->LocalUserIndex, *Record))
+	{
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("There is no session to rejoin."));
+		Request->FailRequest(TEXT("There is no session to rejoin."));
+		return;
+	}
+
+	if (EnhancedOnlineRejoin::IsRecordExpired(*Record))
+	{
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("The last session is too old to rejoin."));
+		FEnhancedOnlineLastSessionCache::Clear(Request->LocalUserIndex);
+		Request->FailRequest(TEXT("The last session is too old to rejoin."));
+		return;
+	}
+
+	APlayerController* PlayerController = UGameplayStatics::GetPlayerController(Request->GetWorld(), Request->LocalUserIndex);
+	ULocalPlayer* LocalPlayer = PlayerController ? PlayerController->GetLocalPlayer() : nullptr;
+	FUniqueNetIdPtr UserId = LocalPlayer ? LocalPlayer->GetPreferredUniqueNetId().GetUniqueNetId() : nullptr;
+	if (!UserId.IsValid())
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Rejoin Last Session was called with a bad local user index: %d."), Request->LocalUserIndex);
+		Request->FailRequest(FString::Printf(TEXT("Rejoin Last Session was called with a bad local user index: %d."), Request->LocalUserIndex));
+		return;
+	}
+
+	PendingRejoinRequest = Request;
+	PendingRejoinRecord = Record;
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Rejoining session %s (%s)..."), *Record->SessionId, *Record->ConnectString);
+
+	// A lookup by id is a single request to the backend, much cheaper than searching
+	IOnlineSessionPtr Sessions = Request->Sessions;
+	FUniqueNetIdPtr SessionId = Sessions->CreateSessionIdFromString(Record->SessionId);
+	TRACE_ENHANCED_REQUEST_DISPATCH(Request, TEXT("FindSessionById"), Record->SessionId.Len());
+	if (!SessionId.IsValid() || !Sessions->FindSessionById(*UserId, *SessionId, *UserId, FOnSingleSessionResultCompleteDelegate::CreateUObject(this, &ThisClass::HandleRejoinSessionFound)))
+	{
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("The session can't be looked up directly, searching for it instead."));
+		IssueRejoinSearch();
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleRejoinSessionFound(int32 LocalUserNum, bool bWasSuccessful, const FOnlineSessionSearchResult& SearchResult)
+{
+	FEnhancedOnlineHitchScope HitchScope(TEXT("HandleRejoinSessionFound"), PendingRejoinRequest);
+	TRACE_ENHANCED_REQUEST_CALLBACK(PendingRejoinRequest, TEXT("FindSessionById"), bWasSuccessful, FEnhancedOnlineRequestTrace::GetPayloadSize(SearchResult.Session.SessionSettings));
+
+	UEnhancedOnlineRequest_RejoinLastSession* Request = PendingRejoinRequest;
+	if (Request == nullptr)
+	{
+		return;
+	}
+
+	if (!bWasSuccessful || !SearchResult.IsValid())
+	{
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("The last session could not be looked up, searching for it instead."));
+		IssueRejoinSearch();
+		return;
+	}
+
+	UEnhancedSessionSearchResult* Candidate = NewObject<UEnhancedSessionSearchResult>(Request);
+	Candidate->StoredSearchResult = SearchResult;
+	ApplyPingEstimate(Candidate);
+
+	JoinRejoinCandidate(Candidate, false);
+}
+
+void UEnhancedOnlineSessionsSubsystem::IssueRejoinSearch()
+{
+	UEnhancedOnlineRequest_RejoinLastSession* Request = PendingRejoinRequest;
+	if (Request == nullptr || !PendingRejoinRecord.IsValid())
+	{
+		return;
+	}
+
+	if (!Request->bAllowSearchFallback)
+	{
+		FinishRejoin(false, false, TEXT("The last session is gone."));
+		return;
+	}
+
+	// Without the keyword the search would list every session of the backend
+	if (PendingRejoinRecord->SearchKeyword.IsEmpty())
+	{
+		FinishRejoin(false, false, TEXT("The last session is gone and was advertised without a keyword to search for."));
+		return;
+	}
+
+	UEnhancedOnlineRequest_FindSessions* FindRequest = NewObject<UEnhancedOnlineRequest_FindSessions>(Request);
+	FindRequest->ConstructRequest();
+	FindRequest->bInvalidateOnCompletion = false;
+	FindRequest->LocalUserIndex = Request->LocalUserIndex;
+	FindRequest->OnlineMode = EEnhancedSessionOnlineMode::Online;
+	FindRequest->bFindLobbies = false;
+	FindRequest->MaxSearchResults = Request->MaxSearchResults;
+	FindRequest->SearchKeyword = PendingRejoinRecord->SearchKeyword;
+
+	// Only the session itself or a session of the same owner, e.g. after the server restarted the match, is of interest
+	FindRequest->ResultFilter = [SessionId = PendingRejoinRecord->SessionId, OwningUserName = PendingRejoinRecord->OwningUserName](const FOnlineSessionSearchResult& SearchResult)
+	{
+		return SearchResult.GetSessionIdStr() == SessionId || (!OwningUserName.IsEmpty() && SearchResult.Session.OwningUserName == OwningUserName);
+	};
+	FindRequest->ResultScorer = [SessionId = PendingRejoinRecord->SessionId](const FOnlineSessionSearchResult& SearchResult)
+	{
+		return SearchResult.GetSessionIdStr() == SessionId ? 1.0f : 0.0f;
+	};
+
+	FindRequest->OnFindOnlineSessionsCompleted.AddWeakLambda(this, [this, Request](const TArray<UEnhancedSessionSearchResult*>& Results)
+	{
+		if (PendingRejoinRequest != Request)
+		{
+			return;
+		}
+
+		if (Results.Num() == 0 || Results[0] == nullptr)
+		{
+			FEnhancedOnlineLastSessionCache::Clear(Request->LocalUserIndex);
+			FinishRejoin(false, true, TEXT("The last session is gone."));
+			return;
+		}
+
+		JoinRejoinCandidate(Results[0], true);
+	});
+
+	FindRequest->OnRequestFailedDelegate.AddWeakLambda(this, [this, Request](const FString& Reason)
+	{
+		if (PendingRejoinRequest == Request)
+		{
+			FinishRejoin(false, true, Reason);
+		}
+	});
+
+	FindOnlineSessions(FindRequest);
+}
+
+void UEnhancedOnlineSessionsSubsystem::JoinRejoinCandidate(UEnhancedSessionSearchResult* Candidate, bool bFromSearch)
+{
+	UEnhancedOnlineRequest_RejoinLastSession* Request = PendingRejoinRequest;
+	if (Request == nullptr)
+	{
+		return;
+	}
+
+	UEnhancedOnlineRequest_JoinSession* JoinRequest = NewObject<UEnhancedOnlineRequest_JoinSession>(Request);
+	JoinRequest->ConstructRequest();
+	JoinRequest->bInvalidateOnCompletion = false;
+	JoinRequest->LocalUserIndex = Request->LocalUserIndex;
+	JoinRequest->SessionToJoin = Candidate;
+
+	JoinRequest->OnJoinSessionCompleted.AddWeakLambda(this, [this, Request, bFromSearch](const FName SessionName)
+	{
+		if (PendingRejoinRequest == Request)
+		{
+			FinishRejoin(true, bFromSearch, FString());
+		}
+	});
+
+	// The session found by id may still refuse us, e.g. because it is full, a newer session of the same owner might not
+	JoinRequest->OnRequestFailedDelegate.AddWeakLambda(this, [this, Request, bFromSearch](const FString& Reason)
+	{
+		if (PendingRejoinRequest != Request)
+		{
+			return;
+		}
+
+		if (bFromSearch)
+		{
+			FinishRejoin(false, true, Reason);
+		}
+		else
+		{
+			UE_LOG(LogEnhancedSubsystem, Log, TEXT("Rejoining directly failed (%s), searching for the session instead."), *Reason);
+			IssueRejoinSearch();
+		}
+	});
+
+	JoinOnlineSession(JoinRequest);
+}
+
+void UEnhancedOnlineSessionsSubsystem::FinishRejoin(bool bWasSuccessful, bool bUsedSearchFallback, const FString& Error)
+{
+	UEnhancedOnlineRequest_RejoinLastSession* Request = PendingRejoinRequest;
+
+	PendingRejoinRequest = nullptr;
+	PendingRejoinRecord.Reset();
+
+	if (Request == nullptr)
+	{
+		return;
+	}
+
+	if (bWasSuccessful)
+	{
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Rejoined the last session%s."), bUsedSearchFallback ? TEXT(" after searching for it") : TEXT(""));
+		Request->OnRejoinSessionCompleted.Broadcast(bUsedSearchFallback);
+	}
+	else
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Failed to rejoin the last session: %s"), *Error);
+		Request->FailRequest(Error);
+	}
+
+	Request->CompleteRequest();
+}
@@ -0,0 +1,381 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineSessionsSubsystem.h"
+
+#include "EnhancedOnlineHitchDetector.h"
+#include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineReservationBeacon.h"
+#include "EnhancedOnlineSubsystem.h"
+#include "OnlineBeaconHost.h"
+#include "OnlineSessionSettings.h"
+#include "TimerManager.h"
+#include "Algo/Count.h"
+#include "Engine/GameInstance.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/NetConnection.h"
+#include "Engine/World.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/GameSession.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "Kismet/GameplayStatics.h"
+#include "Online/OnlineSessionNames.h"
+#include "Persistence/EnhancedOnlinePingHistory.h"
+
+static TAutoConsoleVariable<bool> CVarEnhancedReservationEnabled(
+	TEXT("EnhancedOnline.Reservation.Enabled"),
+	true,
+	TEXT("Whether hosted game sessions run a reservation beacon and clients reserve a slot through it before joining."));
+
+static TAutoConsoleVariable<bool> CVarEnhancedReservationRequired(
+	TEXT("EnhancedOnline.Reservation.Required"),
+	true,
+	TEXT("Whether the host refuses players that join without a reserved slot while its reservation beacon is running."));
+
+static TAutoConsoleVariable<float> CVarEnhancedReservationTokenLifetime(
+	TEXT("EnhancedOnline.Reservation.TokenLifetimeSeconds"),
+	30.0f,
+	TEXT("Seconds a reserved slot is held for a player to join and travel before it is given to someone else."));
+
+namespace EnhancedOnlineReservation
+{
+	static FEnhancedSlotReservation* FindReservation(TArray<FEnhancedSlotReservation>& Reservations, const FUniqueNetId& PlayerId)
+	{
+		return Reservations.FindByPredicate([&PlayerId](const FEnhancedSlotReservation& Reservation) { return Reservation.PlayerId.IsValid() && *Reservation.PlayerId == PlayerId; });
+	}
+}
+
+// Only game sessions hand out slots, lobbies are joined without a reservation and never run the beacon
+void UEnhancedOnlineSessionsSubsystem::AdvertiseReservationBeacon(FOnlineSessionSettings& InSessionSettings) const
+{
+	if (CVarEnhancedReservationEnabled.GetValueOnGameThread())
+	{
+		// Clients only ask for a slot if the session tells them where the beacon listens
+		InSessionSettings.Set(SETTING_BEACONPORT, GetMutableDefault<AOnlineBeaconHost>()->GetListenPort(), EOnlineDataAdvertisementType::ViaOnlineService);
+	}
+}
+
+bool UEnhancedOnlineSessionsSubsystem::ReserveSessionSlot(const FUniqueNetIdRepl& PlayerId, FString& OutToken, FString& OutError)
+{
+	using namespace EnhancedOnlineReservation;
+
+	if (!PlayerId.IsValid())
+	{
+		OutError = TEXT("Slots can only be reserved for logged in players.");
+		return false;
+	}
+
+	IOnlineSessionPtr Sessions = GetOnlineInterfaces().Sessions;
+	const FNamedOnlineSession* Session = Sessions.IsValid() ? Sessions->GetNamedSession(NAME_GameSession) : nullptr;
+	if (Session == nullptr || !Session->bHosting)
+	{
+		OutError = TEXT("The host is not hosting a session anymore.");
+		return false;
+	}
+
+	PruneSlotReservations();
+
+	const double ExpiresAt = FPlatformTime::Seconds() + FMath::Max(1.0f, CVarEnhancedReservationTokenLifetime.GetValueOnGameThread());
+
+	// Asking again, e.g. after the first join failed on the backend, keeps the slot
+	if (FEnhancedSlotReservation* Reservation = FindReservation(SlotReservations, *PlayerId))
+	{
+		Reservation->ExpiresAt = ExpiresAt;
+		OutToken = Reservation->Token;
+		return true;
+	}
+
+	if (!Session->SessionSettings.bAllowJoinInProgress && Session->SessionState == EOnlineSessionState::InProgress)
+	{
+		OutError = TEXT("The session does not allow joining in progress.");
+		return false;
+	}
+
+	const AGameModeBase* GameMode = GetWorld() ? GetWorld()->GetAuthGameMode() : nullptr;
+	const int32 MaxPlayers = Session->SessionSettings.NumPublicConnections + Session->SessionSettings.NumPrivateConnections;
+	const int32 NumPlayers = GameMode ? GameMode->GetNumPlayers() : Session->RegisteredPlayers.Num();
+	if (NumPlayers + SlotReservations.Num() >= MaxPlayers)
+	{
+		UE_LOG(LogEnhancedSubsystem, Verbose, TEXT("Refused a slot for %s, %d players and %d reservations fill all %d slots."), *PlayerId.ToString(), NumPlayers, SlotReservations.Num(), MaxPlayers);
+		OutError = TEXT("The session is full.");
+		return false;
+	}
+
+	FEnhancedSlotReservation& Reservation = SlotReservations.AddDefaulted_GetRef();
+	Reservation.PlayerId = PlayerId.GetUniqueNetId();
+	Reservation.Token = FGuid::NewGuid().ToString(EGuidFormats::Digits);
+	Reservation.ExpiresAt = ExpiresAt;
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Reserved a slot for %s (%d of %d slots taken)."), *PlayerId.ToString(), NumPlayers + SlotReservations.Num(), MaxPlayers);
+
+	OutToken = Reservation.Token;
+	MarkStateSnapshotDirty();
+	return true;
+}
+
+int32 UEnhancedOnlineSessionsSubsystem::GetNumSlotReservations() const
+{
+	const double Now = FPlatformTime::Seconds();
+	return Algo::CountIf(SlotReservations, [Now](const FEnhancedSlotReservation& Reservation) { return Reservation.ExpiresAt > Now; });
+}
+
+void UEnhancedOnlineSessionsSubsystem::PruneSlotReservations()
+{
+	const double Now = FPlatformTime::Seconds();
+	SlotReservations.RemoveAll([Now](const FEnhancedSlotReservation& Reservation) { return Reservation.ExpiresAt <= Now; });
+}
+
+bool UEnhancedOnlineSessionsSubsystem::RequestSlotReservation(UEnhancedOnlineRequest_JoinSession* Request)
+{
+	if (!CVarEnhancedReservationEnabled.GetValueOnGameThread())
+	{
+		return false;
+	}
+
+	// Sessions without a beacon don't take reservations and are joined right away
+	const FOnlineSessionSearchResult& SearchResult = Request->SessionToJoin->StoredSearchResult;
+	int32 BeaconPort = 0;
+	if (!SearchResult.Session.SessionSettings.Get(SETTING_BEACONPORT, BeaconPort) || BeaconPort <= 0)
+	{
+		return false;
+	}
+
+	IOnlineSessionPtr Sessions = GetOnlineInterfaces().Sessions;
+	FString BeaconConnectString;
+	if (!Sessions->GetResolvedConnectString(SearchResult, NAME_BeaconPort, BeaconConnectString))
+	{
+		return false;
+	}
+
+	APlayerController* PlayerController = UGameplayStatics::GetPlayerController(Request->GetWorld(), Request->LocalUserIndex);
+	ULocalPlayer* LocalPlayer = PlayerController ? PlayerController->GetLocalPlayer() : nullptr;
+	if (LocalPlayer == nullptr)
+	{
+		return false;
+	}
+
+	AEnhancedOnlineReservationBeaconClient* Beacon = GetWorld()->SpawnActor<AEnhancedOnlineReservationBeaconClient>();
+	if (Beacon == nullptr)
+	{
+		return false;
+	}
+
+	Beacon->OnReservationResponse.BindUObject(this, &ThisClass::HandleSlotReservationResponse);
+	PendingReservationBeacon = Beacon;
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Reserving a slot at %s..."), *BeaconConnectString);
+
+	TRACE_ENHANCED_REQUEST_DISPATCH(Request, TEXT("ReserveSlot"), BeaconConnectString.Len());
+	if (!Beacon->RequestReservation(BeaconConnectString, LocalPlayer->GetPreferredUniqueNetId()))
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Failed to connect to the reservation beacon at %s, joining without a reservation."), *BeaconConnectString);
+
+		PendingReservationBeacon = nullptr;
+		Beacon->OnReservationResponse.Unbind();
+		Beacon->DestroyBeacon();
+		return false;
+	}
+
+	return true;
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleSlotReservationResponse(EEnhancedSlotReservationResult Result, const FString& Token, const FString& Error)
+{
+	FEnhancedOnlineHitchScope HitchScope(TEXT("HandleSlotReservationResponse"), PendingJoinSessionRequest);
+	TRACE_ENHANCED_REQUEST_CALLBACK(PendingJoinSessionRequest, TEXT("ReserveSlot"), Result == EEnhancedSlotReservationResult::Granted, Token.Len());
+
+	// The beacon can't be torn down from within its own net driver tick
+	float RoundTripMs = 0.0f;
+	if (AEnhancedOnlineReservationBeaconClient* Beacon = PendingReservationBeacon)
+	{
+		RoundTripMs = Beacon->GetRoundTripMs();
+		Beacon->OnReservationResponse.Unbind();
+		GetGameInstance()->GetTimerManager().SetTimerForNextTick(FTimerDelegate::CreateWeakLambda(Beacon, [Beacon]()
+		{
+			Beacon->DestroyBeacon();
+		}));
+	}
+	PendingReservationBeacon = nullptr;
+
+	UEnhancedOnlineRequest_JoinSession* Request = PendingJoinSessionRequest;
+	if (Request == nullptr || Request->SessionToJoin == nullptr)
+	{
+		return;
+	}
+
+	// One request and its answer over a fresh connection, closer to the real latency than the search ping
+	AddPingSample(Request->SessionToJoin->StoredSearchResult, RoundTripMs, EEnhancedPingSource::Probe);
+
+	switch (Result)
+	{
+	case EEnhancedSlotReservationResult::Granted:
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Reserved a slot, joining session..."));
+		PendingSlotReservationToken = Token;
+		break;
+	case EEnhancedSlotReservationResult::Refused:
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("The host refused a slot: %s"), *Error);
+		PendingJoinSessionRequest = nullptr;
+		Request->FailRequest(Error);
+		Request->CompleteRequest();
+		return;
+	case EEnhancedSlotReservationResult::HostUnreachable:
+		// e.g. the beacon port isn't forwarded, the join itself may still get through
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("%s Joining without a reservation."), *Error);
+		break;
+	}
+
+	JoinOnlineSessionInternal(Request, NAME_GameSession);
+}
+
+void UEnhancedOnlineSessionsSubsystem::StartReservationBeacon()
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr || !CVarEnhancedReservationEnabled.GetValueOnGameThread())
+	{
+		return;
+	}
+
+	if (ReservationBeaconHost && ReservationBeaconHost->GetWorld() == World)
+	{
+		return;
+	}
+
+	IOnlineSessionPtr Sessions = GetOnlineInterfaces().Sessions;
+	const FNamedOnlineSession* Session = Sessions.IsValid() ? Sessions->GetNamedSession(NAME_GameSession) : nullptr;
+	if (Session == nullptr || !Session->bHosting)
+	{
+		return;
+	}
+
+	StopReservationBeacon();
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.ObjectFlags |= RF_Transient;
+
+	AOnlineBeaconHost* BeaconHost = World->SpawnActor<AOnlineBeaconHost>(AOnlineBeaconHost::StaticClass(), SpawnParameters);
+	if (BeaconHost == nullptr || !BeaconHost->InitHost())
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to start the reservation beacon, players join without reservations."));
+		if (BeaconHost)
+		{
+			BeaconHost->DestroyBeacon();
+		}
+		return;
+	}
+
+	ReservationBeaconHost = BeaconHost;
+	ReservationBeaconHostObject = World->SpawnActor<AEnhancedOnlineReservationBeaconHostObject>(AEnhancedOnlineReservationBeaconHostObject::StaticClass(), SpawnParameters);
+	ReservationBeaconHost->RegisterHost(ReservationBeaconHostObject);
+	ReservationBeaconHost->PauseBeaconRequests(false);
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Reservation beacon listening on port %d."), ReservationBeaconHost->GetListenPort());
+}
+
+void UEnhancedOnlineSessionsSubsystem::StopReservationBeacon()
+{
+	if (ReservationBeaconHost)
+	{
+		if (ReservationBeaconHostObject)
+		{
+			ReservationBeaconHost->UnregisterHost(ReservationBeaconHostObject->GetBeaconType());
+		}
+		ReservationBeaconHost->DestroyBeacon();
+	}
+
+	if (ReservationBeaconHostObject)
+	{
+		ReservationBeaconHostObject->Destroy();
+	}
+
+	ReservationBeaconHost = nullptr;
+	ReservationBeaconHostObject = nullptr;
+}
+
+void UEnhancedOnlineSessionsSubsystem::ConsumeSlotReservation(AGameModeBase* GameMode, APlayerController* NewPlayer)
+{
+	using namespace EnhancedOnlineReservation;
+
+	const APlayerState* PlayerState = NewPlayer ? NewPlayer->GetPlayerState<APlayerState>() : nullptr;
+	FUniqueNetIdPtr PlayerId = PlayerState ? PlayerState->GetUniqueId().GetUniqueNetId() : nullptr;
+	if (!PlayerId.IsValid() || NewPlayer->IsLocalController())
+	{
+		return;
+	}
+
+	FEnhancedSlotReservation* Reservation = FindReservation(SlotReservations, *PlayerId);
+	if (Reservation == nullptr)
+	{
+		return;
+	}
+
+	const FString Token = Reservation->Token;
+	SlotReservations.RemoveAll([&PlayerId](const FEnhancedSlotReservation& Other) { return Other.PlayerId.IsValid() && *Other.PlayerId == *PlayerId; });
+	MarkStateSnapshotDirty();
+
+	// The slot is held for the id, a different token means someone else is using it
+	const UNetConnection* Connection = NewPlayer->GetNetConnection();
+	const FString TravelToken = Connection ? UGameplayStatics::ParseOption(Connection->RequestURL, TEXT("SlotToken")) : FString();
+	if (TravelToken != Token && CVarEnhancedReservationRequired.GetValueOnGameThread() && GameMode->GameSession)
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Kicking %s, it joined with a slot token that doesn't match its reservation."), *PlayerId->ToString());
+		GameMode->GameSession->KickPlayer(NewPlayer, FText::FromString(TEXT("Invalid slot reservation.")));
+		return;
+	}
+
+	// The reservation is gone now, but the player reconnects without one after every non-seamless travel
+	if (!AdmittedSlotPlayers.ContainsByPredicate([&PlayerId](const FUniqueNetIdRef& Other) { return *Other == *PlayerId; }))
+	{
+		AdmittedSlotPlayers.Add(PlayerId.ToSharedRef());
+	}
+}
+
+bool UEnhancedOnlineSessionsSubsystem::IsAdmittedToHostedSession(const FUniqueNetId& PlayerId)
+{
+	if (AdmittedSlotPlayers.ContainsByPredicate([&PlayerId](const FUniqueNetIdRef& Other) { return *Other == PlayerId; }))
+	{
+		return true;
+	}
+
+	// Players registered with the backend session got in before the beacon started, e.g. lobby members on a handoff
+	IOnlineSessionPtr Sessions = GetOnlineInterfaces().Sessions;
+	const FNamedOnlineSession* Session = Sessions.IsValid() ? Sessions->GetNamedSession(NAME_GameSession) : nullptr;
+	return Session && Session->RegisteredPlayers.ContainsByPredicate([&PlayerId](const FUniqueNetIdRef& Other) { return *Other == PlayerId; });
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleGameModeInitialized(AGameModeBase* GameMode)
+{
+	if (GameMode && GameMode->GetGameInstance() == GetGameInstance())
+	{
+		StartReservationBeacon();
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleGameModePreLogin(AGameModeBase* GameMode, const FUniqueNetIdRepl& NewPlayer, FString& ErrorMessage)
+{
+	using namespace EnhancedOnlineReservation;
+
+	if (GameMode == nullptr || GameMode->GetGameInstance() != GetGameInstance() || !ErrorMessage.IsEmpty())
+	{
+		return;
+	}
+
+	if (ReservationBeaconHost == nullptr || !CVarEnhancedReservationRequired.GetValueOnGameThread())
+	{
+		return;
+	}
+
+	PruneSlotReservations();
+
+	// Only new connections need a reservation, players already in the session come back after every non-seamless travel
+	if (NewPlayer.IsValid() && IsAdmittedToHostedSession(*NewPlayer))
+	{
+		return;
+	}
+
+	// Refused before the player loads anything, the slot it hoped for is already taken
+	if (!NewPlayer.IsValid() || FindReservation(SlotReservations, *NewPlayer) == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Refusing %s, it holds no slot reservation."), *NewPlayer.ToString());
+		ErrorMessage = TEXT("No slot is reserved for this player.");
+	}
+}
@@ -2,13 +2,34 @@
 
 #include "EnhancedOnlineSessionsSubsystem.h"
 
+#include "EnhancedCompactSessionSettings.h"
+#include "EnhancedOnlineHitchDetector.h"
 #include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineSearchDecoding.h"
 #include "EnhancedOnlineSubsystem.h"
 #include "OnlineSessionSettings.h"
+#include "Persistence/EnhancedOnlineLastSessionCache.h"
+#include "Persistence/EnhancedOnlineServerListCache.h"
+#include "Algo/StableSort.h"
 #include "Interfaces/OnlineSessionInterface.h"
 #include "Kismet/GameplayStatics.h"
 #include "Online/OnlineSessionNames.h"
 
+static TAutoConsoleVariable<int32> CVarEnhancedCompactSearchResultsThreshold(
+	TEXT("EnhancedOnline.Sessions.CompactResultsThreshold"),
+	256,
+	TEXT("Search results are stored in the compact, interned representation once a search returns at least this many sessions. 0 disables compaction."));
+
+static TAutoConsoleVariable<bool> CVarEnhancedParallelDecode(
+	TEXT("EnhancedOnline.Sessions.ParallelDecode"),
+	true,
+	TEXT("Whether search results are decoded, filtered and scored on worker threads."));
+
+static TAutoConsoleVariable<float> CVarEnhancedMaterializeBudgetMs(
+	TEXT("EnhancedOnline.Sessions.MaterializeBudgetMs"),
+	2.0f,
+	TEXT("Milliseconds per frame that may be spent wrapping search results into objects, the rest is continued on the next frames. 0 wraps everything at once."));
+
 void UEnhancedOnlineSessionsSubsystem::HostOnlineSession(UEnhancedOnlineRequest_Session* Request)
 {
 	if (Request == nullptr)
@@ -17,10 +38,20 @@ void UEnhancedOnlineSessionsSubsystem::HostOnlineSession(UEnhancedOnlineRequest_
 		return;
 	}
 
+	TRACE_ENHANCED_REQUEST_BEGIN(Request);
+
 	if (IsValid(PendingSessionRequest))
 	{
 		UE_LOG(LogEnhancedSubsystem, Error, TEXT("A session is already being hosted."));
-		Request->OnRequestFailedDelegate.Broadcast(TEXT("A session is already being hosted."));
+		Request->FailRequest(TEXT("A session is already being hosted."));
+		return;
+	}
+
+	// Dedicated servers have no local player to host with
+	UEnhancedOnlineRequest_CreateSession* CreateSessionRequest = Cast<UEnhancedOnlineRequest_CreateSession>(Request);
+	if (CreateSessionRequest && CreateSessionRequest->bIsDedicated && Request->OnlineMode != EEnhancedSessionOnlineMode::Offline)
+	{
+		HostOnlineSessionInternal(nullptr, CreateSessionRequest);
 		return;
 	}
 
@@ -28,7 +59,7 @@ void UEnhancedOnlineSessionsSubsystem::HostOnlineSession(UEnhancedOnlineRequest_
 	if (PlayerController == nullptr)
 	{
 		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Host Online Session was called with a bad local user index."));
-		Request->OnRequestFailedDelegate.Broadcast(TEXT("Host Online Session was called with a bad local user index."));
+		Request->FailRequest(TEXT("Host Online Session was called with a bad local user index."));
 		return;
 	}
 
@@ -36,7 +67,7 @@ void UEnhancedOnlineSessionsSubsystem::HostOnlineSession(UEnhancedOnlineRequest_
 	if (LocalPlayer == nullptr)
 	{
 		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Host Online Session was called with a bad local user index: %d."), Request->LocalUserIndex);
-		Request->OnRequestFailedDelegate.Broadcast(FString::Printf(TEXT("Host Online Session was called with a bad local user index: %d."), Request->LocalUserIndex));
+		Request->FailRequest(FString::Printf(TEXT("Host Online Session was called with a bad local user index: %d."), Request->LocalUserIndex));
 		return;
 	}
 
@@ -44,11 +75,12 @@ void UEnhancedOnlineSessionsSubsystem::HostOnlineSession(UEnhancedOnlineRequest_
 	{
 		if (GetWorld()->GetNetMode() == NM_Client)
 		{
-			Request->OnRequestFailedDelegate.Broadcast(TEXT("Cannot host an offline session on a client."));
+			Request->FailRequest(TEXT("Cannot host an offline session on a client."));
 			return;
 		}
 
 		GetWorld()->ServerTravel(Request->GetTravelURL().ToString());
+		TRACE_ENHANCED_REQUEST_END(Request, true, TEXT("Offline"));
 	}
 	else
 	{
@@ -63,7 +95,7 @@ void UEnhancedOnlineSessionsSubsystem::HostOnlineSession(UEnhancedOnlineRequest_
 		else
 		{
 			UE_LOG(LogEnhancedSubsystem, Error, TEXT("Host Online Session was called with a bad request."));
-			Request->OnRequestFailedDelegate.Broadcast(TEXT("Host Online Session was called with a bad request."));
+			Request->FailRequest(TEXT("Host Online Session was called with a bad request."));
 		}
 	}
 }
@@ -91,18 +123,22 @@ void UEnhancedOnlineSessionsSubsystem::HostOnlineLobbyInternal(ULocalPlayer* Loc
 		SessionSettings->Set(SETTING_MATCHING_TIMEOUT, 120.0f, EOnlineDataAdvertisementType::ViaOnlineService);
 		SessionSettings->Set(SETTING_SESSION_TEMPLATE_NAME, FString("GameSession"), EOnlineDataAdvertisementType::DontAdvertise);
 		SessionSettings->Set(SETTING_FRIENDLYNAME, Request->FriendlyName, EOnlineDataAdvertisementType::ViaOnlineService);
+		SessionSettings->Set(SETTING_LOBBY, true, EOnlineDataAdvertisementType::ViaOnlineService);
 
 		FSessionSettings& UserSettings = SessionSettings->MemberSettings.Add(UserId.ToSharedRef(), FSessionSettings());
 		UserSettings.Add(SETTING_GAMEMODE, FOnlineSessionSetting(FString("GameSession"), EOnlineDataAdvertisementType::ViaOnlineService));
 		
 		PendingSessionRequest = Request;
+		LobbyLocalUserIndex = Request->LocalUserIndex;
 
 		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Hosting lobby with %d players..."), Request->GetMaxPlayers());
 
-		if (!Request->Sessions->CreateSession(0, NAME_GameSession, *SessionSettings))
+		// Lobbies live next to the game session so they can be handed off to one
+		TRACE_ENHANCED_REQUEST_DISPATCH(Request, TEXT("CreateLobby"), FEnhancedOnlineRequestTrace::GetPayloadSize(*SessionSettings));
+		if (!Request->Sessions->CreateSession(0, NAME_PartySession, *SessionSettings))
 		{
 			UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to create lobby."));
-			Request->OnRequestFailedDelegate.Broadcast(TEXT("Failed to create lobby."));
+			Request->FailRequest(TEXT("Failed to create lobby."));
 
 			/* Clear the delegate handle */
 			Request->Sessions->ClearOnCreateSessionCompleteDelegate_Handle(HostLobbyDelegateHandle);
@@ -114,8 +150,10 @@ void UEnhancedOnlineSessionsSubsystem::HostOnlineLobbyInternal(ULocalPlayer* Loc
 
 void UEnhancedOnlineSessionsSubsystem::HandleHostOnlineLobbyComplete(FName SessionName, bool bWasSuccessful)
 {
-	IOnlineSubsystem* OnlineSub = Online::GetSubsystem(GetWorld());
-	IOnlineSessionPtr Sessions = OnlineSub->GetSessionInterface();
+	FEnhancedOnlineHitchScope HitchScope(TEXT("HandleHostOnlineLobbyComplete"), PendingSessionRequest);
+	TRACE_ENHANCED_REQUEST_CALLBACK(PendingSessionRequest, TEXT("CreateLobby"), bWasSuccessful, 0);
+
+	IOnlineSessionPtr Sessions = GetOnlineInterfaces().Sessions;
 
 	if (bWasSuccessful)
 	{
@@ -139,7 +177,7 @@ void UEnhancedOnlineSessionsSubsystem::HandleHostOnlineLobbyComplete(FName Sessi
 	{
 		if (PendingSessionRequest)
 		{
-			PendingSessionRequest->OnRequestFailedDelegate.Broadcast(TEXT("Failed to create lobby."));
+			PendingSessionRequest->FailRequest(TEXT("Failed to create lobby."));
 		}
 		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to create lobby."));
 	}
@@ -162,14 +200,15 @@ void UEnhancedOnlineSessionsSubsystem::HostOnlineSessionInternal(ULocalPlayer* L
 	check(Request->OnlineSub);
 	check(Request->Sessions);
 
-	FUniqueNetIdPtr UserId = LocalPlayer->GetPreferredUniqueNetId().GetUniqueNetId();
+	FUniqueNetIdPtr UserId = LocalPlayer ? LocalPlayer->GetPreferredUniqueNetId().GetUniqueNetId() : nullptr;
 
-	if (ensure(UserId.IsValid()))
+	if (Request->bIsDedicated || ensure(UserId.IsValid()))
 	{
 		HostSessionDelegateHandle = Request->Sessions->AddOnCreateSessionCompleteDelegate_Handle(FOnCreateSessionCompleteDelegate::CreateUObject(this, &ThisClass::HandleHostOnlineSessionComplete));
 
-		SessionSettings = MakeShared<FEnhancedOnlineSessionSettings>(Request->OnlineMode == EEnhancedSessionOnlineMode::LAN, Request->bUsesPresence, Request->GetMaxPlayers(), Request->bAllowJoinInProgress);
-		SessionSettings->bUseLobbiesIfAvailable = Request->bUseLobbiesIfAvailable;
+		SessionSettings = MakeShared<FEnhancedOnlineSessionSettings>(Request->OnlineMode == EEnhancedSessionOnlineMode::LAN, Request->bUsesPresence && !Request->bIsDedicated, Request->GetMaxPlayers(), Request->bAllowJoinInProgress);
+		SessionSettings->bIsDedicated = Request->bIsDedicated;
+		SessionSettings->bUseLobbiesIfAvailable = Request->bUseLobbiesIfAvailable && !Request->bIsDedicated;
 		SessionSettings->bUseLobbiesVoiceChatIfAvailable = Request->bUseVoiceChatIfAvailable;
 		SessionSettings->Set(SETTING_GAMEMODE, Request->GameModeAdvertisementName, EOnlineDataAdvertisementType::ViaOnlineService);
 		SessionSettings->Set(SETTING_MAPNAME, Request->GetMapName(), EOnlineDataAdvertisementType::ViaOnlineService);
@@ -178,38 +217,80 @@ void UEnhancedOnlineSessionsSubsystem::HostOnlineSessionInternal(ULocalPlayer* L
 		SessionSettings->Set(SETTING_SESSION_TEMPLATE_NAME, FString("GameSession"), EOnlineDataAdvertisementType::DontAdvertise);
 		SessionSettings->Set(SETTING_FRIENDLYNAME, Request->FriendlyName, EOnlineDataAdvertisementType::ViaOnlineService);
 
-		FSessionSettings& UserSettings = SessionSettings->MemberSettings.Add(UserId.ToSharedRef(), FSessionSettings());
-		UserSettings.Add(SETTING_GAMEMODE, FOnlineSessionSetting(Request->GameModeAdvertisementName, EOnlineDataAdvertisementType::ViaOnlineService));
+		AdvertiseReservationBeacon(*SessionSettings);
+
+		if (!Request->Region.IsEmpty())
+		{
+			SessionSettings->Set(SETTING_REGION, Request->Region, EOnlineDataAdvertisementType::ViaOnlineService);
+		}
+
+		if (UserId.IsValid())
+		{
+			FSessionSettings& UserSettings = SessionSettings->MemberSettings.Add(UserId.ToSharedRef(), FSessionSettings());
+			UserSettings.Add(SETTING_GAMEMODE, FOnlineSessionSetting(Request->GameModeAdvertisementName, EOnlineDataAdvertisementType::ViaOnlineService));
+		}
 
 		PendingSessionRequest = Request;
 
-		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Hosting session with %d players..."), Request->GetMaxPlayers());
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Hosting %s session with %d players..."), Request->bIsDedicated ? TEXT("dedicated") : TEXT("listen"), Request->GetMaxPlayers());
 
+		TRACE_ENHANCED_REQUEST_DISPATCH(Request, TEXT("CreateSession"), FEnhancedOnlineRequestTrace::GetPayloadSize(*SessionSettings));
 		if (!Request->Sessions->CreateSession(0, NAME_GameSession, *SessionSettings))
 		{
 			UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to create session."));
-			Request->OnRequestFailedDelegate.Broadcast(TEXT("Failed to create session."));
+			Request->FailRequest(TEXT("Failed to create session."));
 
 			/* Clear the delegate handle */
 			Request->Sessions->ClearOnCreateSessionCompleteDelegate_Handle(HostSessionDelegateHandle);
 			HostSessionDelegateHandle.Reset();
+			PendingSessionRequest = nullptr;
 		}
 	}
 }
 
 void UEnhancedOnlineSessionsSubsystem::HandleHostOnlineSessionComplete(FName SessionName, bool bWasSuccessful)
 {
-	IOnlineSubsystem* OnlineSub = Online::GetSubsystem(GetWorld());
-	IOnlineSessionPtr Sessions = OnlineSub->GetSessionInterface();
+	FEnhancedOnlineHitchScope HitchScope(TEXT("HandleHostOnlineSessionComplete"), PendingSessionRequest);
+	TRACE_ENHANCED_REQUEST_CALLBACK(PendingSessionRequest, TEXT("CreateSession"), bWasSuccessful, 0);
+	MarkStateSnapshotDirty();
+
+	IOnlineSessionPtr Sessions = GetOnlineInterfaces().Sessions;
 
 	if (bWasSuccessful)
 	{
 		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Session created successfully."));
 
-		if (!PendingTravelURL.ToString().IsEmpty())
+		// Players of a previously hosted session have to reserve a slot in this one
+		AdmittedSlotPlayers.Reset();
+
+		if (PendingSessionRequest)
+		{
+			PendingSessionRequest->OnCreateSessionCompleted.Broadcast(0, SessionName);
+		}
+
+		if (SessionSettings.IsValid() && SessionSettings->bIsDedicated)
+		{
+			StartDedicatedSessionHeartbeat(SessionName);
+		}
+
+		if (PendingLobbyHandoffRequest)
+		{
+			// The lobby members have to hear about the game session before the host travels and drops them
+			FString ConnectString;
+			Sessions->GetResolvedConnectString(SessionName, ConnectString);
+
+			const FNamedOnlineSession* GameSession = Sessions->GetNamedSession(SessionName);
+			PublishLobbyHandoff(ConnectString, GameSession ? GameSession->GetSessionIdStr() : FString(), true);
+		}
+		else if (!PendingTravelURL.ToString().IsEmpty())
 		{
 			GetWorld()->ServerTravel(PendingTravelURL.ToString());	
 		}
+		else
+		{
+			// Nothing travels, so the game mode of the new map won't start the beacon
+			StartReservationBeacon();
+		}
 	}
 	else
 	{
@@ -217,7 +298,12 @@ void UEnhancedOnlineSessionsSubsystem::HandleHostOnlineSessionComplete(FName Ses
 
 		if (PendingSessionRequest)
 		{
-			PendingSessionRequest->OnRequestFailedDelegate.Broadcast(TEXT("Failed to create session."));
+			PendingSessionRequest->FailRequest(TEXT("Failed to create session."));
+		}
+
+		if (PendingLobbyHandoffRequest)
+		{
+			FailLobbyHandoff(TEXT("Failed to create the game session for the lobby handoff."));
 		}
 	}
 
@@ -240,11 +326,13 @@ void UEnhancedOnlineSessionsSubsystem::FindOnlineSessions(UEnhancedOnlineRequest
 		return;
 	}
 
+	TRACE_ENHANCED_REQUEST_BEGIN(Request);
+
 	APlayerController* PlayerController = UGameplayStatics::GetPlayerController(Request->GetWorld(), Request->LocalUserIndex);
 	if (PlayerController == nullptr)
 	{
 		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Find Online Sessions was called with a bad local user index."));
-		Request->OnRequestFailedDelegate.Broadcast(TEXT("Find Online Sessions was called with a bad local user index."));
+		Request->FailRequest(TEXT("Find Online Sessions was called with a bad local user index."));
 		return;
 	}
 
@@ -252,7 +340,7 @@ void UEnhancedOnlineSessionsSubsystem::FindOnlineSessions(UEnhancedOnlineRequest
 	if (LocalPlayer == nullptr)
 	{
 		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Find Online Sessions was called with a bad local user index: %d."), Request->LocalUserIndex);
-		Request->OnRequestFailedDelegate.Broadcast(FString::Printf(TEXT("Find Online Sessions was called with a bad local user index: %d."), Request->LocalUserIndex));
+		Request->FailRequest(FString::Printf(TEXT("Find Online Sessions was called with a bad local user index: %d."), Request->LocalUserIndex));
 		return;
 	}
 
@@ -264,18 +352,30 @@ void UEnhancedOnlineSessionsSubsystem::FindOnlineSessionsInternal(ULocalPlayer*
 	if (SearchSettings.IsValid())
 	{
 		UE_LOG(LogEnhancedSubsystem, Error, TEXT("A search is already in progress."));
-		InSearchSettings->Request->OnRequestFailedDelegate.Broadcast(TEXT("A search is already in progress."));
+		InSearchSettings->Request->FailRequest(TEXT("A search is already in progress."));
 		return;
 	}
 
 	SearchSettings = InSearchSettings;
 
+	if (InSearchSettings->Request->Regions.Num() > 0)
+	{
+		PendingRegionSearch = MakeShared<FEnhancedRegionSearch>();
+		PendingRegionSearch->Regions = InSearchSettings->Request->Regions;
+		PendingRegionSearch->StartTime = FPlatformTime::Seconds();
+
+		FindSessionsDelegateHandle = InSearchSettings->Request->Sessions->AddOnFindSessionsCompleteDelegate_Handle(FOnFindSessionsCompleteDelegate::CreateUObject(this, &ThisClass::HandleRegionSearchComplete));
+		IssueNextRegionSearch();
+		return;
+	}
+
 	FindSessionsDelegateHandle = SearchSettings->Request->Sessions->AddOnFindSessionsCompleteDelegate_Handle(FOnFindSessionsCompleteDelegate::CreateUObject(this, &ThisClass::HandleFindOnlineSessionsComplete));
 
+	TRACE_ENHANCED_REQUEST_DISPATCH(InSearchSettings->Request, TEXT("FindSessions"), FEnhancedOnlineRequestTrace::GetPayloadSize(InSearchSettings->QuerySettings));
 	if (!InSearchSettings->Request->Sessions->FindSessions(0, InSearchSettings))
 	{
 		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to find sessions. :("));
-		InSearchSettings->Request->OnRequestFailedDelegate.Broadcast(TEXT("Failed to find sessions. :("));
+		InSearchSettings->Request->FailRequest(TEXT("Failed to find sessions. :("));
 
 		InSearchSettings->Request->Sessions->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsDelegateHandle);
 		FindSessionsDelegateHandle.Reset();
@@ -284,41 +384,291 @@ void UEnhancedOnlineSessionsSubsystem::FindOnlineSessionsInternal(ULocalPlayer*
 
 void UEnhancedOnlineSessionsSubsystem::HandleFindOnlineSessionsComplete(bool bWasSuccessful)
 {
+	FEnhancedOnlineHitchScope HitchScope(TEXT("HandleFindOnlineSessionsComplete"), SearchSettings.IsValid() ? SearchSettings->Request : nullptr);
+	HitchScope.SetResultCount(SearchSettings.IsValid() ? SearchSettings->SearchResults.Num() : 0);
+
+	// Region searches trace every region on its own, this is only the merge
+	if (SearchSettings.IsValid() && SearchSettings->Request->Regions.Num() == 0)
+	{
+		TRACE_ENHANCED_REQUEST_CALLBACK(SearchSettings->Request, TEXT("FindSessions"), bWasSuccessful, FEnhancedOnlineRequestTrace::GetPayloadSize(SearchSettings->SearchResults));
+	}
+
 	if (bWasSuccessful)
 	{
 		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Found sessions successfully."));
 
 		if (SearchSettings.IsValid())
 		{
-			TArray<UEnhancedSessionSearchResult*> Results;
-			for (auto& SearchResult : SearchSettings->SearchResults)
+			TArray<FOnlineSessionSearchResult>& SearchResults = SearchSettings->SearchResults;
+			RecordSearchPings(SearchResults);
+
+			FEnhancedSearchDecodeOptions DecodeOptions;
+			DecodeOptions.Filter = SearchSettings->Request->ResultFilter;
+			if (SearchSettings->ClientQueryFilters.Num() > 0)
 			{
-				UEnhancedSessionSearchResult* NewResult = NewObject<UEnhancedSessionSearchResult>(SearchSettings->Request);
-				NewResult->StoredSearchResult = SearchResult;
-				Results.Add(NewResult);
+				DecodeOptions.Filter = [Settings = SearchSettings, ResultFilter = MoveTemp(DecodeOptions.Filter)](const FOnlineSessionSearchResult& SearchResult)
+				{
+					return Settings->MatchesClientQueryFilters(SearchResult) && (!ResultFilter || ResultFilter(SearchResult));
+				};
+			}
+			DecodeOptions.Scorer = SearchSettings->Request->ResultScorer;
+			DecodeOptions.bParallel = CVarEnhancedParallelDecode.GetValueOnGameThread();
 
-				FString OwningUserId = TEXT("Uknown");
-				if (SearchResult.Session.OwningUserId.IsValid())
+			if (SearchSettings->Request->ListDataProvider)
+			{
+				// The list keeps raw results, so they are only filtered and scored off the game thread and put in the same order the wrapped results get
+				if (DecodeOptions.Filter || DecodeOptions.Scorer)
 				{
-					OwningUserId = SearchResult.Session.OwningUserId->ToString();
+					DecodeOptions.bFilterAndScoreOnly = true;
+
+					TArray<FEnhancedDecodedSearchResult> DecodedResults;
+					EnhancedOnlineSearchDecoding::DecodeSearchResults(SearchResults, DecodeOptions, DecodedResults);
+					EnhancedOnlineSearchDecoding::ReorderSearchResults(SearchResults, DecodedResults);
 				}
-				
-				UE_LOG(LogEnhancedSubsystem, Log, TEXT("\tFound session (UserId: %s, UserName: %s, NumOpenPrivConns: %d, NumOpenPubConns: %d, Ping: %d ms"),
-				*OwningUserId,
-				*SearchResult.Session.OwningUserName,
-				SearchResult.Session.NumOpenPrivateConnections,
-				SearchResult.Session.NumOpenPublicConnections,
-				SearchResult.PingInMs);
+
+				UE_LOG(LogEnhancedSubsystem, Log, TEXT("\tHanding %d sessions to the session list."), SearchResults.Num());
+
+				FEnhancedOnlineServerListCache::Save(SearchResults);
+				SnapshotRawSearchResults(SearchResults);
+
+				// Moved rather than shared, the search settings would keep the request and its list alive
+				SearchSettings->Request->ListDataProvider->SetSearchResults(MoveTemp(SearchResults));
+				SearchSettings->Request->OnFindOnlineSessionsCompleted.Broadcast(TArray<UEnhancedSessionSearchResult*>());
+				FinishFindOnlineSessions();
+				return;
+			}
+
+			const int32 CompactThreshold = CVarEnhancedCompactSearchResultsThreshold.GetValueOnGameThread();
+			if (CompactThreshold > 0 && SearchResults.Num() >= CompactThreshold)
+			{
+				DecodeOptions.StringTable = MakeShared<FEnhancedSessionStringTable>();
 			}
 
-			SearchSettings->Request->OnFindOnlineSessionsCompleted.Broadcast(Results);
+			TArray<FEnhancedDecodedSearchResult> DecodedResults;
+			EnhancedOnlineSearchDecoding::DecodeSearchResults(SearchResults, DecodeOptions, DecodedResults);
+
+			// Only wrapping into objects has to happen on the game thread, spread across frames if it takes too long
+			PendingMaterialization = MakeShared<FEnhancedPendingSearchMaterialization>();
+			PendingMaterialization->DecodedResults = MoveTemp(DecodedResults);
+			PendingMaterialization->StringTable = DecodeOptions.StringTable;
+			PendingMaterialization->NumSearchResults = SearchResults.Num();
+
+			MaterializedSearchResults.Reset(PendingMaterialization->DecodedResults.Num());
+			MaterializeSearchResults();
+			return;
 		}
 	}
 	else
 	{
 		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to find sessions. :("));
+
+		if (SearchSettings.IsValid())
+		{
+			SearchSettings->Request->FailRequest(TEXT("Failed to find sessions."));
+		}
+	}
+
+	FinishFindOnlineSessions();
+}
+
+void UEnhancedOnlineSessionsSubsystem::IssueNextRegionSearch()
+{
+	if (!PendingRegionSearch.IsValid() || !SearchSettings.IsValid())
+	{
+		return;
+	}
+
+	// Held on to, a backend answering inside FindSessions can finish the whole search before it returns
+	const TSharedPtr<FEnhancedRegionSearch> RegionSearch = PendingRegionSearch;
+	UEnhancedOnlineRequest_FindSessions* Request = SearchSettings->Request;
+
+	// Backends only run one search at a time and don't say which search completed, so the regions are queried back to back
+	while (RegionSearch->NextRegion < RegionSearch->Regions.Num())
+	{
+		RegionSearch->CurrentRegion = RegionSearch->Regions[RegionSearch->NextRegion++];
+
+		TSharedRef<FOnlineSessionSearch> RegionQuery = MakeShared<FOnlineSessionSearch>();
+		RegionQuery->bIsLanQuery = SearchSettings->bIsLanQuery;
+		RegionQuery->PingBucketSize = SearchSettings->PingBucketSize;
+		RegionQuery->QuerySettings = SearchSettings->QuerySettings;
+		RegionQuery->QuerySettings.Set(SETTING_REGION, RegionSearch->CurrentRegion, EOnlineComparisonOp::Equals);
+		RegionQuery->MaxSearchResults = Request->MaxResultsPerRegion > 0 ? Request->MaxResultsPerRegion : SearchSettings->MaxSearchResults;
+		RegionSearch->CurrentQuery = RegionQuery;
+
+		UE_LOG(LogEnhancedSubsystem, Verbose, TEXT("Searching region %s for up to %d sessions..."), *RegionSearch->CurrentRegion, RegionQuery->MaxSearchResults);
+
+		TRACE_ENHANCED_REQUEST_DISPATCH(Request, TEXT("FindSessionsInRegion"), FEnhancedOnlineRequestTrace::GetPayloadSize(RegionQuery->QuerySettings));
+		if (Request->Sessions->FindSessions(0, RegionQuery))
+		{
+			return;
+		}
+
+		// The completion already ran inside FindSessions, it counted the region and moved on to the next one itself
+		if (PendingRegionSearch != RegionSearch || RegionSearch->CurrentQuery != RegionQuery)
+		{
+			return;
+		}
+
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Failed to search region %s."), *RegionSearch->CurrentRegion);
+		RegionSearch->CurrentQuery.Reset();
+		++RegionSearch->NumFailedRegions;
+	}
+
+	FinishRegionSearch();
+}
+
+void UEnhancedOnlineSessionsSubsystem::HandleRegionSearchComplete(bool bWasSuccessful)
+{
+	if (!PendingRegionSearch.IsValid() || !PendingRegionSearch->CurrentQuery.IsValid())
+	{
+		return;
+	}
+
+	FEnhancedRegionSearch& RegionSearch = *PendingRegionSearch;
+	TSharedPtr<FOnlineSessionSearch> RegionQuery = MoveTemp(RegionSearch.CurrentQuery);
+
+	FEnhancedOnlineHitchScope HitchScope(TEXT("HandleRegionSearchComplete"), SearchSettings.IsValid() ? SearchSettings->Request : nullptr);
+	HitchScope.SetResultCount(RegionQuery->SearchResults.Num());
+	TRACE_ENHANCED_REQUEST_CALLBACK(SearchSettings.IsValid() ? SearchSettings->Request : nullptr, TEXT("FindSessionsInRegion"), bWasSuccessful, FEnhancedOnlineRequestTrace::GetPayloadSize(RegionQuery->SearchResults));
+
+	if (bWasSuccessful)
+	{
+		TArray<FOnlineSessionSearchResult>& Shard = RegionSearch.Shards.Add_GetRef(MoveTemp(RegionQuery->SearchResults));
+
+		// Backends that can't filter by region return sessions of every region
+		Shard.RemoveAll([&Region = RegionSearch.CurrentRegion](const FOnlineSessionSearchResult& SearchResult)
+		{
+			FString SessionRegion;
+			return !SearchResult.Session.SessionSettings.Get(SETTING_REGION, SessionRegion) || SessionRegion != Region;
+		});
+		Algo::StableSortBy(Shard, &FOnlineSessionSearchResult::PingInMs);
+
+		UE_LOG(LogEnhancedSubsystem, Verbose, TEXT("Region %s answered with %d sessions."), *RegionSearch.CurrentRegion, Shard.Num());
+	}
+	else
+	{
+		UE_LOG(LogEnhancedSubsystem, Warning, TEXT("Failed to search region %s."), *RegionSearch.CurrentRegion);
+		++RegionSearch.NumFailedRegions;
+	}
+
+	IssueNextRegionSearch();
+}
+
+void UEnhancedOnlineSessionsSubsystem::FinishRegionSearch()
+{
+	TSharedPtr<FEnhancedRegionSearch> RegionSearch = MoveTemp(PendingRegionSearch);
+	if (!RegionSearch.IsValid() || !SearchSettings.IsValid())
+	{
+		return;
+	}
+
+	// A region that is down shouldn't hide the sessions of all the others
+	if (RegionSearch->NumFailedRegions == RegionSearch->Regions.Num())
+	{
+		HandleFindOnlineSessionsComplete(false);
+		return;
+	}
+
+	EnhancedOnlineSearchDecoding::MergeByPing(RegionSearch->Shards, SearchSettings->Request->MaxSearchResults, SearchSettings->SearchResults);
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("Merged %d sessions from %d of %d regions in %.0f ms."),
+		SearchSettings->SearchResults.Num(), RegionSearch->Regions.Num() - RegionSearch->NumFailedRegions, RegionSearch->Regions.Num(),
+		(FPlatformTime::Seconds() - RegionSearch->StartTime) * 1000.0);
+
+	HandleFindOnlineSessionsComplete(true);
+}
+
+void UEnhancedOnlineSessionsSubsystem::MaterializeSearchResults()
+{
+	FEnhancedOnlineHitchScope HitchScope(TEXT("MaterializeSearchResults"), SearchSettings.IsValid() ? SearchSettings->Request : nullptr);
+
+	MaterializeTimerHandle.Invalidate();
+
+	if (!SearchSettings.IsValid() || !PendingMaterialization.IsValid())
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Lost the search while publishing its results. :("));
+		PendingMaterialization.Reset();
+		MaterializedSearchResults.Reset();
+		FinishFindOnlineSessions();
+		return;
+	}
+
+	UEnhancedOnlineRequest_FindSessions* Request = SearchSettings->Request;
+	TArray<FOnlineSessionSearchResult>& SearchResults = SearchSettings->SearchResults;
+	FEnhancedPendingSearchMaterialization& Pending = *PendingMaterialization;
+
+	const float BudgetMs = Request->FrameBudgetMs >= 0.0f ? Request->FrameBudgetMs : CVarEnhancedMaterializeBudgetMs.GetValueOnGameThread();
+	const double StartTime = FPlatformTime::Seconds();
+
+	TArray<UEnhancedSessionSearchResult*> NewResults;
+	while (Pending.NextIndex < Pending.DecodedResults.Num())
+	{
+		FEnhancedDecodedSearchResult& Decoded = Pending.DecodedResults[Pending.NextIndex++];
+		FOnlineSessionSearchResult& SearchResult = SearchResults[Decoded.SourceIndex];
+
+		UE_LOG(LogEnhancedSubsystem, Verbose, TEXT("\tFound session (UserId: %s, UserName: %s, NumOpenPrivConns: %d, NumOpenPubConns: %d, Ping: %d ms"),
+		*Decoded.OwningUserId,
+		*SearchResult.Session.OwningUserName,
+		SearchResult.Session.NumOpenPrivateConnections,
+		SearchResult.Session.NumOpenPublicConnections,
+		SearchResult.PingInMs);
+
+		// The search is dropped right after, so the result can be moved instead of copied
+		UEnhancedSessionSearchResult* NewResult = NewObject<UEnhancedSessionSearchResult>(Request);
+		NewResult->StoredSearchResult = MoveTemp(SearchResult);
+		ApplyPingEstimate(NewResult);
+		if (Pending.StringTable.IsValid())
+		{
+			NewResult->SetCompactSessionSettings(MoveTemp(Decoded.CompactSettings));
+		}
+		MaterializedSearchResults.Add(NewResult);
+		NewResults.Add(NewResult);
+
+		// Reading the clock for every result would cost about as much as wrapping it
+		if (BudgetMs > 0.0f && NewResults.Num() % 16 == 0 && (FPlatformTime::Seconds() - StartTime) * 1000.0 >= BudgetMs)
+		{
+			break;
+		}
 	}
 
+	HitchScope.SetResultCount(NewResults.Num());
+
+	const int32 NumTotal = Pending.DecodedResults.Num();
+	if (Pending.NextIndex < NumTotal)
+	{
+		UE_LOG(LogEnhancedSubsystem, Verbose, TEXT("\tWrapped %d of %d search results, continuing next frame."), Pending.NextIndex, NumTotal);
+
+		Request->OnFindOnlineSessionsProgress.Broadcast(NewResults, Pending.NextIndex, NumTotal);
+		MaterializeTimerHandle = GetGameInstance()->GetTimerManager().SetTimerForNextTick(FTimerDelegate::CreateUObject(this, &ThisClass::MaterializeSearchResults));
+		return;
+	}
+
+	UE_LOG(LogEnhancedSubsystem, Log, TEXT("\tFound %d sessions, %d kept after filtering."), Pending.NumSearchResults, NumTotal);
+
+	if (Pending.StringTable.IsValid())
+	{
+		UE_LOG(LogEnhancedSubsystem, Log, TEXT("\tCompacted %d results, %d unique strings."), NumTotal, Pending.StringTable->Num());
+	}
+
+	TArray<UEnhancedSessionSearchResult*> Results;
+	Results.Reserve(MaterializedSearchResults.Num());
+	for (UEnhancedSessionSearchResult* Result : MaterializedSearchResults)
+	{
+		Results.Add(Result);
+	}
+
+	PendingMaterialization.Reset();
+	MaterializedSearchResults.Reset();
+	SnapshotSearchResults(Results);
+
+	Request->OnFindOnlineSessionsProgress.Broadcast(NewResults, NumTotal, NumTotal);
+	Request->OnFindOnlineSessionsCompleted.Broadcast(Results);
+
+	FinishFindOnlineSessions();
+}
+
+void UEnhancedOnlineSessionsSubsystem::FinishFindOnlineSessions()
+{
 	if (SearchSettings.IsValid())
 	{
 		SearchSettings->Request->Sessions->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsDelegateHandle);
@@ -341,17 +691,68 @@ void UEnhancedOnlineSessionsSubsystem::JoinOnlineSession(UEnhancedOnlineRequest_
 		return;
 	}
 
-	IOnlineSubsystem* OnlineSub = Online::GetSubsystem(GetWorld());
-	IOnlineSessionPtr Sessions = OnlineSub->GetSessionInterface();
+	TRACE_ENHANCED_REQUEST_BEGIN(Request);
+
+	if (Request->SessionToJoin == nullptr)
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Join Online Session was called without a session to join."));
+		Request->FailRequest(TEXT("Join Online Session was called without a session to join."));
+		return;
+	}
+
+	if (Request->SessionToJoin->IsStale())
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Cannot join a session from the last known server list before it was refreshed."));
+		Request->FailRequest(TEXT("Cannot join a session from the last known server list before it was refreshed."));
+		return;
+	}
+
+	if (IsValid(PendingJoinSessionRequest))
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("A session is already being joined."));
+		Request->FailRequest(TEXT("A session is already being joined."));
+		return;
+	}
+
+	IOnlineSessionPtr Sessions = GetOnlineInterfaces().Sessions;
+	if (!Sessions.IsValid())
+	{
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Join Online Session was called with a bad session interface."));
+		Request->FailRequest(TEXT("Join Online Session was called with a bad session interface."));
+		return;
+	}
+
+	PendingJoinSessionRequest = Request;
+	PendingSlotReservationToken.Reset();
+	Request->SessionToJoin->RestoreSessionSettings();
+
+	// Lobbies are joined next to the game session, so they can hand off to one later
+	bool bIsLobby = false;
+	Request->SessionToJoin->StoredSearchResult.Session.SessionSettings.Get(SETTING_LOBBY, bIsLobby);
+
+	// A full session refuses the reservation before anything is joined, the join continues once a slot is held
+	if (!bIsLobby && Request->bReserveSlot && RequestSlotReservation(Request))
+	{
+		return;
+	}
+
+	JoinOnlineSessionInternal(Request, bIsLobby ? NAME_PartySession : NAME_GameSession);
+}
+
+void UEnhancedOnlineSessionsSubsystem::JoinOnlineSessionInternal(UEnhancedOnlineRequest_JoinSession* Request, FName SessionName)
+{
+	IOnlineSessionPtr Sessions = GetOnlineInterfaces().Sessions;
 
 	JoinSessionDelegateHandle = Sessions->AddOnJoinSessionCompleteDelegate_Handle(FOnJoinSessionCompleteDelegate::CreateUObject(this, &ThisClass::HandleJoinSessionCompleted));
 
 	Sessions->GetResolvedConnectString(Request->SessionToJoin->StoredSearchResult, NAME_GamePort, PendingClientTravelURL);
 
-	if (!Sessions->JoinSession(0, NAME_GameSession, Request->SessionToJoin->StoredSearchResult))
+	TRACE_ENHANCED_REQUEST_DISPATCH(Request, TEXT("JoinSession"), FEnhancedOnlineRequestTrace::GetPayloadSize(Request->SessionToJoin->StoredSearchResult.Session.SessionSettings));
+	if (!Sessions->JoinSession(0, SessionName, Request->SessionToJoin->StoredSearchResult))
 	{
 		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to join session."));
-		Request->OnRequestFailedDelegate.Broadcast(TEXT("Failed to join session."));
+		PendingJoinSessionRequest = nullptr;
+		Request->FailRequest(TEXT("Failed to join session."));
 
 		Sessions->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionDelegateHandle);
 		JoinSessionDelegateHandle.Reset();
@@ -360,29 +761,73 @@ void UEnhancedOnlineSessionsSubsystem::JoinOnlineSession(UEnhancedOnlineRequest_
 
 void UEnhancedOnlineSessionsSubsystem::HandleJoinSessionCompleted(FName SessionName, EOnJoinSessionCompleteResult::Type Result)
 {
-	IOnlineSubsystem* OnlineSub = Online::GetSubsystem(GetWorld());
-	IOnlineSessionPtr Sessions = OnlineSub->GetSessionInterface();
-	
+	FEnhancedOnlineHitchScope HitchScope(TEXT("HandleJoinSessionCompleted"), PendingJoinSessionRequest);
+	TRACE_ENHANCED_REQUEST_CALLBACK(PendingJoinSessionRequest, TEXT("JoinSession"), Result == EOnJoinSessionCompleteResult::Success, PendingClientTravelURL.Len());
+	MarkStateSnapshotDirty();
+
+	IOnlineSessionPtr Sessions = GetOnlineInterfaces().Sessions;
+
+	Sessions->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionDelegateHandle);
+	JoinSessionDelegateHandle.Reset();
+
+	UEnhancedOnlineRequest_JoinSession* Request = PendingJoinSessionRequest;
+	PendingJoinSessionRequest = nullptr;
+
 	if (Result == EOnJoinSessionCompleteResult::Success)
 	{
 		UE_LOG(LogEnhancedSubsystem, Log, TEXT("Joined session successfully."));
 
-		APlayerController* PlayerController = UGameplayStatics::GetPlayerController(GetWorld(), 0);
+		APlayerController* PlayerController = UGameplayStatics::GetPlayerController(GetWorld(), Request ? Request->LocalUserIndex : 0);
 		if (PlayerController == nullptr)
 		{
 			UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to get player controller."));
+			if (Request)
+			{
+				Request->FailRequest(TEXT("Failed to get player controller."));
+				Request->CompleteRequest();
+			}
 			return;
 		}
 
-		PlayerController->ClientTravel(PendingClientTravelURL, TRAVEL_Absolute);
+		if (SessionName == NAME_PartySession)
+		{
+			LobbyLocalUserIndex = Request ? Request->LocalUserIndex : 0;
+			Sessions->ClearOnSessionSettingsUpdatedDelegate_Handle(LobbySettingsUpdatedDelegateHandle);
+			LobbySettingsUpdatedDelegateHandle = Sessions->AddOnSessionSettingsUpdatedDelegate_Handle(FOnSessionSettingsUpdatedDelegate::CreateUObject(this, &ThisClass::HandleLobbySettingsUpdated));
+		}
+		else if (Request && Request->SessionToJoin)
+		{
+			RecordLastSession(Request->LocalUserIndex, Request->SessionToJoin->StoredSearchResult, PendingClientTravelURL);
+			StartConnectionPingSampling(Request->SessionToJoin->StoredSearchResult, Request->LocalUserIndex);
+		}
+
+		if (Request)
+		{
+			Request->OnJoinSessionCompleted.Broadcast(SessionName);
+			Request->CompleteRequest();
+		}
+
+		// The host only admits players travelling with the token of their reserved slot
+		FString TravelURL = PendingClientTravelURL;
+		if (!PendingSlotReservationToken.IsEmpty())
+		{
+			TravelURL += FString::Printf(TEXT("?SlotToken=%s"), *PendingSlotReservationToken);
+			PendingSlotReservationToken.Reset();
+		}
+
+		PlayerController->ClientTravel(TravelURL, TRAVEL_Absolute);
 	}
 	else
 	{
-		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to join session."));
-	}
+		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to join session: %s."), LexToString(Result));
+		PendingSlotReservationToken.Reset();
 
-	Sessions->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionDelegateHandle);
-	JoinSessionDelegateHandle.Reset();
+		if (Request)
+		{
+			Request->FailRequest(FString::Printf(TEXT("Failed to join session: %s."), LexToString(Result)));
+			Request->CompleteRequest();
+		}
+	}
 }
 
 void UEnhancedOnlineSessionsSubsystem::StartOnlineSession(UEnhancedOnlineRequest_StartSession* Request)
@@ -393,22 +838,26 @@ void UEnhancedOnlineSessionsSubsystem::StartOnlineSession(UEnhancedOnlineRequest
 		return;
 	}
 
+	TRACE_ENHANCED_REQUEST_BEGIN(Request);
+
 	IOnlineSessionPtr Sessions = Request->Sessions;
 
 	if (Sessions == nullptr)
 	{
 		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Start Online Session was called with a bad session interface."));
-		Request->OnRequestFailedDelegate.Broadcast(TEXT("Start Online Session was called with a bad session interface."));
+		Request->FailRequest(TEXT("Start Online Session was called with a bad session interface."));
 		return;
 	}
 
 	StartSessionDelegateHandle = Sessions->AddOnStartSessionCompleteDelegate_Handle(FOnStartSessionCompleteDelegate::CreateUObject(this, &ThisClass::HandleStartOnlineSessionComplete));
 	PendingStartSessionRequest = Request;
 
-	if (!Sessions->StartSession(NAME_GameSession))
+	// Starts the hosted lobby when there is no game session
+	TRACE_ENHANCED_REQUEST_DISPATCH(Request, TEXT("StartSession"), 0);
+	if (!Sessions->StartSession(GetActiveSessionName(Sessions)))
 	{
 		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Failed to start session."));
-		Request->OnRequestFailedDelegate.Broadcast(TEXT("Failed to start session."));
+		Request->FailRequest(TEXT("Failed to start session."));
 
 		Sessions->ClearOnStartSessionCompleteDelegate_Handle(StartSessionDelegateHandle);
 		StartSessionDelegateHandle.Reset();
@@ -417,6 +866,10 @@ void UEnhancedOnlineSessionsSubsystem::StartOnlineSession(UEnhancedOnlineRequest
 
 void UEnhancedOnlineSessionsSubsystem::HandleStartOnlineSessionComplete(FName SessionName, bool bWasSuccessful)
 {
+	FEnhancedOnlineHitchScope HitchScope(TEXT("HandleStartOnlineSessionComplete"), PendingStartSessionRequest);
+	TRACE_ENHANCED_REQUEST_CALLBACK(PendingStartSessionRequest, TEXT("StartSession"), bWasSuccessful, 0);
+	MarkStateSnapshotDirty();
+
 	if (PendingStartSessionRequest == nullptr)
 	{
 		UE_LOG(LogEnhancedSubsystem, Error, TEXT("Start Online Session was called with a bad request."));
@@ -426,10 +879,11 @@ void UEnhancedOnlineSessionsSubsystem::HandleStartOnlineSessionComplete(FName Se
 	if (bWasSuccessful)
 	{
 		PendingStartSessionRequest->OnStartSessionCompleted.Broadcast(SessionName, true);
+		TRACE_ENHANCED_REQUEST_END(PendingStartSessionRequest, true, TEXT(""));
 	}
 	else
 	{
-		PendingStartSessionRequest->OnRequestFailedDelegate.Broadcast(TEXT("Failed to start session."));
+		PendingStartSessionRequest->FailRequest(TEXT("Failed to start session."));
 	}
 
 	PendingStartSessionRequest->Sessions->ClearOnStartSessionCompleteDelegate_Handle(StartSessionDelegateHandle);
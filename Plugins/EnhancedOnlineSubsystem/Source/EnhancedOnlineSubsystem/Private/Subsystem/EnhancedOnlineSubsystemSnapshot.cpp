@@ -0,0 +1,134 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineSessionsSubsystem.h"
+
+#include "EnhancedOnlineHitchDetector.h"
+#include "EnhancedOnlineRequests.h"
+#include "EnhancedOnlineStateSnapshotSlot.h"
+#include "OnlineSessionSettings.h"
+#include "TimerManager.h"
+#include "Engine/GameInstance.h"
+#include "Engine/LocalPlayer.h"
+#include "Interfaces/OnlineIdentityInterface.h"
+#include "Persistence/EnhancedOnlinePingHistory.h"
+
+FEnhancedOnlineStateSnapshotPtr UEnhancedOnlineSessionsSubsystem::GetStateSnapshot() const
+{
+	return StateSnapshotSlot.IsValid() ? StateSnapshotSlot->Get() : nullptr;
+}
+
+void UEnhancedOnlineSessionsSubsystem::MarkStateSnapshotDirty()
+{
+	UGameInstance* GameInstance = GetGameInstance();
+	if (GameInstance == nullptr || GameInstance->GetTimerManager().TimerExists(StateSnapshotTimerHandle))
+	{
+		return;
+	}
+
+	StateSnapshotTimerHandle = GameInstance->GetTimerManager().SetTimerForNextTick(FTimerDelegate::CreateUObject(this, &ThisClass::PublishStateSnapshot));
+}
+
+void UEnhancedOnlineSessionsSubsystem::PublishStateSnapshot()
+{
+	FEnhancedOnlineHitchScope HitchScope(TEXT("PublishStateSnapshot"));
+
+	StateSnapshotTimerHandle.Invalidate();
+
+	if (!StateSnapshotSlot.IsValid())
+	{
+		return;
+	}
+
+	TSharedRef<FEnhancedOnlineStateSnapshot, ESPMode::ThreadSafe> Snapshot = MakeShared<FEnhancedOnlineStateSnapshot, ESPMode::ThreadSafe>();
+	Snapshot->Version = ++StateSnapshotVersion;
+	Snapshot->PublishedAt = FPlatformTime::Seconds();
+	Snapshot->SearchResults = SnapshotSearchSessions;
+	Snapshot->bIsMatchmaking = PendingMatchmakeRequest != nullptr;
+
+	const FEnhancedOnlineInterfaceHandles Interfaces = GetOnlineInterfaces();
+
+	if (Interfaces.Identity)
+	{
+		for (const ULocalPlayer* LocalPlayer : GetGameInstance()->GetLocalPlayers())
+		{
+			FEnhancedOnlineSnapshotUser& User = Snapshot->Users.AddDefaulted_GetRef();
+			User.LocalUserNum = LocalPlayer->GetControllerId();
+			User.LoginStatus = Interfaces.Identity->GetLoginStatus(User.LocalUserNum);
+
+			if (FUniqueNetIdPtr UserId = Interfaces.Identity->GetUniquePlayerId(User.LocalUserNum))
+			{
+				User.UserId = UserId->ToString();
+			}
+		}
+	}
+
+	if (const FNamedOnlineSession* Session = Interfaces.Sessions ? Interfaces.Sessions->GetNamedSession(GetActiveSessionName(Interfaces.Sessions)) : nullptr)
+	{
+		if (Session->bHosting)
+		{
+			FEnhancedOnlineSnapshotHostedSession& HostedSession = Snapshot->HostedSession.Emplace();
+			HostedSession.SessionId = Session->GetSessionIdStr();
+			HostedSession.State = Session->SessionState;
+			HostedSession.MaxPlayers = Session->SessionSettings.NumPublicConnections;
+			HostedSession.NumOpenSlots = Session->NumOpenPublicConnections;
+			HostedSession.NumRegisteredPlayers = Session->RegisteredPlayers.Num();
+			HostedSession.NumSlotReservations = GetNumSlotReservations();
+			HostedSession.bIsDedicated = Session->SessionSettings.bIsDedicated;
+		}
+	}
+
+	StateSnapshotSlot->Publish(MoveTemp(Snapshot));
+}
+
+void UEnhancedOnlineSessionsSubsystem::SnapshotSearchResults(const TArray<UEnhancedSessionSearchResult*>& Results)
+{
+	TSharedRef<TArray<FEnhancedOnlineSnapshotSession>, ESPMode::ThreadSafe> Sessions = MakeShared<TArray<FEnhancedOnlineSnapshotSession>, ESPMode::ThreadSafe>();
+	Sessions->Reserve(Results.Num());
+
+	for (const UEnhancedSessionSearchResult* Result : Results)
+	{
+		const FOnlineSessionSearchResult& SearchResult = Result->StoredSearchResult;
+
+		FEnhancedOnlineSnapshotSession& Session = Sessions->AddDefaulted_GetRef();
+		Session.SessionId = SearchResult.GetSessionIdStr();
+		Session.OwningUserId = SearchResult.Session.OwningUserId.IsValid() ? SearchResult.Session.OwningUserId->ToString() : FString();
+		Session.FriendlyName = Result->GetSessionFriendlyName();
+		Session.PingInMs = Result->GetPingInMs();
+		Session.PingConfidence = Result->GetPingConfidence();
+		Session.MaxPlayers = Result->GetMaxPlayers();
+		Session.CurrentPlayers = Result->GetCurrentPlayers();
+	}
+
+	SnapshotSearchSessions = Sessions;
+	MarkStateSnapshotDirty();
+}
+
+void UEnhancedOnlineSessionsSubsystem::SnapshotRawSearchResults(const TArray<FOnlineSessionSearchResult>& Results)
+{
+	TSharedRef<TArray<FEnhancedOnlineSnapshotSession>, ESPMode::ThreadSafe> Sessions = MakeShared<TArray<FEnhancedOnlineSnapshotSession>, ESPMode::ThreadSafe>();
+	Sessions->Reserve(Results.Num());
+
+	for (const FOnlineSessionSearchResult& SearchResult : Results)
+	{
+		FEnhancedOnlineSnapshotSession& Session = Sessions->AddDefaulted_GetRef();
+		Session.SessionId = SearchResult.GetSessionIdStr();
+		Session.OwningUserId = SearchResult.Session.OwningUserId.IsValid() ? SearchResult.Session.OwningUserId->ToString() : FString();
+		Session.PingInMs = SearchResult.PingInMs;
+		Session.MaxPlayers = SearchResult.Session.SessionSettings.NumPublicConnections;
+		Session.CurrentPlayers = Session.MaxPlayers - SearchResult.Session.NumOpenPublicConnections;
+
+		if (!SearchResult.Session.SessionSettings.Get(SETTING_FRIENDLYNAME, Session.FriendlyName))
+		{
+			Session.FriendlyName = SearchResult.Session.OwningUserName;
+		}
+
+		float SmoothedPingInMs = 0.0f;
+		if (PingHistory.IsValid() && PingHistory->GetEstimate(FEnhancedOnlinePingHistory::GetHostKey(SearchResult), SmoothedPingInMs, Session.PingConfidence) && Session.PingConfidence > 0.0f)
+		{
+			Session.PingInMs = FMath::RoundToInt(SmoothedPingInMs);
+		}
+	}
+
+	SnapshotSearchSessions = Sessions;
+	MarkStateSnapshotDirty();
+}
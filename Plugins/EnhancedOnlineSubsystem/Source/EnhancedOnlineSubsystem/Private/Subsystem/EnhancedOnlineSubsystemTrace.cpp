@@ -0,0 +1,97 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#include "EnhancedOnlineSessionsSubsystem.h"
+
+#include "EnhancedOnlineSubsystem.h"
+#include "Backend/EnhancedOnlineTrace.h"
+#include "Backend/EnhancedOnlineTraceRecorder.h"
+#include "Backend/EnhancedOnlineTraceReplay.h"
+
+static TAutoConsoleVariable<FString> CVarEnhancedTraceRecordFile(
+	TEXT("EnhancedOnline.Trace.RecordFile"),
+	TEXT(""),
+	TEXT("Writes the session and identity traffic of the backend to this trace file. Read when the subsystem initializes, relative names are placed in Saved/EnhancedOnline/Traces/."));
+
+static TAutoConsoleVariable<FString> CVarEnhancedTraceReplayFile(
+	TEXT("EnhancedOnline.Trace.ReplayFile"),
+	TEXT(""),
+	TEXT("Answers session and identity calls from this trace file instead of the backend. Read when the subsystem initializes, takes precedence over EnhancedOnline.Trace.RecordFile."));
+
+static TAutoConsoleVariable<float> CVarEnhancedTraceReplaySpeed(
+	TEXT("EnhancedOnline.Trace.ReplaySpeed"),
+	1.0f,
+	TEXT("Playback speed of the recorded backend latency, 2 answers twice as fast. 0 answers every call on the next frame."));
+
+void UEnhancedOnlineSessionsSubsystem::StartBackendTrace()
+{
+	const FString ReplayFile = CVarEnhancedTraceReplayFile.GetValueOnGameThread();
+	const FString RecordFile = CVarEnhancedTraceRecordFile.GetValueOnGameThread();
+
+	if (!ReplayFile.IsEmpty())
+	{
+		TracePlayer = FEnhancedOnlineTracePlayer::Load(EnhancedOnlineTrace::GetTraceFilePath(ReplayFile), CVarEnhancedTraceReplaySpeed.GetValueOnGameThread());
+	}
+	else if (!RecordFile.IsEmpty())
+	{
+		TraceWriter = FEnhancedOnlineTraceWriter::Create(EnhancedOnlineTrace::GetTraceFilePath(RecordFile));
+	}
+}
+
+void UEnhancedOnlineSessionsSubsystem::StopBackendTrace()
+{
+	TraceInterfaceTable.Reset();
+	TraceWriter.Reset();
+	TracePlayer.Reset();
+}
+
+void UEnhancedOnlineSessionsSubsystem::WrapTracedInterfaces(FName SubsystemName, FEnhancedOnlineInterfaceHandles& Handles)
+{
+	if (!TraceWriter.IsValid() && !TracePlayer.IsValid())
+	{
+		return;
+	}
+
+	// Listeners bound by the subsystem must survive world changes, so every world gets the same wrappers
+	FEnhancedOnlineInterfaceHandles& Traced = TraceInterfaceTable.FindOrAdd(SubsystemName);
+	if (Traced.OnlineSub != Handles.OnlineSub)
+	{
+		Traced = FEnhancedOnlineInterfaceHandles();
+		Traced.OnlineSub = Handles.OnlineSub;
+
+		if (TracePlayer.IsValid())
+		{
+			if (Handles.Sessions.IsValid())
+			{
+				Traced.Sessions = MakeShared<FEnhancedOnlineSessionReplay, ESPMode::ThreadSafe>(Handles.Sessions, TracePlayer.ToSharedRef());
+			}
+			if (Handles.Identity.IsValid())
+			{
+				Traced.Identity = MakeShared<FEnhancedOnlineIdentityReplay, ESPMode::ThreadSafe>(Handles.Identity, TracePlayer.ToSharedRef());
+			}
+
+			UE_LOG(LogEnhancedSubsystem, Log, TEXT("Replaying backend %s from %s."), *SubsystemName.ToString(), *TracePlayer->GetFilePath());
+		}
+		else
+		{
+			if (Handles.Sessions.IsValid())
+			{
+				Traced.Sessions = MakeShared<FEnhancedOnlineSessionRecorder, ESPMode::ThreadSafe>(Handles.Sessions, TraceWriter.ToSharedRef());
+			}
+			if (Handles.Identity.IsValid())
+			{
+				Traced.Identity = MakeShared<FEnhancedOnlineIdentityRecorder, ESPMode::ThreadSafe>(Handles.Identity, TraceWriter.ToSharedRef());
+			}
+
+			UE_LOG(LogEnhancedSubsystem, Log, TEXT("Recording backend %s to %s."), *SubsystemName.ToString(), *TraceWriter->GetFilePath());
+		}
+	}
+
+	if (Traced.Sessions.IsValid())
+	{
+		Handles.Sessions = Traced.Sessions;
+	}
+	if (Traced.Identity.IsValid())
+	{
+		Handles.Identity = Traced.Identity;
+	}
+}
@@ -0,0 +1,87 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OnlineSessionSettings.h"
+
+/**
+ * Interned strings shared by all compact session settings of one search.
+ * Game mode, map and template names are usually the same for most sessions and are only stored once.
+ */
+class ENHANCEDONLINESUBSYSTEM_API FEnhancedSessionStringTable
+{
+public:
+	/** Returns the index of the string, adding it if it isn't known yet. Safe to call from several threads at once */
+	int32 Intern(const FString& Value);
+
+	/** Returns an interned string */
+	const FString& Get(int32 Index) const { return Strings[Index]; }
+
+	int32 Num() const { return Strings.Num(); }
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	TArray<FString> Strings;
+	TMap<FString, int32> Indices;
+
+	/** Guards interning, strings must not be read while results are still being decoded */
+	FRWLock Lock;
+};
+
+/**
+ * Session settings stored as a flat array sorted by key, with string values interned in a shared string table
+ * Blobs are rare and rarely repeat, they keep their bytes next to the attributes.
+ */
+class ENHANCEDONLINESUBSYSTEM_API FEnhancedCompactSessionSettings
+{
+public:
+	/** Replaces the compact settings with the given raw settings */
+	void Compact(const FSessionSettings& Settings, const TSharedRef<FEnhancedSessionStringTable>& InStringTable);
+
+	/** Converts the compact settings back into raw settings */
+	void Restore(FSessionSettings& OutSettings) const;
+
+	/** Reads a string setting, returns false if there is no string setting with that key */
+	bool Get(FName Key, FString& OutValue) const;
+
+	void Reset();
+
+	bool IsEmpty() const { return Attributes.Num() == 0; }
+
+	/** Memory owned by these settings, excluding the shared string table */
+	SIZE_T GetAllocatedSize() const;
+
+	/** Memory owned by raw settings, including the values of string settings */
+	static SIZE_T GetRawAllocatedSize(const FSessionSettings& Settings);
+
+	const TSharedPtr<FEnhancedSessionStringTable>& GetStringTable() const { return StringTable; }
+
+private:
+	struct FAttribute
+	{
+		FName Key;
+		int32 SettingId = 0;
+		EOnlineKeyValuePairDataType::Type Type = EOnlineKeyValuePairDataType::Empty;
+		EOnlineDataAdvertisementType::Type AdvertisementType = EOnlineDataAdvertisementType::DontAdvertise;
+
+		union
+		{
+			int64 IntValue = 0;
+			double DoubleValue;
+			int32 StringIndex;
+			int32 BlobIndex;
+		};
+	};
+
+	const FAttribute* FindAttribute(FName Key) const;
+
+	/** Sorted by key */
+	TArray<FAttribute> Attributes;
+
+	/** Values of blob settings */
+	TArray<TArray<uint8>> Blobs;
+
+	TSharedPtr<FEnhancedSessionStringTable> StringTable;
+};
@@ -0,0 +1,87 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Trace/Trace.h"
+
+class UEnhancedOnlineRequestBase;
+class FOnlineSearchSettings;
+class FOnlineSessionSettings;
+class FOnlineSessionSearchResult;
+
+#if !defined(ENHANCEDONLINE_TRACE_ENABLED)
+#define ENHANCEDONLINE_TRACE_ENABLED (UE_TRACE_ENABLED && !UE_BUILD_SHIPPING)
+#endif
+
+#if ENHANCEDONLINE_TRACE_ENABLED
+
+/** Request lifecycles for Unreal Insights, enable with -trace=default,EnhancedOnline or Trace.Enable EnhancedOnline */
+UE_TRACE_CHANNEL_EXTERN(EnhancedOnlineChannel, ENHANCEDONLINESUBSYSTEM_API);
+
+/**
+ * Emits the lifecycle of requests on the EnhancedOnline trace channel.
+ * Every request is also a timing region, so Insights draws it next to the frames and loading.
+ */
+struct ENHANCEDONLINESUBSYSTEM_API FEnhancedOnlineRequestTrace
+{
+	/** The request was handed to the subsystem, later calls for the same request are ignored */
+	static void OutputBegin(UEnhancedOnlineRequestBase* Request);
+
+	/** A call for the request was sent to the backend */
+	static void OutputDispatch(const UEnhancedOnlineRequestBase* Request, const TCHAR* Call, uint32 PayloadSize);
+
+	/** The backend answered a call for the request */
+	static void OutputCallback(const UEnhancedOnlineRequestBase* Request, const TCHAR* Call, bool bWasSuccessful, uint32 PayloadSize);
+
+	/** The request completed or failed, ignored if it never began */
+	static void OutputEnd(UEnhancedOnlineRequestBase* Request, bool bWasSuccessful, const TCHAR* Reason);
+
+	/** Cheap estimate of the bytes the backends send for the settings, from the key names and the value types without formatting anything */
+	static uint32 GetPayloadSize(const FOnlineSessionSettings& SessionSettings);
+	static uint32 GetPayloadSize(const FOnlineSearchSettings& QuerySettings);
+	static uint32 GetPayloadSize(const TArray<FOnlineSessionSearchResult>& SearchResults);
+};
+
+#define TRACE_ENHANCED_REQUEST_BEGIN(Request) \
+	do \
+	{ \
+		if (UE_TRACE_CHANNELEXPR_IS_ENABLED(EnhancedOnlineChannel)) \
+		{ \
+			FEnhancedOnlineRequestTrace::OutputBegin(Request); \
+		} \
+	} while (0)
+
+#define TRACE_ENHANCED_REQUEST_DISPATCH(Request, Call, PayloadSize) \
+	do \
+	{ \
+		if (UE_TRACE_CHANNELEXPR_IS_ENABLED(EnhancedOnlineChannel)) \
+		{ \
+			FEnhancedOnlineRequestTrace::OutputDispatch(Request, Call, PayloadSize); \
+		} \
+	} while (0)
+
+#define TRACE_ENHANCED_REQUEST_CALLBACK(Request, Call, bWasSuccessful, PayloadSize) \
+	do \
+	{ \
+		if (UE_TRACE_CHANNELEXPR_IS_ENABLED(EnhancedOnlineChannel)) \
+		{ \
+			FEnhancedOnlineRequestTrace::OutputCallback(Request, Call, bWasSuccessful, PayloadSize); \
+		} \
+	} while (0)
+
+// Not gated on the channel, a request that began has to be closed even if the channel was turned off since
+#define TRACE_ENHANCED_REQUEST_END(Request, bWasSuccessful, Reason) \
+	do \
+	{ \
+		FEnhancedOnlineRequestTrace::OutputEnd(Request, bWasSuccessful, Reason); \
+	} while (0)
+
+#else
+
+#define TRACE_ENHANCED_REQUEST_BEGIN(Request) do {} while (0)
+#define TRACE_ENHANCED_REQUEST_DISPATCH(Request, Call, PayloadSize) do {} while (0)
+#define TRACE_ENHANCED_REQUEST_CALLBACK(Request, Call, bWasSuccessful, PayloadSize) do {} while (0)
+#define TRACE_ENHANCED_REQUEST_END(Request, bWasSuccessful, Reason) do {} while (0)
+
+#endif
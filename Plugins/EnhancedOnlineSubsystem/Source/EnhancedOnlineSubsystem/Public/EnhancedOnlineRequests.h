@@ -4,6 +4,10 @@
 
 #include "CoreMinimal.h"
 #include "EnhancedOnlineTypes.h"
+#include "EnhancedCompactSessionSettings.h"
+#include "EnhancedOnlineRequestTrace.h"
+#include "EnhancedOnlineSessionsSubsystem.h"
+#include "EnhancedSessionListDataProvider.h"
 #include "OnlineSessionSettings.h"
 #include "Interfaces/OnlineSessionInterface.h"
 #include "OnlineSubsystemUtils.h"
@@ -15,7 +19,6 @@
 #include "EnhancedOnlineRequests.generated.h"
 
 enum class EEnhancedSessionOnlineMode : uint8;
-class UEnhancedOnlineSessionsSubsystem;
 
 /**
  * Delegate for when a request failed
@@ -35,12 +38,30 @@ public:
 	//~ Being UEnhancedOnlineRequestBase Interface
 	virtual void ConstructRequest()
 	{
-		OnlineSub = Online::GetSubsystem(GetWorld());
+		// Borrow the interfaces the subsystem already resolved for this world
+		if (UEnhancedOnlineSessionsSubsystem* Subsystem = UEnhancedOnlineSessionsSubsystem::Get(this))
+		{
+			Interfaces = Subsystem->GetOnlineInterfaces();
+		}
+		else
+		{
+			Interfaces.World = GetWorld();
+			Interfaces.OnlineSub = Online::GetSubsystem(GetWorld());
+			check(Interfaces.OnlineSub);
+
+			Interfaces.Sessions = Interfaces.OnlineSub->GetSessionInterface();
+			Interfaces.Identity = Interfaces.OnlineSub->GetIdentityInterface();
+			Interfaces.Presence = Interfaces.OnlineSub->GetPresenceInterface();
+		}
+
+		OnlineSub = Interfaces.OnlineSub;
 		check(OnlineSub);
 	}
 	
 	virtual void InvalidateRequest()
 	{
+		TRACE_ENHANCED_REQUEST_END(this, false, TEXT("Invalidated"));
+
 		if (OnRequestFailedDelegate.IsBound())
 		{
 			OnRequestFailedDelegate.RemoveAll(this);
@@ -52,6 +73,8 @@ public:
 
 	virtual void CompleteRequest()
 	{
+		TRACE_ENHANCED_REQUEST_END(this, true, TEXT(""));
+
 		if (bInvalidateOnCompletion)
 		{
 			InvalidateRequest();
@@ -59,6 +82,13 @@ public:
 	}
 	//~ End UEnhancedOnlineRequestBase Interface
 
+	/** Tells the listeners why the request failed */
+	void FailRequest(const FString& Reason)
+	{
+		TRACE_ENHANCED_REQUEST_END(this, false, *Reason);
+		OnRequestFailedDelegate.Broadcast(Reason);
+	}
+
 	/** Should the request be garbage collected when it's completed */
 	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
 	bool bInvalidateOnCompletion;
@@ -72,9 +102,16 @@ public:
 
 protected:
 	friend UEnhancedOnlineSessionsSubsystem;
+	friend struct FEnhancedOnlineRequestTrace;
 
 	/** Online subsystem pointer */
 	IOnlineSubsystem* OnlineSub;
+
+	/** Online interfaces borrowed from the subsystem */
+	FEnhancedOnlineInterfaceHandles Interfaces;
+
+	/** Identifies the request in Insights while it runs, 0 if it isn't traced */
+	uint32 TraceRequestId = 0;
 };
 
 /**
@@ -91,7 +128,7 @@ public:
 	{
 		Super::ConstructRequest();
 
-		Sessions = OnlineSub->GetSessionInterface();
+		Sessions = Interfaces.Sessions;
 		check(Sessions);
 	}
 
@@ -157,6 +194,10 @@ public:
 	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
 	FString SearchKeyword;
 
+	/** The region or datacenter the session is hosted in, advertised so region searches can find it */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	FString Region;
+
 	/** Whether the session is a lobby */
 	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
 	bool bUseLobbiesIfAvailable;
@@ -362,7 +403,7 @@ public:
 	{
 		Super::ConstructRequest();
 
-		Identity = OnlineSub->GetIdentityInterface();
+		Identity = Interfaces.Identity;
 		check(Identity);
 	}
 
@@ -399,7 +440,7 @@ public:
 	{
 		Super::ConstructRequest();
 
-		Identity = OnlineSub->GetIdentityInterface();
+		Identity = Interfaces.Identity;
 		check(Identity);
 	}
 
@@ -428,12 +469,31 @@ class UEnhancedSessionSearchResult : public UObject
 	GENERATED_BODY()
 
 public:
-	/** Pings the session to get the current ping in milliseconds */
+	/** Returns the ping in milliseconds, smoothed with the ping history of the host if there is one */
 	int32 GetPingInMs() const
+	{
+		return PingConfidence > 0.0f ? FMath::RoundToInt(SmoothedPingInMs) : StoredSearchResult.PingInMs;
+	}
+
+	/** Returns the ping the backend reported with this search result */
+	int32 GetReportedPingInMs() const
 	{
 		return StoredSearchResult.PingInMs;
 	}
 
+	/** Returns how much the smoothed ping can be trusted, between 0 and 1. 0 if the host has no ping history */
+	float GetPingConfidence() const
+	{
+		return PingConfidence;
+	}
+
+	/** Sets the smoothed ping of the host, used by GetPingInMs while the confidence is above 0 */
+	void SetPingEstimate(float InSmoothedPingInMs, float InPingConfidence)
+	{
+		SmoothedPingInMs = InSmoothedPingInMs;
+		PingConfidence = InPingConfidence;
+	}
+
 	/** Returns the maximum number of players that can join the session */
 	int32 GetMaxPlayers() const
 	{
@@ -446,18 +506,24 @@ public:
 		return StoredSearchResult.Session.SessionSettings.NumPublicConnections - StoredSearchResult.Session.NumOpenPublicConnections;
 	}
 
+	/** Reads an advertised session setting, returns false if the session doesn't advertise it */
+	bool GetSessionSetting(FName Key, FString& OutValue) const
+	{
+		if (IsCompact())
+		{
+			return CompactSettings.Get(Key, OutValue);
+		}
+
+		return StoredSearchResult.Session.SessionSettings.Get(Key, OutValue);
+	}
+
 	/** Returns the session name */
 	FString GetSessionFriendlyName() const
 	{
-		if (StoredSearchResult.Session.SessionSettings.Settings.Array().Num() > 0)
+		FString FriendlyName;
+		if (GetSessionSetting(SETTING_FRIENDLYNAME, FriendlyName))
 		{
-			for (auto& Setting : StoredSearchResult.Session.SessionSettings.Settings)
-			{
-				if (Setting.Key == SETTING_FRIENDLYNAME)
-				{
-					return Setting.Value.Data.ToString();
-				}
-			}
+			return FriendlyName;
 		}
 
 		if (StoredSearchResult.Session.OwningUserId.IsValid())
@@ -468,9 +534,61 @@ public:
 		return TEXT("Unknown");
 	}
 
+	/** Whether the raw session settings were moved into the compact representation */
+	bool IsCompact() const
+	{
+		return !CompactSettings.IsEmpty();
+	}
+
+	/** Moves the raw session settings into the compact representation, member settings stay raw */
+	void CompactSessionSettings(const TSharedRef<FEnhancedSessionStringTable>& StringTable)
+	{
+		FEnhancedCompactSessionSettings NewSettings;
+		NewSettings.Compact(StoredSearchResult.Session.SessionSettings.Settings, StringTable);
+		SetCompactSessionSettings(MoveTemp(NewSettings));
+	}
+
+	/** Replaces the raw session settings with settings that were compacted elsewhere, e.g. on a worker thread */
+	void SetCompactSessionSettings(FEnhancedCompactSessionSettings&& InCompactSettings)
+	{
+		FOnlineSessionSettings& Settings = StoredSearchResult.Session.SessionSettings;
+		CompactSettings = MoveTemp(InCompactSettings);
+		Settings.Settings.Empty();
+	}
+
+	/** Restores the raw session settings, e.g. before the session is handed back to the backend */
+	void RestoreSessionSettings()
+	{
+		if (IsCompact())
+		{
+			CompactSettings.Restore(StoredSearchResult.Session.SessionSettings.Settings);
+			CompactSettings.Reset();
+		}
+	}
+
+	/** Whether the session comes from the last known server list and has not been refreshed yet */
+	bool IsStale() const
+	{
+		return bIsStale;
+	}
+
 public:
 	/** The search result which uniquely identifies the session */
 	FOnlineSessionSearchResult StoredSearchResult;
+
+	/** The session settings once compacted, the raw settings are empty then while the member settings are kept */
+	FEnhancedCompactSessionSettings CompactSettings;
+
+	/** Stale sessions are only good for display, they can't be joined */
+	UPROPERTY(BlueprintReadOnly, Category = "Online|Session")
+	bool bIsStale = false;
+
+private:
+	/** The ping of the host averaged over searches, probes and connections */
+	float SmoothedPingInMs = 0.0f;
+
+	/** How much the smoothed ping can be trusted, between 0 and 1 */
+	float PingConfidence = 0.0f;
 };
 
 /**
@@ -479,6 +597,14 @@ public:
  */
 DECLARE_MULTICAST_DELEGATE_OneParam(FOnEnhancedFindOnlineSessionsCompleted, const TArray<UEnhancedSessionSearchResult*> /* Search Results */);
 
+/**
+ * Delegate for when a part of the search results was wrapped, called once per frame while a large search is published
+ * @param NewResults	The search results wrapped this frame
+ * @param NumCompleted	The number of search results wrapped so far
+ * @param NumTotal		The number of search results that will be published
+ */
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FOnEnhancedFindOnlineSessionsProgress, const TArray<UEnhancedSessionSearchResult*>& /* New Results */, int32 /* Num Completed */, int32 /* Num Total */);
+
 /**
  * Request class used to find online sessions
  */
@@ -504,13 +630,58 @@ public:
 	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
 	FString SearchKeyword;
 
+	/**
+	 * Criteria pushed into the search query, so the backend drops sessions before they are sent.
+	 * The query holds one criterion per key, further ones on the same key are checked on the results.
+	 */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	TArray<FEnhancedSessionQueryFilter> QueryFilters;
+
+	/**
+	 * Regions or datacenters to search, one query each with at most MaxResultsPerRegion results.
+	 * The results are merged nearest first. Empty searches everywhere with a single query.
+	 */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	TArray<FString> Regions;
+
+	/** Maximum number of search results per region, 0 uses MaxSearchResults */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	int32 MaxResultsPerRegion = 20;
+
 	/** List of all the search results found online, will be valid after the request is completed */
 	UPROPERTY(BlueprintReadOnly, Category = "Online|Request")
 	TArray<TObjectPtr<UEnhancedSessionSearchResult>> SearchResults;
 
+	/** Optional native filter, called on worker threads, or on the game thread for a list. Return false to drop a result */
+	TFunction<bool(const FOnlineSessionSearchResult&)> ResultFilter;
+
+	/**
+	 * Optional native score, called on worker threads, or on the game thread for a list. Results are sorted by it with the highest first.
+	 * A list keeps that order while its sort mode is None.
+	 */
+	TFunction<float(const FOnlineSessionSearchResult&)> ResultScorer;
+
+	/**
+	 * If set, the results are handed to this list instead of being wrapped all at once.
+	 * The completion delegate is then called with an empty array, items are fetched from the list.
+	 * ResultFilter and ResultScorer still apply. The settings are never compacted, since the list only wraps the visible items.
+	 */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	TObjectPtr<UEnhancedSessionListDataProvider> ListDataProvider;
+
+	/**
+	 * Milliseconds per frame that may be spent wrapping search results, the rest is continued on the next frames.
+	 * 0 wraps everything at once, negative uses EnhancedOnline.Sessions.MaterializeBudgetMs.
+	 */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	float FrameBudgetMs = -1.0f;
+
 	/** Native delegate for when the request is completed */
 	FOnEnhancedFindOnlineSessionsCompleted OnFindOnlineSessionsCompleted;
 
+	/** Native delegate for every frame of search results that was wrapped, Blueprints bind it through Construct Online Find Sessions Request */
+	FOnEnhancedFindOnlineSessionsProgress OnFindOnlineSessionsProgress;
+
 public:
 	virtual void InvalidateRequest() override
 	{
@@ -521,10 +692,76 @@ public:
 			OnFindOnlineSessionsCompleted.RemoveAll(this);
 			OnFindOnlineSessionsCompleted.Clear();
 		}
+
+		if (OnFindOnlineSessionsProgress.IsBound())
+		{
+			OnFindOnlineSessionsProgress.RemoveAll(this);
+			OnFindOnlineSessionsProgress.Clear();
+		}
+	}
+
+	/** Only finds sessions on this map */
+	UFUNCTION(BlueprintCallable, Category = "Online|Request|Query")
+	UEnhancedOnlineRequest_FindSessions* WhereMapName(const FString& MapName)
+	{
+		return WhereString(SETTING_MAPNAME, EEnhancedSessionQueryComparison::Equals, MapName);
+	}
+
+	/** Only finds sessions advertising this game mode */
+	UFUNCTION(BlueprintCallable, Category = "Online|Request|Query")
+	UEnhancedOnlineRequest_FindSessions* WhereGameMode(const FString& GameMode)
+	{
+		return WhereString(SETTING_GAMEMODE, EEnhancedSessionQueryComparison::Equals, GameMode);
+	}
+
+	/** Only finds sessions with at least this many open slots */
+	UFUNCTION(BlueprintCallable, Category = "Online|Request|Query")
+	UEnhancedOnlineRequest_FindSessions* WithMinOpenSlots(int32 NumSlots)
+	{
+		// Backends read the value as a minimum, the comparison is ignored
+		return WhereInt(SEARCH_MINSLOTSAVAILABLE, EEnhancedSessionQueryComparison::Equals, NumSlots);
+	}
+
+	/** Compares an integer session setting against the value */
+	UFUNCTION(BlueprintCallable, Category = "Online|Request|Query")
+	UEnhancedOnlineRequest_FindSessions* WhereInt(FName Key, EEnhancedSessionQueryComparison Comparison, int32 Value)
+	{
+		QueryFilters.Add(FEnhancedSessionQueryFilter::MakeInt(Key, Comparison, Value));
+		return this;
+	}
+
+	/** Only finds sessions whose integer setting lies between Min and Max, both included */
+	UFUNCTION(BlueprintCallable, Category = "Online|Request|Query")
+	UEnhancedOnlineRequest_FindSessions* WhereIntInRange(FName Key, int32 Min, int32 Max)
+	{
+		WhereInt(Key, EEnhancedSessionQueryComparison::GreaterThanEquals, Min);
+		return WhereInt(Key, EEnhancedSessionQueryComparison::LessThanEquals, Max);
+	}
+
+	/** Compares a string session setting against the value */
+	UFUNCTION(BlueprintCallable, Category = "Online|Request|Query")
+	UEnhancedOnlineRequest_FindSessions* WhereString(FName Key, EEnhancedSessionQueryComparison Comparison, const FString& Value)
+	{
+		QueryFilters.Add(FEnhancedSessionQueryFilter::MakeString(Key, Comparison, Value));
+		return this;
+	}
+
+	/** Only finds sessions whose bool setting has this value */
+	UFUNCTION(BlueprintCallable, Category = "Online|Request|Query")
+	UEnhancedOnlineRequest_FindSessions* WhereBool(FName Key, bool bValue)
+	{
+		QueryFilters.Add(FEnhancedSessionQueryFilter::MakeBool(Key, bValue));
+		return this;
 	}
 };
 
 
+/**
+ * Delegate for when a session was joined, called right before travelling to it
+ * @param SessionName	The name of the joined session
+ */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnEnhancedJoinSessionCompleted, const FName /* Session Name */);
+
 /**
  * Request class used to join an online session
  */
@@ -537,6 +774,231 @@ public:
 	/** The session to join */
 	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
 	TObjectPtr<UEnhancedSessionSearchResult> SessionToJoin;
+
+	/** Whether to reserve a slot with the host before joining, if the session takes reservations */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	bool bReserveSlot = true;
+
+	/** Native delegate for when the session was joined */
+	FOnEnhancedJoinSessionCompleted OnJoinSessionCompleted;
+
+public:
+	virtual void InvalidateRequest() override
+	{
+		Super::InvalidateRequest();
+
+		if (OnJoinSessionCompleted.IsBound())
+		{
+			OnJoinSessionCompleted.RemoveAll(this);
+			OnJoinSessionCompleted.Clear();
+		}
+	}
+};
+
+/**
+ * Delegate for when the last session was joined again
+ * @param bUsedSearchFallback	Whether the session had to be searched for because the direct lookup failed
+ */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnEnhancedRejoinSessionCompleted, bool /* bUsedSearchFallback */);
+
+/**
+ * Request class used to get back into the game session the local user joined last
+ */
+UCLASS()
+class UEnhancedOnlineRequest_RejoinLastSession : public UEnhancedOnlineSessionRequestBase
+{
+	GENERATED_BODY()
+
+public:
+	/** Whether to search for the session by its owner if it can't be looked up by its id anymore */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	bool bAllowSearchFallback = true;
+
+	/** Maximum number of search results the fallback search considers */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	int32 MaxSearchResults = 100;
+
+	/** Native delegate for when the session was joined again */
+	FOnEnhancedRejoinSessionCompleted OnRejoinSessionCompleted;
+
+public:
+	virtual void InvalidateRequest() override
+	{
+		Super::InvalidateRequest();
+
+		if (OnRejoinSessionCompleted.IsBound())
+		{
+			OnRejoinSessionCompleted.RemoveAll(this);
+			OnRejoinSessionCompleted.Clear();
+		}
+	}
+};
+
+/**
+ * Delegate for when a lobby was handed off to its game session
+ * @param ConnectString	The address the lobby members were sent to
+ */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnEnhancedLobbyHandoffCompleted, const FString& /* Connect String */);
+
+/**
+ * Request class used to move a hosted lobby into a game session without the members searching for it
+ */
+UCLASS()
+class UEnhancedOnlineRequest_LobbyHandoff : public UEnhancedOnlineSessionRequestBase
+{
+	GENERATED_BODY()
+
+public:
+	/** The game session the lobby host creates, the members follow the host when it travels */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	TObjectPtr<UEnhancedOnlineRequest_CreateSession> GameSessionTemplate;
+
+	/** An existing game session, e.g. a dedicated server, the whole lobby travels to. Takes precedence over the template */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	TObjectPtr<UEnhancedSessionSearchResult> GameSessionToClaim;
+
+	/** Native delegate for when the members were told where to go, called right before the host travels */
+	FOnEnhancedLobbyHandoffCompleted OnLobbyHandoffCompleted;
+
+public:
+	virtual void InvalidateRequest() override
+	{
+		Super::InvalidateRequest();
+
+		if (OnLobbyHandoffCompleted.IsBound())
+		{
+			OnLobbyHandoffCompleted.RemoveAll(this);
+			OnLobbyHandoffCompleted.Clear();
+		}
+	}
+};
+
+/**
+ * Delegate for when a matchmaking request ended up in a session
+ * @param Result	Whether a session was joined or hosted
+ */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnEnhancedMatchmakingCompleted, EEnhancedMatchmakingResult /* Result */);
+
+/**
+ * Request class used to find the best fitting session and join it, or host one if nothing fits
+ */
+UCLASS()
+class UEnhancedOnlineRequest_Matchmake : public UEnhancedOnlineSessionRequestBase
+{
+	GENERATED_BODY()
+
+public:
+	/** Specifies the online mode of the session */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	EEnhancedSessionOnlineMode OnlineMode;
+
+	/** Whether to search for player-hosted lobbies */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	bool bFindLobbies;
+
+	/** Maximum number of search results to consider per search */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	int32 MaxSearchResults = 50;
+
+	/** Preferred search keyword, dropped from the query once the criteria are widened far enough */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	FString SearchKeyword;
+
+	/** Preferred game mode, only a preference once the criteria are widened */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	FString GameModeAdvertisementName;
+
+	/** Sessions above this ping are rejected, each widening step tolerates 50% more. 0 disables the limit */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	int32 MaxPingInMs = 150;
+
+	/** Time in seconds after which the template is hosted if no session could be joined */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	float TimeBudgetSeconds = 30.0f;
+
+	/** Delay in seconds before searching again with widened criteria */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	float WidenIntervalSeconds = 3.0f;
+
+	/** Score weights */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request|Scoring")
+	float PingWeight = 1.0f;
+
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request|Scoring")
+	float FillWeight = 0.5f;
+
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request|Scoring")
+	float GameModeWeight = 1.0f;
+
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request|Scoring")
+	float KeywordWeight = 0.5f;
+
+	/** The session to host when nothing fits within the time budget, nothing is hosted if not set */
+	UPROPERTY(BlueprintReadWrite, Category = "Online|Request")
+	TObjectPtr<UEnhancedOnlineRequest_CreateSession> HostFallbackTemplate;
+
+	/** Native delegate for when matchmaking ended up in a session */
+	FOnEnhancedMatchmakingCompleted OnMatchmakingCompleted;
+
+public:
+	virtual void InvalidateRequest() override
+	{
+		Super::InvalidateRequest();
+
+		if (OnMatchmakingCompleted.IsBound())
+		{
+			OnMatchmakingCompleted.RemoveAll(this);
+			OnMatchmakingCompleted.Clear();
+		}
+	}
+
+	/** Returns the keyword to query the backend with at the given widen level */
+	virtual FString GetSearchKeyword(int32 WidenLevel) const
+	{
+		return WidenLevel < 2 ? SearchKeyword : FString();
+	}
+
+	/**
+	 * Scores a search result, the higher the better
+	 * @param SearchResult	The search result to score
+	 * @param WidenLevel	How often the criteria have been widened so far
+	 * @return The score, negative if the session should not be joined at all
+	 */
+	virtual float ScoreSearchResult(const UEnhancedSessionSearchResult* SearchResult, int32 WidenLevel) const
+	{
+		const int32 MaxPlayers = SearchResult->GetMaxPlayers();
+		const int32 CurrentPlayers = SearchResult->GetCurrentPlayers();
+		if (MaxPlayers <= 0 || CurrentPlayers >= MaxPlayers)
+		{
+			return -1.0f;
+		}
+
+		const float PingTolerance = MaxPingInMs * (1.0f + 0.5f * WidenLevel);
+		const int32 Ping = SearchResult->GetPingInMs();
+		if (MaxPingInMs > 0 && Ping > PingTolerance)
+		{
+			return -1.0f;
+		}
+
+		FString GameMode;
+		const bool bGameModeMatches = GameModeAdvertisementName.IsEmpty()
+			|| (SearchResult->GetSessionSetting(SETTING_GAMEMODE, GameMode) && GameMode == GameModeAdvertisementName);
+		if (!bGameModeMatches && WidenLevel == 0)
+		{
+			return -1.0f;
+		}
+
+		FString Keyword;
+		const bool bKeywordMatches = SearchKeyword.IsEmpty()
+			|| (SearchResult->GetSessionSetting(SEARCH_KEYWORDS, Keyword) && Keyword == SearchKeyword);
+
+		float Score = 0.0f;
+		Score += PingWeight * (MaxPingInMs > 0 ? 1.0f - FMath::Clamp(Ping / PingTolerance, 0.0f, 1.0f) : 1.0f);
+		Score += FillWeight * static_cast<float>(CurrentPlayers) / MaxPlayers;
+		Score += bGameModeMatches ? GameModeWeight : 0.0f;
+		Score += bKeywordMatches ? KeywordWeight : 0.0f;
+		return Score;
+	}
 };
 
 /**
@@ -591,8 +1053,39 @@ public:
 		{
 			QuerySettings.Set(SEARCH_KEYWORDS, InRequest->SearchKeyword, EOnlineComparisonOp::Equals);
 		}
+
+		for (const FEnhancedSessionQueryFilter& Filter : InRequest->QueryFilters)
+		{
+			// LAN hosts answer every query without looking at it
+			if (bIsLanQuery || QuerySettings.SearchParams.Contains(Filter.Key))
+			{
+				ClientQueryFilters.Add(Filter);
+			}
+			else
+			{
+				Filter.ApplyTo(QuerySettings);
+			}
+		}
 	}
 
 	virtual ~FEnhancedOnlineSearchSettings() {}
+
+	/** Returns whether the result passes the filters that could not be pushed into the query */
+	bool MatchesClientQueryFilters(const FOnlineSessionSearchResult& SearchResult) const
+	{
+		for (const FEnhancedSessionQueryFilter& Filter : ClientQueryFilters)
+		{
+			if (!Filter.Matches(SearchResult))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+public:
+	/** Query filters that have to be checked on the results */
+	TArray<FEnhancedSessionQueryFilter> ClientQueryFilters;
 };
 
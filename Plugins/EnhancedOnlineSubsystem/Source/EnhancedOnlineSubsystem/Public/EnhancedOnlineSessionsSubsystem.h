@@ -3,6 +3,10 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "EnhancedOnlineStateSnapshot.h"
+#include "EnhancedOnlineTypes.h"
+#include "Engine/EngineTypes.h"
+#include "OnlineSubsystem.h"
 #include "Interfaces/OnlineSessionInterface.h"
 #include "Subsystems/GameInstanceSubsystem.h"
 #include "EnhancedOnlineSessionsSubsystem.generated.h"
@@ -12,8 +16,21 @@ class UEnhancedOnlineRequest_GetFriendsList;
 class UEnhancedOnlineRequest_StartSession;
 class UEnhancedOnlineRequest_LogoutUser;
 class UEnhancedOnlineRequest_JoinSession;
+class UEnhancedOnlineRequest_LobbyHandoff;
+class UEnhancedOnlineRequest_RejoinLastSession;
+class UEnhancedOnlineRequest_Matchmake;
 class UEnhancedSessionSearchResult;
 class FEnhancedOnlineSearchSettings;
+struct FEnhancedPendingSearchMaterialization;
+struct FEnhancedRegionSearch;
+struct FEnhancedOnlineLastSessionRecord;
+class FEnhancedOnlinePingHistory;
+class FEnhancedOnlineStateSnapshotSlot;
+class FEnhancedOnlineTraceWriter;
+class FEnhancedOnlineTracePlayer;
+class FEnhancedOnlineFaultInjector;
+struct FEnhancedOnlineSnapshotSession;
+enum class EEnhancedPingSource : uint8;
 class UEnhancedOnlineRequest_FindSessions;
 class UEnhancedOnlineRequest_LoginUser;
 class FEnhancedOnlineSessionSettings;
@@ -21,7 +38,104 @@ class UEnhancedOnlineRequest_CreateLobby;
 class UEnhancedOnlineRequest_CreateSession;
 class UEnhancedOnlineRequest_Session;
 class FOnlineSessionSearch;
+class AGameModeBase;
+class AOnlineBeaconHost;
+class AEnhancedOnlineReservationBeaconClient;
+class AEnhancedOnlineReservationBeaconHostObject;
+struct FUniqueNetIdRepl;
+enum class EEnhancedSlotReservationResult : uint8;
 
+/**
+ * Online interfaces resolved once per world and backend, borrowed by the subsystem and its requests
+ */
+struct FEnhancedOnlineInterfaceHandles
+{
+	/** The world the interfaces were resolved for */
+	TWeakObjectPtr<UWorld> World;
+
+	/** The backend the interfaces belong to */
+	IOnlineSubsystem* OnlineSub = nullptr;
+
+	IOnlineSessionPtr Sessions;
+	IOnlineIdentityPtr Identity;
+	IOnlinePresencePtr Presence;
+
+	bool IsValid() const { return OnlineSub != nullptr; }
+};
+
+/**
+ * Snapshot of a rich presence that is either pending, in flight or published
+ */
+struct FEnhancedPresenceSnapshot
+{
+	FEnhancedOnlineFriendPresenceInfo Info;
+	TMap<FString, FString> Properties;
+
+	bool Equals(const FEnhancedPresenceSnapshot& Other) const
+	{
+		return Info.PresenceState == Other.Info.PresenceState
+			&& Info.StatusString == Other.Info.StatusString
+			&& Properties.OrderIndependentCompareEqual(Other.Properties);
+	}
+};
+
+/**
+ * Rich presence of a single local user on its way to the backend
+ */
+struct FEnhancedPresencePublishState
+{
+	/** The presence gameplay wants to publish, coalesced until the next publish */
+	FEnhancedPresenceSnapshot Pending;
+
+	/** The presence that is currently being written to the backend */
+	FEnhancedPresenceSnapshot InFlight;
+
+	/** The presence that was last accepted by the backend */
+	FEnhancedPresenceSnapshot Published;
+
+	/** Whether the pending presence differs from what was last queued */
+	bool bDirty = false;
+
+	/** Whether a presence write is currently in flight */
+	bool bWriteInFlight = false;
+
+	/** Platform time of the last presence write */
+	double LastPublishTime = 0.0;
+
+	/** Timer used to delay the next publish until the interval has passed */
+	FTimerHandle PublishTimerHandle;
+
+	/** Bound while the publish waits for the user to log in */
+	FDelegateHandle LoginStatusChangedDelegateHandle;
+};
+
+/**
+ * What a dedicated server currently advertises through its session settings
+ */
+struct FEnhancedDedicatedSessionAdvertisement
+{
+	int32 NumPlayers = INDEX_NONE;
+	FString MapName;
+	FName MatchState;
+};
+
+/**
+ * A slot of the hosted session held for a player that is on its way in
+ */
+struct FEnhancedSlotReservation
+{
+	FUniqueNetIdPtr PlayerId;
+	FString Token;
+
+	/** Platform time after which the slot is given to someone else */
+	double ExpiresAt = 0.0;
+};
+
+/**
+ * Delegate for when the host of the joined lobby handed it off to a game session
+ * @param ConnectString	The address of the game session
+ */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnEnhancedLobbyHandoffReceived, const FString& /* Connect String */);
 
 /**
  * Subsystem for managing online sessions and communication with the online service.
@@ -40,6 +154,33 @@ public:
 	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
 	//~ End UGameInstanceSubsystem Interface
 
+	/** Returns the subsystem of the game instance the world context object lives in */
+	static UEnhancedOnlineSessionsSubsystem* Get(const UObject* WorldContextObject);
+
+	/**
+	 * Returns the cached online interfaces for the current world.
+	 * They are resolved on first use and again whenever the world or the backend changes.
+	 * Returned as a copy, resolving another backend may move the cached entries.
+	 * @param SubsystemName		The backend to use, NAME_None for the default one
+	 */
+	FEnhancedOnlineInterfaceHandles GetOnlineInterfaces(FName SubsystemName = NAME_None);
+
+	/** Drops all cached online interfaces, they will be resolved again on next use */
+	void InvalidateOnlineInterfaces();
+
+	/**
+	 * Sets the backend that is used when no backend is named, NAME_None for the platform default.
+	 * A backend can be named as Backend:Instance, so several game instances in one process don't share it.
+	 */
+	void SetDefaultOnlineBackend(FName BackendName);
+
+	/**
+	 * Returns the name of the session this instance hosts or is in.
+	 * Game sessions are named NAME_GameSession and lobbies NAME_PartySession, so a lobby can be handed off to a game session while both exist.
+	 * The game session wins while both exist, NAME_GameSession is returned if there is neither.
+	 */
+	static FName GetActiveSessionName(const IOnlineSessionPtr& Sessions);
+
 #pragma region online_identity
 	/**
 	 * Logs in the online user.
@@ -85,6 +226,164 @@ public:
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Sessions")
 	virtual void JoinOnlineSession(UEnhancedOnlineRequest_JoinSession* Request);
+
+	/**
+	 * Joins the game session the local user was in last, e.g. after a disconnect or a crash.
+	 * The session is looked up by its id first and only searched for by its owner if it is gone.
+	 * @param Request	The request object that contains the rejoin settings.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Sessions")
+	virtual void RejoinLastSession(UEnhancedOnlineRequest_RejoinLastSession* Request);
+
+	/** Whether there is a recent enough session the local user can rejoin */
+	UFUNCTION(BlueprintPure, Category = "Online|EnhancedSessions|Sessions", meta = (AdvancedDisplay = "LocalUserIndex"))
+	bool HasLastSession(int32 LocalUserIndex = 0) const;
+
+	/** Forgets the last session of the local user, e.g. after leaving a match on purpose */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Sessions", meta = (AdvancedDisplay = "LocalUserIndex"))
+	void ForgetLastSession(int32 LocalUserIndex = 0);
+#pragma endregion
+
+
+
+#pragma region online_matchmaking
+	/**
+	 * Searches for the best fitting sessions and joins them in order of their score.
+	 * The criteria are widened after every unsuccessful search, once the time budget runs out the fallback template is hosted instead.
+	 * @param Request	The request object that contains the matchmaking criteria.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Matchmaking")
+	virtual void StartMatchmaking(UEnhancedOnlineRequest_Matchmake* Request);
+
+	/** Stops the current matchmaking, a join or host that is already in flight is not cancelled */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Matchmaking")
+	virtual void CancelMatchmaking();
+
+	/** Whether a matchmaking request is currently running */
+	UFUNCTION(BlueprintPure, Category = "Online|EnhancedSessions|Matchmaking")
+	bool IsMatchmaking() const { return PendingMatchmakeRequest != nullptr; }
+#pragma endregion
+
+
+
+#pragma region online_lobby
+	/**
+	 * Moves the hosted lobby into a game session.
+	 * The game session is created or claimed while the lobby is still alive, its address is pushed to all members
+	 * with a single lobby update and everyone travels there without searching for it.
+	 * @param Request	The request object that contains the game session to create or claim.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Lobby")
+	virtual void HandoffLobbyToGameSession(UEnhancedOnlineRequest_LobbyHandoff* Request);
+
+	/** Called on lobby members when the lobby host handed the lobby off, before travelling */
+	FOnEnhancedLobbyHandoffReceived OnLobbyHandoffReceived;
+#pragma endregion
+
+
+
+#pragma region online_reservation
+	/**
+	 * Reserves a slot of the hosted game session for a player that is about to join.
+	 * Called through the reservation beacon, the player is only admitted while the reservation is valid.
+	 * @param PlayerId	The player asking for a slot
+	 * @param OutToken	The token the player has to travel with
+	 * @param OutError	Why no slot could be reserved
+	 */
+	virtual bool ReserveSessionSlot(const FUniqueNetIdRepl& PlayerId, FString& OutToken, FString& OutError);
+
+	/** Number of slots held for players that have not arrived yet */
+	UFUNCTION(BlueprintPure, Category = "Online|EnhancedSessions|Sessions")
+	int32 GetNumSlotReservations() const;
+#pragma endregion
+
+
+
+#pragma region online_ping
+	/**
+	 * Sets the smoothed ping of a search result from the ping history of its host.
+	 * Called for every wrapped search result, the history is fed by searches, slot reservations and joined connections.
+	 * @param SearchResult	The search result to enrich
+	 */
+	void ApplyPingEstimate(UEnhancedSessionSearchResult* SearchResult) const;
+#pragma endregion
+
+
+
+#pragma region online_snapshot
+	/**
+	 * Returns the last published state snapshot, null before the first one.
+	 * Safe to call from any thread while the subsystem is alive, it never waits for the game thread.
+	 * A snapshot never changes, state changes publish a new one on the next frame.
+	 */
+	FEnhancedOnlineStateSnapshotPtr GetStateSnapshot() const;
+#pragma endregion
+
+
+
+#pragma region online_dedicated
+	/** Whether this instance hosts a dedicated session that is being advertised */
+	UFUNCTION(BlueprintPure, Category = "Online|EnhancedSessions|Dedicated")
+	bool IsHostingDedicatedSession() const { return !DedicatedSessionName.IsNone(); }
+
+	/**
+	 * Schedules an advertisement refresh with the next heartbeat, e.g. after a custom setting changed.
+	 * Several calls within one heartbeat interval still result in a single UpdateSession.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Dedicated")
+	virtual void MarkDedicatedSessionDirty();
+#pragma endregion
+
+
+
+#pragma region online_registry
+	/**
+	 * Queues a player to be registered with the hosted game session.
+	 * Called automatically on PostLogin, registrations are flushed in batches.
+	 * @param PlayerController	The player that joined
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Sessions")
+	virtual void RegisterSessionPlayer(APlayerController* PlayerController);
+
+	/**
+	 * Queues a player to be unregistered from the hosted game session.
+	 * Called automatically on Logout, unregistrations are flushed in batches.
+	 * @param Controller	The player that left
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Sessions")
+	virtual void UnregisterSessionPlayer(AController* Controller);
+
+	/** Sends all queued registrations and unregistrations right away */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Sessions")
+	virtual void FlushSessionPlayerRegistry();
+#pragma endregion
+
+
+
+#pragma region online_presence
+	/**
+	 * Queues a rich presence update for the local user.
+	 * Updates are coalesced and published at most once per EnhancedOnline.Presence.MinPublishInterval.
+	 * @param LocalUserIndex	The index of the local user whose presence should be updated
+	 * @param PresenceState		The online presence state to publish
+	 * @param StatusString		The additional status string to publish
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Presence", meta = (AdvancedDisplay = "LocalUserIndex"))
+	virtual void UpdateOnlinePresence(int32 LocalUserIndex, EBlueprintEnhancedPresenceState PresenceState, const FString& StatusString);
+
+	/**
+	 * Queues a rich presence property (e.g. map, game mode, party size) for the local user.
+	 * The last value written for a key before the next publish wins.
+	 * @param LocalUserIndex	The index of the local user whose presence should be updated
+	 * @param Key				The presence property key
+	 * @param Value				The presence property value
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|Presence", meta = (AdvancedDisplay = "LocalUserIndex"))
+	virtual void SetOnlinePresenceProperty(int32 LocalUserIndex, const FString& Key, const FString& Value);
+
+	/** Returns the presence of the local user that was last accepted by the presence backend */
+	UFUNCTION(BlueprintPure, Category = "Online|EnhancedSessions|Presence", meta = (AdvancedDisplay = "LocalUserIndex"))
+	FEnhancedOnlineFriendPresenceInfo GetPublishedOnlinePresence(int32 LocalUserIndex = 0) const;
 #pragma endregion
 
 protected:
@@ -108,8 +407,89 @@ protected:
 	virtual void HandleHostOnlineSessionComplete(FName SessionName, bool bWasSuccessful);
 	virtual void HandleStartOnlineSessionComplete(FName SessionName, bool bWasSuccessful);
 	virtual void HandleFindOnlineSessionsComplete(bool bWasSuccessful);
+	virtual void IssueNextRegionSearch();
+	virtual void HandleRegionSearchComplete(bool bWasSuccessful);
+	virtual void FinishRegionSearch();
+	virtual void MaterializeSearchResults();
+	virtual void FinishFindOnlineSessions();
+	virtual void JoinOnlineSessionInternal(UEnhancedOnlineRequest_JoinSession* Request, FName SessionName);
 	virtual void HandleJoinSessionCompleted(FName SessionName, EOnJoinSessionCompleteResult::Type Result);
 
+	/** Slot Reservations */
+	virtual void AdvertiseReservationBeacon(FOnlineSessionSettings& InSessionSettings) const;
+	virtual bool RequestSlotReservation(UEnhancedOnlineRequest_JoinSession* Request);
+	virtual void HandleSlotReservationResponse(EEnhancedSlotReservationResult Result, const FString& Token, const FString& Error);
+	virtual void StartReservationBeacon();
+	virtual void StopReservationBeacon();
+	virtual void PruneSlotReservations();
+	virtual void ConsumeSlotReservation(AGameModeBase* GameMode, APlayerController* NewPlayer);
+	virtual bool IsAdmittedToHostedSession(const FUniqueNetId& PlayerId);
+	virtual void HandleGameModeInitialized(AGameModeBase* GameMode);
+	virtual void HandleGameModePreLogin(AGameModeBase* GameMode, const FUniqueNetIdRepl& NewPlayer, FString& ErrorMessage);
+
+	FDelegateHandle GameModeInitializedDelegateHandle;
+	FDelegateHandle GameModePreLoginDelegateHandle;
+
+	/** State Snapshot */
+	virtual void MarkStateSnapshotDirty();
+	virtual void PublishStateSnapshot();
+	virtual void SnapshotSearchResults(const TArray<UEnhancedSessionSearchResult*>& Results);
+	virtual void SnapshotRawSearchResults(const TArray<FOnlineSessionSearchResult>& Results);
+
+	/** Ping History */
+	virtual void RecordSearchPings(const TArray<FOnlineSessionSearchResult>& SearchResults);
+	virtual void AddPingSample(const FOnlineSessionSearchResult& SearchResult, float PingInMs, EEnhancedPingSource Source);
+	virtual void StartConnectionPingSampling(const FOnlineSessionSearchResult& SearchResult, int32 LocalUserIndex);
+	virtual void SampleConnectionPing();
+	virtual void StopConnectionPingSampling();
+
+	/** Rejoin */
+	virtual void RecordLastSession(int32 LocalUserIndex, const FOnlineSessionSearchResult& SearchResult, const FString& ConnectString);
+	virtual void HandleRejoinSessionFound(int32 LocalUserNum, bool bWasSuccessful, const FOnlineSessionSearchResult& SearchResult);
+	virtual void IssueRejoinSearch();
+	virtual void JoinRejoinCandidate(UEnhancedSessionSearchResult* Candidate, bool bFromSearch);
+	virtual void FinishRejoin(bool bWasSuccessful, bool bUsedSearchFallback, const FString& Error);
+
+	/** Matchmaking */
+	virtual void IssueMatchmakingSearch();
+	virtual void HandleMatchmakingSearchComplete(const TArray<UEnhancedSessionSearchResult*>& Results);
+	virtual void TryNextMatchmakingCandidate();
+	virtual void WidenMatchmakingCriteria();
+	virtual void HostMatchmakingFallback();
+	virtual void FinishMatchmaking(bool bWasSuccessful, EEnhancedMatchmakingResult Result, const FString& Error);
+
+	/** Lobby Handoff */
+	virtual void PublishLobbyHandoff(const FString& ConnectString, const FString& GameSessionId, bool bFollowHost);
+	virtual void HandleLobbyHandoffPublished(FName SessionName, bool bWasSuccessful);
+	virtual void FinishLobbyHandoff();
+	virtual void FailLobbyHandoff(const FString& Error);
+	virtual void HandleLobbySettingsUpdated(FName SessionName, const FOnlineSessionSettings& UpdatedSettings);
+
+	FDelegateHandle LobbyHandoffUpdateDelegateHandle;
+	FDelegateHandle LobbySettingsUpdatedDelegateHandle;
+
+	/** Dedicated Sessions */
+	virtual void StartDedicatedSessionHeartbeat(FName SessionName);
+	virtual void StopDedicatedSessionHeartbeat();
+	virtual void TickDedicatedSessionHeartbeat();
+	virtual void GatherDedicatedSessionAdvertisement(FEnhancedDedicatedSessionAdvertisement& OutAdvertisement) const;
+	virtual void HandleUpdateDedicatedSessionComplete(FName SessionName, bool bWasSuccessful);
+
+	FDelegateHandle UpdateSessionDelegateHandle;
+
+	/** Player Registry */
+	virtual void ScheduleSessionPlayerRegistryFlush();
+	virtual void RetrySessionPlayerRegistry(FName SessionName, const TArray<FUniqueNetIdRef>& Players, bool bRegister);
+	virtual void HandleGameModePostLogin(AGameModeBase* GameMode, APlayerController* NewPlayer);
+	virtual void HandleGameModeLogout(AGameModeBase* GameMode, AController* Exiting);
+	virtual void HandleRegisterPlayersComplete(FName SessionName, const TArray<FUniqueNetIdRef>& Players, bool bWasSuccessful);
+	virtual void HandleUnregisterPlayersComplete(FName SessionName, const TArray<FUniqueNetIdRef>& Players, bool bWasSuccessful);
+
+	FDelegateHandle GameModePostLoginDelegateHandle;
+	FDelegateHandle GameModeLogoutDelegateHandle;
+	FDelegateHandle RegisterPlayersDelegateHandle;
+	FDelegateHandle UnregisterPlayersDelegateHandle;
+
 	/** Online Identity */
 	virtual void LoginOnlineUserInternal(ULocalPlayer* LocalPlayer, UEnhancedOnlineRequest_LoginUser* Request);
 	virtual void LogoutOnlineUserInternal(ULocalPlayer* LocalPlayer, UEnhancedOnlineRequest_LogoutUser* Request);
@@ -120,8 +500,58 @@ protected:
 	virtual void HandleLoginComplete(int32 LocalUserNum, bool bWasSuccessful, const FUniqueNetId& UserId, const FString& Error);
 	virtual void HandleLogoutComplete(int32 LocalUserNum, bool bWasSuccessful);
 
+	/** Starts a background login with the cached auth token, if there is one */
+	virtual void StartAutoLogin();
+
+	/** Stores a token that can be used to log the user back in on the next launch */
+	virtual void CacheLoginCredentials(int32 LocalUserNum, const FUniqueNetId& UserId, EEnhancedLoginAuthType AuthType);
+
+	/** Online Interfaces */
+	virtual FEnhancedOnlineInterfaceHandles ResolveOnlineInterfaces(FName SubsystemName);
+	virtual void HandleWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources);
+
+	FDelegateHandle WorldCleanupDelegateHandle;
+
+	/** Backend Trace */
+	virtual void StartBackendTrace();
+	virtual void StopBackendTrace();
+	virtual void WrapTracedInterfaces(FName SubsystemName, FEnhancedOnlineInterfaceHandles& Handles);
+
+	/** Backend Faults */
+	virtual void StartBackendFaults();
+	virtual void StopBackendFaults();
+	virtual void WrapFaultInjectedInterfaces(FName SubsystemName, FEnhancedOnlineInterfaceHandles& Handles);
+
+	/** Online Presence */
+	virtual void SchedulePresencePublish(int32 LocalUserIndex);
+	virtual void PublishPendingPresence(int32 LocalUserIndex);
+	virtual void HandlePublishPresenceComplete(const FUniqueNetId& UserId, bool bWasSuccessful, int32 LocalUserIndex);
+	virtual void HandlePresenceLoginStatusChanged(int32 LocalUserNum, ELoginStatus::Type OldStatus, ELoginStatus::Type NewStatus, const FUniqueNetId& NewId);
+	virtual void StopPresencePublishing();
+
 
 private:
+	/** Online interfaces per backend, invalidated when the world or the backend changes */
+	TMap<FName, FEnhancedOnlineInterfaceHandles> OnlineInterfaceTable;
+
+	/** Backend resolved when no backend is named, see SetDefaultOnlineBackend */
+	FName DefaultOnlineBackend;
+
+	/** Interfaces wrapped by the backend trace per backend, shared by every world so listeners stay bound */
+	TMap<FName, FEnhancedOnlineInterfaceHandles> TraceInterfaceTable;
+
+	/** Writes the backend traffic to a trace file, see EnhancedOnline.Trace.RecordFile */
+	TSharedPtr<FEnhancedOnlineTraceWriter> TraceWriter;
+
+	/** Answers backend calls from a trace file, see EnhancedOnline.Trace.ReplayFile */
+	TSharedPtr<FEnhancedOnlineTracePlayer> TracePlayer;
+
+	/** Interfaces wrapped by the fault injection per backend, shared by every world so listeners stay bound */
+	TMap<FName, FEnhancedOnlineInterfaceHandles> FaultInterfaceTable;
+
+	/** Delays and drops answers of the backend, see EnhancedOnline.Faults.Enabled */
+	TSharedPtr<FEnhancedOnlineFaultInjector> FaultInjector;
+
 	/** The URL to travel to after the session is created */
 	FURL PendingTravelURL;
 
@@ -136,19 +566,167 @@ private:
 	UPROPERTY()
 	TObjectPtr<UEnhancedOnlineRequest_LoginUser> PendingLoginRequest;
 
+	/** Login requests that were issued while the auto login was still running */
+	UPROPERTY()
+	TArray<TObjectPtr<UEnhancedOnlineRequest_LoginUser>> DeferredLoginRequests;
+
+	/** Whether the pending login is the auto login started during initialization */
+	bool bAutoLoginPending = false;
+
 	/** The request object for the pending logout */
 	UPROPERTY()
 	TObjectPtr<UEnhancedOnlineRequest_LogoutUser> PendingLogoutRequest;
 
-	/** The request object for the pending join session */
+	/** The request object for the pending start session */
 	UPROPERTY()
 	TObjectPtr<UEnhancedOnlineRequest_StartSession> PendingStartSessionRequest;
 
+	/** The request object for the pending join session */
+	UPROPERTY()
+	TObjectPtr<UEnhancedOnlineRequest_JoinSession> PendingJoinSessionRequest;
+
+	/** The request object for the running matchmaking */
+	UPROPERTY()
+	TObjectPtr<UEnhancedOnlineRequest_Matchmake> PendingMatchmakeRequest;
+
+	/** Sessions of the last matchmaking search, best score first */
+	UPROPERTY()
+	TArray<TObjectPtr<UEnhancedSessionSearchResult>> MatchmakingCandidates;
+
+	/** Index of the next candidate to try joining */
+	int32 MatchmakingCandidateIndex = 0;
+
+	/** How often the matchmaking criteria have been widened */
+	int32 MatchmakingWidenLevel = 0;
+
+	/** Platform time the matchmaking was started at */
+	double MatchmakingStartTime = 0.0;
+
+	/** Timer used to delay the next matchmaking search */
+	FTimerHandle MatchmakingRetryTimerHandle;
+
+
+
+	/** The request object for the running rejoin */
+	UPROPERTY()
+	TObjectPtr<UEnhancedOnlineRequest_RejoinLastSession> PendingRejoinRequest;
+
+	/** The session the running rejoin is trying to get back into */
+	TSharedPtr<FEnhancedOnlineLastSessionRecord> PendingRejoinRecord;
+
+	/** The request object for the running lobby handoff */
+	UPROPERTY()
+	TObjectPtr<UEnhancedOnlineRequest_LobbyHandoff> PendingLobbyHandoffRequest;
+
+	/** Where the lobby is being handed off to */
+	FString LobbyHandoffConnectString;
+
+	/** Whether the lobby host owns the game session and the members follow its travel */
+	bool bLobbyHandoffFollowsHost = false;
+
+	/** Timer used to give the members time to read the handoff before the lobby goes away */
+	FTimerHandle LobbyHandoffTimerHandle;
+
+	/** The local user that hosts or joined the lobby, it is the one that travels on a handoff */
+	int32 LobbyLocalUserIndex = 0;
+
+	/** Listener of the reservation beacon while hosting a game session */
+	UPROPERTY()
+	TObjectPtr<AOnlineBeaconHost> ReservationBeaconHost;
+
+	/** Hands out slots to clients connecting to the reservation beacon */
+	UPROPERTY()
+	TObjectPtr<AEnhancedOnlineReservationBeaconHostObject> ReservationBeaconHostObject;
+
+	/** Slots held for players that have not arrived yet */
+	TArray<FEnhancedSlotReservation> SlotReservations;
+
+	/** Players that arrived with a valid slot, they keep it across server travel until a new session is hosted */
+	TArray<FUniqueNetIdRef> AdmittedSlotPlayers;
+
+	/** The beacon asking the host of the session being joined for a slot */
+	UPROPERTY()
+	TObjectPtr<AEnhancedOnlineReservationBeaconClient> PendingReservationBeacon;
+
+	/** The slot token to travel with once the pending join completes */
+	FString PendingSlotReservationToken;
 
+	/** Round trip times per host, persisted between runs */
+	TSharedPtr<FEnhancedOnlinePingHistory> PingHistory;
+
+	/** Host of the joined game session whose connection latency is being sampled */
+	FString ConnectionPingHostKey;
+
+	/** Local user who joined the session, whose connection is sampled */
+	int32 ConnectionPingLocalUserIndex = 0;
+
+	/** How often the connection latency sampler ran since the join */
+	int32 NumConnectionPingTicks = 0;
+
+	/** Timer used to sample the connection latency after a join */
+	FTimerHandle ConnectionPingTimerHandle;
+
+	/** Hands the published state snapshot to readers on other threads, kept until the subsystem is destroyed */
+	TSharedPtr<FEnhancedOnlineStateSnapshotSlot, ESPMode::ThreadSafe> StateSnapshotSlot;
+
+	/** Sessions of the last search, shared by every snapshot until the next search */
+	TSharedPtr<const TArray<FEnhancedOnlineSnapshotSession>, ESPMode::ThreadSafe> SnapshotSearchSessions;
+
+	/** Version of the last published snapshot */
+	uint64 StateSnapshotVersion = 0;
+
+	/** Timer used to publish all state changes of a frame as a single snapshot */
+	FTimerHandle StateSnapshotTimerHandle;
+
+	/** The per region queries of the current search, if it searches by region */
+	TSharedPtr<FEnhancedRegionSearch> PendingRegionSearch;
+
+	/** Decoded search results that are being wrapped across frames */
+	TSharedPtr<FEnhancedPendingSearchMaterialization> PendingMaterialization;
+
+	/** Search results wrapped so far for the current search */
+	UPROPERTY()
+	TArray<TObjectPtr<UEnhancedSessionSearchResult>> MaterializedSearchResults;
+
+	/** Timer used to continue wrapping search results on the next frame */
+	FTimerHandle MaterializeTimerHandle;
 
 	/** Session settings for the pending session */
 	TSharedPtr<FEnhancedOnlineSessionSettings> SessionSettings;
 
 	/** Settings for the current search */
 	TSharedPtr<FEnhancedOnlineSearchSettings> SearchSettings;
+
+	/** Players that joined since the last registry flush */
+	TArray<FUniqueNetIdRef> PendingPlayerRegistrations;
+
+	/** Players that left since the last registry flush */
+	TArray<FUniqueNetIdRef> PendingPlayerUnregistrations;
+
+	/** Timer used to batch player registrations */
+	FTimerHandle PlayerRegistryFlushTimerHandle;
+
+	/** Failed registry calls per player since its last success, players are given up on past the retry limit */
+	TArray<TPair<FUniqueNetIdRef, int32>> PlayerRegistryFailures;
+
+	/** Name of the dedicated session being advertised, none if not hosting one */
+	FName DedicatedSessionName;
+
+	/** The advertisement the backend last accepted */
+	FEnhancedDedicatedSessionAdvertisement AdvertisedDedicatedState;
+
+	/** The advertisement currently being written */
+	FEnhancedDedicatedSessionAdvertisement InFlightDedicatedState;
+
+	/** Forces the next heartbeat to update the session even if nothing tracked changed */
+	bool bDedicatedSessionDirty = false;
+
+	/** Whether an UpdateSession call is in flight */
+	bool bDedicatedUpdateInFlight = false;
+
+	/** Timer driving the dedicated session heartbeat */
+	FTimerHandle DedicatedHeartbeatTimerHandle;
+
+	/** Rich presence per local user, every user is published and rate limited on its own */
+	TMap<int32, FEnhancedPresencePublishState> PresenceStates;
 };
@@ -0,0 +1,76 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OnlineSubsystemTypes.h"
+
+/**
+ * A session of the last search, as seen by snapshot readers
+ */
+struct FEnhancedOnlineSnapshotSession
+{
+	FString SessionId;
+	FString OwningUserId;
+	FString FriendlyName;
+	int32 PingInMs = 0;
+	float PingConfidence = 0.0f;
+	int32 MaxPlayers = 0;
+	int32 CurrentPlayers = 0;
+};
+
+/**
+ * Login state of a local user, as seen by snapshot readers
+ */
+struct FEnhancedOnlineSnapshotUser
+{
+	int32 LocalUserNum = 0;
+	FString UserId;
+	ELoginStatus::Type LoginStatus = ELoginStatus::NotLoggedIn;
+};
+
+/**
+ * The game session hosted by this instance, as seen by snapshot readers
+ */
+struct FEnhancedOnlineSnapshotHostedSession
+{
+	FString SessionId;
+	EOnlineSessionState::Type State = EOnlineSessionState::NoSession;
+	int32 MaxPlayers = 0;
+	int32 NumOpenSlots = 0;
+	int32 NumRegisteredPlayers = 0;
+	int32 NumSlotReservations = 0;
+	bool bIsDedicated = false;
+};
+
+/**
+ * Immutable copy of the subsystem state, published by the game thread and readable from any thread
+ * A snapshot never changes after it was published, state changes publish a new one
+ */
+struct FEnhancedOnlineStateSnapshot
+{
+	/** Increases with every published snapshot */
+	uint64 Version = 0;
+
+	/** Platform time the snapshot was published at */
+	double PublishedAt = 0.0;
+
+	/** Login state of every local player */
+	TArray<FEnhancedOnlineSnapshotUser> Users;
+
+	/** Sessions of the last completed search, shared with later snapshots until the next search */
+	TSharedPtr<const TArray<FEnhancedOnlineSnapshotSession>, ESPMode::ThreadSafe> SearchResults;
+
+	/** The hosted game session, unset if this instance doesn't host one */
+	TOptional<FEnhancedOnlineSnapshotHostedSession> HostedSession;
+
+	/** Whether matchmaking is running */
+	bool bIsMatchmaking = false;
+
+	int32 GetNumSearchResults() const
+	{
+		return SearchResults.IsValid() ? SearchResults->Num() : 0;
+	}
+};
+
+using FEnhancedOnlineStateSnapshotPtr = TSharedPtr<const FEnhancedOnlineStateSnapshot, ESPMode::ThreadSafe>;
@@ -10,6 +10,14 @@
 #define MaxNumConnectionsLobby 64
 
 #define SETTING_FRIENDLYNAME FName(TEXT("FRIENDLYNAME"))
+#define SETTING_NUMPLAYERS FName(TEXT("NUMPLAYERS"))
+#define SETTING_MATCHSTATE FName(TEXT("MATCHSTATE"))
+#define SETTING_REGION FName(TEXT("REGION"))
+
+#define SETTING_LOBBY FName(TEXT("ENHANCEDLOBBY"))
+#define SETTING_HANDOFF_CONNECT FName(TEXT("HANDOFFCONNECT"))
+#define SETTING_HANDOFF_SESSIONID FName(TEXT("HANDOFFSESSIONID"))
+#define SETTING_HANDOFF_FOLLOWHOST FName(TEXT("HANDOFFFOLLOWHOST"))
 
 /**
  * Specifies the online mode of a game session
@@ -51,6 +59,100 @@ enum class EBlueprintEnhancedPresenceState : uint8
 	Chat,
 };
 
+/**
+ * Specifies how a matchmaking request ended up in a session
+ */
+UENUM(BlueprintType)
+enum class EEnhancedMatchmakingResult : uint8
+{
+	/** Joined one of the sessions that were found */
+	Joined,
+
+	/** Nothing fit within the time budget, hosted a new session instead */
+	Hosted,
+
+	/** Matchmaking was cancelled before it ended up in a session */
+	Cancelled,
+};
+
+/**
+ * Specifies how a session list is sorted
+ */
+UENUM(BlueprintType)
+enum class EEnhancedSessionSortMode : uint8
+{
+	/** Keep the order of the backend */
+	None,
+	Ping,
+	OpenSlots,
+	FriendlyName,
+};
+
+/**
+ * Specifies how a session setting is compared against the value of a search query filter
+ */
+UENUM(BlueprintType)
+enum class EEnhancedSessionQueryComparison : uint8
+{
+	Equals,
+	NotEquals,
+	GreaterThan,
+	GreaterThanEquals,
+	LessThan,
+	LessThanEquals,
+};
+
+/**
+ * Specifies which value of a search query filter is used
+ */
+UENUM(BlueprintType)
+enum class EEnhancedSessionQueryValueType : uint8
+{
+	Int,
+	String,
+	Bool,
+};
+
+/**
+ * A single criterion of a session search, pushed into the query so the backend filters before sending results
+ */
+USTRUCT(BlueprintType)
+struct ENHANCEDONLINESUBSYSTEM_API FEnhancedSessionQueryFilter
+{
+	GENERATED_BODY()
+
+public:
+	/** The session setting to compare, e.g. SETTING_MAPNAME */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Session Query")
+	FName Key;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Session Query")
+	EEnhancedSessionQueryComparison Comparison = EEnhancedSessionQueryComparison::Equals;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Session Query")
+	EEnhancedSessionQueryValueType ValueType = EEnhancedSessionQueryValueType::Int;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Session Query", meta = (EditCondition = "ValueType == EEnhancedSessionQueryValueType::Int", EditConditionHides))
+	int32 IntValue = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Session Query", meta = (EditCondition = "ValueType == EEnhancedSessionQueryValueType::String", EditConditionHides))
+	FString StringValue;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Session Query", meta = (EditCondition = "ValueType == EEnhancedSessionQueryValueType::Bool", EditConditionHides))
+	bool bBoolValue = false;
+
+public:
+	static FEnhancedSessionQueryFilter MakeInt(FName InKey, EEnhancedSessionQueryComparison InComparison, int32 InValue);
+	static FEnhancedSessionQueryFilter MakeString(FName InKey, EEnhancedSessionQueryComparison InComparison, const FString& InValue);
+	static FEnhancedSessionQueryFilter MakeBool(FName InKey, bool bInValue);
+
+	/** Writes the filter into the query settings of a search */
+	void ApplyTo(FOnlineSearchSettings& QuerySettings) const;
+
+	/** Evaluates the filter on a search result, for filters the backend could not take */
+	bool Matches(const FOnlineSessionSearchResult& SearchResult) const;
+};
+
 /**
  * Helper class for the online session settings
  */
@@ -0,0 +1,130 @@
+// Copyright © 2024 MajorT. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EnhancedOnlineTypes.h"
+#include "OnlineSessionSettings.h"
+#include "UObject/Object.h"
+#include "EnhancedSessionListDataProvider.generated.h"
+
+class UEnhancedSessionSearchResult;
+
+/**
+ * Delegate for when the items of a session list changed, e.g. after a new search or a different sort order
+ */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnEnhancedSessionListChanged);
+
+/**
+ * Virtualized view over the results of a session search.
+ * The raw results are moved into the list and only wrapped into search result objects once they are fetched,
+ * sorting and filtering reorder indices instead of copying results.
+ * The list doesn't hold on to the search itself, which keeps its request alive for the garbage collector.
+ */
+UCLASS(BlueprintType)
+class ENHANCEDONLINESUBSYSTEM_API UEnhancedSessionListDataProvider : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/** Replaces the results of the list, last known sessions that are still around are refreshed in place */
+	void SetSearchResults(TArray<FOnlineSessionSearchResult>&& InSearchResults);
+
+	/** Returns a raw search result by its index in the sorted and filtered list */
+	const FOnlineSessionSearchResult* GetSearchResult(int32 Index) const;
+
+	/**
+	 * Fills the list with the sessions of the last search that was persisted, marked as stale.
+	 * They are replaced in place once the next search completes.
+	 * @return True if a snapshot was found
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|SessionList")
+	bool ShowLastKnownSessions();
+
+	/** Whether the list currently shows the last known sessions instead of live ones */
+	UFUNCTION(BlueprintPure, Category = "Online|EnhancedSessions|SessionList")
+	bool IsShowingLastKnownSessions() const { return bShowingLastKnownSessions; }
+
+	/** Empties the list */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|SessionList")
+	void Reset();
+
+	/** Returns the number of items after filtering */
+	UFUNCTION(BlueprintPure, Category = "Online|EnhancedSessions|SessionList")
+	int32 GetNumItems() const { return View.Num(); }
+
+	/** Returns the number of search results before filtering */
+	UFUNCTION(BlueprintPure, Category = "Online|EnhancedSessions|SessionList")
+	int32 GetNumSearchResults() const;
+
+	/**
+	 * Returns the items of the visible range, only these are materialized.
+	 * Items far outside of the range are released again.
+	 * @param FirstIndex	Index of the first visible item
+	 * @param Count			Number of visible items
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|SessionList")
+	TArray<UEnhancedSessionSearchResult*> GetItemsInRange(int32 FirstIndex, int32 Count);
+
+	/** Returns a single item, materializing it if needed */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|SessionList")
+	UEnhancedSessionSearchResult* GetItem(int32 Index);
+
+	/**
+	 * Changes the sort order of the list
+	 * @param InSortMode	The setting to sort by
+	 * @param bInDescending	Whether the largest value comes first
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|SessionList")
+	void SetSortMode(EEnhancedSessionSortMode InSortMode, bool bInDescending);
+
+	/**
+	 * Changes which search results are part of the list
+	 * @param InNameFilter			Only keep sessions whose friendly name contains this, empty to keep all
+	 * @param bInHideFullSessions	Whether sessions without open slots are hidden
+	 * @param InMaxPingInMs			Hides sessions above this ping, 0 to keep all
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Online|EnhancedSessions|SessionList")
+	void SetFilter(const FString& InNameFilter, bool bInHideFullSessions, int32 InMaxPingInMs);
+
+	/** Called whenever the items of the list changed */
+	UPROPERTY(BlueprintAssignable, Category = "Online|EnhancedSessions|SessionList")
+	FOnEnhancedSessionListChanged OnListChanged;
+
+protected:
+	/** Sorts and filters the indices of the search results */
+	virtual void RebuildView();
+	virtual bool PassesFilter(const FOnlineSessionSearchResult& SearchResult) const;
+
+	UEnhancedSessionSearchResult* MaterializeItem(int32 SearchResultIndex);
+
+	/** Moves sessions that were already listed to their previous position and refreshes their items */
+	void MergeIntoLastKnownSessions(TArray<FOnlineSessionSearchResult>& FreshResults);
+
+	/** Releases materialized items that are far away from the given range */
+	void ReleaseItemsOutsideOf(int32 FirstIndex, int32 Count);
+
+private:
+	/** Raw results of the last search */
+	TArray<FOnlineSessionSearchResult> SearchResults;
+
+	/** Session ids of the last known sessions, parallel to the search results */
+	TArray<FString> LastKnownSessionIds;
+
+	/** Whether the search results come from the persisted snapshot */
+	bool bShowingLastKnownSessions = false;
+
+	/** Indices into the search results, sorted and filtered */
+	TArray<int32> View;
+
+	/** Materialized items by their search result index */
+	UPROPERTY()
+	TMap<int32, TObjectPtr<UEnhancedSessionSearchResult>> MaterializedItems;
+
+	EEnhancedSessionSortMode SortMode = EEnhancedSessionSortMode::None;
+	bool bSortDescending = false;
+
+	FString NameFilter;
+	bool bHideFullSessions = false;
+	int32 MaxPingInMs = 0;
+};
@@ -16,6 +16,10 @@ class UEnhancedOnlineRequest_CreateLobby;
 class UEnhancedOnlineRequestBase;
 enum class EEnhancedSessionOnlineMode : uint8;
 class UEnhancedOnlineRequest_CreateSession;
+class UEnhancedOnlineRequest_Matchmake;
+class UEnhancedOnlineRequest_LobbyHandoff;
+class UEnhancedOnlineRequest_RejoinLastSession;
+enum class EEnhancedMatchmakingResult : uint8;
 
 /**
  * Delegate for when a request fails
@@ -42,6 +46,32 @@ DECLARE_DYNAMIC_DELEGATE_OneParam(FBPOnStartSessionRequestSucceeded, const FName
  */
 DECLARE_DYNAMIC_DELEGATE_OneParam(FBPOnFindSessionsSuceeeded, const TArray<UEnhancedSessionSearchResult*>&, SearchResults);
 
+/**
+ * Delegate for every frame of search results that was published
+ * @param NewResults	The search results published this frame
+ * @param NumCompleted	The number of search results published so far
+ * @param NumTotal		The number of search results that will be published
+ */
+DECLARE_DYNAMIC_DELEGATE_ThreeParams(FBPOnFindSessionsProgress, const TArray<UEnhancedSessionSearchResult*>&, NewResults, int32, NumCompleted, int32, NumTotal);
+
+/**
+ * Delegate for when a matchmaking request succeeds
+ * @param Result	Whether a session was joined or hosted
+ */
+DECLARE_DYNAMIC_DELEGATE_OneParam(FBPOnMatchmakingSucceeded, EEnhancedMatchmakingResult, Result);
+
+/**
+ * Delegate for when a lobby handoff request succeeds
+ * @param ConnectString	The address the lobby members were sent to
+ */
+DECLARE_DYNAMIC_DELEGATE_OneParam(FBPOnLobbyHandoffSucceeded, const FString&, ConnectString);
+
+/**
+ * Delegate for when a rejoin request succeeds
+ * @param bUsedSearchFallback	Whether the session had to be searched for
+ */
+DECLARE_DYNAMIC_DELEGATE_OneParam(FBPOnRejoinSessionSucceeded, bool, bUsedSearchFallback);
+
 /**
  * Library of functions for interacting with the Enhanced Online Subsystem
  */
@@ -62,6 +92,14 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Online|EnhancedSessions|Sessions")
 	static int32 GetPingInMs(UEnhancedSessionSearchResult* SearchResult);
 
+	/**
+	 * Gets how much the ping of a search result can be trusted
+	 * @param SearchResult	The search result to get the ping confidence of
+	 * @return Between 0 and 1, 0 if the ping is the raw ping reported by the backend
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Online|EnhancedSessions|Sessions")
+	static float GetPingConfidence(UEnhancedSessionSearchResult* SearchResult);
+
 	/**
 	 * Gets the number of players in a search result
 	 * @param SearchResult	The search result to get the number of players of
@@ -86,6 +124,14 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Online|EnhancedSessions|Sessions")
 	static FString GetSessionFriendlyName(UEnhancedSessionSearchResult* SearchResult);
 
+	/**
+	 * Whether a search result comes from the last known server list and can't be joined yet
+	 * @param SearchResult	The search result to check
+	 * @return True if the session is stale
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Online|EnhancedSessions|Sessions")
+	static bool IsSessionStale(UEnhancedSessionSearchResult* SearchResult);
+
 public:
 	/**
 	 * Constructs a request to create an online session
@@ -174,11 +220,12 @@ public:
 	 * @param bInvalidateOnCompletion	Whether to invalidate the request when it's completed
 	 * @param OnSucceededDelegate	Delegate to call when the request succeeds
 	 * @param OnFailedDelegate		Delegate to call when the request fails
+	 * @param OnProgressDelegate	Delegate to call for every frame of results while a large search is published, so a list can fill in early
 	 * @return The request object
 	 */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Online|EnhancedSessions|Sessions", meta =
 		(WorldContext = "WorldContextObject", Keywords = "Make, Create, New", DisplayName = "Construct Online Find Sessions Request",
-			AdvancedDisplay = "LocalUserIndex, bInvalidateOnCompletion", LocalUserIndex = "0", bFindLobbies = "true", bInvalidateOnCompletion = "false"))
+			AdvancedDisplay = "LocalUserIndex, bInvalidateOnCompletion, OnProgressDelegate", LocalUserIndex = "0", bFindLobbies = "true", bInvalidateOnCompletion = "false", AutoCreateRefTerm = "OnProgressDelegate"))
 	static UPARAM(DisplayName = "Request") UEnhancedOnlineRequest_FindSessions* ConstructOnlineFindSessionsRequest(
 		UObject* WorldContextObject,
 		const EEnhancedSessionOnlineMode OnlineMode,
@@ -188,7 +235,8 @@ public:
 		const int32 LocalUserIndex,
 		const bool bInvalidateOnCompletion,
 		FBPOnFindSessionsSuceeeded OnSucceededDelegate,
-		FBPOnRequestFailedWithLog OnFailedDelegate);
+		FBPOnRequestFailedWithLog OnFailedDelegate,
+		const FBPOnFindSessionsProgress& OnProgressDelegate);
 
 	/**
 	 * Constructs a request to join an online session
@@ -209,6 +257,83 @@ public:
 		const bool bInvalidateOnCompletion,
 		FBPOnRequestFailedWithLog OnFailedDelegate);
 
+	/**
+	 * Constructs a request to join the game session the local user was in last
+	 * @param WorldContextObject		The world context object, IF YOU SEE THIS IN BLUEPRINTS, YOU ARE DOING SOMETHING WRONG >:(
+	 * @param bAllowSearchFallback		Whether to search for the session if it can't be looked up directly
+	 * @param LocalUserIndex			The index of the local user who made the request
+	 * @param bInvalidateOnCompletion	Whether to invalidate the request when it's completed
+	 * @param OnSucceededDelegate		Delegate to call when the request succeeds
+	 * @param OnFailedDelegate			Delegate to call when the request fails
+	 * @return The request object
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Online|EnhancedSessions|Sessions", meta =
+		(WorldContext = "WorldContextObject", Keywords = "Make, Create, New, Reconnect", DisplayName = "Construct Online Rejoin Last Session Request",
+			AdvancedDisplay = "LocalUserIndex, bInvalidateOnCompletion", LocalUserIndex = "0", bAllowSearchFallback = "true", bInvalidateOnCompletion = "true"))
+	static UPARAM(DisplayName = "Request") UEnhancedOnlineRequest_RejoinLastSession* ConstructOnlineRejoinLastSessionRequest(
+		UObject* WorldContextObject,
+		const bool bAllowSearchFallback,
+		const int32 LocalUserIndex,
+		const bool bInvalidateOnCompletion,
+		FBPOnRejoinSessionSucceeded OnSucceededDelegate,
+		FBPOnRequestFailedWithLog OnFailedDelegate);
+
+	/**
+	 * Constructs a request to find the best fitting session and join it, or host one if nothing fits
+	 * @param WorldContextObject			The world context object, IF YOU SEE THIS IN BLUEPRINTS, YOU ARE DOING SOMETHING WRONG >:(
+	 * @param OnlineMode					The online mode of the session
+	 * @param bFindLobbies					Whether to find lobbies
+	 * @param SearchKeyword					The preferred search keyword
+	 * @param GameModeAdvertisementName		The preferred game mode
+	 * @param MaxPingInMs					Sessions above this ping are rejected until the criteria are widened
+	 * @param TimeBudgetSeconds				Time after which the fallback template is hosted
+	 * @param HostFallbackTemplate			The session to host if nothing fits, can be left empty
+	 * @param LocalUserIndex				The index of the local user who made the request
+	 * @param bInvalidateOnCompletion		Whether to invalidate the request when it's completed
+	 * @param OnSucceededDelegate			Delegate to call when the request succeeds
+	 * @param OnFailedDelegate				Delegate to call when the request fails
+	 * @return The request object
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Online|EnhancedSessions|Matchmaking", meta =
+		(WorldContext = "WorldContextObject", Keywords = "Make, Create, New", DisplayName = "Construct Online Matchmake Request",
+			AdvancedDisplay = "LocalUserIndex, bInvalidateOnCompletion", LocalUserIndex = "0", bFindLobbies = "true", MaxPingInMs = "150", TimeBudgetSeconds = "30", bInvalidateOnCompletion = "true"))
+	static UPARAM(DisplayName = "Request") UEnhancedOnlineRequest_Matchmake* ConstructOnlineMatchmakeRequest(
+		UObject* WorldContextObject,
+		const EEnhancedSessionOnlineMode OnlineMode,
+		const bool bFindLobbies,
+		const FString SearchKeyword,
+		const FString GameModeAdvertisementName,
+		const int32 MaxPingInMs,
+		const float TimeBudgetSeconds,
+		UEnhancedOnlineRequest_CreateSession* HostFallbackTemplate,
+		const int32 LocalUserIndex,
+		const bool bInvalidateOnCompletion,
+		FBPOnMatchmakingSucceeded OnSucceededDelegate,
+		FBPOnRequestFailedWithLog OnFailedDelegate);
+
+	/**
+	 * Constructs a request to move the hosted lobby into a game session
+	 * @param WorldContextObject		The world context object, IF YOU SEE THIS IN BLUEPRINTS, YOU ARE DOING SOMETHING WRONG >:(
+	 * @param GameSessionTemplate		The game session the lobby host creates, used if there is no session to claim
+	 * @param GameSessionToClaim		An existing game session the whole lobby travels to
+	 * @param LocalUserIndex			The index of the local user who made the request
+	 * @param bInvalidateOnCompletion	Whether to invalidate the request when it's completed
+	 * @param OnSucceededDelegate		Delegate to call when the request succeeds
+	 * @param OnFailedDelegate			Delegate to call when the request fails
+	 * @return The request object
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Online|EnhancedSessions|Lobby", meta =
+		(WorldContext = "WorldContextObject", Keywords = "Make, Create, New", DisplayName = "Construct Online Lobby Handoff Request",
+			AdvancedDisplay = "LocalUserIndex, bInvalidateOnCompletion", LocalUserIndex = "0", bInvalidateOnCompletion = "true"))
+	static UPARAM(DisplayName = "Request") UEnhancedOnlineRequest_LobbyHandoff* ConstructOnlineLobbyHandoffRequest(
+		UObject* WorldContextObject,
+		UEnhancedOnlineRequest_CreateSession* GameSessionTemplate,
+		UEnhancedSessionSearchResult* GameSessionToClaim,
+		const int32 LocalUserIndex,
+		const bool bInvalidateOnCompletion,
+		FBPOnLobbyHandoffSucceeded OnSucceededDelegate,
+		FBPOnRequestFailedWithLog OnFailedDelegate);
+
 	/**
 	 * Constructs a request to start an online session
 	 * @param WorldContextObject	The world context object, IF YOU SEE THIS IN BLUEPRINTS, YOU ARE DOING SOMETHING WRONG >:(
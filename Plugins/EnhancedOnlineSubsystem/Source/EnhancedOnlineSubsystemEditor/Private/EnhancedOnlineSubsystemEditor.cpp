@@ -18,6 +18,11 @@ void FEnhancedOnlineSubsystemEditorModule::StartupModule()
 
 void FEnhancedOnlineSubsystemEditorModule::ShutdownModule()
 {
+	if (UObjectInitialized())
+	{
+		GetMutableDefault<UEnhancedOnlineSubsystemSettings>()->FlushPendingConfigEdits();
+	}
+
 	if (ISettingsModule* SettingsModule = FModuleManager::GetModulePtr<ISettingsModule>("Settings"))
 	{
 		SettingsModule->UnregisterSettings("Project", "Plugins", "EnhancedOnlineSubsystemSettings");
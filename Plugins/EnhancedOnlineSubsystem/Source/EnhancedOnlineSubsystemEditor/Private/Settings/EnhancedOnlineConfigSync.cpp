@@ -0,0 +1,191 @@
+// Copyright © 2024 Botanibots Team. All rights reserved.
+
+#include "EnhancedOnlineConfigSync.h"
+
+#include "Misc/ConfigCacheIni.h"
+
+FEnhancedOnlineConfigSync::FEnhancedOnlineConfigSync(const FString& InIniFilename, float InDebounceDelay)
+	: IniFilename(InIniFilename)
+	, DebounceDelay(InDebounceDelay)
+{
+}
+
+FEnhancedOnlineConfigSync::~FEnhancedOnlineConfigSync()
+{
+	if (FlushTickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(FlushTickerHandle);
+		FlushTickerHandle.Reset();
+	}
+
+	// Don't lose edits that were made right before shutting down
+	Flush();
+}
+
+FString FEnhancedOnlineConfigSync::NormalizeKey(const FString& Key)
+{
+	if (Key.Len() > 1 && (Key[0] == TEXT('+') || Key[0] == TEXT('-') || Key[0] == TEXT('.') || Key[0] == TEXT('!')))
+	{
+		return Key.RightChop(1);
+	}
+	return Key;
+}
+
+const TMap<FString, FString>* FEnhancedOnlineConfigSync::FindLoadedSection(const FString& Section) const
+{
+	if (const TMap<FString, FString>* Loaded = LoadedValues.Find(Section))
+	{
+		return Loaded;
+	}
+
+	TMap<FString, FString>& Loaded = LoadedValues.Add(Section);
+
+	if (GConfig)
+	{
+		if (const FConfigSection* ConfigSection = GConfig->GetSection(*Section, false, IniFilename))
+		{
+			for (const auto& Pair : *ConfigSection)
+			{
+				Loaded.Add(Pair.Key.ToString(), Pair.Value.GetValue());
+			}
+		}
+	}
+
+	return &Loaded;
+}
+
+bool FEnhancedOnlineConfigSync::GetValue(const FString& Section, const FString& Key, FString& OutValue) const
+{
+	const FConfigKey ConfigKey{ Section, Key };
+
+	if (PendingRemovals.Contains(ConfigKey))
+	{
+		return false;
+	}
+
+	if (const FString* PendingValue = PendingSets.Find(ConfigKey))
+	{
+		OutValue = *PendingValue;
+		return true;
+	}
+
+	if (const FString* LoadedValue = FindLoadedSection(Section)->Find(NormalizeKey(Key)))
+	{
+		OutValue = *LoadedValue;
+		return true;
+	}
+
+	return false;
+}
+
+int32 FEnhancedOnlineConfigSync::SetDesired(const FConfigValues& ValuesToSet, const FConfigValues& ValuesToRemove)
+{
+	int32 NumChanges = 0;
+
+	for (const auto& Section : ValuesToSet)
+	{
+		for (const auto& Pair : Section.Value)
+		{
+			FString CurrentValue;
+			if (GetValue(Section.Key, Pair.Key, CurrentValue) && CurrentValue.Equals(Pair.Value, ESearchCase::CaseSensitive))
+			{
+				continue;
+			}
+
+			const FConfigKey ConfigKey{ Section.Key, Pair.Key };
+			PendingRemovals.Remove(ConfigKey);
+			PendingSets.Add(ConfigKey, Pair.Value);
+			++NumChanges;
+		}
+	}
+
+	for (const auto& Section : ValuesToRemove)
+	{
+		const TMap<FString, FString>* DesiredSection = ValuesToSet.Find(Section.Key);
+
+		for (const auto& Pair : Section.Value)
+		{
+			// Keys shared between backends (e.g. DefaultPlatformService) stay
+			if (DesiredSection && DesiredSection->Contains(Pair.Key))
+			{
+				continue;
+			}
+
+			FString CurrentValue;
+			if (!GetValue(Section.Key, Pair.Key, CurrentValue))
+			{
+				continue;
+			}
+
+			const FConfigKey ConfigKey{ Section.Key, Pair.Key };
+			PendingSets.Remove(ConfigKey);
+			PendingRemovals.Add(ConfigKey);
+			++NumChanges;
+		}
+	}
+
+	if (NumChanges > 0)
+	{
+		ScheduleFlush();
+	}
+
+	return NumChanges;
+}
+
+void FEnhancedOnlineConfigSync::ScheduleFlush()
+{
+	if (FlushTickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(FlushTickerHandle);
+	}
+
+	FlushTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateSP(this, &FEnhancedOnlineConfigSync::HandleFlushTicker), DebounceDelay);
+}
+
+bool FEnhancedOnlineConfigSync::HandleFlushTicker(float DeltaTime)
+{
+	FlushTickerHandle.Reset();
+	Flush();
+
+	return false;
+}
+
+bool FEnhancedOnlineConfigSync::Flush()
+{
+	if (!HasPendingEdits() || !GConfig)
+	{
+		return false;
+	}
+
+	if (FlushTickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(FlushTickerHandle);
+		FlushTickerHandle.Reset();
+	}
+
+	for (const FConfigKey& ConfigKey : PendingRemovals)
+	{
+		GConfig->RemoveKey(*ConfigKey.Section, *ConfigKey.Key, IniFilename);
+
+		FindLoadedSection(ConfigKey.Section);
+		LoadedValues.FindChecked(ConfigKey.Section).Remove(NormalizeKey(ConfigKey.Key));
+	}
+
+	for (const auto& Pair : PendingSets)
+	{
+		GConfig->SetString(*Pair.Key.Section, *Pair.Key.Key, *Pair.Value, IniFilename);
+
+		FindLoadedSection(Pair.Key.Section);
+		LoadedValues.FindChecked(Pair.Key.Section).Add(NormalizeKey(Pair.Key.Key), Pair.Value);
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Writing %d changed and %d removed keys to: %s"), PendingSets.Num(), PendingRemovals.Num(), *IniFilename);
+
+	PendingSets.Reset();
+	PendingRemovals.Reset();
+
+	GConfig->Flush(false, IniFilename);
+
+	OnConfigWritten.Broadcast();
+	return true;
+}
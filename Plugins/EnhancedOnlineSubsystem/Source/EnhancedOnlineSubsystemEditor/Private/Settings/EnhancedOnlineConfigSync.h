@@ -0,0 +1,71 @@
+// Copyright © 2024 Botanibots Team. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+
+/**
+ * Keeps a single ini file in sync with a desired set of values.
+ * Only keys whose value actually differs from what is currently loaded are written,
+ * edits are batched and the file is flushed once after the debounce delay has passed without new edits.
+ */
+class FEnhancedOnlineConfigSync : public TSharedFromThis<FEnhancedOnlineConfigSync>
+{
+public:
+	/** Section -> Key -> Value */
+	typedef TMap<FString, TMap<FString, FString>> FConfigValues;
+
+	FEnhancedOnlineConfigSync(const FString& InIniFilename, float InDebounceDelay = 0.5f);
+	~FEnhancedOnlineConfigSync();
+
+	/** Returns the value that is currently in the ini, including edits that are still pending */
+	bool GetValue(const FString& Section, const FString& Key, FString& OutValue) const;
+
+	/**
+	 * Queues the difference between the desired values and the ini.
+	 * @param ValuesToSet		Values that should be present in the ini
+	 * @param ValuesToRemove	Keys that should not be present, unless they are also in ValuesToSet
+	 * @return The number of keys that will change
+	 */
+	int32 SetDesired(const FConfigValues& ValuesToSet, const FConfigValues& ValuesToRemove);
+
+	/** Writes all pending edits right away, returns true if the ini file changed */
+	bool Flush();
+
+	/** Whether there are edits that haven't been written yet */
+	bool HasPendingEdits() const { return PendingSets.Num() > 0 || PendingRemovals.Num() > 0; }
+
+	/** Called after pending edits were written to disk */
+	FSimpleMulticastDelegate OnConfigWritten;
+
+private:
+	struct FConfigKey
+	{
+		FString Section;
+		FString Key;
+
+		bool operator==(const FConfigKey& Other) const { return Section == Other.Section && Key == Other.Key; }
+		friend uint32 GetTypeHash(const FConfigKey& InKey) { return HashCombine(GetTypeHash(InKey.Section), GetTypeHash(InKey.Key)); }
+	};
+
+	/** Array keys are written with their operator (e.g. +NetDriverDefinitions) but loaded without it */
+	static FString NormalizeKey(const FString& Key);
+
+	/** Reads every section once into the snapshot */
+	const TMap<FString, FString>* FindLoadedSection(const FString& Section) const;
+
+	void ScheduleFlush();
+	bool HandleFlushTicker(float DeltaTime);
+
+	FString IniFilename;
+	float DebounceDelay;
+
+	/** Section -> normalized key -> value, as currently present in the ini */
+	mutable TMap<FString, TMap<FString, FString>> LoadedValues;
+
+	TMap<FConfigKey, FString> PendingSets;
+	TSet<FConfigKey> PendingRemovals;
+
+	FTSTicker::FDelegateHandle FlushTickerHandle;
+};
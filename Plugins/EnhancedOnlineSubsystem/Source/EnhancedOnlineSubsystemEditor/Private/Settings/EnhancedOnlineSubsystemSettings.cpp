@@ -3,9 +3,12 @@
 
 #include "Settings/EnhancedOnlineSubsystemSettings.h"
 
+#include "EnhancedOnlineConfigSync.h"
 #include "ISettingsEditorModule.h"
 #include "Misc/ConfigCacheIni.h"
 
+#define SETTINGS_SECTION TEXT("/Script/EnhancedOnlineSubsystemEditor.EnhancedOnlineSubsystemSettings")
+
 UEnhancedOnlineSubsystemSettings::UEnhancedOnlineSubsystemSettings(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
@@ -26,10 +29,13 @@ UEnhancedOnlineSubsystemSettings::UEnhancedOnlineSubsystemSettings(const FObject
 	bIsUsingP2PSockets = false;
 	NetDriverEOSSettings = GetNetDriverDefinition(ESupportedSubsystem::EOS);
 
+	ConfigSync = MakeShared<FEnhancedOnlineConfigSync>(GetDefaultEngineIni());
+	ConfigSync->OnConfigWritten.AddUObject(this, &ThisClass::HandleConfigWritten);
+
 	/** Platform specific settings Steam */
 	UpdateSubsystemSettings();
 
-	// Load the settings from the config file if they exist
+	// Load the settings from the config file if they exist, every section is only read once
 	for (auto& SubsystemSetting : SubsystemSettings)
 	{
 		for (auto& Setting : SubsystemSetting.Value)
@@ -37,14 +43,10 @@ UEnhancedOnlineSubsystemSettings::UEnhancedOnlineSubsystemSettings(const FObject
 			for (auto& Pair : Setting.Value)
 			{
 				FString Value;
-				if (GConfig->GetString(
-					*Setting.Key,
-					*Pair.Key,
-					Value,
-					FConfigCacheIni::NormalizeConfigIniPath(FPaths::SourceConfigDir() / TEXT("DefaultEngine.ini"))))
+				if (ConfigSync->GetValue(Setting.Key, Pair.Key, Value))
 				{
 					Pair.Value = Value;
-					UE_LOG(LogTemp, Log, TEXT("Found Key: %s, Value: %s"), *Pair.Key, *Pair.Value);
+					UE_LOG(LogTemp, Verbose, TEXT("Found Key: %s, Value: %s"), *Pair.Key, *Pair.Value);
 				}
 			}
 		}
@@ -120,19 +122,14 @@ void UEnhancedOnlineSubsystemSettings::LoadSubsystemSettings()
 
 	bIsUsingP2PSockets = SubsystemSettings[ESupportedSubsystem::EOS][TEXT("/Script/SocketSubsystemEOS.NetDriverEOSBase")][TEXT("bIsUsingP2PSockets")].Equals(TEXT("True"));
 
-	// Load the Supported Subsystem from the EnhancedOnlineSubsystemSettings using GConfig
-	FString DefaultEngineIni = FPaths::SourceConfigDir() / TEXT("DefaultEngine.ini");
-	DefaultEngineIni = FConfigCacheIni::NormalizeConfigIniPath(DefaultEngineIni);
-
+	// Load the Supported Subsystem from the EnhancedOnlineSubsystemSettings section
 	FString DefaultPlatformService;
-	GConfig->GetString(
-		TEXT("/Script/EnhancedOnlineSubsystemEditor.EnhancedOnlineSubsystemSettings"),
-		TEXT("SupportedSubsystem"),
-		DefaultPlatformService,
-		DefaultEngineIni);
-
-	// Set the SupportedSubsystem to the value from the config file
-	SupportedSubsystem = static_cast<ESupportedSubsystem>(FCString::Atoi(*DefaultPlatformService));
+	if (ConfigSync.IsValid() && ConfigSync->GetValue(SETTINGS_SECTION, TEXT("SupportedSubsystem"), DefaultPlatformService))
+	{
+		// Saved by name, older versions stored the raw value
+		const int64 EnumValue = StaticEnum<ESupportedSubsystem>()->GetValueByNameString(DefaultPlatformService);
+		SupportedSubsystem = static_cast<ESupportedSubsystem>(EnumValue != INDEX_NONE ? EnumValue : FCString::Atoi(*DefaultPlatformService));
+	}
 }
 
 
@@ -140,67 +137,52 @@ void UEnhancedOnlineSubsystemSettings::PostEditChangeProperty(FPropertyChangedEv
 {
 	UObject::PostEditChangeProperty(PropertyChangedEvent);
 
-	if (!GConfig)
+	if (!GConfig || !ConfigSync.IsValid())
 	{
 		return;
 	}
 
 	if (PropertyChangedEvent.Property)
 	{
-		UEnhancedOnlineSubsystemSettings* Settings = GetMutableDefault<UEnhancedOnlineSubsystemSettings>();
-		FString DefaultEngineIni = FPaths::SourceConfigDir() / TEXT("DefaultEngine.ini");
-		DefaultEngineIni = FConfigCacheIni::NormalizeConfigIniPath(DefaultEngineIni);
-
 		UpdateSubsystemSettings();
 
-		/** Remove redundant settings */
-		for (auto& SubsystemSetting : SubsystemSettings)
-		{
-			if (SubsystemSetting.Key != SupportedSubsystem)
-			{
-				for (auto& Setting : SubsystemSetting.Value)
-				{
-					for (auto& Pair : Setting.Value)
-					{
-						GConfig->RemoveKey(
-						*Setting.Key,
-						*Pair.Key,
-						DefaultEngineIni);
-					}
-				}
-			}
-		}
+		/** Apply settings of the supported subsystem, remove the redundant ones of all others */
+		FEnhancedOnlineConfigSync::FConfigValues ValuesToSet;
+		FEnhancedOnlineConfigSync::FConfigValues ValuesToRemove;
 
-		/** Apply settings */
 		for (auto& SubsystemSetting : SubsystemSettings)
 		{
-			if (SubsystemSetting.Key == SupportedSubsystem)
+			FEnhancedOnlineConfigSync::FConfigValues& Target = SubsystemSetting.Key == SupportedSubsystem ? ValuesToSet : ValuesToRemove;
+			for (auto& Setting : SubsystemSetting.Value)
 			{
-				for (auto& Setting : SubsystemSetting.Value)
-				{
-					for (auto& Pair : Setting.Value)
-					{
-						GConfig->SetString(
-							*Setting.Key,
-							*Pair.Key,
-							*Pair.Value,
-							DefaultEngineIni);
-					}
-				}	
+				Target.FindOrAdd(Setting.Key).Append(Setting.Value);
 			}
 		}
 
-		GConfig->Flush(false, DefaultEngineIni);
-			
-		Settings->SaveConfig(CPF_Config, *DefaultEngineIni);
+		ValuesToSet.FindOrAdd(SETTINGS_SECTION).Add(TEXT("SupportedSubsystem"), StaticEnum<ESupportedSubsystem>()->GetNameStringByValue(static_cast<int64>(SupportedSubsystem)));
+
+		// Written once the user stopped editing for a moment
+		const int32 NumChanges = ConfigSync->SetDesired(ValuesToSet, ValuesToRemove);
+		UE_LOG(LogTemp, Verbose, TEXT("Property changed, %d keys queued for: %s"), NumChanges, *GetDefaultEngineIni());
+	}
+}
 
-		UE_LOG(LogTemp, Warning, TEXT("Property changed, saving to: %s"), *DefaultEngineIni);
+void UEnhancedOnlineSubsystemSettings::FlushPendingConfigEdits()
+{
+	if (ConfigSync.IsValid())
+	{
+		ConfigSync->Flush();
+	}
+}
 
-		ISettingsEditorModule* SettingsEditorModule = FModuleManager::GetModulePtr<ISettingsEditorModule>("SettingsEditor");
-		if (SettingsEditorModule)
-		{
-			SettingsEditorModule->OnApplicationRestartRequired();
-		}
+void UEnhancedOnlineSubsystemSettings::HandleConfigWritten()
+{
+	UE_LOG(LogTemp, Warning, TEXT("Settings changed, saved to: %s"), *GetDefaultEngineIni());
+
+	ISettingsEditorModule* SettingsEditorModule = FModuleManager::GetModulePtr<ISettingsEditorModule>("SettingsEditor");
+	if (SettingsEditorModule)
+	{
+		SettingsEditorModule->OnApplicationRestartRequired();
 	}
 }
 
@@ -239,3 +221,10 @@ FString UEnhancedOnlineSubsystemSettings::GetNetDriverDefinition(ESupportedSubsy
 		return TEXT("GameNetDriver SteamNetDriver");
 	}
 }
+
+FString UEnhancedOnlineSubsystemSettings::GetDefaultEngineIni()
+{
+	return FConfigCacheIni::NormalizeConfigIniPath(FPaths::SourceConfigDir() / TEXT("DefaultEngine.ini"));
+}
+
+#undef SETTINGS_SECTION
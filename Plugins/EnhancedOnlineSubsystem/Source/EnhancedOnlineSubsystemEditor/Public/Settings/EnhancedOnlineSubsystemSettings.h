@@ -6,6 +6,8 @@
 #include "UObject/Object.h"
 #include "EnhancedOnlineSubsystemSettings.generated.h"
 
+class FEnhancedOnlineConfigSync;
+
 /**
  * Enum to define the supported online subsystem used by the plugin.
  */
@@ -40,8 +42,18 @@ public:
 	void UpdateSubsystemSettings();
 	void LoadSubsystemSettings();
 
+	/** Writes edits that are still waiting for the debounce delay */
+	void FlushPendingConfigEdits();
+
 	static FString GetDefaultPlatformService(ESupportedSubsystem Subsystem);
 	static FString GetNetDriverDefinition(ESupportedSubsystem Subsystem);
+	static FString GetDefaultEngineIni();
+
+private:
+	void HandleConfigWritten();
+
+	/** Diffs the settings against DefaultEngine.ini and writes only the changed keys */
+	TSharedPtr<FEnhancedOnlineConfigSync> ConfigSync;
 
 public:
 